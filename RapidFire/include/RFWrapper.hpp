@@ -58,12 +58,15 @@ public:
     typedef RFStatus            (RAPIDFIRE_API *RF_GET_RENDERTARGET_STATE)    (RFEncodeSession s, RFRenderTargetState* state, const unsigned int idx);
     typedef RFStatus            (RAPIDFIRE_API *RF_RESIZE_SESSION)            (RFEncodeSession s, const unsigned int uiWidth, const unsigned int uiHeight);
     typedef RFStatus            (RAPIDFIRE_API *RF_ENCODE_FRAME)              (RFEncodeSession s, const unsigned int idx);
+    typedef RFStatus            (RAPIDFIRE_API *RF_ENCODE_FRAME_ASYNC)        (RFEncodeSession s, const unsigned int idx, RFEncodeCallback pCallback, void* pUserData);
     typedef RFStatus            (RAPIDFIRE_API *RF_GET_ENCODED_FRAME)         (RFEncodeSession s, unsigned int* uiSize, void** pBitStream);
+    typedef RFStatus            (RAPIDFIRE_API *RF_WAIT_ENCODED_FRAME)        (RFEncodeSession s, unsigned long long uiTimeoutNs, unsigned int* uiSize, void** pBitStream);
     typedef RFStatus            (RAPIDFIRE_API *RF_GET_SOURCE_FRAME)          (RFEncodeSession s, unsigned int* uiSize, void** pBitStream);
     typedef RFStatus            (RAPIDFIRE_API *RF_SET_ENCODE_PARAMETER)      (RFEncodeSession s, const int param, const RFProperties value);
     typedef RFStatus            (RAPIDFIRE_API *RF_GET_ENCODE_PARAMETER)      (RFEncodeSession s, const int param, RFProperties* value);
     typedef RFStatus            (RAPIDFIRE_API *RF_GET_MOUSEDATA)             (RFEncodeSession s, const int iWaitForShapeChange, RFMouseData* md);
     typedef RFStatus            (RAPIDFIRE_API *RF_RELEASE_EVENT)             (RFEncodeSession s, const RFNotification rfNotification);
+    typedef RFStatus            (RAPIDFIRE_API *RF_GET_SESSION_STATS)         (RFEncodeSession s, RFSessionStats* pStats);
 
     static const RFWrapper& getInstance()
     {
@@ -84,12 +87,15 @@ public:
         RF_GET_RENDERTARGET_STATE   rfGetRenderTargetState;
         RF_RESIZE_SESSION           rfResizeSession;
         RF_ENCODE_FRAME             rfEncodeFrame;
+        RF_ENCODE_FRAME_ASYNC       rfEncodeFrameAsync;
         RF_GET_ENCODED_FRAME        rfGetEncodedFrame;
+        RF_WAIT_ENCODED_FRAME       rfWaitEncodedFrame;
         RF_GET_SOURCE_FRAME         rfGetSourceFrame;
         RF_SET_ENCODE_PARAMETER     rfSetEncodeParameter;
         RF_GET_ENCODE_PARAMETER     rfGetEncodeParameter;
         RF_GET_MOUSEDATA            rfGetMouseData;
         RF_RELEASE_EVENT            rfReleaseEvent;
+        RF_GET_SESSION_STATS        rfGetSessionStats;
     };
 
     RFFunctions rfFunc;
@@ -151,12 +157,15 @@ bool RFWrapper::loadFunctions()
     GET_RF_PROC(rfGetRenderTargetState);
     GET_RF_PROC(rfResizeSession);
     GET_RF_PROC(rfEncodeFrame);
+    GET_RF_PROC(rfEncodeFrameAsync);
     GET_RF_PROC(rfGetEncodedFrame);
+    GET_RF_PROC(rfWaitEncodedFrame);
     GET_RF_PROC(rfGetSourceFrame);
     GET_RF_PROC(rfSetEncodeParameter);
     GET_RF_PROC(rfGetEncodeParameter);
     GET_RF_PROC(rfGetMouseData);
     GET_RF_PROC(rfReleaseEvent);
+    GET_RF_PROC(rfGetSessionStats);
 
     return true;
 }
@@ -57,6 +57,9 @@ typedef intptr_t            RFProperties;
 typedef void*               RFEncodeSession;
 typedef void*               RFRenderTarget;
 
+// Timeout for rfWaitEncodedFrame to wait until a frame is available.
+#define RF_INFINITE_TIMEOUT 0xFFFFFFFFFFFFFFFFULL
+
 /**************************************************************************
 * The RapidFire API status *
 **************************************************************************/
@@ -118,6 +121,13 @@ typedef enum RFSessionParams
     RF_ENCODER_BLOCKING_READ          = 0x1015,
     RF_MOUSE_DATA                     = 0x1016,
     RF_DESKTOP_INTERNAL_DSP_ID        = 0x1017,
+    RF_HOST_MEMORY                    = 0x1018,
+    RF_FILE_SOURCE                    = 0x1019,
+    RF_FILE_SOURCE_WIDTH              = 0x101A,
+    RF_FILE_SOURCE_HEIGHT             = 0x101B,
+    RF_FILE_SOURCE_FORMAT             = 0x101C,
+    RF_FILE_SOURCE_FPS                = 0x101D,
+    RF_PIPELINE_DEPTH                 = 0x101E,
 } RFSessionParams;
 
 
@@ -159,6 +169,17 @@ typedef enum RFEncoderParams
     RF_DIFF_ENCODER_BLOCK_S              	= 0x1154,
     RF_DIFF_ENCODER_BLOCK_T                	= 0x1155,
     RF_DIFF_ENCODER_LOCK_BUFFER             = 0x1156,
+    RF_DIFF_ENCODER_MAP_FORMAT              = 0x1157,
+    RF_DIFF_ENCODER_SUPERBLOCK_MAP          = 0x1158,
+    RF_DIFF_ENCODER_HASH_BLOCKS             = 0x1159,
+    RF_DIFF_ENCODER_MOVE_DETECTION          = 0x115A,
+    RF_DIFF_ENCODER_PIXEL_THRESHOLD         = 0x115B,
+    RF_DIFF_ENCODER_BLOCK_THRESHOLD         = 0x115C,
+    RF_DIFF_ENCODER_MIN_CHANGED_PIXELS      = 0x115D,
+    RF_DIFF_ENCODER_ACCUMULATE              = 0x115E,
+    RF_DIFF_ENCODER_ACKNOWLEDGE             = 0x115F,
+    RF_DIFF_ENCODER_BLOCK_VERSIONS          = 0x1160,
+    RF_DIFF_ENCODER_WAIT_TIMEOUT            = 0x1161,
 
     // AVC Pre Submit parameters
     RF_ENCODER_FORCE_INTRA_REFRESH          = 0x1061,
@@ -281,6 +302,13 @@ typedef struct
 * @RF_BGRA8: 32-bit RGB with Alpha, each pixel is represented by one byte each
 *            for the red, green, blue, and alpha channels.
 * @RF_NV12:  8-bit Y plane followed by an interleaved U/V plane with 2x2 subsampling.
+* @RF_I420:  8-bit Y plane followed by a U and a V plane with 2x2 subsampling. The
+*            pitch of the U and V plane is half the pitch of the Y plane.
+* @RF_P010:  16-bit Y plane followed by an interleaved U/V plane with 2x2 subsampling.
+*            The 10-bit samples are stored in the upper bits. Register RGB10_A2 or
+*            16-bit float render targets to keep the precision of the input. Values
+*            of float render targets are clamped to [0, 1]. Supported by the identity
+*            and the HEVC encoder, not supported for render targets in host memory.
 *
 *******************************************************************************
 */
@@ -290,7 +318,9 @@ typedef enum RFFormat
     RF_RGBA8          =  0,
     RF_ARGB8          =  1,
     RF_BGRA8          =  2,
-    RF_NV12           =  3
+    RF_NV12           =  3,
+    RF_I420           =  4,
+    RF_P010           =  5
 } RFFormat;
 
 /**
@@ -342,20 +372,178 @@ typedef enum RFEncodePreset
 * @enum RFEncoderID
 * @brief This is the type of the encoder.
 *
-* @RF_AMF:        AMD Media Foundation library encoder (HW).
-* @RF_IDENTITY:   Identity encoder which returns the captured texture.
-* @RF_DIFFERENCE: Difference encoder returns a difference map with 1 where the source image has changed and 0 otherwise.
+* @RF_AMF:              AMD Media Foundation library encoder (HW).
+* @RF_IDENTITY:         Identity encoder which returns the captured texture.
+* @RF_DIFFERENCE:       Difference encoder returns a difference map with 1 where the source image has changed and 0 otherwise.
+* @RF_DIFFERENCE_TILES: Difference encoder that returns the difference map followed by the pixels of all changed blocks.
+* @RF_LOSSLESS_TILES:   Like RF_DIFFERENCE_TILES but the pixels of each changed block are compressed without loss.
 *
 *******************************************************************************
 */
 typedef enum RFEncoderID
 {
-    RF_ENCODER_UNKNOWN = -1,
-    RF_AMF             =  0,
-    RF_IDENTITY        =  1,
-    RF_DIFFERENCE      =  2
+    RF_ENCODER_UNKNOWN  = -1,
+    RF_AMF              =  0,
+    RF_IDENTITY         =  1,
+    RF_DIFFERENCE       =  2,
+    RF_DIFFERENCE_TILES =  3,
+    RF_LOSSLESS_TILES   =  4
 } RFEncoderID;
 
+/**
+*******************************************************************************
+* @enum RFDiffMapFormat
+* @brief This is the layout of the difference map returned by the RF_DIFFERENCE
+*        encoder. It is selected with RF_DIFF_ENCODER_MAP_FORMAT. Blocks are
+*        stored row by row, the first block is the top left block.
+*
+* @RF_DIFF_MAP_BYTE: One byte per block that is 1 if the block has changed and 0 otherwise.
+* @RF_DIFF_MAP_BIT:  One bit per block. Block x of a row is stored in bit (x % 8) of
+*                    byte (x / 8). Each row is padded to a multiple of 4 bytes.
+* @RF_DIFF_MAP_RLE:  Row run length encoding. Each row starts with a 16-bit number of
+*                    runs N followed by N pairs of 16-bit values: the first changed block
+*                    of the run and the number of changed blocks. All values are little
+*                    endian. Rows without changes only take 2 bytes. The size of the map
+*                    varies from frame to frame.
+* @RF_DIFF_MAP_RECT: List of RFDiffRect in pixels that cover all changed blocks. Adjacent
+*                    changed blocks are merged into rectangles as long as at most a quarter
+*                    of the blocks of a rectangle did not change. The rectangles do not
+*                    overlap. The number of rectangles is the size of the map divided by
+*                    sizeof(RFDiffRect).
+*
+*******************************************************************************
+*/
+typedef enum RFDiffMapFormat
+{
+    RF_DIFF_MAP_BYTE = 0,
+    RF_DIFF_MAP_BIT  = 1,
+    RF_DIFF_MAP_RLE  = 2,
+    RF_DIFF_MAP_RECT = 3
+} RFDiffMapFormat;
+
+/**
+*******************************************************************************
+* @struct RFDiffRect
+* @brief Rectangle of changed pixels returned by the RF_DIFFERENCE encoder if
+*        RF_DIFF_ENCODER_MAP_FORMAT is RF_DIFF_MAP_RECT. The rectangle is
+*        clipped to the size of the encoder.
+*
+* @uiX:      Left edge of the rectangle in pixels.
+* @uiY:      Top edge of the rectangle in pixels.
+* @uiWidth:  Width of the rectangle in pixels.
+* @uiHeight: Height of the rectangle in pixels.
+*
+*******************************************************************************
+*/
+typedef struct
+{
+    unsigned int    uiX;
+    unsigned int    uiY;
+    unsigned int    uiWidth;
+    unsigned int    uiHeight;
+} RFDiffRect;
+
+/**
+*******************************************************************************
+* @struct RFDiffMoveRect
+* @brief Copy command returned by the RF_DIFFERENCE encoder if
+*        RF_DIFF_ENCODER_MOVE_DETECTION is set. The rectangle at uiDstX, uiDstY
+*        of the current frame is the same as the rectangle at uiSrcX, uiSrcY of
+*        the previous frame. Copies are applied to the previous frame in the order
+*        they are listed, the destination of a copy does not overlap the source or
+*        destination of any other copy. Blocks that are completely covered by the
+*        destination of a copy are not marked as changed in the diff map.
+*
+* @uiSrcX:   Left edge of the source in pixels.
+* @uiSrcY:   Top edge of the source in pixels.
+* @uiDstX:   Left edge of the destination in pixels.
+* @uiDstY:   Top edge of the destination in pixels.
+* @uiWidth:  Width of the rectangle in pixels.
+* @uiHeight: Height of the rectangle in pixels.
+*
+*******************************************************************************
+*/
+typedef struct
+{
+    unsigned int    uiSrcX;
+    unsigned int    uiSrcY;
+    unsigned int    uiDstX;
+    unsigned int    uiDstY;
+    unsigned int    uiWidth;
+    unsigned int    uiHeight;
+} RFDiffMoveRect;
+
+/**
+*******************************************************************************
+* @struct RFDiffTile
+* @brief Position of a changed block returned by the RF_DIFFERENCE_TILES encoder.
+*        The pixels of the tiles follow the list of RFDiffTile in the same order.
+*        Each tile has the block size RF_DIFF_ENCODER_BLOCK_S x RF_DIFF_ENCODER_BLOCK_T
+*        and is stored row by row with 4 bytes per pixel in the input format of the
+*        encoder. Pixels outside of the image are 0.
+*
+* @uiX:      Left edge of the tile in pixels.
+* @uiY:      Top edge of the tile in pixels.
+*
+*******************************************************************************
+*/
+typedef struct
+{
+    unsigned int    uiX;
+    unsigned int    uiY;
+} RFDiffTile;
+
+/**
+*******************************************************************************
+* @struct RFDiffMapHeader
+* @brief If RF_DIFF_ENCODER_SUPERBLOCK_MAP or RF_DIFF_ENCODER_MOVE_DETECTION is
+*        set, the map returned by the RF_DIFFERENCE encoder starts with this header.
+*        It is followed by a superblock map with one byte per superblock that is 1
+*        if any block of the superblock has changed. A superblock covers at least
+*        64x64 pixels and is a multiple of the block size. The diff map in the format
+*        selected by RF_DIFF_ENCODER_MAP_FORMAT follows at uiMapOffset. If moves are
+*        detected, a list of RFDiffMoveRect follows at uiMoveRectOffset.
+*        The RF_DIFFERENCE_TILES encoder always returns the header. The list of
+*        RFDiffTile starts at uiTileOffset and is followed by the pixels of the tiles.
+*        The RF_LOSSLESS_TILES encoder returns the same layout up to the end of the
+*        tile list. It is followed by uiNumTiles 32-bit sizes of the compressed tiles
+*        and the compressed tiles in the same order, which are decompressed with
+*        rfDecodeLosslessTile.
+*
+* @uiNumChangedBlocks:    Number of changed blocks. 0 if the frame did not change.
+* @uiNumSuperBlocksX:     Number of superblocks in x direction.
+* @uiNumSuperBlocksY:     Number of superblocks in y direction.
+* @uiSuperBlockWidth:     Width of a superblock in pixels.
+* @uiSuperBlockHeight:    Height of a superblock in pixels.
+* @uiSuperBlockMapOffset: Offset of the superblock map in bytes from the start of the header.
+* @uiMapOffset:           Offset of the diff map in bytes from the start of the header.
+* @uiMapSize:             Size of the diff map in bytes.
+* @uiNumMoveRects:        Number of RFDiffMoveRect. Always 0 if moves are not detected.
+* @uiMoveRectOffset:      Offset of the RFDiffMoveRect list in bytes from the start of the header.
+* @uiNumTiles:            Number of RFDiffTile. Always 0 for the RF_DIFFERENCE encoder.
+* @uiTileOffset:          Offset of the RFDiffTile list in bytes from the start of the header.
+* @uiVersion:             Version of the frame. Frames are numbered from 1 in the order they
+*                         were encoded. Can be passed to rfGetChangedBlocks.
+*
+*******************************************************************************
+*/
+typedef struct
+{
+    unsigned int    uiNumChangedBlocks;
+    unsigned int    uiNumSuperBlocksX;
+    unsigned int    uiNumSuperBlocksY;
+    unsigned int    uiSuperBlockWidth;
+    unsigned int    uiSuperBlockHeight;
+    unsigned int    uiSuperBlockMapOffset;
+    unsigned int    uiMapOffset;
+    unsigned int    uiMapSize;
+    unsigned int    uiNumMoveRects;
+    unsigned int    uiMoveRectOffset;
+    unsigned int    uiNumTiles;
+    unsigned int    uiTileOffset;
+    unsigned int    uiVersion;
+} RFDiffMapHeader;
+
 /**
 *******************************************************************************
 * @enum RFRenderTargetState
@@ -376,6 +564,28 @@ typedef enum RFRenderTargetState
     RF_STATE_BLOCKED =  1
 } RFRenderTargetState;
 
+/**
+*******************************************************************************
+* @struct RFHostRenderTarget
+* @brief Describes a render target located in system memory. It is used by
+*        sessions created with RF_HOST_MEMORY. A pointer to this struct is
+*        passed as RFRenderTarget to rfRegisterRenderTarget.
+*
+* @pBuffer: Pointer to the first pixel of the image. The memory has to stay
+*           valid until the render target is removed.
+* @uiPitch: Number of bytes between two lines of the image.
+* @format:  Format of the image. Supported formats are RF_RGBA8, RF_ARGB8 and
+*           RF_BGRA8.
+*
+*******************************************************************************
+*/
+typedef struct
+{
+    void*           pBuffer;
+    unsigned int    uiPitch;
+    RFFormat        format;
+} RFHostRenderTarget;
+
 /**
 *******************************************************************************
 * @enum RFNotification
@@ -399,6 +609,88 @@ typedef enum RFNotification
     RFMouseShapeNotification = 2
 } RFNotification;
 
+/**
+*******************************************************************************
+* @typedef RFEncodedFrameInfo
+* @brief This structure is passed to the RFEncodeCallback of rfEncodeFrameAsync.
+*        All time stamps are taken from the same monotonic clock in nanoseconds.
+*
+* @uiFrameId:          Id of the frame. The frames submitted by rfEncodeFrameAsync
+*                      are numbered starting with 0 after rfCreateEncoder.
+* @rfStatus:           RF_STATUS_OK if pBitStream contains the encoded frame.
+*                      RF_STATUS_NO_ENCODED_FRAME if the frame was discarded, e.g.
+*                      because the session was resized or deleted.
+* @pBitStream:         Encoded frame. Only valid until the callback returns.
+* @uiSize:             Size of pBitStream in bytes.
+* @uiSubmitTimeNs:     Time rfEncodeFrameAsync was called.
+* @uiPreprocessTimeNs: Time the source was preprocessed, e.g. the desktop was captured.
+* @uiEncodeTimeNs:     Time the frame was submitted to the encoder.
+* @uiCompleteTimeNs:   Time the encoded frame was available.
+*
+*******************************************************************************
+*/
+typedef struct
+{
+    unsigned int        uiFrameId;
+    RFStatus            rfStatus;
+    void*               pBitStream;
+    unsigned int        uiSize;
+    unsigned long long  uiSubmitTimeNs;
+    unsigned long long  uiPreprocessTimeNs;
+    unsigned long long  uiEncodeTimeNs;
+    unsigned long long  uiCompleteTimeNs;
+} RFEncodedFrameInfo;
+
+/**
+*******************************************************************************
+* @typedef RFEncodeCallback
+* @brief Callback of rfEncodeFrameAsync. It is called by the completion thread
+*        of the session, one call per submitted frame in submission order.
+*        Frames that are returned by rfResizeSession or rfDeleteEncodeSession
+*        are passed to the callback on the thread that called these functions.
+*        The callback may call functions of the same session, e.g. to submit
+*        the next frame, but must not call rfResizeSession or
+*        rfDeleteEncodeSession for it.
+*
+*******************************************************************************
+*/
+typedef void (RAPIDFIRE_API *RFEncodeCallback)(RFEncodeSession session, const RFEncodedFrameInfo* pFrameInfo, void* pUserData);
+
+/**
+*******************************************************************************
+* @typedef RFSessionStats
+* @brief This structure is filled by rfGetSessionStats. The counters are accumulated
+*        over the lifetime of the session.
+*
+* @uiFramesSubmitted: Number of frames that were submitted to the encoder.
+* @uiFramesEncoded:   Number of encoded frames that were returned to the application.
+* @uiFramesDropped:   Number of submitted frames that were discarded before they were
+*                     returned, e.g. because the session was resized.
+* @uiQueueFullCount:  Number of times rfEncodeFrame or rfEncodeFrameAsync returned
+*                     RF_STATUS_QUEUE_FULL.
+* @uiQueueDepth:      Number of frames that are currently submitted but not yet returned.
+* @uiEncodedBytes:    Sum of the sizes of all returned encoded frames.
+* @uiLatencyP50Ns:    Median time between the submission of a frame and the time the
+*                     encoded frame was returned, in nanoseconds.
+* @uiLatencyP95Ns:    95th percentile of the latency in nanoseconds.
+* @uiLatencyP99Ns:    99th percentile of the latency in nanoseconds.
+*                     The percentiles have a relative error below 12.5%.
+*
+*******************************************************************************
+*/
+typedef struct
+{
+    unsigned long long  uiFramesSubmitted;
+    unsigned long long  uiFramesEncoded;
+    unsigned long long  uiFramesDropped;
+    unsigned long long  uiQueueFullCount;
+    unsigned int        uiQueueDepth;
+    unsigned long long  uiEncodedBytes;
+    unsigned long long  uiLatencyP50Ns;
+    unsigned long long  uiLatencyP95Ns;
+    unsigned long long  uiLatencyP99Ns;
+} RFSessionStats;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -413,6 +705,9 @@ extern "C" {
     * @param[in] properties: Specifies a list of session property names and their
     *                        corresponding values.
     *                        The list is terminated with 0.
+    *                        RF_PIPELINE_DEPTH defines the number of result buffers
+    *                        of the session (2 to 16, default 3). Up to 3 render
+    *                        targets can be registered independent of the depth.
     *
     * @return RFEncodeSession: RF_STATUS_OK if successful; otherwise an error code and session is set to NULL.
     *******************************************************************************
@@ -474,7 +769,11 @@ extern "C" {
     * @fn rfRegisterRenderTarget
     * @brief This function registers a render target that is created by the user
     *        and returns the index used for this render target in idx.
-    *        The render target must have the same dimesnions as the encoder.
+    *        All render targets of a session must have the same dimensions. If
+    *        they differ from the dimensions of the encoder, the render target
+    *        is scaled to the encoder dimensions by the color space conversion.
+    *        Scaling is not supported by the AMF encoder and for YUV host render
+    *        targets.
     *
     * @param[in] session:      The encoding session.
     * @param[in] renderTarget: The handle of the render target.
@@ -550,6 +849,35 @@ extern "C" {
     */
     RFStatus RAPIDFIRE_API rfEncodeFrame(RFEncodeSession session, const unsigned int idx);
 
+    /**
+    *******************************************************************************
+    * @fn rfEncodeFrameAsync
+    * @brief This function encodes the render target with id idx like rfEncodeFrame.
+    *        Once the encoded frame is available, pCallback is called from a
+    *        completion thread that is owned by the session. The application
+    *        does not need to poll rfGetEncodedFrame.
+    *        After the first successful call to rfEncodeFrameAsync the session
+    *        only accepts asynchronous encoding; rfEncodeFrame, rfGetEncodedFrame
+    *        and rfWaitEncodedFrame will fail. If the first call fails the session
+    *        stays in synchronous mode. The first call fails as long as frames
+    *        submitted by rfEncodeFrame were not retrieved.
+    *        Frames that are still in flight when the session is resized or
+    *        deleted are returned by rfResizeSession or rfDeleteEncodeSession.
+    *        While rfResizeSession runs, rfEncodeFrameAsync fails with
+    *        RF_STATUS_FAIL.
+    *
+    * @param[in] session:   The encoding session.
+    * @param[in] idx:       The index of the render target which will be encoded.
+    *                       (ignored for encoding sessions with a desktop set as source)
+    * @param[in] pCallback: Function that receives the encoded frame.
+    * @param[in] pUserData: Passed to pCallback.
+    *
+    * @return RFStatus: RF_STATUS_OK if successful; otherwise an error code. The
+    *                   callback is only called if RF_STATUS_OK was returned.
+    *******************************************************************************
+    */
+    RFStatus RAPIDFIRE_API rfEncodeFrameAsync(RFEncodeSession session, const unsigned int idx, RFEncodeCallback pCallback, void* pUserData);
+
     /**
     *******************************************************************************
     * @fn rfGetEncodedFrame
@@ -565,6 +893,26 @@ extern "C" {
     */
     RFStatus RAPIDFIRE_API rfGetEncodedFrame(RFEncodeSession session, unsigned int* uiSize, void** pBitStream);
 
+    /**
+    *******************************************************************************
+    * @fn rfWaitEncodedFrame
+    * @brief This function blocks until an encoded frame is available or the timeout
+    *        elapsed and returns the frame like rfGetEncodedFrame. The calling thread
+    *        sleeps while waiting. It can be used by a reader thread instead of
+    *        polling rfGetEncodedFrame.
+    *
+    * @param[in] session:     The encoding session.
+    * @param[in] uiTimeoutNs: Maximum time to wait in nanoseconds. 0 does not wait,
+    *                         RF_INFINITE_TIMEOUT waits until a frame is available.
+    * @param[out] uiSize:     The size (in bytes) of the bit stream.
+    * @param[out] pBitStream: Pointer to the bit stream of the encoded frame.
+    *
+    * @return RFStatus: RF_STATUS_OK if successful; RF_STATUS_NO_ENCODED_FRAME if
+    *                   the timeout elapsed; otherwise an error code.
+    *******************************************************************************
+    */
+    RFStatus RAPIDFIRE_API rfWaitEncodedFrame(RFEncodeSession session, unsigned long long uiTimeoutNs, unsigned int* uiSize, void** pBitStream);
+
     /**
     *******************************************************************************
     * @fn  rfGetSourceFrame
@@ -573,7 +921,8 @@ extern "C" {
     *         image contains the result of the color space conversion.
     *         The function needs to be called prior to rfGetEncodedFrame to guarantee
     *         that the returned image is the source of the encoded image returned by
-    *         rfGetEncodedFrame.
+    *         rfGetEncodedFrame. It can be called by a different thread than
+    *         rfGetEncodedFrame; the calls are serialized by the session.
     *
     * @param[in] session:     The encoding session.
     * @param[out] uiSize:     The size (in bytes) of the source image.
@@ -646,6 +995,86 @@ extern "C" {
     */
     RFStatus RAPIDFIRE_API rfReleaseEvent(RFEncodeSession session, const RFNotification rfNotification);
 
+    /**
+    *******************************************************************************
+    * @fn rfGetSessionStats
+    * @brief This function returns the frame counters and latency percentiles of
+    *        the session. It can be called from any thread.
+    *
+    * @param[in]  session: The encoding session.
+    * @param[out] pStats:  Pointer to a RFSessionStats structure that is filled.
+    *
+    * @return RFStatus: RF_STATUS_OK if successful; otherwise an error code.
+    *******************************************************************************
+    */
+    RFStatus RAPIDFIRE_API rfGetSessionStats(RFEncodeSession session, RFSessionStats* pStats);
+
+    /**
+    *******************************************************************************
+    * @fn rfDecodeLosslessTile
+    * @brief This function decompresses a tile returned by the RF_LOSSLESS_TILES
+    *        encoder. It does not require a session.
+    *
+    *        The first byte of a tile is 0 if the pixels are stored uncompressed,
+    *        otherwise it is 1 and followed by the filter of each row with 2 bits
+    *        per row: row y uses bits 2 * (y % 4) of byte y / 4. Each pixel is the
+    *        byte wise sum of a prediction and a residual. With the row above A,
+    *        which is 0 for the first row, the left neighbour L and the upper left
+    *        neighbour C, where L and C are A[0] for the first pixel of a row, the
+    *        filters predict 0: L, 1: A[x], 2: L + A[x] - C. The residuals of the
+    *        pixels in row order are coded by these operations:
+    *        0x00-0x3E: A run of op + 1 pixels with a residual of 0.
+    *        0x3F:      A run of 64 + N pixels, N follows with 7 bits per byte,
+    *                   the lowest bits first, bit 7 is set if another byte follows.
+    *        0x40-0x7F: Residual of bytes 0-2 in bits 4-5, 2-3, 0-1, each biased by 2.
+    *        0x80-0xBF: Bits 0-5 are the residual g of byte 1 biased by 32. The next
+    *                   byte holds the residuals of byte 0 and 2 minus g biased by 8
+    *                   in bits 4-7 and 0-3.
+    *        0xC0-0xDF: The pixel is entry op - 0xC0 of the pixel cache.
+    *        0xFE:      The residuals of bytes 0-2 follow.
+    *        0xFF:      The residuals of bytes 0-3 follow.
+    *        Unless stated otherwise the residual of byte 3 is 0. After each pixel
+    *        that is not part of a run, the pixel p is stored in entry
+    *        (p * 0x9E3779B1) >> 27 of a cache with 32 entries that starts with 0.
+    *
+    * @param[in]  pTile:        The compressed tile.
+    * @param[in]  uiSize:       Size of the compressed tile in bytes.
+    * @param[in]  uiTileWidth:  RF_DIFF_ENCODER_BLOCK_S of the encoder.
+    * @param[in]  uiTileHeight: RF_DIFF_ENCODER_BLOCK_T of the encoder.
+    * @param[out] pPixels:      Receives uiTileWidth * uiTileHeight pixels with 4 bytes
+    *                           per pixel in the layout of the RF_DIFFERENCE_TILES encoder.
+    *
+    * @return RFStatus: RF_STATUS_OK if successful; otherwise an error code.
+    *******************************************************************************
+    */
+    RFStatus RAPIDFIRE_API rfDecodeLosslessTile(const void* pTile, unsigned int uiSize, unsigned int uiTileWidth, unsigned int uiTileHeight, void* pPixels);
+
+    /**
+    *******************************************************************************
+    * @fn rfGetChangedBlocks
+    * @brief This function returns the blocks that changed after a version of the
+    *        frame. It requires a difference encoder that was created with
+    *        RF_DIFF_ENCODER_BLOCK_VERSIONS. The version of a block is the version
+    *        of the frame in which it changed last. This way several consumers that
+    *        received different frames can be updated by one session. A consumer
+    *        stores pVersion and passes it with its next call. Blocks of frames that
+    *        were encoded but not yet returned by rfGetEncodedFrame are marked as well.
+    *
+    * @param[in]  session:   The encoding session.
+    * @param[in]  uiVersion: Version of the last frame the consumer received or 0.
+    * @param[out] pBlockMap: Receives one byte per block in row order that is 1 if the
+    *                        block changed after uiVersion and 0 otherwise. All
+    *                        blocks are marked after the session was resized.
+    * @param[in]  uiSize:    Size of pBlockMap in bytes. Needs to be at least the
+    *                        number of blocks.
+    * @param[out] pVersion:  Receives the version of the frame that was last returned
+    *                        by rfGetEncodedFrame.
+    *
+    * @return RFStatus: RF_STATUS_OK if successful; otherwise an error code.
+    *******************************************************************************
+    */
+    RFStatus RAPIDFIRE_API rfGetChangedBlocks(RFEncodeSession session, unsigned int uiVersion, void* pBlockMap, unsigned int uiSize, unsigned int* pVersion);
+
 #ifdef __cplusplus
 };
 #endif
@@ -37,6 +37,7 @@
 #include <CL/cl_gl.h>
 
 #include "RFError.h"
+#include "RFTrace.h"
 #include "RFUtils.h"
 
 #define clGetGLContextInfoKHR               clGetGLContextInfoKHR_proc
@@ -676,7 +677,13 @@ bool RFProgramCL::BuildFromSourceCode(cl_context context, const char* sourceCode
 // Native CL context for CSC
 //////////////////////////////////////////////////////////
 RFContextCL::RFContextCL()
-    : m_uiNumResultBuffers(NUM_RESULT_BUFFERS)
+    : RFContextCL(true)
+{}
+
+
+RFContextCL::RFContextCL(bool bRequireCLPlatform)
+    : m_uiNumResultBuffers(0)
+    , m_uiMaxNumRT(MAX_NUM_RENDER_TARGETS)
     , m_bValid(false)
     , m_bUseAsyncCopy(false)
     , m_uiOutputWidth(0)
@@ -696,30 +703,27 @@ RFContextCL::RFContextCL()
     , m_CtxType(RF_CTX_UNKNOWN)
     , m_TargetFormat(RF_FORMAT_UNKNOWN)
     , m_uiCSCKernelIdx(RF_KERNEL_UNKNOWN)
+    , m_uiScaledCSCKernelIdx(RF_KERNEL_UNKNOWN)
     , m_fnAcquireInputMemObj(NULL)
     , m_fnReleaseInputMemObj(NULL)
     , m_fnAcquireDX9Obj(NULL)
     , m_fnReleaseDX9Obj(NULL)
     , m_fnAcquireDX11Obj(NULL)
     , m_fnReleaseDX11Obj(NULL)
+    , m_pTrace(nullptr)
 {
     memset(m_CSCKernels, 0, RF_KERNEL_NUMBER * sizeof(CSC_KERNEL));
 
-    memset(m_clInputImage, 0, MAX_NUM_RENDER_TARGETS * sizeof(cl_mem));
+    RFContextCL::setPipelineDepth(DEFAULT_PIPELINE_DEPTH);
 
-    for (int i = 0; i < NUM_RESULT_BUFFERS; ++i)
+    if (bRequireCLPlatform)
     {
-        m_rtState[i] = RF_STATE_INVALID;
-        m_clResultBuffer[i] = NULL;
-        m_clPageLockedBuffer[i] = NULL;
-        m_pSysmemBuffer[i] = nullptr;
-    }
-
-    m_clPlatformId = CLPlatform::getInstance().id;
+        m_clPlatformId = CLPlatform::getInstance().id;
 
-    if (m_clPlatformId == NULL)
-    {
-        throw std::runtime_error("No AMD platform");
+        if (m_clPlatformId == NULL)
+        {
+            throw std::runtime_error("No AMD platform");
+        }
     }
 
     // get version info of RapidFire.dll
@@ -1324,6 +1328,36 @@ RFStatus RFContextCL::setInputTexture(IDirect3DSurface9* pD3D9Texture, const uns
 }
 
 
+RFStatus RFContextCL::setPipelineDepth(unsigned int uiDepth)
+{
+    if (uiDepth < MIN_PIPELINE_DEPTH || uiDepth > MAX_PIPELINE_DEPTH)
+    {
+        return RF_STATUS_INVALID_SESSION_PROPERTIES;
+    }
+
+    // The rings can only be resized as long as they are not in use.
+    if (m_uiNumRegisteredRT > 0 || m_nOutputBufferSize > 0)
+    {
+        return RF_STATUS_FAIL;
+    }
+
+    m_uiNumResultBuffers = uiDepth;
+
+    // The number of render targets does not change with the depth. The slots are reset like the rings.
+    m_clInputImage.assign(m_uiMaxNumRT, NULL);
+    m_rtState.assign(m_uiMaxNumRT, RF_STATE_INVALID);
+
+    m_clResultBuffer.assign(m_uiNumResultBuffers, NULL);
+    m_clPageLockedBuffer.assign(m_uiNumResultBuffers, NULL);
+    m_pSysmemBuffer.assign(m_uiNumResultBuffers, nullptr);
+
+    m_clDMAFinished.reset(new RFEventCL[m_uiNumResultBuffers]);
+    m_clCSCFinished.reset(new RFEventCL[m_uiNumResultBuffers]);
+
+    return RF_STATUS_OK;
+}
+
+
 RFStatus RFContextCL::createBuffers(RFFormat format, unsigned int uiWidth, unsigned int uiHeight, unsigned int uiAlignedWidth, unsigned int uiAlignedHeight, bool bUseAsyncCopy)
 {
     cl_int nStatus;
@@ -1333,9 +1367,8 @@ RFStatus RFContextCL::createBuffers(RFFormat format, unsigned int uiWidth, unsig
         return RF_STATUS_INVALID_OPENCL_CONTEXT;
     }
 
-    if (!validateDimensions(uiWidth, uiHeight))
+    if (!validateOutputDimensions(uiWidth, uiHeight))
     {
-        // Scaling is not supported.
         return RF_STATUS_INVALID_DIMENSION;
     }
 
@@ -1350,14 +1383,30 @@ RFStatus RFContextCL::createBuffers(RFFormat format, unsigned int uiWidth, unsig
     {
         case RF_NV12:
             m_uiCSCKernelIdx = RF_KERNEL_RGBA_TO_NV12;
+            m_uiScaledCSCKernelIdx = RF_KERNEL_RGBA_TO_NV12_SCALED;
             // NV12 width * height * 1 Byte for the Y plane + width * height / 2 for the UV interleaved plane (CbCr)
             m_nOutputBufferSize = (m_uiAlignedOutputWidth * m_uiAlignedOutputHeight) + (m_uiAlignedOutputWidth * m_uiAlignedOutputHeight) / 2;
             break;
 
+        case RF_I420:
+            m_uiCSCKernelIdx = RF_KERNEL_RGBA_TO_I420;
+            m_uiScaledCSCKernelIdx = RF_KERNEL_RGBA_TO_I420_SCALED;
+            // I420 width * height * 1 Byte for the Y plane + width * height / 4 for the U and for the V plane
+            m_nOutputBufferSize = (m_uiAlignedOutputWidth * m_uiAlignedOutputHeight) + (m_uiAlignedOutputWidth * m_uiAlignedOutputHeight) / 2;
+            break;
+
+        case RF_P010:
+            m_uiCSCKernelIdx = RF_KERNEL_RGBA_TO_P010;
+            m_uiScaledCSCKernelIdx = RF_KERNEL_RGBA_TO_P010_SCALED;
+            // P010 uses 2 Bytes per sample: width * height * 2 for the Y plane + width * height for the UV interleaved plane
+            m_nOutputBufferSize = (m_uiAlignedOutputWidth * m_uiAlignedOutputHeight) * 3;
+            break;
+
         case RF_RGBA8:
         case RF_ARGB8:
         case RF_BGRA8:
             m_uiCSCKernelIdx = RF_KERNEL_RGBA_COPY;
+            m_uiScaledCSCKernelIdx = RF_KERNEL_RGBA_COPY_SCALED;
             m_nOutputBufferSize = m_uiAlignedOutputWidth * m_uiAlignedOutputHeight * 4;
             break;
 
@@ -1368,9 +1417,9 @@ RFStatus RFContextCL::createBuffers(RFFormat format, unsigned int uiWidth, unsig
     // Store target format. The CSC Context will convert the registered texture into this format.
     m_TargetFormat = format;
 
-    // Create NUM_RESULT_BUFFERS OpenCL buffers that will contain the YUV coded colors.
+    // Create m_uiNumResultBuffers OpenCL buffers that will contain the YUV coded colors.
     // An OpenCL kernel will convert color values from m_clImageBufferRGBA to YUV buffers.
-    for (int i = 0; i < NUM_RESULT_BUFFERS; ++i)
+    for (unsigned int i = 0; i < m_uiNumResultBuffers; ++i)
     {
         // Create a pinned OpenCL buffer which is used to copy data back from the GPU to sys mem.
         m_clPageLockedBuffer[i] = clCreateBuffer(m_clCtx, CL_MEM_WRITE_ONLY | CL_MEM_ALLOC_HOST_PTR, m_nOutputBufferSize, nullptr, &nStatus);
@@ -1417,7 +1466,7 @@ RFStatus RFContextCL::createBuffers(RFFormat format, unsigned int uiWidth, unsig
 
 RFStatus RFContextCL::deleteBuffers()
 {
-    for (int i = 0; i < NUM_RESULT_BUFFERS; ++i)
+    for (unsigned int i = 0; i < m_uiNumResultBuffers; ++i)
     {
         m_clCSCFinished[i].release();
         m_clDMAFinished[i].release();
@@ -1435,7 +1484,7 @@ RFStatus RFContextCL::deleteBuffers()
 
     cl_int nStatus = CL_SUCCESS;
 
-    for (int i = 0; i < NUM_RESULT_BUFFERS; ++i)
+    for (unsigned int i = 0; i < m_uiNumResultBuffers; ++i)
     {
         if (m_clPageLockedBuffer[i])
         {
@@ -1453,18 +1502,18 @@ RFStatus RFContextCL::deleteBuffers()
             nStatus |= clReleaseMemObject(m_clResultBuffer[i]);
             m_clResultBuffer[i] = NULL;
         }
-
-        m_rtState[i] = RF_STATE_INVALID;
     }
 
 
-    for (unsigned int i = 0; i < MAX_NUM_RENDER_TARGETS; ++i)
+    for (unsigned int i = 0; i < m_uiMaxNumRT; ++i)
     {
         if (m_clInputImage[i])
         {
             nStatus |= clReleaseMemObject(m_clInputImage[i]);
             m_clInputImage[i] = NULL;
         }
+
+        m_rtState[i] = RF_STATE_INVALID;
     }
 
     if (nStatus != CL_SUCCESS)
@@ -1485,13 +1534,12 @@ RFStatus RFContextCL::deleteBuffers()
 }
 
 
-// validateDimensions is called either when a new input texture is registered or when the result buffers
-// are created. An input texture might have been registered before the result buffer is created,
-// or vice versa. In any case the dimensions have to match.
+// validateDimensions is called when a new input texture is registered. An input texture might have been
+// registered before the result buffer is created, or vice versa. All input textures need to have the same
+// dimensions. If the context cannot scale, the result buffers need to match them as well.
 bool RFContextCL::validateDimensions(unsigned int uiWidth, unsigned int uiHeight)
 {
-    // If an input texture was already registered any new input texture or
-    // result buffer has to match those dimensions.
+    // If an input texture was already registered any new input texture has to match those dimensions.
     if (m_uiInputWidth > 0)
     {
         if (uiWidth != m_uiInputWidth || uiHeight != m_uiInputHeight)
@@ -1500,9 +1548,9 @@ bool RFContextCL::validateDimensions(unsigned int uiWidth, unsigned int uiHeight
         }
     }
 
-    // If a result buffer was already created the size of any new input texture
+    // If a result buffer was already created and the CSC cannot scale, the size of any new input texture
     // must match those dimensions.
-    if (m_uiOutputWidth > 0)
+    if (m_uiOutputWidth > 0 && !isScalingSupported())
     {
         if ((uiWidth != m_uiOutputWidth) || uiHeight != m_uiOutputHeight)
         {
@@ -1514,6 +1562,22 @@ bool RFContextCL::validateDimensions(unsigned int uiWidth, unsigned int uiHeight
 }
 
 
+// validateOutputDimensions is called when the result buffers are created. If the CSC scales the input,
+// any dimension is accepted.
+bool RFContextCL::validateOutputDimensions(unsigned int uiWidth, unsigned int uiHeight)
+{
+    if (m_uiInputWidth > 0 && !isScalingSupported())
+    {
+        if (uiWidth != m_uiInputWidth || uiHeight != m_uiInputHeight)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
 bool RFContextCL::configureKernels()
 {
     if (m_uiOutputWidth == 0 || m_uiOutputHeight == 0 || m_TargetFormat == RF_FORMAT_UNKNOWN)
@@ -1541,6 +1605,36 @@ bool RFContextCL::configureKernels()
     m_CSCKernels[RF_KERNEL_RGBA_COPY].uiLocalWorkSize[0] = 16;
     m_CSCKernels[RF_KERNEL_RGBA_COPY].uiLocalWorkSize[1] = 16;
 
+    m_CSCKernels[RF_KERNEL_RGBA_TO_NV12_SCALED].uiGlobalWorkSize[0] = m_uiOutputWidth / 2;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_NV12_SCALED].uiGlobalWorkSize[1] = m_uiOutputHeight / 2;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_NV12_SCALED].uiLocalWorkSize[0] = 16;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_NV12_SCALED].uiLocalWorkSize[1] = 16;
+
+    m_CSCKernels[RF_KERNEL_RGBA_COPY_SCALED].uiGlobalWorkSize[0] = m_uiOutputWidth;
+    m_CSCKernels[RF_KERNEL_RGBA_COPY_SCALED].uiGlobalWorkSize[1] = m_uiOutputHeight;
+    m_CSCKernels[RF_KERNEL_RGBA_COPY_SCALED].uiLocalWorkSize[0] = 16;
+    m_CSCKernels[RF_KERNEL_RGBA_COPY_SCALED].uiLocalWorkSize[1] = 16;
+
+    m_CSCKernels[RF_KERNEL_RGBA_TO_I420_SCALED].uiGlobalWorkSize[0] = m_uiOutputWidth / 2;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_I420_SCALED].uiGlobalWorkSize[1] = m_uiOutputHeight / 2;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_I420_SCALED].uiLocalWorkSize[0] = 16;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_I420_SCALED].uiLocalWorkSize[1] = 16;
+
+    m_CSCKernels[RF_KERNEL_RGBA_TO_P010].uiGlobalWorkSize[0] = m_uiOutputWidth / 2;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_P010].uiGlobalWorkSize[1] = m_uiOutputHeight / 2;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_P010].uiLocalWorkSize[0] = 16;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_P010].uiLocalWorkSize[1] = 16;
+
+    m_CSCKernels[RF_KERNEL_RGBA_TO_P010_SCALED].uiGlobalWorkSize[0] = m_uiOutputWidth / 2;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_P010_SCALED].uiGlobalWorkSize[1] = m_uiOutputHeight / 2;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_P010_SCALED].uiLocalWorkSize[0] = 16;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_P010_SCALED].uiLocalWorkSize[1] = 16;
+
+    m_CSCKernels[RF_KERNEL_RGBA_TO_P010_PLANES].uiGlobalWorkSize[0] = m_uiOutputWidth / 2;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_P010_PLANES].uiGlobalWorkSize[1] = m_uiOutputHeight / 2;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_P010_PLANES].uiLocalWorkSize[0] = 16;
+    m_CSCKernels[RF_KERNEL_RGBA_TO_P010_PLANES].uiLocalWorkSize[1] = 16;
+
     cl_int4 vDim = {static_cast<int>(m_uiOutputWidth),
         static_cast<int>(m_uiOutputHeight),
         static_cast<int>(m_uiAlignedOutputWidth),
@@ -1580,6 +1674,11 @@ bool RFContextCL::configureKernels()
         {
             return false;
         }
+
+        if (clSetKernelArg(m_CSCKernels[RF_KERNEL_RGBA_COPY_SCALED].kernel, 4, sizeof(cl_int), &m_TargetFormat) != CL_SUCCESS)
+        {
+            return false;
+        }
     }
 
     return true;
@@ -1622,7 +1721,7 @@ RFStatus RFContextCL::releaseCLMemObj(cl_command_queue clQueue, unsigned int idx
 
 RFStatus RFContextCL::removeCLInputMemObj(unsigned int idx)
 {
-    if (idx >= MAX_NUM_RENDER_TARGETS)
+    if (idx >= m_uiMaxNumRT)
     {
         return RF_STATUS_INVALID_INDEX;
     }
@@ -1647,7 +1746,7 @@ RFStatus RFContextCL::removeCLInputMemObj(unsigned int idx)
 
 RFStatus RFContextCL::getInputMemObjState(RFRenderTargetState* state, unsigned int idx) const
 {
-    if (idx >= MAX_NUM_RENDER_TARGETS)
+    if (idx >= m_uiMaxNumRT)
     {
         *state = RF_STATE_INVALID;
         return RF_STATUS_INVALID_INDEX;
@@ -1670,6 +1769,9 @@ void RFContextCL::getResultBuffer(unsigned int idx, void* &pBuffer) const
 {
     pBuffer = nullptr;
 
+    // Measures how long the application waits for the CSC and the transfer to sys mem.
+    RFTraceScope dmaWaitScope(m_pTrace, RF_TRACE_DMA_WAIT, idx);
+
     if (!m_bUseAsyncCopy)
     {
         clEnqueueCopyBuffer(m_clCmdQueue, m_clResultBuffer[idx], m_clPageLockedBuffer[idx], 0, 0, m_nOutputBufferSize, 0, nullptr, nullptr);
@@ -1719,42 +1821,83 @@ RFStatus RFContextCL::processBuffer(bool bRunCSC, bool bInvert, unsigned int uiS
         return RF_STATUS_INVALID_OPENCL_MEMOBJ;
     }
 
+    // If the input is scaled, the scaled variant of the kernel reads the input once and writes the converted
+    // output. The input cannot be copied without running a kernel.
+    const bool bScaleInput = isInputScaled();
+    const csc_kernel uiKernelIdx = (bScaleInput) ? m_uiScaledCSCKernelIdx : m_uiCSCKernelIdx;
+
+    if (uiKernelIdx <= RF_KERNEL_UNKNOWN)
+    {
+        return RF_STATUS_INVALID_DIMENSION;
+    }
+
     // Acquire OpenCL object from OpenGl/D3D object.
     RFEventCL clAcquireImageEvent;
-    RFStatus rfStatus = acquireCLMemObj(m_clCmdQueue, uiSrcIdx, 0, nullptr, &clAcquireImageEvent);
+    RFStatus rfStatus;
+
+    {
+        RFTraceScope acquireScope(m_pTrace, RF_TRACE_ACQUIRE, uiSrcIdx);
+
+        rfStatus = acquireCLMemObj(m_clCmdQueue, uiSrcIdx, 0, nullptr, &clAcquireImageEvent);
+    }
 
     if (rfStatus != RF_STATUS_OK)
     {
         return rfStatus;
     }
 
-    if (bRunCSC || m_uiCSCKernelIdx != RF_KERNEL_RGBA_COPY)
+    // The CSC and DMA stages measure the time to submit the commands. The time the GPU needs to execute them
+    // is part of the RF_TRACE_DMA_WAIT stage in getResultBuffer.
+    if (bRunCSC || bScaleInput || m_uiCSCKernelIdx != RF_KERNEL_RGBA_COPY)
     {
+        RFTraceScope cscScope(m_pTrace, RF_TRACE_CSC, uiDestIdx);
+
         // RGBA input buffer (src)
-        SAFE_CALL_CL(clSetKernelArg(m_CSCKernels[m_uiCSCKernelIdx].kernel, 0, sizeof(cl_mem), static_cast<void*>(&(m_clInputImage[uiSrcIdx]))));
+        SAFE_CALL_CL(clSetKernelArg(m_CSCKernels[uiKernelIdx].kernel, 0, sizeof(cl_mem), static_cast<void*>(&(m_clInputImage[uiSrcIdx]))));
 
         // output buffer (dst)
-        SAFE_CALL_CL(clSetKernelArg(m_CSCKernels[m_uiCSCKernelIdx].kernel, 1, sizeof(cl_mem), static_cast<void*>(&(m_clResultBuffer[uiDestIdx]))));
+        SAFE_CALL_CL(clSetKernelArg(m_CSCKernels[uiKernelIdx].kernel, 1, sizeof(cl_mem), static_cast<void*>(&(m_clResultBuffer[uiDestIdx]))));
 
         int nInvert = (bInvert) ? 1 : 0;
-        SAFE_CALL_CL(clSetKernelArg(m_CSCKernels[m_uiCSCKernelIdx].kernel, 3, sizeof(cl_int), static_cast<void*>(&nInvert)));
+        SAFE_CALL_CL(clSetKernelArg(m_CSCKernels[uiKernelIdx].kernel, 3, sizeof(cl_int), static_cast<void*>(&nInvert)));
 
-        SAFE_CALL_CL(clEnqueueNDRangeKernel(m_clCmdQueue, m_CSCKernels[m_uiCSCKernelIdx].kernel, 2, nullptr,
-                                            m_CSCKernels[m_uiCSCKernelIdx].uiGlobalWorkSize, m_CSCKernels[m_uiCSCKernelIdx].uiLocalWorkSize, 0,
+        if (bScaleInput)
+        {
+            // The scaling is the last argument of the scaled kernels. The registered textures might change
+            // after the kernels were configured, so it is set for each frame.
+            cl_float4 vScale = {static_cast<float>(m_uiInputWidth) / m_uiOutputWidth,
+                static_cast<float>(m_uiInputHeight) / m_uiOutputHeight,
+                static_cast<float>(m_uiInputWidth),
+                static_cast<float>(m_uiInputHeight)};
+
+            cl_uint uiScaleArg = (uiKernelIdx == RF_KERNEL_RGBA_COPY_SCALED) ? 5 : 4;
+
+            SAFE_CALL_CL(clSetKernelArg(m_CSCKernels[uiKernelIdx].kernel, uiScaleArg, sizeof(cl_float4), static_cast<void*>(&vScale)));
+        }
+
+        SAFE_CALL_CL(clEnqueueNDRangeKernel(m_clCmdQueue, m_CSCKernels[uiKernelIdx].kernel, 2, nullptr,
+                                            m_CSCKernels[uiKernelIdx].uiGlobalWorkSize, m_CSCKernels[uiKernelIdx].uiLocalWorkSize, 0,
                                             nullptr, &m_clCSCFinished[uiDestIdx]));
 
         clFlush(m_clCmdQueue);
 
         if (m_bUseAsyncCopy)
         {
+            RFTraceScope dmaScope(m_pTrace, RF_TRACE_DMA, uiDestIdx);
+
             clEnqueueCopyBuffer(m_clDMAQueue, m_clResultBuffer[uiDestIdx], m_clPageLockedBuffer[uiDestIdx], 0, 0, m_nOutputBufferSize, 1, &m_clCSCFinished[uiDestIdx], &m_clDMAFinished[uiDestIdx]);
             clFlush(m_clDMAQueue);
         }
     }
     else
     {
+        // The copy writes tightly packed rows. This matches the pitch of the result buffers since none of the
+        // encoders aligns the width (m_uiAlignedOutputWidth == m_uiOutputWidth).
         const size_t src_origin[3] = {0, 0, 0};
         const size_t region[3] = {m_uiOutputWidth, m_uiOutputHeight, 1};
+
+        RFTraceScope dmaScope(m_pTrace, RF_TRACE_DMA, uiDestIdx);
+
         if (m_bUseAsyncCopy)
         {
             SAFE_CALL_CL(clEnqueueCopyImageToBuffer(m_clDMAQueue, m_clInputImage[uiSrcIdx], m_clPageLockedBuffer[uiDestIdx], src_origin, region, 0, 1, &clAcquireImageEvent, &m_clDMAFinished[uiDestIdx]));
@@ -1783,10 +1926,10 @@ RFStatus RFContextCL::processBuffer(bool bRunCSC, bool bInvert, unsigned int uiS
 
 bool RFContextCL::getFreeRenderTargetIndex(unsigned int& uiIndex)
 {
-    if (m_uiNumRegisteredRT >= MAX_NUM_RENDER_TARGETS)
+    if (m_uiNumRegisteredRT >= m_uiMaxNumRT)
     {
         char buf[256];
-        sprintf_s(buf, 256, "Exceed the maximum number of render targets: %d", MAX_NUM_RENDER_TARGETS);
+        sprintf_s(buf, 256, "Exceed the maximum number of render targets: %d", m_uiMaxNumRT);
         RF_Error(RF_STATUS_RENDER_TARGET_FAIL, buf);
 
         return false;
@@ -1794,7 +1937,7 @@ bool RFContextCL::getFreeRenderTargetIndex(unsigned int& uiIndex)
 
     // Find a render target index whose state is invalid.
     bool found = false;
-    for (int i = 0; i < MAX_NUM_RENDER_TARGETS; ++i)
+    for (unsigned int i = 0; i < m_uiMaxNumRT; ++i)
     {
         if (m_rtState[i] == RF_STATE_INVALID)
         {
@@ -1826,6 +1969,22 @@ RFStatus RFContextCL::setupKernel()
         m_CSCKernels[RF_KERNEL_RGBA_COPY].kernel = clCreateKernel(m_clCscProgram, "copy_rgba_image2d", &nStatus);
         SAFE_CALL_CL(nStatus);
 
+        // Create the kernels that scale the input while converting it.
+        m_CSCKernels[RF_KERNEL_RGBA_TO_NV12_SCALED].kernel = clCreateKernel(m_clCscProgram, "rgbaTonv12_scaled_image2d", &nStatus);
+        SAFE_CALL_CL(nStatus);
+        m_CSCKernels[RF_KERNEL_RGBA_COPY_SCALED].kernel = clCreateKernel(m_clCscProgram, "copy_rgba_scaled_image2d", &nStatus);
+        SAFE_CALL_CL(nStatus);
+        m_CSCKernels[RF_KERNEL_RGBA_TO_I420_SCALED].kernel = clCreateKernel(m_clCscProgram, "rgbaToI420_scaled_image2d", &nStatus);
+        SAFE_CALL_CL(nStatus);
+
+        // Create the kernels that write 10 bit samples.
+        m_CSCKernels[RF_KERNEL_RGBA_TO_P010].kernel = clCreateKernel(m_clCscProgram, "rgbaToP010_image2d", &nStatus);
+        SAFE_CALL_CL(nStatus);
+        m_CSCKernels[RF_KERNEL_RGBA_TO_P010_SCALED].kernel = clCreateKernel(m_clCscProgram, "rgbaToP010_scaled_image2d", &nStatus);
+        SAFE_CALL_CL(nStatus);
+        m_CSCKernels[RF_KERNEL_RGBA_TO_P010_PLANES].kernel = clCreateKernel(m_clCscProgram, "rgbaToP010_Planes", &nStatus);
+        SAFE_CALL_CL(nStatus);
+
         return RF_STATUS_OK;
     }
     else
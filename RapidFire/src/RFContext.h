@@ -22,6 +22,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -32,6 +33,8 @@
 #include "RFPlatform.h"
 #include "RFTypes.h"
 
+class RFTrace;
+
 class RFEventCL
 {
 public:
@@ -131,6 +134,10 @@ public:
     // Creates OpenCL context based on an existing D3D9Ex Device.
     virtual RFStatus    createContext(IDirect3DDevice9Ex* pD3DDeviceEx);
 
+    // Sets the number of render targets and result buffers. Needs to be called before any render target is
+    // registered and before the result buffers are created.
+    virtual RFStatus    setPipelineDepth(unsigned int uiDepth);
+
     // Creates OpenCL Output buffers. Those buffers will contain the results of the CSC.
     virtual RFStatus    createBuffers(RFFormat format, unsigned int uiWidth, unsigned int uiHeight, unsigned int uiAlignedWidth, unsigned int uiAlignedHeight, bool bUseAsyncCopy = false);
 
@@ -156,7 +163,7 @@ public:
     // Copys CSC results to the GPU or sys memory.
     void                getResultBuffer(unsigned int idx, cl_mem* pBuffer) const;
     // Blocks until all results are written into the m_clResultBuffer[idx] and returns the pointer to the buffer in sys mem.
-    void                getResultBuffer(unsigned int idx, void* &pBuffer) const;
+    virtual void        getResultBuffer(unsigned int idx, void* &pBuffer) const;
 
     // Acquires an OpenCL object that has been created from a GL/D3D object.
     RFStatus            acquireCLMemObj(cl_command_queue clQueue, unsigned int idx, unsigned int numEvents = 0, cl_event* eventsWait = nullptr, cl_event* eventReturned = nullptr);
@@ -180,6 +187,8 @@ public:
 
     unsigned int        getNumRegisteredRT()  const { return m_uiNumRegisteredRT; }
 
+    unsigned int        getMaxNumRT()         const { return m_uiMaxNumRT; }
+
     unsigned int        getResultBufferSize() const { return static_cast<unsigned int>(m_nOutputBufferSize); }
 
     RFFormat            getTargetFormat()     const { return m_TargetFormat; }
@@ -190,13 +199,24 @@ public:
 
     bool                getAsyncCopy()        const { return m_bUseAsyncCopy; }
 
-    enum ctx_type { RF_CTX_UNKNOWN = -1, RF_CTX_CL = 0, RF_CTX_FROM_GL = 1, RF_CTX_FROM_DX9EX = 2, RF_CTX_FROM_DX9 = 3, RF_CTX_FROM_DX11 = 4 };
+    // Returns true if the CSC can scale registered textures to the dimension of the result buffers.
+    virtual bool        isScalingSupported()  const { return true; }
+
+    // Sets the trace that records the duration of the CSC and DMA stages. pTrace may be NULL.
+    void                setTrace(RFTrace* pTrace)     { m_pTrace = pTrace; }
+
+    enum ctx_type { RF_CTX_UNKNOWN = -1, RF_CTX_CL = 0, RF_CTX_FROM_GL = 1, RF_CTX_FROM_DX9EX = 2, RF_CTX_FROM_DX9 = 3, RF_CTX_FROM_DX11 = 4, RF_CTX_HOST = 5 };
 
     ctx_type            getCtxType()          const { return m_CtxType; }
 
 protected:
 
-    enum csc_kernel { RF_KERNEL_UNKNOWN = -1, RF_KERNEL_RGBA_TO_NV12 = 0, RF_KERNEL_RGBA_TO_NV12_PLANES = 1, RF_KERNEL_RGBA_TO_I420 = 2, RF_KERNEL_RGBA_COPY = 3, RF_KERNEL_NUMBER = 4 };
+    // Constructor used by derived contexts that do not require the AMD OpenCL platform.
+    explicit RFContextCL(bool bRequireCLPlatform);
+
+    enum csc_kernel { RF_KERNEL_UNKNOWN = -1, RF_KERNEL_RGBA_TO_NV12 = 0, RF_KERNEL_RGBA_TO_NV12_PLANES = 1, RF_KERNEL_RGBA_TO_I420 = 2, RF_KERNEL_RGBA_COPY = 3,
+                      RF_KERNEL_RGBA_TO_NV12_SCALED = 4, RF_KERNEL_RGBA_COPY_SCALED = 5, RF_KERNEL_RGBA_TO_I420_SCALED = 6, RF_KERNEL_RGBA_TO_P010 = 7,
+                      RF_KERNEL_RGBA_TO_P010_SCALED = 8, RF_KERNEL_RGBA_TO_P010_PLANES = 9, RF_KERNEL_NUMBER = 10 };
 
     typedef struct
     {
@@ -221,9 +241,16 @@ protected:
 
     RFStatus            setupKernel();
 
-    // Checks if the texture and the buffer dimension match.
+    // Checks if the texture dimension matches the registered textures. If the context cannot scale, the texture
+    // has to match the result buffers as well.
     bool                validateDimensions(unsigned int uiWidth, unsigned int uiHeight);
 
+    // Checks if the result buffer dimension is valid for the registered textures.
+    bool                validateOutputDimensions(unsigned int uiWidth, unsigned int uiHeight);
+
+    // Returns true if the registered textures differ from the result buffers and the input is scaled by the CSC.
+    bool                isInputScaled() const { return (m_uiInputWidth > 0 && (m_uiInputWidth != m_uiOutputWidth || m_uiInputHeight != m_uiOutputHeight)); }
+
     bool                        m_bValid;
 
     // Dimensions of output buffers
@@ -238,7 +265,9 @@ protected:
     unsigned int                m_uiInputHeight;
 
     // The amount of result and page locked buffers
-    const unsigned int          m_uiNumResultBuffers;
+    unsigned int                m_uiNumResultBuffers;
+    // The maximum number of render targets that can be registered.
+    unsigned int                m_uiMaxNumRT;
     // The number of registered render targets.
     unsigned int                m_uiNumRegisteredRT;
 
@@ -254,23 +283,26 @@ protected:
 
     RFFormat                    m_TargetFormat;
     csc_kernel                  m_uiCSCKernelIdx;
+    // Kernel that is used instead of m_uiCSCKernelIdx if the input is scaled.
+    csc_kernel                  m_uiScaledCSCKernelIdx;
 
     CSC_KERNEL                  m_CSCKernels[RF_KERNEL_NUMBER];
 
     // m_clInputBuffer is set by the application when calling setInputTexture.
     // m_clInputBuffer is used as input for the CSC.
-    cl_mem                      m_clInputImage[MAX_NUM_RENDER_TARGETS];
+    std::vector<cl_mem>                 m_clInputImage;
     // m_clResultBuffer stores the results of the CSC.
-    cl_mem                      m_clResultBuffer[NUM_RESULT_BUFFERS];
+    std::vector<cl_mem>                 m_clResultBuffer;
 
-    mutable RFEventCL           m_clDMAFinished[NUM_RESULT_BUFFERS];
-    mutable RFEventCL           m_clCSCFinished[NUM_RESULT_BUFFERS];
+    // RFEventCL cannot be copied, the events are stored in arrays of m_uiNumResultBuffers elements.
+    std::unique_ptr<RFEventCL[]>        m_clDMAFinished;
+    std::unique_ptr<RFEventCL[]>        m_clCSCFinished;
 
-    RFRenderTargetState         m_rtState[MAX_NUM_RENDER_TARGETS];
+    std::vector<RFRenderTargetState>    m_rtState;
 
     // Pinned buffer used for data transfer between GPU and host.
-    cl_mem                      m_clPageLockedBuffer[NUM_RESULT_BUFFERS];
-    char*                       m_pSysmemBuffer[NUM_RESULT_BUFFERS];
+    std::vector<cl_mem>                 m_clPageLockedBuffer;
+    std::vector<char*>                  m_pSysmemBuffer;
 
     // Indicates if an asynchronous copy of the result buffer to sys mem should be used.
     bool                        m_bUseAsyncCopy;
@@ -287,6 +319,9 @@ protected:
 
     DWORD						m_dwVersion[4];
 
+    // Owned by the session, NULL if tracing is disabled.
+    RFTrace*                    m_pTrace;
+
 private:
 
     RFContextCL(const RFContextCL& other);
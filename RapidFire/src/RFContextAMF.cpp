@@ -26,6 +26,7 @@
 
 #include "AMFWrapper.h"
 #include "RFError.h"
+#include "RFTrace.h"
 
 using namespace amf;
 
@@ -38,15 +39,7 @@ RFContextAMF::RFContextAMF()
     , m_amfFormat(AMF_SURFACE_UNKNOWN)
     , m_amfMemory(AMF_MEMORY_UNKNOWN)
 {
-    m_pSurfaceList = new AMFSurfacePtr[NUM_RESULT_BUFFERS];
-
-    for (int i = 0; i < MAX_NUM_RENDER_TARGETS; ++i)
-    {
-        m_pD3D9Surfaces[i] = NULL;
-        m_clNV12Planes[i * 2] = NULL;
-        m_clNV12Planes[i * 2 + 1] = NULL;
-        m_clNV12Memory[i] = AMF_MEMORY_UNKNOWN;
-    }
+    RFContextAMF::setPipelineDepth(DEFAULT_PIPELINE_DEPTH);
 }
 
 
@@ -58,17 +51,14 @@ RFContextAMF::~RFContextAMF()
     m_clCmdQueue = NULL;
     m_clDevId = NULL;
 
-    if (m_pSurfaceList)
-    {
-        delete[] m_pSurfaceList;
-    }
+    m_pSurfaceList.clear();
 
-    for (int i = 0; i < MAX_NUM_RENDER_TARGETS; ++i)
-    {
-        // Surfaces are created by the application, so no need to delete them here.
-        m_pD3D9Surfaces[i] = NULL;
+    // Surfaces are created by the application, so no need to delete them here.
+    m_pD3D9Surfaces.clear();
 
-        if (m_CtxType != RF_CTX_FROM_DX9)
+    if (m_CtxType != RF_CTX_FROM_DX9)
+    {
+        for (unsigned int i = 0; i < m_uiNumResultBuffers; ++i)
         {
             releaseNV12Interop(i);
         }
@@ -76,6 +66,25 @@ RFContextAMF::~RFContextAMF()
 }
 
 
+RFStatus RFContextAMF::setPipelineDepth(unsigned int uiDepth)
+{
+    RFStatus rfStatus = RFContextCL::setPipelineDepth(uiDepth);
+
+    if (rfStatus != RF_STATUS_OK)
+    {
+        return rfStatus;
+    }
+
+    m_pSurfaceList.assign(m_uiNumResultBuffers, AMFSurfacePtr());
+    m_clNV12Planes.assign(m_uiNumResultBuffers * 2, NULL);
+    m_clNV12Memory.assign(m_uiNumResultBuffers, AMF_MEMORY_UNKNOWN);
+
+    m_pD3D9Surfaces.assign(m_uiMaxNumRT, NULL);
+
+    return RF_STATUS_OK;
+}
+
+
 RFStatus RFContextAMF::createContext()
 {
     // No interop device is known, this config is not supported with AMF.
@@ -252,7 +261,7 @@ RFStatus RFContextAMF::createBuffers(RFFormat format, unsigned int uiWidth, unsi
         return RF_STATUS_INVALID_CONTEXT;
     }
 
-    if (!validateDimensions(uiWidth, uiHeight))
+    if (!validateOutputDimensions(uiWidth, uiHeight))
     {
         // Scaling is not supported.
         return RF_STATUS_INVALID_DIMENSION;
@@ -268,8 +277,8 @@ RFStatus RFContextAMF::createBuffers(RFFormat format, unsigned int uiWidth, unsi
     m_uiAlignedOutputWidth = uiAlignedWidth;
     m_uiAlignedOutputHeight = uiAlignedHeight;
 
-    // The AMF encoder is implemented to use NV12 as input. The RFContextAMD::processBuffers will transform the input buffer to
-    // a NV12 buffer that is passed to the encoder.
+    // The AMF encoder is implemented to use NV12 or P010 as input. The RFContextAMD::processBuffers will transform the input buffer to
+    // a NV12 or P010 buffer that is passed to the encoder.
     // EXCEPTION DX9: Since no CL-DX9 interop exists the DX9 BGRA surfaces are passed directly to the AMF encoder. The CSC
     // is done by AMF. For DX9 only BGRA is supported. Dx9Ex will work through the OpenCL CSC.
     if (m_CtxType == RF_CTX_FROM_DX9)
@@ -285,13 +294,21 @@ RFStatus RFContextAMF::createBuffers(RFFormat format, unsigned int uiWidth, unsi
             return RF_STATUS_INVALID_FORMAT;
         }
     }
+    else if (format == RF_P010)
+    {
+        // P010 surfaces store the 10 bit samples in the upper bits of 16 bit and are encoded as HEVC Main 10.
+        m_amfFormat = AMF_SURFACE_P010;
+
+        m_TargetFormat = RF_P010;
+        m_uiCSCKernelIdx = RF_KERNEL_RGBA_TO_P010_PLANES;
+    }
     else if (format != RF_NV12)
     {
         return RF_STATUS_INVALID_FORMAT;
     }
 
     // Create surdfaces that are used as target for the CSC and as input for the VCE.
-    for (unsigned int i = 0; i < NUM_RESULT_BUFFERS; ++i)
+    for (unsigned int i = 0; i < m_uiNumResultBuffers; ++i)
     {
         amfErr = m_amfContext->AllocSurface(m_amfMemory, m_amfFormat, m_uiAlignedOutputWidth, m_uiAlignedOutputHeight, &(m_pSurfaceList[i]));
         if ((amfErr == AMF_DIRECTX_FAILED || amfErr == AMF_NO_DEVICE) && m_amfMemory == AMF_MEMORY_DX11)
@@ -363,7 +380,7 @@ RFStatus RFContextAMF::processBuffer(bool /*bRunCSC*/, bool bInvert, unsigned in
         return RF_STATUS_OK;
     }
 
-    if (m_TargetFormat != RF_NV12 || m_uiCSCKernelIdx != RF_KERNEL_RGBA_TO_NV12_PLANES)
+    if (m_uiCSCKernelIdx != RF_KERNEL_RGBA_TO_NV12_PLANES && m_uiCSCKernelIdx != RF_KERNEL_RGBA_TO_P010_PLANES)
     {
         return RF_STATUS_INVALID_FORMAT;
     }
@@ -387,8 +404,14 @@ RFStatus RFContextAMF::processBuffer(bool /*bRunCSC*/, bool bInvert, unsigned in
         return RF_STATUS_INVALID_OPENCL_MEMOBJ;
     }
 
-    // Acquire OpenCL object from OpenGl/D3D object.
-    SAFE_CALL_RF(acquireCLMemObj(m_clCmdQueue, uiSorceIdx));
+    {
+        RFTraceScope acquireScope(m_pTrace, RF_TRACE_ACQUIRE, uiSorceIdx);
+
+        // Acquire OpenCL object from OpenGl/D3D object.
+        SAFE_CALL_RF(acquireCLMemObj(m_clCmdQueue, uiSorceIdx));
+    }
+
+    RFTraceScope cscScope(m_pTrace, RF_TRACE_CSC, uiDestIdx);
 
     // RGBA input buffer (src)
     SAFE_CALL_CL(clSetKernelArg(m_CSCKernels[m_uiCSCKernelIdx].kernel, 0, sizeof(cl_mem), static_cast<void*>(&(m_clInputImage[uiSorceIdx]))));
@@ -426,8 +449,10 @@ AMFSurfacePtr RFContextAMF::getAMFSurface(unsigned int uiIdx) const
         return m_pSurfaceList[uiIdx];
     }
 
-    if (uiIdx < NUM_RESULT_BUFFERS)
+    if (uiIdx < m_uiNumResultBuffers)
     {
+        RFTraceScope waitScope(m_pTrace, RF_TRACE_DMA_WAIT, uiIdx);
+
         // We need to wait until CSC kernel finished.
         m_clCSCFinished[uiIdx].wait();
 
@@ -440,7 +465,7 @@ AMFSurfacePtr RFContextAMF::getAMFSurface(unsigned int uiIdx) const
 
 cl_mem RFContextAMF::getImageBuffer(unsigned int uiBuffer, unsigned int uiPlaneId)
 {
-    if (uiBuffer >= MAX_NUM_RENDER_TARGETS || uiPlaneId >= m_uiPlaneCount)
+    if (uiBuffer >= m_uiNumResultBuffers || uiPlaneId >= m_uiPlaneCount)
     {
         return NULL;
     }
@@ -481,6 +506,9 @@ RFStatus RFContextAMF::createNV12InteropFromDX11(unsigned int idx)
     auto native = plane->GetNative();
     auto dx11texture = static_cast<ID3D11Texture2D*>(native);
 
+    // The kernels write the samples as unsigned integers, P010 planes have 16 bit per sample.
+    const cl_channel_type clPlaneType = (m_amfFormat == AMF_SURFACE_P010) ? CL_UNSIGNED_INT16 : CL_UNSIGNED_INT8;
+
     cl_int nStatus;
     cl_mem interopTexture = createFromD3D11Texture2DKHR(CL_MEM_WRITE_ONLY, dx11texture, 0, &nStatus);
     SAFE_CALL_CL(nStatus);
@@ -494,9 +522,9 @@ RFStatus RFContextAMF::createNV12InteropFromDX11(unsigned int idx)
         SAFE_CALL_CL(clGetImageInfo(plane, CL_IMAGE_FORMAT, sizeof(cl_image_format), &format, nullptr));
         SAFE_CALL_CL(nStatus);
 
-        if (format.image_channel_data_type != CL_UNSIGNED_INT8)
+        if (format.image_channel_data_type != clPlaneType)
         {
-            format.image_channel_data_type = CL_UNSIGNED_INT8;
+            format.image_channel_data_type = clPlaneType;
             cl_mem planeUI = convertImageAmd(plane, &format, &nStatus);
             SAFE_CALL_CL(nStatus);
             SAFE_CALL_CL(clReleaseMemObject(plane));
@@ -531,6 +559,9 @@ RFStatus RFContextAMF::createNV12InteropFromDX9(unsigned int idx)
     auto native = plane->GetNative();
     auto dx9Surface = static_cast<IDirect3DSurface9*>(native);
 
+    // Same plane type as in createNV12InteropFromDX11.
+    const cl_channel_type clPlaneType = (m_amfFormat == AMF_SURFACE_P010) ? CL_UNSIGNED_INT16 : CL_UNSIGNED_INT8;
+
     cl_int nStatus;
     for (int p = 0; p < 2; ++p)
     {
@@ -541,9 +572,9 @@ RFStatus RFContextAMF::createNV12InteropFromDX9(unsigned int idx)
         SAFE_CALL_CL(clGetImageInfo(plane, CL_IMAGE_FORMAT, sizeof(cl_image_format), &format, nullptr));
         SAFE_CALL_CL(nStatus);
 
-        if (format.image_channel_data_type != CL_UNSIGNED_INT8)
+        if (format.image_channel_data_type != clPlaneType)
         {
-            format.image_channel_data_type = CL_UNSIGNED_INT8;
+            format.image_channel_data_type = clPlaneType;
             cl_mem planeUI = convertImageAmd(plane, &format, &nStatus);
             SAFE_CALL_CL(nStatus);
             SAFE_CALL_CL(clReleaseMemObject(plane));
@@ -49,10 +49,16 @@ public:
     // Registers DX9 texture. DX9 is only supported with AMF.
     virtual RFStatus    setInputTexture(IDirect3DSurface9* pD3D9Texture, const unsigned int uiWidth, unsigned int uiHeight, unsigned int& idx) override;
 
+    // Sets the number of render targets and result buffers.
+    virtual RFStatus    setPipelineDepth(unsigned int uiDepth) override;
+
     virtual RFStatus    createBuffers(RFFormat format, unsigned int uiWidth, unsigned int uiHeight, unsigned int uiAlignedWidth, unsigned int uiAlignedHeight, bool bUseAsyncCopy) override;
 
     virtual RFStatus    processBuffer(bool bRunCSC, bool bInvert, unsigned int uiSorceIdx, unsigned int uiDestIdx) override;
 
+    // The NV12 and P010 surfaces of AMF are converted by rgbaToNV12_Planes and rgbaToP010_Planes which do not scale.
+    virtual bool        isScalingSupported() const override { return false; }
+
     amf::AMFContextPtr  getAMFContext() const { return m_amfContext; };
 
     amf::AMFSurfacePtr  getAMFSurface(unsigned int uiIdx) const;
@@ -76,10 +82,11 @@ private:
 
     amf::AMFContextPtr              m_amfContext;
     amf::AMF_SURFACE_FORMAT         m_amfFormat;
-    amf::AMFSurfacePtr*             m_pSurfaceList;
-    amf::AMF_MEMORY_TYPE            m_amfMemory;
-    cl_mem                          m_clNV12Planes[MAX_NUM_RENDER_TARGETS * 2];
-    amf::AMF_MEMORY_TYPE            m_clNV12Memory[MAX_NUM_RENDER_TARGETS];
+    std::vector<amf::AMFSurfacePtr>     m_pSurfaceList;
+    amf::AMF_MEMORY_TYPE                m_amfMemory;
+    // Two planes per result buffer.
+    std::vector<cl_mem>                 m_clNV12Planes;
+    std::vector<amf::AMF_MEMORY_TYPE>   m_clNV12Memory;
 
-    IDirect3DSurface9*              m_pD3D9Surfaces[MAX_NUM_RENDER_TARGETS];
+    std::vector<IDirect3DSurface9*>     m_pD3D9Surfaces;
 };
\ No newline at end of file
@@ -0,0 +1,998 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "RFContextHost.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#include <immintrin.h>
+
+#include "RFError.h"
+#include "RFTrace.h"
+#include "RFUtils.h"
+
+// Alignment of the result buffers in system memory.
+#define HOST_BUFFER_ALIGNMENT   32
+
+
+// Byte offsets of the R, G, B and A channel within a pixel. The table is indexed by RF_RGBA8, RF_ARGB8 and RF_BGRA8.
+static const unsigned char g_ChannelOffset[3][4] = { { 0, 1, 2, 3 }, { 1, 2, 3, 0 }, { 2, 1, 0, 3 } };
+
+// Channel (0: R, 1: G, 2: B, 3: A) that is stored at each byte of a pixel. Indexed like g_ChannelOffset.
+static const unsigned char g_ChannelOrder[3][4]  = { { 0, 1, 2, 3 }, { 3, 0, 1, 2 }, { 2, 1, 0, 3 } };
+
+
+static inline bool isRGBAFormat(RFFormat rfFormat)
+{
+    return (rfFormat == RF_RGBA8 || rfFormat == RF_ARGB8 || rfFormat == RF_BGRA8);
+}
+
+
+static inline bool isIdentityMap(const unsigned char* pMap)
+{
+    return (pMap[0] == 0 && pMap[1] == 1 && pMap[2] == 2 && pMap[3] == 3);
+}
+
+
+//////////////////////////////////////////////////////////
+// Scalar color space conversion
+// The computations follow rgbaTonv12_image2d and copy_rgba_image2d in rfkernels.cl.
+//////////////////////////////////////////////////////////
+static inline unsigned char rgbToY(int r, int g, int b)
+{
+    return static_cast<unsigned char>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+
+static inline unsigned char rgbToU(int r, int g, int b)
+{
+    return static_cast<unsigned char>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+
+static inline unsigned char rgbToV(int r, int g, int b)
+{
+    return static_cast<unsigned char>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+
+// Converts the pixel pairs [uiStart, uiEnd) of two rows into two luma rows and one interleaved chroma row.
+// pMap contains the byte offsets of the R, G and B channel within a source pixel.
+static void convertRGBAToNV12Scalar(const unsigned char* pSrc0, const unsigned char* pSrc1, unsigned char* pY0, unsigned char* pY1, unsigned char* pUV,
+                                    const unsigned char* pMap, unsigned int uiStart, unsigned int uiEnd)
+{
+    const unsigned int R = pMap[0];
+    const unsigned int G = pMap[1];
+    const unsigned int B = pMap[2];
+
+    for (unsigned int x = uiStart; x < uiEnd; ++x)
+    {
+        const unsigned char* p0 = pSrc0 + x * 8;
+        const unsigned char* p1 = pSrc1 + x * 8;
+
+        pY0[2 * x]     = rgbToY(p0[R],     p0[G],     p0[B]);
+        pY0[2 * x + 1] = rgbToY(p0[R + 4], p0[G + 4], p0[B + 4]);
+        pY1[2 * x]     = rgbToY(p1[R],     p1[G],     p1[B]);
+        pY1[2 * x + 1] = rgbToY(p1[R + 4], p1[G + 4], p1[B + 4]);
+
+        // Take average color of the 2x2 block.
+        int r = (p0[R] + p0[R + 4] + p1[R] + p1[R + 4]) >> 2;
+        int g = (p0[G] + p0[G + 4] + p1[G] + p1[G + 4]) >> 2;
+        int b = (p0[B] + p0[B + 4] + p1[B] + p1[B + 4]) >> 2;
+
+        pUV[2 * x]     = rgbToU(r, g, b);
+        pUV[2 * x + 1] = rgbToV(r, g, b);
+    }
+}
+
+
+// Interleaves the chroma samples [uiStart, uiEnd) of a 4:2:0 image into a NV12 chroma row. uiStep is the distance
+// between two samples in the source rows.
+static void interleaveChromaRow(const unsigned char* pU, const unsigned char* pV, unsigned char* pUV, unsigned int uiStep, unsigned int uiStart, unsigned int uiEnd)
+{
+    for (unsigned int x = uiStart; x < uiEnd; ++x)
+    {
+        pUV[2 * x]     = pU[x * uiStep];
+        pUV[2 * x + 1] = pV[x * uiStep];
+    }
+}
+
+
+// Copies the chroma samples [uiStart, uiEnd) of a row of a 4:2:0 image into a planar chroma row. uiStep is the
+// distance between two samples in the source row.
+static void copyChromaRow(const unsigned char* pSrc, unsigned char* pDst, unsigned int uiStep, unsigned int uiStart, unsigned int uiEnd)
+{
+    if (uiStep == 1)
+    {
+        memcpy(pDst + uiStart, pSrc + uiStart, uiEnd - uiStart);
+        return;
+    }
+
+    for (unsigned int x = uiStart; x < uiEnd; ++x)
+    {
+        pDst[x] = pSrc[x * uiStep];
+    }
+}
+
+
+// Splits the samples [uiStart, uiEnd) of a NV12 chroma row into a U and a V row.
+static void splitChromaRow(const unsigned char* pUV, unsigned char* pU, unsigned char* pV, unsigned int uiStart, unsigned int uiEnd)
+{
+    for (unsigned int x = uiStart; x < uiEnd; ++x)
+    {
+        pU[x] = pUV[2 * x];
+        pV[x] = pUV[2 * x + 1];
+    }
+}
+
+
+// Copies the pixels [uiStart, uiEnd) of a row. Byte i of a destination pixel is taken from byte pMap[i] of the source pixel.
+static void copyRGBARowScalar(const unsigned char* pSrc, unsigned char* pDst, const unsigned char* pMap, unsigned int uiStart, unsigned int uiEnd)
+{
+    for (unsigned int x = uiStart; x < uiEnd; ++x)
+    {
+        const unsigned char* pIn  = pSrc + x * 4;
+        unsigned char*       pOut = pDst + x * 4;
+
+        pOut[0] = pIn[pMap[0]];
+        pOut[1] = pIn[pMap[1]];
+        pOut[2] = pIn[pMap[2]];
+        pOut[3] = pIn[pMap[3]];
+    }
+}
+
+
+// Builds the filter that scales uiInputSize samples to uiOutputSize samples. Same as readScaled in rfkernels.cl: the
+// input area of each output sample is covered by bilinear taps that are at most 2 samples apart. Samples outside
+// of the input are clamped to the edge. uiNumTaps is the largest number of input samples an output sample depends on.
+static void createScaleFilter(unsigned int uiInputSize, unsigned int uiOutputSize, unsigned int& uiNumTaps, std::vector<unsigned int>& Start, std::vector<unsigned short>& Weights)
+{
+    const float fScale = static_cast<float>(uiInputSize) / uiOutputSize;
+    const int   nTaps  = std::max(static_cast<int>(ceilf(fScale * 0.5f)), 1);
+    const float fStep  = fScale / nTaps;
+
+    // Returns the first of the two samples read by tap t of output sample i and the weight of the second sample.
+    auto getTap = [&](unsigned int i, int t, float& fFrac)
+    {
+        float fPos = i * fScale + (t + 0.5f) * fStep - 0.5f;
+        float fFirst = floorf(fPos);
+
+        fFrac = fPos - fFirst;
+
+        return static_cast<int>(fFirst);
+    };
+
+    auto clampSample = [&](int nSample)
+    {
+        return static_cast<unsigned int>(std::min(std::max(nSample, 0), static_cast<int>(uiInputSize) - 1));
+    };
+
+    Start.resize(uiOutputSize);
+
+    // Find the first sample of each output sample and the largest number of samples.
+    uiNumTaps = 1;
+
+    for (unsigned int i = 0; i < uiOutputSize; ++i)
+    {
+        float fFrac;
+
+        unsigned int uiFirst = clampSample(getTap(i, 0, fFrac));
+        unsigned int uiLast  = clampSample(getTap(i, nTaps - 1, fFrac) + 1);
+
+        Start[i]  = uiFirst;
+        uiNumTaps = std::max(uiNumTaps, uiLast - uiFirst + 1);
+    }
+
+    Weights.assign(uiOutputSize * uiNumTaps, 0);
+
+    std::vector<float> Contribution(uiNumTaps);
+
+    for (unsigned int i = 0; i < uiOutputSize; ++i)
+    {
+        // Make sure the window does not exceed the input.
+        Start[i] = std::min(Start[i], uiInputSize - uiNumTaps);
+
+        std::fill(Contribution.begin(), Contribution.end(), 0.0f);
+
+        for (int t = 0; t < nTaps; ++t)
+        {
+            float fFrac;
+            int   nFirst = getTap(i, t, fFrac);
+
+            Contribution[clampSample(nFirst) - Start[i]]     += (1.0f - fFrac) / nTaps;
+            Contribution[clampSample(nFirst + 1) - Start[i]] += fFrac / nTaps;
+        }
+
+        // Convert the weights to fixed point. The rounding error is added to the largest weight.
+        unsigned short* pWeights = &Weights[i * uiNumTaps];
+        unsigned int    uiSum    = 0;
+        unsigned int    uiMax    = 0;
+
+        for (unsigned int t = 0; t < uiNumTaps; ++t)
+        {
+            pWeights[t] = static_cast<unsigned short>(Contribution[t] * 256.0f + 0.5f);
+            uiSum += pWeights[t];
+
+            if (pWeights[t] > pWeights[uiMax])
+            {
+                uiMax = t;
+            }
+        }
+
+        pWeights[uiMax] = static_cast<unsigned short>(pWeights[uiMax] + 256 - uiSum);
+    }
+}
+
+
+// Combines the bytes [uiStart, uiEnd) of uiNumRows input rows. The result is stored in 7.8 fixed point, so it fits
+// into 15 bits.
+static void filterRowsScalar(const unsigned char* const* pRows, const unsigned short* pWeights, unsigned int uiNumRows, unsigned short* pOut,
+                             unsigned int uiStart, unsigned int uiEnd)
+{
+    for (unsigned int i = uiStart; i < uiEnd; ++i)
+    {
+        unsigned int uiSum = 0;
+
+        for (unsigned int r = 0; r < uiNumRows; ++r)
+        {
+            uiSum += pWeights[r] * pRows[r][i];
+        }
+
+        pOut[i] = static_cast<unsigned short>(uiSum >> 1);
+    }
+}
+
+
+// Filters the output pixels [uiStart, uiEnd) of a row that was combined by filterRowsScalar.
+static void filterColumnsScalar(const unsigned short* pFiltered, const unsigned int* pStart, const unsigned short* pWeights, unsigned int uiNumTaps,
+                                unsigned char* pOut, unsigned int uiStart, unsigned int uiEnd)
+{
+    for (unsigned int x = uiStart; x < uiEnd; ++x)
+    {
+        const unsigned short* pIn = pFiltered + pStart[x] * 4;
+        const unsigned short* pW  = pWeights + x * uiNumTaps;
+
+        unsigned int uiSum[4] = { 1 << 14, 1 << 14, 1 << 14, 1 << 14 };
+
+        for (unsigned int t = 0; t < uiNumTaps; ++t)
+        {
+            uiSum[0] += pW[t] * pIn[4 * t];
+            uiSum[1] += pW[t] * pIn[4 * t + 1];
+            uiSum[2] += pW[t] * pIn[4 * t + 2];
+            uiSum[3] += pW[t] * pIn[4 * t + 3];
+        }
+
+        pOut[4 * x]     = static_cast<unsigned char>(uiSum[0] >> 15);
+        pOut[4 * x + 1] = static_cast<unsigned char>(uiSum[1] >> 15);
+        pOut[4 * x + 2] = static_cast<unsigned char>(uiSum[2] >> 15);
+        pOut[4 * x + 3] = static_cast<unsigned char>(uiSum[3] >> 15);
+    }
+}
+
+
+//////////////////////////////////////////////////////////
+// AVX2 color space conversion
+//////////////////////////////////////////////////////////
+
+// Creates a shuffle mask that reorders the bytes of each pixel according to pMap.
+RF_TARGET_AVX2 static inline __m256i createShuffleMaskAVX2(const unsigned char* pMap)
+{
+    char mask[32];
+
+    for (int i = 0; i < 32; ++i)
+    {
+        mask[i] = static_cast<char>((i & ~3) + pMap[i & 3]);
+    }
+
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask));
+}
+
+
+// Packs two vectors of 8 int32 values into 16 unsigned bytes in the order a0..a7, b0..b7.
+RF_TARGET_AVX2 static inline __m128i packDWordsToBytesAVX2(__m256i a, __m256i b)
+{
+    __m256i v = _mm256_packs_epi32(a, b);
+    v = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 1, 2, 0));
+    v = _mm256_packus_epi16(v, v);
+    v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 4, 5, 0, 1, 4, 5));
+
+    return _mm256_castsi256_si128(v);
+}
+
+
+// Computes the luma of 8 RGBA pixels. Returns 8 int32 values.
+RF_TARGET_AVX2 static inline __m256i computeLumaAVX2(__m256i vRGBA, __m256i vCoeffY)
+{
+    const __m256i vZero = _mm256_setzero_si256();
+
+    // Each 64 bit chunk contains R, G, B, A as 16 bit values. Multiply and add the R,G and B,A pairs.
+    __m256i vLo = _mm256_madd_epi16(_mm256_unpacklo_epi8(vRGBA, vZero), vCoeffY);
+    __m256i vHi = _mm256_madd_epi16(_mm256_unpackhi_epi8(vRGBA, vZero), vCoeffY);
+
+    __m256i vY = _mm256_hadd_epi32(vLo, vHi);
+
+    vY = _mm256_srai_epi32(_mm256_add_epi32(vY, _mm256_set1_epi32(128)), 8);
+
+    return _mm256_add_epi32(vY, _mm256_set1_epi32(16));
+}
+
+
+// Computes the interleaved chroma of 4 2x2 blocks. vRow0 and vRow1 contain 8 RGBA pixels of two consecutive rows.
+// Returns the values U0, V0, U1, V1, U2, V2, U3, V3 as int32.
+RF_TARGET_AVX2 static inline __m256i computeChromaAVX2(__m256i vRow0, __m256i vRow1, __m256i vCoeffU, __m256i vCoeffV)
+{
+    const __m256i vZero = _mm256_setzero_si256();
+
+    // Vertical sum of both rows as 16 bit values.
+    __m256i vLo = _mm256_add_epi16(_mm256_unpacklo_epi8(vRow0, vZero), _mm256_unpacklo_epi8(vRow1, vZero));
+    __m256i vHi = _mm256_add_epi16(_mm256_unpackhi_epi8(vRow0, vZero), _mm256_unpackhi_epi8(vRow1, vZero));
+
+    // Horizontal sum of neighboring pixels.
+    vLo = _mm256_add_epi16(vLo, _mm256_srli_si256(vLo, 8));
+    vHi = _mm256_add_epi16(vHi, _mm256_srli_si256(vHi, 8));
+
+    // Take average color.
+    __m256i vRGBA = _mm256_srli_epi16(_mm256_unpacklo_epi64(vLo, vHi), 2);
+
+    // Each 128 bit lane contains U0, U1, V0, V1.
+    __m256i vUV = _mm256_hadd_epi32(_mm256_madd_epi16(vRGBA, vCoeffU), _mm256_madd_epi16(vRGBA, vCoeffV));
+
+    vUV = _mm256_srai_epi32(_mm256_add_epi32(vUV, _mm256_set1_epi32(128)), 8);
+    vUV = _mm256_add_epi32(vUV, _mm256_set1_epi32(128));
+
+    return _mm256_permutevar8x32_epi32(vUV, _mm256_setr_epi32(0, 2, 1, 3, 4, 6, 5, 7));
+}
+
+
+// Converts pixel pairs of two rows into NV12. Each iteration processes 16 pixels per row.
+// Returns the number of pixel pairs that were converted.
+RF_TARGET_AVX2 static unsigned int convertRGBAToNV12AVX2(const unsigned char* pSrc0, const unsigned char* pSrc1, unsigned char* pY0, unsigned char* pY1, unsigned char* pUV,
+                                                         const unsigned char* pMap, unsigned int uiNumPairs)
+{
+    const __m256i vCoeffY = _mm256_setr_epi16(66, 129, 25, 0, 66, 129, 25, 0, 66, 129, 25, 0, 66, 129, 25, 0);
+    const __m256i vCoeffU = _mm256_setr_epi16(-38, -74, 112, 0, -38, -74, 112, 0, -38, -74, 112, 0, -38, -74, 112, 0);
+    const __m256i vCoeffV = _mm256_setr_epi16(112, -94, -18, 0, 112, -94, -18, 0, 112, -94, -18, 0, 112, -94, -18, 0);
+
+    // Reorders the source pixels to RGBA if required.
+    const bool    bShuffle = !isIdentityMap(pMap);
+    const __m256i vShuffle = createShuffleMaskAVX2(pMap);
+
+    unsigned int x = 0;
+
+    for (; x + 8 <= uiNumPairs; x += 8)
+    {
+        __m256i vRow0a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc0 + x * 8));
+        __m256i vRow0b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc0 + x * 8 + 32));
+        __m256i vRow1a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc1 + x * 8));
+        __m256i vRow1b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc1 + x * 8 + 32));
+
+        if (bShuffle)
+        {
+            vRow0a = _mm256_shuffle_epi8(vRow0a, vShuffle);
+            vRow0b = _mm256_shuffle_epi8(vRow0b, vShuffle);
+            vRow1a = _mm256_shuffle_epi8(vRow1a, vShuffle);
+            vRow1b = _mm256_shuffle_epi8(vRow1b, vShuffle);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pY0 + 2 * x), packDWordsToBytesAVX2(computeLumaAVX2(vRow0a, vCoeffY), computeLumaAVX2(vRow0b, vCoeffY)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pY1 + 2 * x), packDWordsToBytesAVX2(computeLumaAVX2(vRow1a, vCoeffY), computeLumaAVX2(vRow1b, vCoeffY)));
+
+        __m256i vUVa = computeChromaAVX2(vRow0a, vRow1a, vCoeffU, vCoeffV);
+        __m256i vUVb = computeChromaAVX2(vRow0b, vRow1b, vCoeffU, vCoeffV);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pUV + 2 * x), packDWordsToBytesAVX2(vUVa, vUVb));
+    }
+
+    return x;
+}
+
+
+// Copies 8 pixels per iteration and reorders the channels according to pMap. Returns the number of pixels that were copied.
+RF_TARGET_AVX2 static unsigned int copyRGBARowAVX2(const unsigned char* pSrc, unsigned char* pDst, const unsigned char* pMap, unsigned int uiWidth)
+{
+    const __m256i vShuffle = createShuffleMaskAVX2(pMap);
+
+    unsigned int x = 0;
+
+    for (; x + 8 <= uiWidth; x += 8)
+    {
+        __m256i vPixel = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + x * 4));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + x * 4), _mm256_shuffle_epi8(vPixel, vShuffle));
+    }
+
+    return x;
+}
+
+
+// Combines 32 bytes of uiNumRows input rows per iteration. Returns the number of bytes that were filtered.
+RF_TARGET_AVX2 static unsigned int filterRowsAVX2(const unsigned char* const* pRows, const unsigned short* pWeights, unsigned int uiNumRows, unsigned short* pOut,
+                                                  unsigned int uiSize)
+{
+    unsigned int i = 0;
+
+    for (; i + 32 <= uiSize; i += 32)
+    {
+        __m256i vSum0 = _mm256_setzero_si256();
+        __m256i vSum1 = _mm256_setzero_si256();
+
+        for (unsigned int r = 0; r < uiNumRows; ++r)
+        {
+            const __m256i vWeight = _mm256_set1_epi16(static_cast<short>(pWeights[r]));
+
+            __m256i vIn0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pRows[r] + i)));
+            __m256i vIn1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pRows[r] + i + 16)));
+
+            vSum0 = _mm256_add_epi16(vSum0, _mm256_mullo_epi16(vIn0, vWeight));
+            vSum1 = _mm256_add_epi16(vSum1, _mm256_mullo_epi16(vIn1, vWeight));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut + i),      _mm256_srli_epi16(vSum0, 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut + i + 16), _mm256_srli_epi16(vSum1, 1));
+    }
+
+    return i;
+}
+
+
+// Filters two output pixels per iteration. Each 128 bit lane multiplies two taps of one pixel with the packed weights
+// of pPairWeights. The row needs to be padded by one pixel if the number of taps is odd. Returns the number of pixels
+// that were filtered.
+RF_TARGET_AVX2 static unsigned int filterColumnsAVX2(const unsigned short* pFiltered, const unsigned int* pStart, const unsigned int* pPairWeights, unsigned int uiNumPairs,
+                                                     unsigned char* pOut, unsigned int uiWidth)
+{
+    // Interleaves the channels of the two pixels of each lane.
+    const __m256i vInterleave = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15,
+                                                 0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+
+    unsigned int x = 0;
+
+    for (; x + 2 <= uiWidth; x += 2)
+    {
+        const unsigned short* pIn0 = pFiltered + pStart[x] * 4;
+        const unsigned short* pIn1 = pFiltered + pStart[x + 1] * 4;
+        const unsigned int*   pW0  = pPairWeights + x * uiNumPairs;
+        const unsigned int*   pW1  = pW0 + uiNumPairs;
+
+        __m256i vSum = _mm256_set1_epi32(1 << 14);
+
+        for (unsigned int p = 0; p < uiNumPairs; ++p)
+        {
+            __m256i vIn = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn0 + 8 * p))),
+                                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn1 + 8 * p)), 1);
+            __m256i vW  = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_set1_epi32(static_cast<int>(pW0[p]))),
+                                                  _mm_set1_epi32(static_cast<int>(pW1[p])), 1);
+
+            vSum = _mm256_add_epi32(vSum, _mm256_madd_epi16(_mm256_shuffle_epi8(vIn, vInterleave), vW));
+        }
+
+        vSum = _mm256_srai_epi32(vSum, 15);
+
+        // The first 4 bytes of each lane contain the channels of one pixel.
+        __m256i v = _mm256_packs_epi32(vSum, vSum);
+        v = _mm256_packus_epi16(v, v);
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pOut + 4 * x), _mm_unpacklo_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+    }
+
+    return x;
+}
+
+
+//////////////////////////////////////////////////////////
+// Host context for CSC
+//////////////////////////////////////////////////////////
+RFContextHost::RFContextHost()
+    : RFContextCL(false)
+    , m_bUseAVX2(utilIsAVX2Supported())
+{
+    RFContextHost::setPipelineDepth(DEFAULT_PIPELINE_DEPTH);
+
+    for (ScaleFilter& filter : m_ScaleFilter)
+    {
+        filter.uiInputSize = 0;
+        filter.uiNumTaps   = 0;
+    }
+}
+
+
+RFContextHost::~RFContextHost()
+{
+    deleteBuffers();
+}
+
+
+RFStatus RFContextHost::createContext()
+{
+    m_CtxType = RF_CTX_HOST;
+    m_bValid  = true;
+
+    return RF_STATUS_OK;
+}
+
+
+RFStatus RFContextHost::setPipelineDepth(unsigned int uiDepth)
+{
+    RFStatus rfStatus = RFContextCL::setPipelineDepth(uiDepth);
+
+    if (rfStatus != RF_STATUS_OK)
+    {
+        return rfStatus;
+    }
+
+    m_pInputBuffer.assign(m_uiMaxNumRT, nullptr);
+    m_uiInputPitch.assign(m_uiMaxNumRT, 0);
+    m_InputFormat.assign(m_uiMaxNumRT, RF_FORMAT_UNKNOWN);
+
+    m_pInputChroma[0].assign(m_uiMaxNumRT, nullptr);
+    m_pInputChroma[1].assign(m_uiMaxNumRT, nullptr);
+    m_uiInputChromaPitch.assign(m_uiMaxNumRT, 0);
+    m_uiInputChromaStep.assign(m_uiMaxNumRT, 0);
+
+    return RF_STATUS_OK;
+}
+
+
+RFStatus RFContextHost::createBuffers(RFFormat format, unsigned int uiWidth, unsigned int uiHeight, unsigned int uiAlignedWidth, unsigned int uiAlignedHeight, bool bUseAsyncCopy)
+{
+    if (!m_bValid)
+    {
+        return RF_STATUS_INVALID_CONTEXT;
+    }
+
+    if (!validateOutputDimensions(uiWidth, uiHeight))
+    {
+        return RF_STATUS_INVALID_DIMENSION;
+    }
+
+    m_uiOutputWidth = uiWidth;
+    m_uiOutputHeight = uiHeight;
+    m_uiAlignedOutputWidth = uiAlignedWidth;
+    m_uiAlignedOutputHeight = uiAlignedHeight;
+
+    // The result is always written to sys mem.
+    m_bUseAsyncCopy = bUseAsyncCopy;
+
+    switch (format)
+    {
+        case RF_NV12:
+            m_uiCSCKernelIdx = RF_KERNEL_RGBA_TO_NV12;
+            m_nOutputBufferSize = (m_uiAlignedOutputWidth * m_uiAlignedOutputHeight) + (m_uiAlignedOutputWidth * m_uiAlignedOutputHeight) / 2;
+            break;
+
+        case RF_I420:
+            m_uiCSCKernelIdx = RF_KERNEL_RGBA_TO_I420;
+            m_nOutputBufferSize = (m_uiAlignedOutputWidth * m_uiAlignedOutputHeight) + (m_uiAlignedOutputWidth * m_uiAlignedOutputHeight) / 2;
+            // Chroma samples are converted into m_ChromaRow before they are split into the U and V plane.
+            m_ChromaRow.resize((m_uiOutputWidth / 2) * 2);
+            break;
+
+        case RF_RGBA8:
+        case RF_ARGB8:
+        case RF_BGRA8:
+            m_uiCSCKernelIdx = RF_KERNEL_RGBA_COPY;
+            m_nOutputBufferSize = m_uiAlignedOutputWidth * m_uiAlignedOutputHeight * 4;
+            break;
+
+        default:
+            return RF_STATUS_INVALID_FORMAT;
+    }
+
+    m_TargetFormat = format;
+
+    for (unsigned int i = 0; i < m_uiNumResultBuffers; ++i)
+    {
+        m_pSysmemBuffer[i] = static_cast<char*>(rfAlignedMalloc(m_nOutputBufferSize, HOST_BUFFER_ALIGNMENT));
+
+        if (!m_pSysmemBuffer[i])
+        {
+            return RF_STATUS_MEMORY_FAIL;
+        }
+
+        // The CSC does not write the padding of aligned buffers.
+        memset(m_pSysmemBuffer[i], 0, m_nOutputBufferSize);
+    }
+
+    return RF_STATUS_OK;
+}
+
+
+RFStatus RFContextHost::deleteBuffers()
+{
+    for (unsigned int i = 0; i < m_uiNumResultBuffers; ++i)
+    {
+        if (m_pSysmemBuffer[i])
+        {
+            rfAlignedFree(m_pSysmemBuffer[i]);
+            m_pSysmemBuffer[i] = nullptr;
+        }
+    }
+
+    for (unsigned int i = 0; i < m_uiMaxNumRT; ++i)
+    {
+        m_pInputBuffer[i] = nullptr;
+        m_uiInputPitch[i] = 0;
+        m_InputFormat[i]  = RF_FORMAT_UNKNOWN;
+        m_rtState[i]      = RF_STATE_INVALID;
+
+        m_pInputChroma[0][i]     = nullptr;
+        m_pInputChroma[1][i]     = nullptr;
+        m_uiInputChromaPitch[i]  = 0;
+        m_uiInputChromaStep[i]   = 0;
+    }
+
+    // No OpenCL objects were created, the base class only resets the dimensions.
+    return RFContextCL::deleteBuffers();
+}
+
+
+RFStatus RFContextHost::setInputBuffer(const void* pBuffer, unsigned int uiPitch, RFFormat format, unsigned int uiWidth, unsigned int uiHeight, unsigned int& idx)
+{
+    if (!m_bValid)
+    {
+        return RF_STATUS_INVALID_CONTEXT;
+    }
+
+    if (!isRGBAFormat(format))
+    {
+        return RF_STATUS_INVALID_FORMAT;
+    }
+
+    if (!pBuffer || uiPitch < uiWidth * 4)
+    {
+        return RF_STATUS_INVALID_RENDER_TARGET;
+    }
+
+    if (!validateDimensions(uiWidth, uiHeight))
+    {
+        return RF_STATUS_INVALID_DIMENSION;
+    }
+
+    unsigned int uiIndex = 0;
+
+    if (!getFreeRenderTargetIndex(uiIndex))
+    {
+        return RF_STATUS_RENDER_TARGET_FAIL;
+    }
+
+    m_pInputBuffer[uiIndex] = static_cast<const unsigned char*>(pBuffer);
+    m_uiInputPitch[uiIndex] = uiPitch;
+    m_InputFormat[uiIndex]  = format;
+    m_rtState[uiIndex]      = RF_STATE_FREE;
+
+    idx = uiIndex;
+
+    ++m_uiNumRegisteredRT;
+
+    m_uiInputWidth  = uiWidth;
+    m_uiInputHeight = uiHeight;
+
+    return RF_STATUS_OK;
+}
+
+
+RFStatus RFContextHost::setInputPlanes(const void* pY, const void* pU, const void* pV, unsigned int uiPitchY, unsigned int uiPitchUV, unsigned int uiChromaStep,
+                                       unsigned int uiWidth, unsigned int uiHeight, unsigned int& idx)
+{
+    if (!m_bValid)
+    {
+        return RF_STATUS_INVALID_CONTEXT;
+    }
+
+    if (!pY || !pU || !pV || uiChromaStep == 0 || uiPitchY < uiWidth || uiPitchUV < (uiWidth / 2) * uiChromaStep)
+    {
+        return RF_STATUS_INVALID_RENDER_TARGET;
+    }
+
+    if (!validateDimensions(uiWidth, uiHeight))
+    {
+        return RF_STATUS_INVALID_DIMENSION;
+    }
+
+    unsigned int uiIndex = 0;
+
+    if (!getFreeRenderTargetIndex(uiIndex))
+    {
+        return RF_STATUS_RENDER_TARGET_FAIL;
+    }
+
+    // RF_NV12 marks a 4:2:0 input. The layout of the chroma samples is described by the chroma pointers and step.
+    m_pInputBuffer[uiIndex]       = static_cast<const unsigned char*>(pY);
+    m_uiInputPitch[uiIndex]       = uiPitchY;
+    m_InputFormat[uiIndex]        = RF_NV12;
+    m_pInputChroma[0][uiIndex]    = static_cast<const unsigned char*>(pU);
+    m_pInputChroma[1][uiIndex]    = static_cast<const unsigned char*>(pV);
+    m_uiInputChromaPitch[uiIndex] = uiPitchUV;
+    m_uiInputChromaStep[uiIndex]  = uiChromaStep;
+    m_rtState[uiIndex]            = RF_STATE_FREE;
+
+    idx = uiIndex;
+
+    ++m_uiNumRegisteredRT;
+
+    m_uiInputWidth  = uiWidth;
+    m_uiInputHeight = uiHeight;
+
+    return RF_STATUS_OK;
+}
+
+
+RFStatus RFContextHost::processBuffer(bool bRunCSC, bool bInvert, unsigned int uiSrcIdx, unsigned int uiDestIdx)
+{
+    if (!m_bValid)
+    {
+        return RF_STATUS_INVALID_CONTEXT;
+    }
+
+    if (m_TargetFormat == RF_FORMAT_UNKNOWN || m_uiCSCKernelIdx <= RF_KERNEL_UNKNOWN || m_uiCSCKernelIdx >= RF_KERNEL_NUMBER)
+    {
+        return RF_STATUS_INVALID_FORMAT;
+    }
+
+    if (uiSrcIdx >= m_uiMaxNumRT || m_rtState[uiSrcIdx] == RF_STATE_INVALID || !m_pInputBuffer[uiSrcIdx])
+    {
+        return RF_STATUS_INVALID_RENDER_TARGET;
+    }
+
+    if (uiDestIdx >= m_uiNumResultBuffers || !m_pSysmemBuffer[uiDestIdx])
+    {
+        return RF_STATUS_INVALID_INDEX;
+    }
+
+    // 4:2:0 input can only be repacked to NV12 or I420 and cannot be scaled.
+    if (m_InputFormat[uiSrcIdx] == RF_NV12 && m_uiCSCKernelIdx != RF_KERNEL_RGBA_TO_NV12 && m_uiCSCKernelIdx != RF_KERNEL_RGBA_TO_I420)
+    {
+        return RF_STATUS_INVALID_FORMAT;
+    }
+
+    if (m_InputFormat[uiSrcIdx] == RF_NV12 && isInputScaled())
+    {
+        return RF_STATUS_INVALID_DIMENSION;
+    }
+
+    if (isInputScaled())
+    {
+        updateScaleFilters();
+    }
+
+    m_rtState[uiSrcIdx] = RF_STATE_BLOCKED;
+
+    // The conversion is executed synchronously, there is no separate DMA stage.
+    RFTraceScope cscScope(m_pTrace, RF_TRACE_CSC, uiDestIdx);
+
+    const unsigned char* pSrc    = m_pInputBuffer[uiSrcIdx];
+    const unsigned int   uiPitch = m_uiInputPitch[uiSrcIdx];
+    unsigned char*       pDst    = reinterpret_cast<unsigned char*>(m_pSysmemBuffer[uiDestIdx]);
+
+    // Offset to the start of the chroma planes. Same as in rgbaTonv12_image2d and rgbaToI420_image2d.
+    unsigned char*       pUVPlane      = pDst + m_uiAlignedOutputWidth * m_uiOutputHeight;
+    const unsigned int   uiPlanarPitch = m_uiAlignedOutputWidth / 2;
+    unsigned char*       pVPlane       = pUVPlane + uiPlanarPitch * (m_uiOutputHeight / 2);
+
+    if (m_InputFormat[uiSrcIdx] == RF_NV12)
+    {
+        const unsigned char* pU = m_pInputChroma[0][uiSrcIdx];
+        const unsigned char* pV = m_pInputChroma[1][uiSrcIdx];
+
+        const unsigned int uiChromaPitch = m_uiInputChromaPitch[uiSrcIdx];
+        const unsigned int uiChromaStep  = m_uiInputChromaStep[uiSrcIdx];
+
+        for (unsigned int y = 0; y < m_uiOutputHeight; ++y)
+        {
+            const unsigned int uiRow = (bInvert) ? (m_uiOutputHeight - (y + 1)) : y;
+
+            memcpy(pDst + y * m_uiAlignedOutputWidth, pSrc + uiRow * uiPitch, m_uiOutputWidth);
+        }
+
+        for (unsigned int y = 0; y < m_uiOutputHeight / 2; ++y)
+        {
+            const unsigned int uiRow = (bInvert) ? (m_uiOutputHeight / 2 - (y + 1)) : y;
+
+            if (m_uiCSCKernelIdx == RF_KERNEL_RGBA_TO_I420)
+            {
+                copyChromaRow(pU + uiRow * uiChromaPitch, pUVPlane + y * uiPlanarPitch, uiChromaStep, 0, m_uiOutputWidth / 2);
+                copyChromaRow(pV + uiRow * uiChromaPitch, pVPlane + y * uiPlanarPitch, uiChromaStep, 0, m_uiOutputWidth / 2);
+            }
+            else
+            {
+                interleaveChromaRow(pU + uiRow * uiChromaPitch, pV + uiRow * uiChromaPitch, pUVPlane + y * m_uiAlignedOutputWidth, uiChromaStep, 0, m_uiOutputWidth / 2);
+            }
+        }
+
+        m_rtState[uiSrcIdx] = RF_STATE_FREE;
+
+        return RF_STATUS_OK;
+    }
+
+    // Byte offsets of the R, G, B and A channel in the source pixels.
+    const unsigned char* pChannelOffset = g_ChannelOffset[m_InputFormat[uiSrcIdx]];
+
+    if (m_uiCSCKernelIdx == RF_KERNEL_RGBA_TO_NV12 || m_uiCSCKernelIdx == RF_KERNEL_RGBA_TO_I420)
+    {
+        const unsigned int uiNumPairs = m_uiOutputWidth / 2;
+        const bool         bPlanar    = (m_uiCSCKernelIdx == RF_KERNEL_RGBA_TO_I420);
+
+        for (unsigned int y = 0; y < m_uiOutputHeight / 2; ++y)
+        {
+            const unsigned char* pSrc0 = getInputRow(uiSrcIdx, 2 * y, bInvert, 0);
+            const unsigned char* pSrc1 = getInputRow(uiSrcIdx, 2 * y + 1, bInvert, 1);
+
+            unsigned char* pY0 = pDst + (2 * y) * m_uiAlignedOutputWidth;
+            unsigned char* pY1 = pY0 + m_uiAlignedOutputWidth;
+            // I420 chroma samples are converted into an interleaved row first and split into the U and V plane.
+            unsigned char* pUV = (bPlanar) ? m_ChromaRow.data() : pUVPlane + y * m_uiAlignedOutputWidth;
+
+            unsigned int x = 0;
+
+            if (m_bUseAVX2)
+            {
+                x = convertRGBAToNV12AVX2(pSrc0, pSrc1, pY0, pY1, pUV, pChannelOffset, uiNumPairs);
+            }
+
+            convertRGBAToNV12Scalar(pSrc0, pSrc1, pY0, pY1, pUV, pChannelOffset, x, uiNumPairs);
+
+            if (bPlanar)
+            {
+                splitChromaRow(pUV, pUVPlane + y * uiPlanarPitch, pVPlane + y * uiPlanarPitch, 0, uiNumPairs);
+            }
+        }
+    }
+    else
+    {
+        // Build the mapping from destination bytes to source bytes. If no CSC is requested the input is copied
+        // without reordering the channels, same as the image to buffer copy of the OpenCL context.
+        unsigned char pMap[4] = { 0, 1, 2, 3 };
+
+        if (bRunCSC)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                pMap[i] = pChannelOffset[g_ChannelOrder[m_TargetFormat][i]];
+            }
+        }
+
+        const bool bFlip = (bRunCSC) ? bInvert : false;
+        const bool bCopy = isIdentityMap(pMap);
+
+        for (unsigned int y = 0; y < m_uiOutputHeight; ++y)
+        {
+            const unsigned char* pRow = getInputRow(uiSrcIdx, y, bFlip, 0);
+            unsigned char*       pOut = pDst + y * m_uiAlignedOutputWidth * 4;
+
+            if (bCopy)
+            {
+                memcpy(pOut, pRow, m_uiOutputWidth * 4);
+                continue;
+            }
+
+            unsigned int x = 0;
+
+            if (m_bUseAVX2)
+            {
+                x = copyRGBARowAVX2(pRow, pOut, pMap, m_uiOutputWidth);
+            }
+
+            copyRGBARowScalar(pRow, pOut, pMap, x, m_uiOutputWidth);
+        }
+    }
+
+    m_rtState[uiSrcIdx] = RF_STATE_FREE;
+
+    return RF_STATUS_OK;
+}
+
+
+void RFContextHost::getResultBuffer(unsigned int idx, void* &pBuffer) const
+{
+    pBuffer = m_pSysmemBuffer[idx];
+}
+
+
+void RFContextHost::updateScaleFilters()
+{
+    const unsigned int uiInputSize[2]  = { m_uiInputWidth, m_uiInputHeight };
+    const unsigned int uiOutputSize[2] = { m_uiOutputWidth, m_uiOutputHeight };
+
+    for (int i = 0; i < 2; ++i)
+    {
+        ScaleFilter& filter = m_ScaleFilter[i];
+
+        if (filter.uiInputSize != uiInputSize[i] || filter.Start.size() != uiOutputSize[i])
+        {
+            createScaleFilter(uiInputSize[i], uiOutputSize[i], filter.uiNumTaps, filter.Start, filter.Weights);
+
+            filter.uiInputSize = uiInputSize[i];
+        }
+    }
+
+    // Pack the weights of two consecutive taps of the horizontal filter. An odd number of taps is padded with a
+    // zero weight which is applied to the padding of m_FilteredRow.
+    const ScaleFilter& Columns    = m_ScaleFilter[0];
+    const unsigned int uiNumPairs = (Columns.uiNumTaps + 1) / 2;
+
+    m_PairWeights.assign(m_uiOutputWidth * uiNumPairs, 0);
+
+    for (unsigned int x = 0; x < m_uiOutputWidth; ++x)
+    {
+        for (unsigned int t = 0; t < Columns.uiNumTaps; ++t)
+        {
+            m_PairWeights[x * uiNumPairs + t / 2] |= static_cast<unsigned int>(Columns.Weights[x * Columns.uiNumTaps + t]) << (16 * (t & 1));
+        }
+    }
+
+    m_pFilterRows.resize(m_ScaleFilter[1].uiNumTaps);
+    m_FilteredRow.assign((m_uiInputWidth + 1) * 4, 0);
+    m_ScaledRow[0].resize(m_uiOutputWidth * 4);
+    m_ScaledRow[1].resize(m_uiOutputWidth * 4);
+}
+
+
+const unsigned char* RFContextHost::getInputRow(unsigned int uiSrcIdx, unsigned int uiRow, bool bInvert, unsigned int uiSlot)
+{
+    const unsigned char* pSrc    = m_pInputBuffer[uiSrcIdx];
+    const unsigned int   uiPitch = m_uiInputPitch[uiSrcIdx];
+
+    if (!isInputScaled())
+    {
+        return pSrc + ((bInvert) ? (m_uiOutputHeight - (uiRow + 1)) : uiRow) * uiPitch;
+    }
+
+    const ScaleFilter& Columns = m_ScaleFilter[0];
+    const ScaleFilter& Rows    = m_ScaleFilter[1];
+
+    // Combine the input rows of the output row. Each input row is only read by the output rows that depend on it.
+    for (unsigned int t = 0; t < Rows.uiNumTaps; ++t)
+    {
+        const unsigned int uiInputRow = Rows.Start[uiRow] + t;
+
+        m_pFilterRows[t] = pSrc + ((bInvert) ? (m_uiInputHeight - (uiInputRow + 1)) : uiInputRow) * uiPitch;
+    }
+
+    const unsigned short* pRowWeights = &Rows.Weights[uiRow * Rows.uiNumTaps];
+    const unsigned int    uiRowSize   = m_uiInputWidth * 4;
+
+    unsigned int i = 0;
+
+    if (m_bUseAVX2)
+    {
+        i = filterRowsAVX2(m_pFilterRows.data(), pRowWeights, Rows.uiNumTaps, m_FilteredRow.data(), uiRowSize);
+    }
+
+    filterRowsScalar(m_pFilterRows.data(), pRowWeights, Rows.uiNumTaps, m_FilteredRow.data(), i, uiRowSize);
+
+    // Filter the combined row horizontally. The channels are filtered independently, so the channel order of
+    // the input is kept.
+    unsigned char* pOut = m_ScaledRow[uiSlot].data();
+
+    unsigned int x = 0;
+
+    if (m_bUseAVX2)
+    {
+        x = filterColumnsAVX2(m_FilteredRow.data(), Columns.Start.data(), m_PairWeights.data(), (Columns.uiNumTaps + 1) / 2, pOut, m_uiOutputWidth);
+    }
+
+    filterColumnsScalar(m_FilteredRow.data(), Columns.Start.data(), Columns.Weights.data(), Columns.uiNumTaps, pOut, x, m_uiOutputWidth);
+
+    return pOut;
+}
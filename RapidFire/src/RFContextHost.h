@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "RFContext.h"
+
+// RFContextHost runs the color space conversion on the CPU. Input images and result buffers
+// are located in system memory, so no OpenCL device and no pinned buffer transfer is needed.
+// The output is identical to the output of the OpenCL kernels in rfkernels.cl. Scaled images
+// use the same filter as the scaled kernels but may differ by rounding.
+class RFContextHost : public RFContextCL
+{
+public:
+
+    RFContextHost();
+    ~RFContextHost();
+
+    // Initializes the context. No OpenCL context is created.
+    virtual RFStatus    createContext() override;
+
+    // Creates result buffers in system memory.
+    virtual RFStatus    createBuffers(RFFormat format, unsigned int uiWidth, unsigned int uiHeight, unsigned int uiAlignedWidth, unsigned int uiAlignedHeight, bool bUseAsyncCopy = false) override;
+
+    // Deletes all result buffers and removes all registered input buffers.
+    virtual RFStatus    deleteBuffers() override;
+
+    // Registers an image in system memory. format can be RF_RGBA8, RF_ARGB8 or RF_BGRA8. The memory has to stay
+    // valid until the buffer is removed.
+    RFStatus            setInputBuffer(const void* pBuffer, unsigned int uiPitch, RFFormat format, unsigned int uiWidth, unsigned int uiHeight, unsigned int& idx);
+
+    // Registers a YUV 4:2:0 image in system memory. uiChromaStep is the distance in bytes between two samples of
+    // a chroma plane, 1 for planar (I420) and 2 for interleaved (NV12) images. The image can only be converted to NV12 or I420.
+    RFStatus            setInputPlanes(const void* pY, const void* pU, const void* pV, unsigned int uiPitchY, unsigned int uiPitchUV, unsigned int uiChromaStep,
+                                       unsigned int uiWidth, unsigned int uiHeight, unsigned int& idx);
+
+    // Sets the number of render targets and result buffers.
+    virtual RFStatus    setPipelineDepth(unsigned int uiDepth) override;
+
+    // Converts the input buffer uiSrcIdx into the result buffer uiDestIdx.
+    virtual RFStatus    processBuffer(bool bRunCSC, bool bInvert, unsigned int uiSrcIdx, unsigned int uiDestIdx) override;
+
+    using RFContextCL::getResultBuffer;
+
+    // Returns the pointer to the result buffer. The CSC is executed synchronously, no wait is required.
+    virtual void        getResultBuffer(unsigned int idx, void* &pBuffer) const override;
+
+private:
+
+    // Filter of one dimension of the scaled conversion. Output sample i is the weighted sum of uiNumTaps input
+    // samples starting at Start[i]. The weights of each output sample add up to 256.
+    struct ScaleFilter
+    {
+        unsigned int                uiInputSize;
+        unsigned int                uiNumTaps;
+        std::vector<unsigned int>   Start;
+        std::vector<unsigned short> Weights;
+    };
+
+    // Builds the filters for the current input and output dimensions if they changed.
+    void                updateScaleFilters();
+
+    // Returns row uiRow of the input uiSrcIdx with the width of the output. If the input is scaled, the row is
+    // filtered into m_ScaledRow[uiSlot], otherwise the input row is returned. The channel order is not changed.
+    const unsigned char* getInputRow(unsigned int uiSrcIdx, unsigned int uiRow, bool bInvert, unsigned int uiSlot);
+
+    std::vector<const unsigned char*>   m_pInputBuffer;
+    std::vector<unsigned int>           m_uiInputPitch;
+    std::vector<RFFormat>               m_InputFormat;
+
+    // Chroma planes of 4:2:0 inputs. m_pInputChroma[0] stores the U and m_pInputChroma[1] the V planes.
+    std::vector<const unsigned char*>   m_pInputChroma[2];
+    std::vector<unsigned int>           m_uiInputChromaPitch;
+    std::vector<unsigned int>           m_uiInputChromaStep;
+
+    // Horizontal and vertical filter of the scaled conversion.
+    ScaleFilter                         m_ScaleFilter[2];
+    // Weights of two consecutive taps of the horizontal filter packed into 32 bits. Used by the AVX2 code path.
+    std::vector<unsigned int>           m_PairWeights;
+    // Input rows of the vertical filter and the filtered row in 7.8 fixed point. The row is padded by one pixel.
+    std::vector<const unsigned char*>   m_pFilterRows;
+    std::vector<unsigned short>         m_FilteredRow;
+    // Scaled rows that are passed to the conversion. The NV12 conversion needs two rows.
+    std::vector<unsigned char>          m_ScaledRow[2];
+    // Interleaved chroma samples of a row pair of the I420 conversion.
+    std::vector<unsigned char>          m_ChromaRow;
+
+    // Indicates if the AVX2 code path can be used.
+    bool                                m_bUseAVX2;
+};
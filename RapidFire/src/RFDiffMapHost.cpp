@@ -0,0 +1,1819 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "RFDiffMapHost.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+#include <immintrin.h>
+
+#include "RFUtils.h"
+
+// Number of stripes per thread. Changes are usually not distributed evenly, smaller stripes balance the load.
+#define RF_DIFF_HOST_STRIPES_PER_THREAD     4
+
+// Blocks are merged into a rectangle as long as at most 1 / RF_DIFF_RECT_OVERDRAW_RATIO of its blocks did not change.
+#define RF_DIFF_RECT_OVERDRAW_RATIO         4
+
+// Number of pixels hashed at once. A stripe is 32 bytes that are processed as 4 64 bit lanes.
+#define RF_DIFF_HASH_STRIPE_SIZE            8
+
+// Maximum number of changed lines or columns of a strip that are used to find the shift of a move.
+#define RF_DIFF_MOVE_SAMPLES                64
+
+// Number of entries of the hash table of the samples. Needs to be a power of 2 and larger than RF_DIFF_MOVE_SAMPLES.
+#define RF_DIFF_MOVE_TABLE_SIZE             256
+
+// Secret of the block hash. The key of stripe s of a block is s_HashKey + s * s_HashStep. The same
+// values are used by the DiffMap_Hash kernels.
+static const uint64_t s_HashKey[4]  = { 0x9E3779B185EBCA87ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL, 0x85EBCA77C2B2AE63ULL };
+static const uint64_t s_HashStep[4] = { 0x27D4EB2F165667C5ULL, 0x94D049BB133111EBULL, 0xBF58476D1CE4E5B9ULL, 0xFF51AFD7ED558CCDULL };
+
+
+static bool isDifferentScalar(const unsigned char* p1, const unsigned char* p2, unsigned int uiSize)
+{
+    return (memcmp(p1, p2, uiSize) != 0);
+}
+
+
+// Packs the uiNumBlocks bytes of pBytes into one bit per block and sets the padding of the uiPitch bytes of pBits to 0.
+static void packBits(const unsigned char* pBytes, unsigned int uiNumBlocks, unsigned char* pBits, unsigned int uiPitch)
+{
+    memset(pBits, 0, uiPitch);
+
+    for (unsigned int x = 0; x < uiNumBlocks; ++x)
+    {
+        if (pBytes[x])
+        {
+            pBits[x >> 3] |= static_cast<unsigned char>(1 << (x & 7));
+        }
+    }
+}
+
+
+// Finds the next run of changed blocks in a row of a bit map starting at block x. Returns false if there is none.
+// Otherwise the run is [uiStart, x).
+static bool findNextRun(const unsigned char* pRow, unsigned int uiNumBlocks, unsigned int& x, unsigned int& uiStart)
+{
+    while (x < uiNumBlocks)
+    {
+        // Skip 32 unchanged blocks at once. Reading the whole word is safe since rows are padded to 32 bit.
+        if ((x & 31) == 0)
+        {
+            unsigned int uiWord;
+
+            memcpy(&uiWord, pRow + (x >> 3), sizeof(uiWord));
+
+            if (uiWord == 0)
+            {
+                x += 32;
+                continue;
+            }
+        }
+
+        if (!(pRow[x >> 3] & (1 << (x & 7))))
+        {
+            ++x;
+            continue;
+        }
+
+        uiStart = x;
+
+        while (x < uiNumBlocks && (pRow[x >> 3] & (1 << (x & 7))))
+        {
+            ++x;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+
+// Returns the number of changed blocks in [uiLeft, uiRight) of a row of a RF_DIFF_MAP_BIT map.
+static unsigned int countChangedBlocks(const unsigned char* pRow, unsigned int uiLeft, unsigned int uiRight)
+{
+    unsigned int uiChanged = 0;
+
+    for (unsigned int x = uiLeft; x < uiRight; ++x)
+    {
+        uiChanged += (pRow[x >> 3] >> (x & 7)) & 1;
+    }
+
+    return uiChanged;
+}
+
+
+// Returns true if a rectangle of uiArea blocks of which uiChanged blocks changed is within the overdraw limit.
+static bool isOverdrawAccepted(unsigned int uiArea, unsigned int uiChanged)
+{
+    return ((uiArea - uiChanged) * RF_DIFF_RECT_OVERDRAW_RATIO <= uiArea);
+}
+
+
+static void writeUShort(unsigned char* p, unsigned int uiValue)
+{
+    p[0] = static_cast<unsigned char>(uiValue & 0xFF);
+    p[1] = static_cast<unsigned char>((uiValue >> 8) & 0xFF);
+}
+
+
+RF_TARGET_SSE41 static bool isDifferentSSE41(const unsigned char* p1, const unsigned char* p2, unsigned int uiSize)
+{
+    unsigned int i = 0;
+
+    for (; i + 16 <= uiSize; i += 16)
+    {
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p1 + i));
+        const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p2 + i));
+        const __m128i vDiff = _mm_xor_si128(v1, v2);
+
+        if (!_mm_testz_si128(vDiff, vDiff))
+        {
+            return true;
+        }
+    }
+
+    return isDifferentScalar(p1 + i, p2 + i, uiSize - i);
+}
+
+
+RF_TARGET_AVX2 static bool isDifferentAVX2(const unsigned char* p1, const unsigned char* p2, unsigned int uiSize)
+{
+    unsigned int i = 0;
+
+    for (; i + 32 <= uiSize; i += 32)
+    {
+        const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p1 + i));
+        const __m256i v2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p2 + i));
+        const __m256i vDiff = _mm256_xor_si256(v1, v2);
+
+        if (!_mm256_testz_si256(vDiff, vDiff))
+        {
+            return true;
+        }
+    }
+
+    return isDifferentScalar(p1 + i, p2 + i, uiSize - i);
+}
+
+
+static unsigned int getPixelDifferenceScalar(const unsigned char* p1, const unsigned char* p2, unsigned int uiNumPixels, unsigned int uiPixelThreshold,
+                                             unsigned int& uiNumChanged)
+{
+    unsigned int uiSum = 0;
+
+    for (unsigned int i = 0; i < uiNumPixels * 4; i += 4)
+    {
+        unsigned int uiDiff = 0;
+
+        for (unsigned int c = i; c < i + 4; ++c)
+        {
+            uiDiff += (p1[c] > p2[c]) ? (p1[c] - p2[c]) : (p2[c] - p1[c]);
+        }
+
+        if (uiDiff > uiPixelThreshold)
+        {
+            uiSum += uiDiff;
+            ++uiNumChanged;
+        }
+    }
+
+    return uiSum;
+}
+
+
+RF_TARGET_AVX2 static unsigned int getPixelDifferenceAVX2(const unsigned char* p1, const unsigned char* p2, unsigned int uiNumPixels, unsigned int uiPixelThreshold,
+                                                          unsigned int& uiNumChanged)
+{
+    // The difference of a pixel is at most 4 * 255. Larger thresholds would turn negative in the signed compare.
+    const __m256i vThreshold = _mm256_set1_epi32(static_cast<int>(std::min(uiPixelThreshold, 4U * 255U)));
+    const __m256i vOnes8     = _mm256_set1_epi8(1);
+    const __m256i vOnes16    = _mm256_set1_epi16(1);
+
+    __m256i vSum   = _mm256_setzero_si256();
+    __m256i vCount = _mm256_setzero_si256();
+
+    unsigned int i = 0;
+
+    for (; i + 8 <= uiNumPixels; i += 8)
+    {
+        const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p1 + i * 4));
+        const __m256i v2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p2 + i * 4));
+
+        // Absolute difference of each channel summed into one 32 bit value per pixel.
+        const __m256i vAbsDiff = _mm256_or_si256(_mm256_subs_epu8(v1, v2), _mm256_subs_epu8(v2, v1));
+        const __m256i vDiff    = _mm256_madd_epi16(_mm256_maddubs_epi16(vAbsDiff, vOnes8), vOnes16);
+        const __m256i vChanged = _mm256_cmpgt_epi32(vDiff, vThreshold);
+
+        vSum   = _mm256_add_epi32(vSum, _mm256_and_si256(vDiff, vChanged));
+        vCount = _mm256_sub_epi32(vCount, vChanged);
+    }
+
+    unsigned int Sum[8];
+    unsigned int Count[8];
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(Sum), vSum);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(Count), vCount);
+
+    unsigned int uiSum = 0;
+
+    for (unsigned int j = 0; j < 8; ++j)
+    {
+        uiSum        += Sum[j];
+        uiNumChanged += Count[j];
+    }
+
+    return uiSum + getPixelDifferenceScalar(p1 + i * 4, p2 + i * 4, uiNumPixels - i, uiPixelThreshold, uiNumChanged);
+}
+
+
+// Adds one stripe to the accumulators of a block. Each lane is multiplied with its key as two 32 bit halves and
+// the neighbouring lane is added to spread the input over all accumulators.
+static inline void hashStripeScalar(const unsigned char* pStripe, const uint64_t* pKey, uint64_t* pAcc)
+{
+    uint64_t Data[4];
+
+    memcpy(Data, pStripe, sizeof(Data));
+
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        const uint64_t uiDataKey = Data[i] ^ pKey[i];
+
+        pAcc[i] += (uiDataKey & 0xFFFFFFFF) * (uiDataKey >> 32);
+        pAcc[i] += Data[i ^ 1];
+    }
+}
+
+
+static void hashLineScalar(const unsigned char* pLine, unsigned int uiWidth, unsigned int uiBlockWidth, unsigned int uiLine, uint64_t* pAcc)
+{
+    const unsigned int uiStripesPerLine = (uiBlockWidth + RF_DIFF_HASH_STRIPE_SIZE - 1) / RF_DIFF_HASH_STRIPE_SIZE;
+
+    for (unsigned int x = 0; x < uiWidth; x += uiBlockWidth, pAcc += 4)
+    {
+        const unsigned int uiBlockEnd = std::min(x + uiBlockWidth, uiWidth);
+
+        uint64_t Key[4];
+
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            Key[i] = s_HashKey[i] + static_cast<uint64_t>(uiLine * uiStripesPerLine) * s_HashStep[i];
+        }
+
+        for (unsigned int px = x; px < uiBlockEnd; px += RF_DIFF_HASH_STRIPE_SIZE)
+        {
+            if (px + RF_DIFF_HASH_STRIPE_SIZE <= uiBlockEnd)
+            {
+                hashStripeScalar(pLine + px * 4, Key, pAcc);
+            }
+            else
+            {
+                // Pixels outside of the block or the image are hashed as 0.
+                unsigned char Stripe[RF_DIFF_HASH_STRIPE_SIZE * 4] = {};
+
+                memcpy(Stripe, pLine + px * 4, (uiBlockEnd - px) * 4);
+
+                hashStripeScalar(Stripe, Key, pAcc);
+            }
+
+            for (unsigned int i = 0; i < 4; ++i)
+            {
+                Key[i] += s_HashStep[i];
+            }
+        }
+    }
+}
+
+
+RF_TARGET_AVX2 static void hashLineAVX2(const unsigned char* pLine, unsigned int uiWidth, unsigned int uiBlockWidth, unsigned int uiLine, uint64_t* pAcc)
+{
+    const unsigned int uiStripesPerLine = (uiBlockWidth + RF_DIFF_HASH_STRIPE_SIZE - 1) / RF_DIFF_HASH_STRIPE_SIZE;
+    const uint64_t     uiFirstStripe    = uiLine * uiStripesPerLine;
+
+    const __m256i vStep     = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s_HashStep));
+    const __m256i vLineKey  = _mm256_set_epi64x(s_HashKey[3] + uiFirstStripe * s_HashStep[3], s_HashKey[2] + uiFirstStripe * s_HashStep[2],
+                                                s_HashKey[1] + uiFirstStripe * s_HashStep[1], s_HashKey[0] + uiFirstStripe * s_HashStep[0]);
+
+    for (unsigned int x = 0; x < uiWidth; x += uiBlockWidth, pAcc += 4)
+    {
+        const unsigned int uiBlockEnd = std::min(x + uiBlockWidth, uiWidth);
+
+        __m256i vAcc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pAcc));
+        __m256i vKey = vLineKey;
+
+        for (unsigned int px = x; px < uiBlockEnd; px += RF_DIFF_HASH_STRIPE_SIZE)
+        {
+            __m256i vData;
+
+            if (px + RF_DIFF_HASH_STRIPE_SIZE <= uiBlockEnd)
+            {
+                vData = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pLine + px * 4));
+            }
+            else
+            {
+                unsigned char Stripe[RF_DIFF_HASH_STRIPE_SIZE * 4] = {};
+
+                memcpy(Stripe, pLine + px * 4, (uiBlockEnd - px) * 4);
+
+                vData = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Stripe));
+            }
+
+            const __m256i vDataKey = _mm256_xor_si256(vData, vKey);
+
+            // _mm256_mul_epu32 multiplies the low 32 bits of each lane.
+            vAcc = _mm256_add_epi64(vAcc, _mm256_mul_epu32(vDataKey, _mm256_srli_epi64(vDataKey, 32)));
+            vAcc = _mm256_add_epi64(vAcc, _mm256_shuffle_epi32(vData, _MM_SHUFFLE(1, 0, 3, 2)));
+
+            vKey = _mm256_add_epi64(vKey, vStep);
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pAcc), vAcc);
+    }
+}
+
+
+static inline uint64_t mixHash(uint64_t uiHash)
+{
+    uiHash ^= uiHash >> 33;
+    uiHash *= 0xFF51AFD7ED558CCDULL;
+    uiHash ^= uiHash >> 33;
+    uiHash *= 0xC4CEB9FE1A85EC53ULL;
+    uiHash ^= uiHash >> 33;
+
+    return uiHash;
+}
+
+
+static inline uint64_t finalizeHash(const uint64_t* pAcc)
+{
+    uint64_t uiHash = mixHash(pAcc[0]);
+
+    uiHash = mixHash(uiHash ^ pAcc[1]);
+    uiHash = mixHash(uiHash ^ pAcc[2]);
+    uiHash = mixHash(uiHash ^ pAcc[3]);
+
+    return uiHash;
+}
+
+
+// Adds line uiLine of a superblock row to the hash of each column. Each pixel is multiplied with itself
+// combined with two halves of the key of the line.
+static void hashColumnsScalar(const unsigned char* pLine, unsigned int uiWidth, unsigned int uiLine, uint64_t* pColumnHashes)
+{
+    const uint64_t uiKey   = s_HashKey[0] + uiLine * s_HashStep[0];
+    const uint32_t uiKeyLo = static_cast<uint32_t>(uiKey);
+    const uint32_t uiKeyHi = static_cast<uint32_t>(uiKey >> 32);
+
+    for (unsigned int x = 0; x < uiWidth; ++x)
+    {
+        uint32_t uiPixel;
+
+        memcpy(&uiPixel, pLine + x * 4, sizeof(uiPixel));
+
+        pColumnHashes[x] += static_cast<uint64_t>(uiPixel ^ uiKeyLo) * (uiPixel ^ uiKeyHi);
+    }
+}
+
+
+RF_TARGET_AVX2 static void hashColumnsAVX2(const unsigned char* pLine, unsigned int uiWidth, unsigned int uiLine, uint64_t* pColumnHashes)
+{
+    const uint64_t uiKey  = s_HashKey[0] + uiLine * s_HashStep[0];
+    const __m256i  vKeyLo = _mm256_set1_epi64x(static_cast<uint32_t>(uiKey));
+    const __m256i  vKeyHi = _mm256_set1_epi64x(static_cast<uint32_t>(uiKey >> 32));
+
+    unsigned int x = 0;
+
+    for (; x + 4 <= uiWidth; x += 4)
+    {
+        const __m256i vPixels = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pLine + x * 4)));
+        const __m256i vHash   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pColumnHashes + x));
+        const __m256i vMul    = _mm256_mul_epu32(_mm256_xor_si256(vPixels, vKeyLo), _mm256_xor_si256(vPixels, vKeyHi));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pColumnHashes + x), _mm256_add_epi64(vHash, vMul));
+    }
+
+    hashColumnsScalar(pLine + x * 4, uiWidth - x, uiLine, pColumnHashes + x);
+}
+
+
+// Returns the blocks [uiFirst, uiLast) that are completely covered by the pixels [uiStart, uiEnd). A block at the border
+// of the image is covered if its part inside the image is covered.
+static void getCoveredBlocks(unsigned int uiStart, unsigned int uiEnd, unsigned int uiBlockSize, unsigned int uiImageSize, unsigned int& uiFirst, unsigned int& uiLast)
+{
+    uiFirst = (uiStart + uiBlockSize - 1) / uiBlockSize;
+    uiLast  = (uiEnd == uiImageSize) ? (uiEnd + uiBlockSize - 1) / uiBlockSize : uiEnd / uiBlockSize;
+
+    uiLast = std::max(uiFirst, uiLast);
+}
+
+
+static inline unsigned int getSampleSlot(uint64_t uiHash)
+{
+    return static_cast<unsigned int>(uiHash >> 56) & (RF_DIFF_MOVE_TABLE_SIZE - 1);
+}
+
+
+// Access the source, destination and size of a move in x (d = 0) or y (d = 1) direction.
+static unsigned int getMoveSrc(const RFDiffMoveRect& Move, unsigned int d)
+{
+    return (d == 0) ? Move.uiSrcX : Move.uiSrcY;
+}
+
+
+static unsigned int getMoveDst(const RFDiffMoveRect& Move, unsigned int d)
+{
+    return (d == 0) ? Move.uiDstX : Move.uiDstY;
+}
+
+
+static unsigned int getMoveSize(const RFDiffMoveRect& Move, unsigned int d)
+{
+    return (d == 0) ? Move.uiWidth : Move.uiHeight;
+}
+
+
+static void setMoveRange(RFDiffMoveRect& Move, unsigned int d, unsigned int uiSrc, unsigned int uiDst, unsigned int uiSize)
+{
+    if (d == 0)
+    {
+        Move.uiSrcX  = uiSrc;
+        Move.uiDstX  = uiDst;
+        Move.uiWidth = uiSize;
+    }
+    else
+    {
+        Move.uiSrcY   = uiSrc;
+        Move.uiDstY   = uiDst;
+        Move.uiHeight = uiSize;
+    }
+}
+
+
+// Returns true if the source or destination of Move1 overlaps with the source or destination of Move2.
+static bool isConflicting(const RFDiffMoveRect& Move1, const RFDiffMoveRect& Move2)
+{
+    const unsigned int Pos1[2][2] = { { Move1.uiSrcX, Move1.uiSrcY }, { Move1.uiDstX, Move1.uiDstY } };
+    const unsigned int Pos2[2][2] = { { Move2.uiSrcX, Move2.uiSrcY }, { Move2.uiDstX, Move2.uiDstY } };
+
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+        for (unsigned int j = 0; j < 2; ++j)
+        {
+            // Both sources may overlap, they are only read.
+            if (i == 0 && j == 0)
+            {
+                continue;
+            }
+
+            if (Pos1[i][0] < Pos2[j][0] + Move2.uiWidth && Pos2[j][0] < Pos1[i][0] + Move1.uiWidth &&
+                Pos1[i][1] < Pos2[j][1] + Move2.uiHeight && Pos2[j][1] < Pos1[i][1] + Move1.uiHeight)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+RFDiffMapHost::RFDiffMapHost()
+    : m_uiWidth(0)
+    , m_uiHeight(0)
+    , m_uiMapOffset(0)
+    , m_Format(RF_DIFF_MAP_BYTE)
+    , m_uiPixelThreshold(0)
+    , m_uiBlockThreshold(0)
+    , m_uiMinChangedPixels(1)
+    , m_bApplyThresholds(false)
+    , m_bCompareHashes(false)
+    , m_bHashesValid(false)
+    , m_bDetectMoves(false)
+    , m_bMoveHashesValid(false)
+    , m_bKeepBlockFrames(false)
+    , m_bBlockFramesValid(false)
+    , m_uiFrame(0)
+    , m_uiAcknowledgedFrame(0)
+    , m_bAppendTiles(false)
+    , m_pfnIsDifferent(isDifferentScalar)
+    , m_pfnGetPixelDifference(getPixelDifferenceScalar)
+    , m_pfnHashLine(hashLineScalar)
+    , m_pfnHashColumns(hashColumnsScalar)
+    , m_pThreadPool(nullptr)
+{
+    m_uiBlockSize[0] = 0;
+    m_uiBlockSize[1] = 0;
+
+    m_uiNumBlocks[0] = 0;
+    m_uiNumBlocks[1] = 0;
+
+    m_uiSuperBlockSize[0] = 0;
+    m_uiSuperBlockSize[1] = 0;
+
+    m_uiNumSuperBlocks[0] = 0;
+    m_uiNumSuperBlocks[1] = 0;
+
+    if (utilIsAVX2Supported())
+    {
+        m_pfnIsDifferent = isDifferentAVX2;
+        m_pfnGetPixelDifference = getPixelDifferenceAVX2;
+        m_pfnHashLine    = hashLineAVX2;
+        m_pfnHashColumns = hashColumnsAVX2;
+    }
+    else if (utilIsSSE41Supported())
+    {
+        m_pfnIsDifferent = isDifferentSSE41;
+    }
+
+    const unsigned int uiNumThreads = std::min(std::max(std::thread::hardware_concurrency(), 1U), static_cast<unsigned int>(RF_DIFF_HOST_MAX_THREADS));
+
+    m_pThreadPool.reset(new (std::nothrow) RFThreadPool(uiNumThreads));
+}
+
+
+RFDiffMapHost::~RFDiffMapHost()
+{}
+
+
+bool RFDiffMapHost::init(unsigned int uiWidth, unsigned int uiHeight, unsigned int uiBlockWidth, unsigned int uiBlockHeight, RFDiffMapFormat format,
+                         bool bCompareHashes, bool bDetectMoves, bool bAppendTiles)
+{
+    if (uiWidth == 0 || uiHeight == 0 || uiBlockWidth == 0 || uiBlockHeight == 0)
+    {
+        return false;
+    }
+
+    if (format != RF_DIFF_MAP_BYTE && format != RF_DIFF_MAP_BIT && format != RF_DIFF_MAP_RLE && format != RF_DIFF_MAP_RECT)
+    {
+        return false;
+    }
+
+    m_uiWidth  = uiWidth;
+    m_uiHeight = uiHeight;
+
+    m_uiBlockSize[0] = uiBlockWidth;
+    m_uiBlockSize[1] = uiBlockHeight;
+
+    // Same as the number of work groups of the diff map kernels.
+    m_uiNumBlocks[0] = (uiWidth  + uiBlockWidth  - 1) / uiBlockWidth;
+    m_uiNumBlocks[1] = (uiHeight + uiBlockHeight - 1) / uiBlockHeight;
+
+    // The run length map stores block indices as 16 bit values.
+    if (format == RF_DIFF_MAP_RLE && m_uiNumBlocks[0] > 0xFFFF)
+    {
+        return false;
+    }
+
+    m_uiSuperBlockSize[0] = getSuperBlockSize(uiBlockWidth) / uiBlockWidth;
+    m_uiSuperBlockSize[1] = getSuperBlockSize(uiBlockHeight) / uiBlockHeight;
+
+    m_uiNumSuperBlocks[0] = (m_uiNumBlocks[0] + m_uiSuperBlockSize[0] - 1) / m_uiSuperBlockSize[0];
+    m_uiNumSuperBlocks[1] = (m_uiNumBlocks[1] + m_uiSuperBlockSize[1] - 1) / m_uiSuperBlockSize[1];
+
+    m_uiMapOffset = getMapOffset(m_uiNumSuperBlocks[0], m_uiNumSuperBlocks[1]);
+
+    m_Format = format;
+
+    m_ByteMap.clear();
+    m_BitMap.clear();
+
+    if (m_Format != RF_DIFF_MAP_BYTE)
+    {
+        m_ByteMap.resize(m_uiNumBlocks[0] * m_uiNumBlocks[1]);
+    }
+
+    if (m_Format == RF_DIFF_MAP_RLE || m_Format == RF_DIFF_MAP_RECT)
+    {
+        m_BitMap.resize(getBitMapPitch(m_uiNumBlocks[0]) * m_uiNumBlocks[1]);
+    }
+
+    m_bCompareHashes = bCompareHashes;
+    m_bHashesValid   = false;
+
+    m_BlockHashes.clear();
+
+    if (m_bCompareHashes)
+    {
+        m_BlockHashes.resize(m_uiNumBlocks[0] * m_uiNumBlocks[1]);
+    }
+
+    m_bDetectMoves     = bDetectMoves;
+    m_bMoveHashesValid = false;
+
+    m_LineHashes.clear();
+    m_PrevLineHashes.clear();
+    m_ColumnHashes.clear();
+    m_PrevColumnHashes.clear();
+    m_MoveRects.clear();
+
+    if (m_bDetectMoves)
+    {
+        m_LineHashes.resize(m_uiNumSuperBlocks[0] * m_uiHeight);
+        m_PrevLineHashes.resize(m_uiNumSuperBlocks[0] * m_uiHeight);
+        m_ColumnHashes.resize(m_uiNumSuperBlocks[1] * m_uiWidth);
+        m_PrevColumnHashes.resize(m_uiNumSuperBlocks[1] * m_uiWidth);
+    }
+
+    // The frames are reset for the new dimension.
+    setBlockFrames(m_bKeepBlockFrames);
+
+    m_bAppendTiles = bAppendTiles;
+
+    m_FirstTile.clear();
+
+    if (m_bAppendTiles)
+    {
+        m_FirstTile.resize(m_uiNumBlocks[1] + 1);
+    }
+
+    return true;
+}
+
+
+void RFDiffMapHost::setThresholds(unsigned int uiPixelThreshold, unsigned int uiBlockThreshold, unsigned int uiMinChangedPixels)
+{
+    m_uiPixelThreshold   = uiPixelThreshold;
+    m_uiBlockThreshold   = uiBlockThreshold;
+    m_uiMinChangedPixels = std::max(uiMinChangedPixels, 1U);
+
+    m_bApplyThresholds = (m_uiPixelThreshold > 0 || m_uiBlockThreshold > 0 || m_uiMinChangedPixels > 1);
+}
+
+
+void RFDiffMapHost::setBlockFrames(bool bKeepFrames)
+{
+    m_bKeepBlockFrames  = bKeepFrames;
+    m_bBlockFramesValid = false;
+
+    m_BlockFrames.clear();
+
+    if (m_bKeepBlockFrames)
+    {
+        m_BlockFrames.resize(m_uiNumBlocks[0] * m_uiNumBlocks[1]);
+    }
+}
+
+
+unsigned int RFDiffMapHost::getMaxDiffMapSize() const
+{
+    unsigned int uiSize = m_uiMapOffset + getMaxMapSize();
+
+    // The list of moves and the tiles follow the map aligned to 32 bit.
+    if (m_bDetectMoves)
+    {
+        uiSize = ((uiSize + 3) / 4) * 4 + RF_DIFF_MAX_MOVE_RECTS * sizeof(RFDiffMoveRect);
+    }
+
+    if (m_bAppendTiles)
+    {
+        uiSize = ((uiSize + 3) / 4) * 4 + m_uiNumBlocks[0] * m_uiNumBlocks[1] * (sizeof(RFDiffTile) + m_uiBlockSize[0] * m_uiBlockSize[1] * 4);
+    }
+
+    return uiSize;
+}
+
+
+unsigned int RFDiffMapHost::getMaxMapSize() const
+{
+    if (m_Format == RF_DIFF_MAP_BIT)
+    {
+        return getBitMapPitch(m_uiNumBlocks[0]) * m_uiNumBlocks[1];
+    }
+    else if (m_Format == RF_DIFF_MAP_RLE)
+    {
+        return getMaxRunLengthSize(m_uiNumBlocks[0], m_uiNumBlocks[1]);
+    }
+    else if (m_Format == RF_DIFF_MAP_RECT)
+    {
+        return getMaxRectListSize(m_uiNumBlocks[0], m_uiNumBlocks[1]);
+    }
+
+    return m_uiNumBlocks[0] * m_uiNumBlocks[1];
+}
+
+
+unsigned int RFDiffMapHost::getChangedBlocks(const unsigned int* pBlockFrames, unsigned int uiNumBlocks, unsigned int uiFrame, unsigned char* pBlockMap)
+{
+    if (!pBlockFrames)
+    {
+        memset(pBlockMap, 1, uiNumBlocks);
+
+        return uiNumBlocks;
+    }
+
+    unsigned int uiNumChanged = 0;
+
+    for (unsigned int i = 0; i < uiNumBlocks; ++i)
+    {
+        pBlockMap[i] = (pBlockFrames[i] > uiFrame) ? 1 : 0;
+
+        uiNumChanged += pBlockMap[i];
+    }
+
+    return uiNumChanged;
+}
+
+
+unsigned int RFDiffMapHost::getSuperBlockSize(unsigned int uiBlockSize)
+{
+    return ((RF_DIFF_SUPERBLOCK_SIZE + uiBlockSize - 1) / uiBlockSize) * uiBlockSize;
+}
+
+
+unsigned int RFDiffMapHost::getMapOffset(unsigned int uiNumSuperBlocksX, unsigned int uiNumSuperBlocksY)
+{
+    // The map is aligned to 32 bit for the bit map and the rectangle list.
+    return ((sizeof(RFDiffMapHeader) + uiNumSuperBlocksX * uiNumSuperBlocksY + 3) / 4) * 4;
+}
+
+
+unsigned int RFDiffMapHost::getBitMapPitch(unsigned int uiNumBlocksX)
+{
+    // Rows are padded to 32 bit to allow the kernels to set the bits with atomic_or.
+    return ((uiNumBlocksX + 31) / 32) * 4;
+}
+
+
+unsigned int RFDiffMapHost::getMaxRunLengthSize(unsigned int uiNumBlocksX, unsigned int uiNumBlocksY)
+{
+    // Worst case is every second block changed: one run per two blocks.
+    return uiNumBlocksY * (2 + ((uiNumBlocksX + 1) / 2) * 4);
+}
+
+
+unsigned int RFDiffMapHost::encodeRunLength(const unsigned char* pBitMap, unsigned int uiNumBlocksX, unsigned int uiNumBlocksY, unsigned char* pRunLengthMap)
+{
+    const unsigned int uiPitch = getBitMapPitch(uiNumBlocksX);
+
+    unsigned char* pOut = pRunLengthMap;
+
+    for (unsigned int by = 0; by < uiNumBlocksY; ++by)
+    {
+        const unsigned char* pRow = pBitMap + by * uiPitch;
+
+        unsigned char* pNumRuns = pOut;
+        unsigned int   uiNumRuns = 0;
+
+        pOut += 2;
+
+        unsigned int x       = 0;
+        unsigned int uiStart = 0;
+
+        while (findNextRun(pRow, uiNumBlocksX, x, uiStart))
+        {
+            writeUShort(pOut, uiStart);
+            writeUShort(pOut + 2, x - uiStart);
+
+            pOut += 4;
+            ++uiNumRuns;
+        }
+
+        writeUShort(pNumRuns, uiNumRuns);
+    }
+
+    return static_cast<unsigned int>(pOut - pRunLengthMap);
+}
+
+
+unsigned int RFDiffMapHost::getMaxRectListSize(unsigned int uiNumBlocksX, unsigned int uiNumBlocksY)
+{
+    // Each rectangle contains at least one run of a row.
+    return uiNumBlocksY * ((uiNumBlocksX + 1) / 2) * sizeof(RFDiffRect);
+}
+
+
+unsigned int RFDiffMapHost::encodeRects(const unsigned char* pBitMap, unsigned int uiNumBlocksX, unsigned int uiNumBlocksY, unsigned int uiBlockWidth, unsigned int uiBlockHeight,
+                                        unsigned int uiWidth, unsigned int uiHeight, RFDiffRect* pRects)
+{
+    // Rectangle that was extended in the previous row and may grow into the current row. Coordinates are in blocks.
+    struct OpenRect
+    {
+        unsigned int    uiRect;
+        unsigned int    uiLeft;
+        unsigned int    uiRight;
+        unsigned int    uiChanged;
+    };
+
+    const unsigned int uiPitch = getBitMapPitch(uiNumBlocksX);
+
+    std::vector<OpenRect> PrevRow;
+    std::vector<OpenRect> CurrentRow;
+
+    // Row below the lowest rectangle that covers a block column. A rectangle starting in row uiTop can only be
+    // widened to columns with ColumnBottom <= uiTop, this way the rectangles never overlap.
+    std::vector<unsigned int> ColumnBottom(uiNumBlocksX, 0);
+
+    unsigned int uiNumRects = 0;
+
+    auto isColumnRangeFree = [&](unsigned int uiLeft, unsigned int uiRight, unsigned int uiTop)
+    {
+        for (unsigned int x = uiLeft; x < uiRight; ++x)
+        {
+            if (ColumnBottom[x] > uiTop)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    auto placeRect = [&](unsigned int by, const OpenRect& Rect)
+    {
+        std::fill(ColumnBottom.begin() + Rect.uiLeft, ColumnBottom.begin() + Rect.uiRight, by + 1);
+
+        CurrentRow.push_back(Rect);
+    };
+
+    // Adds the span [uiLeft, uiRight) of row by to the open rectangle at PrevRow[uiPrev] or starts a new rectangle.
+    // PrevRow and the spans are sorted by their left edge, so each open rectangle is visited once. The rectangles
+    // in CurrentRow are sorted and disjoint, a span never ends up in two rectangles of the same row.
+    unsigned int uiPrev = 0;
+
+    std::function<void(const unsigned char*, unsigned int, unsigned int, unsigned int, unsigned int)> addSpan;
+
+    addSpan = [&](const unsigned char* pRow, unsigned int by, unsigned int uiLeft, unsigned int uiRight, unsigned int uiChanged)
+    {
+        // The rectangle last placed into this row may already cover the start of the span.
+        if (!CurrentRow.empty() && CurrentRow.back().uiRight > uiLeft)
+        {
+            OpenRect&    Last = CurrentRow.back();
+            RFDiffRect&  Rect = pRects[Last.uiRect];
+
+            if (uiRight <= Last.uiRight)
+            {
+                Last.uiChanged += uiChanged;
+
+                return;
+            }
+
+            const unsigned int uiArea = (uiRight - Last.uiLeft) * Rect.uiHeight;
+
+            if (isColumnRangeFree(Last.uiRight, uiRight, Rect.uiY) && isOverdrawAccepted(uiArea, Last.uiChanged + uiChanged))
+            {
+                std::fill(ColumnBottom.begin() + Last.uiRight, ColumnBottom.begin() + uiRight, by + 1);
+
+                Rect.uiWidth     = uiRight - Last.uiLeft;
+                Last.uiRight     = uiRight;
+                Last.uiChanged  += uiChanged;
+
+                return;
+            }
+
+            // The rectangle takes the covered part. The gaps of the span were only accepted for the whole span,
+            // so the runs right of the rectangle are added one by one.
+            Last.uiChanged += countChangedBlocks(pRow, uiLeft, Last.uiRight);
+
+            unsigned int x       = Last.uiRight;
+            unsigned int uiStart = 0;
+
+            while (findNextRun(pRow, uiRight, x, uiStart))
+            {
+                addSpan(pRow, by, uiStart, x, x - uiStart);
+            }
+
+            return;
+        }
+
+        while (uiPrev < PrevRow.size() && PrevRow[uiPrev].uiRight <= uiLeft)
+        {
+            ++uiPrev;
+        }
+
+        if (uiPrev < PrevRow.size() && PrevRow[uiPrev].uiLeft < uiRight)
+        {
+            const OpenRect&    Open       = PrevRow[uiPrev];
+            RFDiffRect&        Rect       = pRects[Open.uiRect];
+            const unsigned int uiNewLeft  = std::min(Open.uiLeft, uiLeft);
+            const unsigned int uiNewRight = std::max(Open.uiRight, uiRight);
+            const unsigned int uiArea     = (uiNewRight - uiNewLeft) * (Rect.uiHeight + 1);
+            const unsigned int uiRowLeft  = CurrentRow.empty() ? 0 : CurrentRow.back().uiRight;
+
+            if (uiNewLeft >= uiRowLeft &&
+                isColumnRangeFree(uiNewLeft, Open.uiLeft, Rect.uiY) && isColumnRangeFree(Open.uiRight, uiNewRight, Rect.uiY) &&
+                isOverdrawAccepted(uiArea, Open.uiChanged + uiChanged))
+            {
+                Rect.uiX      = uiNewLeft;
+                Rect.uiWidth  = uiNewRight - uiNewLeft;
+                Rect.uiHeight += 1;
+
+                placeRect(by, { Open.uiRect, uiNewLeft, uiNewRight, Open.uiChanged + uiChanged });
+
+                ++uiPrev;
+
+                return;
+            }
+        }
+
+        pRects[uiNumRects] = { uiLeft, by, uiRight - uiLeft, 1 };
+
+        placeRect(by, { uiNumRects, uiLeft, uiRight, uiChanged });
+
+        ++uiNumRects;
+    };
+
+    for (unsigned int by = 0; by < uiNumBlocksY; ++by)
+    {
+        const unsigned char* pRow = pBitMap + by * uiPitch;
+
+        CurrentRow.clear();
+        uiPrev = 0;
+
+        unsigned int x       = 0;
+        unsigned int uiStart = 0;
+
+        // Current span of the row. Runs are joined into one span as long as the gaps are within the overdraw limit.
+        unsigned int uiSpanLeft    = 0;
+        unsigned int uiSpanRight   = 0;
+        unsigned int uiSpanChanged = 0;
+
+        while (findNextRun(pRow, uiNumBlocksX, x, uiStart))
+        {
+            const unsigned int uiRunSize = x - uiStart;
+
+            if (uiSpanChanged > 0 && isOverdrawAccepted(x - uiSpanLeft, uiSpanChanged + uiRunSize))
+            {
+                uiSpanRight    = x;
+                uiSpanChanged += uiRunSize;
+
+                continue;
+            }
+
+            if (uiSpanChanged > 0)
+            {
+                addSpan(pRow, by, uiSpanLeft, uiSpanRight, uiSpanChanged);
+            }
+
+            uiSpanLeft    = uiStart;
+            uiSpanRight   = x;
+            uiSpanChanged = uiRunSize;
+        }
+
+        if (uiSpanChanged > 0)
+        {
+            addSpan(pRow, by, uiSpanLeft, uiSpanRight, uiSpanChanged);
+        }
+
+        // Rectangles that did not grow into this row are complete.
+        PrevRow.swap(CurrentRow);
+    }
+
+    // Convert from blocks to pixels and clip the rectangles at the right and bottom border.
+    for (unsigned int i = 0; i < uiNumRects; ++i)
+    {
+        RFDiffRect& Rect = pRects[i];
+
+        const unsigned int uiRight  = std::min((Rect.uiX + Rect.uiWidth) * uiBlockWidth, uiWidth);
+        const unsigned int uiBottom = std::min((Rect.uiY + Rect.uiHeight) * uiBlockHeight, uiHeight);
+
+        Rect.uiX      *= uiBlockWidth;
+        Rect.uiY      *= uiBlockHeight;
+        Rect.uiWidth  = uiRight - Rect.uiX;
+        Rect.uiHeight = uiBottom - Rect.uiY;
+    }
+
+    return uiNumRects * sizeof(RFDiffRect);
+}
+
+
+void RFDiffMapHost::hashMoveLines(const unsigned char* pImage, unsigned int uiPitch, unsigned int by, uint64_t* pAcc)
+{
+    const unsigned int uiSuperBlockWidth  = m_uiSuperBlockSize[0] * m_uiBlockSize[0];
+    const unsigned int uiSuperBlockHeight = m_uiSuperBlockSize[1] * m_uiBlockSize[1];
+
+    const unsigned int uiFirstLine = by * m_uiBlockSize[1];
+    const unsigned int uiLastLine  = std::min(uiFirstLine + m_uiBlockSize[1], m_uiHeight);
+
+    for (unsigned int y = uiFirstLine; y < uiLastLine; ++y)
+    {
+        const unsigned char* pLine = pImage + static_cast<size_t>(y) * uiPitch;
+
+        // The key does not depend on y, a line has the same hash at any position.
+        memset(pAcc, 0, m_uiNumSuperBlocks[0] * 4 * sizeof(uint64_t));
+
+        m_pfnHashLine(pLine, m_uiWidth, uiSuperBlockWidth, 0, pAcc);
+
+        for (unsigned int sx = 0; sx < m_uiNumSuperBlocks[0]; ++sx)
+        {
+            m_LineHashes[sx * m_uiHeight + y] = finalizeHash(pAcc + sx * 4);
+        }
+
+        // Superblock rows are processed by one thread, the column hashes are accumulated line by line.
+        uint64_t* pColumnHashes = m_ColumnHashes.data() + (y / uiSuperBlockHeight) * m_uiWidth;
+
+        if ((y % uiSuperBlockHeight) == 0)
+        {
+            memset(pColumnHashes, 0, m_uiWidth * sizeof(uint64_t));
+        }
+
+        m_pfnHashColumns(pLine, m_uiWidth, y % uiSuperBlockHeight, pColumnHashes);
+    }
+}
+
+
+bool RFDiffMapHost::findShift(const uint64_t* pPrevious, const uint64_t* pCurrent, unsigned int uiSize, int& iShift)
+{
+    m_ChangedEntries.clear();
+    m_MoveSamples.clear();
+    m_Shifts.clear();
+
+    for (unsigned int i = 0; i < uiSize; ++i)
+    {
+        if (pCurrent[i] != pPrevious[i])
+        {
+            m_ChangedEntries.push_back(i);
+        }
+    }
+
+    if (m_ChangedEntries.empty())
+    {
+        return false;
+    }
+
+    // A scroll shifts all changed entries by the same amount. A sample of them is enough to find the shift.
+    const size_t uiNumSamples = std::min(m_ChangedEntries.size(), static_cast<size_t>(RF_DIFF_MOVE_SAMPLES));
+
+    for (size_t i = 0; i < uiNumSamples; ++i)
+    {
+        const unsigned int uiIndex = m_ChangedEntries[i * m_ChangedEntries.size() / uiNumSamples];
+
+        m_MoveSamples.push_back({ pCurrent[uiIndex], uiIndex, 0, 0 });
+    }
+
+    // Open addressing hash table that stores the index of a sample + 1. The column hashes are not finalized,
+    // the table index is taken from the upper bits which depend on all bits of the products.
+    unsigned char SampleTable[RF_DIFF_MOVE_TABLE_SIZE] = {};
+
+    for (size_t i = 0; i < m_MoveSamples.size(); ++i)
+    {
+        unsigned int uiSlot = getSampleSlot(m_MoveSamples[i].uiHash);
+
+        while (SampleTable[uiSlot])
+        {
+            uiSlot = (uiSlot + 1) & (RF_DIFF_MOVE_TABLE_SIZE - 1);
+        }
+
+        SampleTable[uiSlot] = static_cast<unsigned char>(i + 1);
+    }
+
+    // Count how often each sample appears in pPrevious.
+    for (unsigned int i = 0; i < uiSize; ++i)
+    {
+        for (unsigned int uiSlot = getSampleSlot(pPrevious[i]); SampleTable[uiSlot]; uiSlot = (uiSlot + 1) & (RF_DIFF_MOVE_TABLE_SIZE - 1))
+        {
+            MoveSample& Sample = m_MoveSamples[SampleTable[uiSlot] - 1];
+
+            if (Sample.uiHash == pPrevious[i])
+            {
+                ++Sample.uiNumMatches;
+                Sample.uiMatch = i;
+            }
+        }
+    }
+
+    // Lines that appear more than once like empty lines do not indicate a shift.
+    for (const MoveSample& Sample : m_MoveSamples)
+    {
+        if (Sample.uiNumMatches == 1)
+        {
+            m_Shifts.push_back(static_cast<int>(Sample.uiMatch) - static_cast<int>(Sample.uiIndex));
+        }
+    }
+
+    if (m_Shifts.empty())
+    {
+        return false;
+    }
+
+    std::sort(m_Shifts.begin(), m_Shifts.end());
+
+    unsigned int uiBestCount = 0;
+
+    for (size_t i = 0; i < m_Shifts.size();)
+    {
+        size_t j = i + 1;
+
+        while (j < m_Shifts.size() && m_Shifts[j] == m_Shifts[i])
+        {
+            ++j;
+        }
+
+        if (j - i > uiBestCount)
+        {
+            uiBestCount = static_cast<unsigned int>(j - i);
+            iShift      = m_Shifts[i];
+        }
+
+        i = j;
+    }
+
+    return true;
+}
+
+
+unsigned int RFDiffMapHost::detectMoves(unsigned char* pByteMap, unsigned char* pBitMap, unsigned char* pSuperBlockMap, unsigned int uiNumChangedBlocks)
+{
+    m_MoveRects.clear();
+
+    if (!m_bMoveHashesValid || uiNumChangedBlocks == 0)
+    {
+        return uiNumChangedBlocks;
+    }
+
+    m_MoveCandidates.clear();
+
+    const unsigned int uiSuperBlockSize[2] = { m_uiSuperBlockSize[0] * m_uiBlockSize[0], m_uiSuperBlockSize[1] * m_uiBlockSize[1] };
+    const unsigned int uiImageSize[2]      = { m_uiWidth, m_uiHeight };
+
+    // Candidates of the previous and the current strip that can be extended by the next strip.
+    std::vector<size_t> PrevStrip;
+    std::vector<size_t> CurrentStrip;
+
+    // Vertical moves are searched in the lines of each superblock column (d = 1), horizontal moves in the columns
+    // of each superblock row (d = 0). A run is merged with a run of the previous strip if it has the same shift.
+    for (unsigned int d = 0; d < 2; ++d)
+    {
+        const std::vector<uint64_t>& Current  = (d == 1) ? m_LineHashes : m_ColumnHashes;
+        const std::vector<uint64_t>& Previous = (d == 1) ? m_PrevLineHashes : m_PrevColumnHashes;
+
+        const unsigned int uiSize = uiImageSize[d];
+
+        PrevStrip.clear();
+
+        for (unsigned int uiStrip = 0; uiStrip < m_uiNumSuperBlocks[1 - d]; ++uiStrip)
+        {
+            const uint64_t* pCurrent  = Current.data() + uiStrip * uiSize;
+            const uint64_t* pPrevious = Previous.data() + uiStrip * uiSize;
+
+            const unsigned int uiStripPos  = uiStrip * uiSuperBlockSize[1 - d];
+            const unsigned int uiStripSize = std::min(uiSuperBlockSize[1 - d], uiImageSize[1 - d] - uiStripPos);
+
+            CurrentStrip.clear();
+
+            int iShift = 0;
+
+            if (findShift(pPrevious, pCurrent, uiSize, iShift))
+            {
+                const unsigned int uiLast = static_cast<unsigned int>(std::min(static_cast<int>(uiSize), static_cast<int>(uiSize) - iShift));
+
+                unsigned int i = static_cast<unsigned int>(std::max(0, -iShift));
+
+                while (i < uiLast)
+                {
+                    if (pCurrent[i] != pPrevious[i + iShift])
+                    {
+                        ++i;
+                        continue;
+                    }
+
+                    const unsigned int uiStart  = i;
+                    bool               bChanged = false;
+
+                    for (; i < uiLast && pCurrent[i] == pPrevious[i + iShift]; ++i)
+                    {
+                        bChanged |= (pCurrent[i] != pPrevious[i]);
+                    }
+
+                    // Runs that did not change at all are no move.
+                    if (!bChanged)
+                    {
+                        continue;
+                    }
+
+                    RFDiffMoveRect Move;
+
+                    setMoveRange(Move, d, uiStart + iShift, uiStart, i - uiStart);
+                    setMoveRange(Move, 1 - d, uiStripPos, uiStripPos, uiStripSize);
+
+                    size_t uiCandidate = m_MoveCandidates.size();
+
+                    for (size_t c : PrevStrip)
+                    {
+                        RFDiffMoveRect& Prev = m_MoveCandidates[c];
+
+                        if (getMoveSrc(Prev, d) == getMoveSrc(Move, d) && getMoveDst(Prev, d) == getMoveDst(Move, d) &&
+                            getMoveSize(Prev, d) == getMoveSize(Move, d))
+                        {
+                            setMoveRange(Prev, 1 - d, getMoveDst(Prev, 1 - d), getMoveDst(Prev, 1 - d), getMoveSize(Prev, 1 - d) + uiStripSize);
+
+                            uiCandidate = c;
+                            break;
+                        }
+                    }
+
+                    if (uiCandidate == m_MoveCandidates.size())
+                    {
+                        m_MoveCandidates.push_back(Move);
+                    }
+
+                    CurrentStrip.push_back(uiCandidate);
+                }
+            }
+
+            PrevStrip.swap(CurrentStrip);
+        }
+    }
+
+    // Larger moves save more blocks. A move is only used if it does not conflict with a larger one and
+    // covers at least one changed block.
+    std::stable_sort(m_MoveCandidates.begin(), m_MoveCandidates.end(), [](const RFDiffMoveRect& m1, const RFDiffMoveRect& m2)
+    {
+        return (m1.uiWidth * m1.uiHeight > m2.uiWidth * m2.uiHeight);
+    });
+
+    unsigned int uiNumCovered = 0;
+
+    for (const RFDiffMoveRect& Move : m_MoveCandidates)
+    {
+        if (m_MoveRects.size() == RF_DIFF_MAX_MOVE_RECTS)
+        {
+            break;
+        }
+
+        bool bConflict = false;
+
+        for (const RFDiffMoveRect& Accepted : m_MoveRects)
+        {
+            bConflict |= isConflicting(Move, Accepted);
+        }
+
+        if (bConflict)
+        {
+            continue;
+        }
+
+        unsigned int uiFirst[2];
+        unsigned int uiLast[2];
+
+        getCoveredBlocks(Move.uiDstX, Move.uiDstX + Move.uiWidth, m_uiBlockSize[0], m_uiWidth, uiFirst[0], uiLast[0]);
+        getCoveredBlocks(Move.uiDstY, Move.uiDstY + Move.uiHeight, m_uiBlockSize[1], m_uiHeight, uiFirst[1], uiLast[1]);
+
+        unsigned int uiCovered = 0;
+
+        for (unsigned int by = uiFirst[1]; by < uiLast[1]; ++by)
+        {
+            for (unsigned int bx = uiFirst[0]; bx < uiLast[0]; ++bx)
+            {
+                uiCovered += pByteMap[by * m_uiNumBlocks[0] + bx];
+
+                pByteMap[by * m_uiNumBlocks[0] + bx] = 0;
+            }
+        }
+
+        if (uiCovered > 0)
+        {
+            m_MoveRects.push_back(Move);
+
+            uiNumCovered += uiCovered;
+        }
+    }
+
+    if (uiNumCovered == 0)
+    {
+        return uiNumChangedBlocks;
+    }
+
+    // Rebuild the superblock map and the bit map from the byte map.
+    memset(pSuperBlockMap, 0, m_uiNumSuperBlocks[0] * m_uiNumSuperBlocks[1]);
+
+    const unsigned int uiBitMapPitch = getBitMapPitch(m_uiNumBlocks[0]);
+
+    for (unsigned int by = 0; by < m_uiNumBlocks[1]; ++by)
+    {
+        const unsigned char* pMapRow = pByteMap + by * m_uiNumBlocks[0];
+
+        for (unsigned int bx = 0; bx < m_uiNumBlocks[0]; ++bx)
+        {
+            if (pMapRow[bx])
+            {
+                pSuperBlockMap[(by / m_uiSuperBlockSize[1]) * m_uiNumSuperBlocks[0] + bx / m_uiSuperBlockSize[0]] = 1;
+            }
+        }
+
+        if (pBitMap)
+        {
+            packBits(pMapRow, m_uiNumBlocks[0], pBitMap + by * uiBitMapPitch, uiBitMapPitch);
+        }
+    }
+
+    return uiNumChangedBlocks - uiNumCovered;
+}
+
+
+unsigned int RFDiffMapHost::compute(const unsigned char* pImage1, const unsigned char* pImage2, unsigned int uiPitch, unsigned char* pDiffMap,
+                                    unsigned int uiFrame, unsigned int uiAcknowledgedFrame)
+{
+    m_uiFrame             = uiFrame;
+    m_uiAcknowledgedFrame = uiAcknowledgedFrame;
+
+    unsigned char* pSuperBlockMap = pDiffMap + sizeof(RFDiffMapHeader);
+    unsigned char* pMap           = pDiffMap + m_uiMapOffset;
+
+    // Blocks are always compared into a byte map. For the other formats each row is packed into bits while it is
+    // still in the cache. The run length map and the rectangle list are created from the bit map afterwards.
+    unsigned char* pByteMap = (m_Format == RF_DIFF_MAP_BYTE) ? pMap : m_ByteMap.data();
+    unsigned char* pBitMap  = nullptr;
+
+    if (m_Format == RF_DIFF_MAP_BIT)
+    {
+        pBitMap = pMap;
+    }
+    else if (m_Format == RF_DIFF_MAP_RLE || m_Format == RF_DIFF_MAP_RECT)
+    {
+        pBitMap = m_BitMap.data();
+    }
+
+    // Stripes start at a superblock row. This way each superblock is only written by one thread.
+    const unsigned int uiNumThreads         = (m_pThreadPool) ? m_pThreadPool->getNumThreads() : 1;
+    const unsigned int uiMaxStripes         = std::min(m_uiNumSuperBlocks[1], uiNumThreads * RF_DIFF_HOST_STRIPES_PER_THREAD);
+    const unsigned int uiSuperRowsPerStripe = (m_uiNumSuperBlocks[1] + uiMaxStripes - 1) / uiMaxStripes;
+    const unsigned int uiRowsPerStripe      = uiSuperRowsPerStripe * m_uiSuperBlockSize[1];
+    const unsigned int uiNumStripes         = (m_uiNumBlocks[1] + uiRowsPerStripe - 1) / uiRowsPerStripe;
+
+    unsigned int uiNumChangedBlocks = 0;
+
+    if (uiNumStripes <= 1 || !m_pThreadPool)
+    {
+        uiNumChangedBlocks = computeBlockRows(pImage1, pImage2, uiPitch, pByteMap, pBitMap, pSuperBlockMap, 0, m_uiNumBlocks[1]);
+    }
+    else
+    {
+        std::atomic<unsigned int> uiNumChanged(0);
+
+        m_pThreadPool->run(uiNumStripes, [&](unsigned int uiStripe)
+        {
+            const unsigned int uiFirstRow = uiStripe * uiRowsPerStripe;
+            const unsigned int uiLastRow  = std::min(uiFirstRow + uiRowsPerStripe, m_uiNumBlocks[1]);
+
+            if (uiFirstRow < uiLastRow)
+            {
+                uiNumChanged += computeBlockRows(pImage1, pImage2, uiPitch, pByteMap, pBitMap, pSuperBlockMap, uiFirstRow, uiLastRow);
+            }
+        });
+
+        uiNumChangedBlocks = uiNumChanged;
+    }
+
+    // The hashes of this call are the reference of the next one.
+    m_bHashesValid      = m_bCompareHashes;
+    m_bBlockFramesValid = m_bKeepBlockFrames;
+
+    if (m_bDetectMoves)
+    {
+        uiNumChangedBlocks = detectMoves(pByteMap, pBitMap, pSuperBlockMap, uiNumChangedBlocks);
+
+        m_LineHashes.swap(m_PrevLineHashes);
+        m_ColumnHashes.swap(m_PrevColumnHashes);
+
+        m_bMoveHashesValid = true;
+    }
+
+    unsigned int uiMapSize = getMaxMapSize();
+
+    // Nothing needs to be encoded if the frame did not change.
+    if (m_Format == RF_DIFF_MAP_RLE)
+    {
+        if (uiNumChangedBlocks > 0)
+        {
+            uiMapSize = encodeRunLength(pBitMap, m_uiNumBlocks[0], m_uiNumBlocks[1], pMap);
+        }
+        else
+        {
+            uiMapSize = 2 * m_uiNumBlocks[1];
+            memset(pMap, 0, uiMapSize);
+        }
+    }
+    else if (m_Format == RF_DIFF_MAP_RECT)
+    {
+        uiMapSize = 0;
+
+        if (uiNumChangedBlocks > 0)
+        {
+            uiMapSize = encodeRects(pBitMap, m_uiNumBlocks[0], m_uiNumBlocks[1], m_uiBlockSize[0], m_uiBlockSize[1], m_uiWidth, m_uiHeight,
+                                    reinterpret_cast<RFDiffRect*>(pMap));
+        }
+    }
+
+    RFDiffMapHeader Header;
+
+    getHeader(Header);
+
+    Header.uiNumChangedBlocks = uiNumChangedBlocks;
+    Header.uiMapSize          = uiMapSize;
+    Header.uiVersion          = m_uiFrame;
+
+    unsigned int uiSize = m_uiMapOffset + uiMapSize;
+
+    if (m_bDetectMoves)
+    {
+        Header.uiNumMoveRects   = static_cast<unsigned int>(m_MoveRects.size());
+        Header.uiMoveRectOffset = ((uiSize + 3) / 4) * 4;
+
+        memset(pDiffMap + uiSize, 0, Header.uiMoveRectOffset - uiSize);
+
+        if (!m_MoveRects.empty())
+        {
+            memcpy(pDiffMap + Header.uiMoveRectOffset, m_MoveRects.data(), m_MoveRects.size() * sizeof(RFDiffMoveRect));
+        }
+
+        uiSize = Header.uiMoveRectOffset + Header.uiNumMoveRects * sizeof(RFDiffMoveRect);
+    }
+
+    if (m_bAppendTiles)
+    {
+        Header.uiNumTiles   = uiNumChangedBlocks;
+        Header.uiTileOffset = ((uiSize + 3) / 4) * 4;
+
+        memset(pDiffMap + uiSize, 0, Header.uiTileOffset - uiSize);
+
+        if (uiNumChangedBlocks > 0)
+        {
+            gatherTiles(pImage1, uiPitch, pByteMap, uiNumChangedBlocks, pDiffMap + Header.uiTileOffset);
+        }
+
+        uiSize = Header.uiTileOffset + Header.uiNumTiles * (sizeof(RFDiffTile) + m_uiBlockSize[0] * m_uiBlockSize[1] * 4);
+    }
+
+    memcpy(pDiffMap, &Header, sizeof(Header));
+
+    return uiSize;
+}
+
+
+void RFDiffMapHost::getHeader(RFDiffMapHeader& Header) const
+{
+    Header.uiNumChangedBlocks    = 0;
+    Header.uiNumSuperBlocksX     = m_uiNumSuperBlocks[0];
+    Header.uiNumSuperBlocksY     = m_uiNumSuperBlocks[1];
+    Header.uiSuperBlockWidth     = m_uiSuperBlockSize[0] * m_uiBlockSize[0];
+    Header.uiSuperBlockHeight    = m_uiSuperBlockSize[1] * m_uiBlockSize[1];
+    Header.uiSuperBlockMapOffset = sizeof(RFDiffMapHeader);
+    Header.uiMapOffset           = m_uiMapOffset;
+    Header.uiMapSize             = getMaxMapSize();
+    Header.uiNumMoveRects        = 0;
+    Header.uiMoveRectOffset      = 0;
+    Header.uiNumTiles            = 0;
+    Header.uiTileOffset          = 0;
+    Header.uiVersion             = 0;
+}
+
+
+void RFDiffMapHost::gatherTiles(const unsigned char* pImage, unsigned int uiPitch, const unsigned char* pByteMap, unsigned int uiNumTiles,
+                                unsigned char* pTiles)
+{
+    RFDiffTile*    pTileList = reinterpret_cast<RFDiffTile*>(pTiles);
+    unsigned char* pTileData = pTiles + uiNumTiles * sizeof(RFDiffTile);
+
+    const unsigned int uiTilePitch = m_uiBlockSize[0] * 4;
+    const unsigned int uiTileSize  = uiTilePitch * m_uiBlockSize[1];
+
+    // The tiles are stored in the order of the blocks. Counting the tiles of each block row first allows
+    // to copy the rows in parallel.
+    m_FirstTile[0] = 0;
+
+    for (unsigned int by = 0; by < m_uiNumBlocks[1]; ++by)
+    {
+        const unsigned char* pMapRow = pByteMap + by * m_uiNumBlocks[0];
+
+        m_FirstTile[by + 1] = m_FirstTile[by] + static_cast<unsigned int>(std::count(pMapRow, pMapRow + m_uiNumBlocks[0], 1));
+    }
+
+    auto gatherRow = [&](unsigned int by)
+    {
+        const unsigned char* pMapRow     = pByteMap + by * m_uiNumBlocks[0];
+        const unsigned int   uiFirstLine = by * m_uiBlockSize[1];
+        const unsigned int   uiNumLines  = std::min(m_uiBlockSize[1], m_uiHeight - uiFirstLine);
+
+        if (m_FirstTile[by] == m_FirstTile[by + 1])
+        {
+            return;
+        }
+
+        unsigned int uiTile = m_FirstTile[by];
+
+        for (unsigned int bx = 0; bx < m_uiNumBlocks[0]; ++bx)
+        {
+            if (pMapRow[bx])
+            {
+                pTileList[uiTile].uiX = bx * m_uiBlockSize[0];
+                pTileList[uiTile].uiY = uiFirstLine;
+
+                // Lines below the image are 0.
+                if (uiNumLines < m_uiBlockSize[1])
+                {
+                    memset(pTileData + static_cast<size_t>(uiTile) * uiTileSize + uiNumLines * uiTilePitch, 0, (m_uiBlockSize[1] - uiNumLines) * uiTilePitch);
+                }
+
+                ++uiTile;
+            }
+        }
+
+        // Copy line by line to read the image sequentially.
+        for (unsigned int y = 0; y < uiNumLines; ++y)
+        {
+            const unsigned char* pLine = pImage + static_cast<size_t>(uiFirstLine + y) * uiPitch;
+
+            for (uiTile = m_FirstTile[by]; uiTile < m_FirstTile[by + 1]; ++uiTile)
+            {
+                const unsigned int x      = pTileList[uiTile].uiX;
+                const unsigned int uiSize = std::min(m_uiBlockSize[0], m_uiWidth - x) * 4;
+
+                unsigned char* pDst = pTileData + static_cast<size_t>(uiTile) * uiTileSize + y * uiTilePitch;
+
+                memcpy(pDst, pLine + x * 4, uiSize);
+
+                // Pixels right of the image are 0.
+                if (uiSize < uiTilePitch)
+                {
+                    memset(pDst + uiSize, 0, uiTilePitch - uiSize);
+                }
+            }
+        }
+    };
+
+    if (m_pThreadPool)
+    {
+        m_pThreadPool->run(m_uiNumBlocks[1], gatherRow);
+    }
+    else
+    {
+        for (unsigned int by = 0; by < m_uiNumBlocks[1]; ++by)
+        {
+            gatherRow(by);
+        }
+    }
+}
+
+
+unsigned int RFDiffMapHost::computeBlockRows(const unsigned char* pImage1, const unsigned char* pImage2, unsigned int uiPitch, unsigned char* pByteMap,
+                                             unsigned char* pBitMap, unsigned char* pSuperBlockMap, unsigned int uiFirstRow, unsigned int uiLastRow)
+{
+    const unsigned int uiBitMapPitch = getBitMapPitch(m_uiNumBlocks[0]);
+
+    // Accumulators of the hashes of one block row and of the line hashes of one line.
+    std::vector<uint64_t> Acc;
+    std::vector<uint64_t> LineAcc;
+
+    // Number of changed pixels and sum of their differences of each block of a row.
+    std::vector<unsigned int> BlockDiff;
+
+    if (m_bCompareHashes)
+    {
+        Acc.resize(m_uiNumBlocks[0] * 4);
+    }
+    else if (m_bApplyThresholds)
+    {
+        BlockDiff.resize(m_uiNumBlocks[0] * 2);
+    }
+
+    if (m_bDetectMoves)
+    {
+        LineAcc.resize(m_uiNumSuperBlocks[0] * 4);
+    }
+
+    unsigned int uiNumChangedBlocks = 0;
+
+    for (unsigned int by = uiFirstRow; by < uiLastRow; ++by)
+    {
+        unsigned char* pMapRow        = pByteMap + by * m_uiNumBlocks[0];
+        unsigned char* pSuperBlockRow = pSuperBlockMap + (by / m_uiSuperBlockSize[1]) * m_uiNumSuperBlocks[0];
+
+        if ((by % m_uiSuperBlockSize[1]) == 0)
+        {
+            memset(pSuperBlockRow, 0, m_uiNumSuperBlocks[0]);
+        }
+
+        unsigned int uiNumChanged = 0;
+
+        if (m_bCompareHashes)
+        {
+            uiNumChanged = hashBlockRow(pImage1, uiPitch, by, pMapRow, Acc.data());
+        }
+        else if (m_bApplyThresholds)
+        {
+            uiNumChanged = compareBlockRowThreshold(pImage1, pImage2, uiPitch, by, pMapRow, BlockDiff.data());
+        }
+        else
+        {
+            uiNumChanged = compareBlockRow(pImage1, pImage2, uiPitch, by, pMapRow);
+        }
+
+        if (m_bDetectMoves)
+        {
+            hashMoveLines(pImage1, uiPitch, by, LineAcc.data());
+        }
+
+        if (m_bKeepBlockFrames)
+        {
+            uiNumChanged = accumulateBlockRow(by, pMapRow);
+        }
+
+        if (uiNumChanged > 0)
+        {
+            for (unsigned int bx = 0; bx < m_uiNumBlocks[0]; ++bx)
+            {
+                if (pMapRow[bx])
+                {
+                    pSuperBlockRow[bx / m_uiSuperBlockSize[0]] = 1;
+                }
+            }
+
+            uiNumChangedBlocks += uiNumChanged;
+        }
+
+        if (pBitMap)
+        {
+            packBits(pMapRow, m_uiNumBlocks[0], pBitMap + by * uiBitMapPitch, uiBitMapPitch);
+        }
+    }
+
+    return uiNumChangedBlocks;
+}
+
+
+unsigned int RFDiffMapHost::compareBlockRow(const unsigned char* pImage1, const unsigned char* pImage2, unsigned int uiPitch, unsigned int by,
+                                            unsigned char* pMapRow) const
+{
+    memset(pMapRow, 0, m_uiNumBlocks[0]);
+
+    const unsigned int uiFirstLine = by * m_uiBlockSize[1];
+    const unsigned int uiLastLine  = std::min(uiFirstLine + m_uiBlockSize[1], m_uiHeight);
+
+    unsigned int uiNumChanged = 0;
+
+    // Walk the lines of the block row and compare the segments of all blocks that did not change so far.
+    // A block is skipped as soon as one difference is found.
+    for (unsigned int y = uiFirstLine; y < uiLastLine && uiNumChanged < m_uiNumBlocks[0]; ++y)
+    {
+        const unsigned char* pLine1 = pImage1 + static_cast<size_t>(y) * uiPitch;
+        const unsigned char* pLine2 = pImage2 + static_cast<size_t>(y) * uiPitch;
+
+        unsigned int bx = 0;
+
+        while (bx < m_uiNumBlocks[0])
+        {
+            if (pMapRow[bx])
+            {
+                ++bx;
+                continue;
+            }
+
+            // Compare a run of unchanged blocks at once. Most lines of a desktop are identical and
+            // only need to be checked block by block if the run differs.
+            unsigned int uiRunEnd = bx + 1;
+
+            while (uiRunEnd < m_uiNumBlocks[0] && !pMapRow[uiRunEnd])
+            {
+                ++uiRunEnd;
+            }
+
+            const unsigned int uiRunStart = bx * m_uiBlockSize[0];
+            const unsigned int uiRunSize  = std::min(uiRunEnd * m_uiBlockSize[0], m_uiWidth) - uiRunStart;
+
+            if (m_pfnIsDifferent(pLine1 + uiRunStart * 4, pLine2 + uiRunStart * 4, uiRunSize * 4))
+            {
+                for (; bx < uiRunEnd; ++bx)
+                {
+                    const unsigned int x      = bx * m_uiBlockSize[0];
+                    const unsigned int uiSize = std::min(m_uiBlockSize[0], m_uiWidth - x) * 4;
+
+                    if (m_pfnIsDifferent(pLine1 + x * 4, pLine2 + x * 4, uiSize))
+                    {
+                        pMapRow[bx] = 1;
+                        ++uiNumChanged;
+                    }
+                }
+            }
+
+            bx = uiRunEnd;
+        }
+    }
+
+    return uiNumChanged;
+}
+
+
+unsigned int RFDiffMapHost::compareBlockRowThreshold(const unsigned char* pImage1, const unsigned char* pImage2, unsigned int uiPitch, unsigned int by,
+                                                     unsigned char* pMapRow, unsigned int* pBlockDiff) const
+{
+    memset(pMapRow, 0, m_uiNumBlocks[0]);
+    memset(pBlockDiff, 0, m_uiNumBlocks[0] * 2 * sizeof(unsigned int));
+
+    const unsigned int uiFirstLine = by * m_uiBlockSize[1];
+    const unsigned int uiLastLine  = std::min(uiFirstLine + m_uiBlockSize[1], m_uiHeight);
+
+    unsigned int uiNumChanged = 0;
+
+    // The differences are only computed for segments that are not identical. A block is skipped once it
+    // exceeds the thresholds.
+    for (unsigned int y = uiFirstLine; y < uiLastLine && uiNumChanged < m_uiNumBlocks[0]; ++y)
+    {
+        const unsigned char* pLine1 = pImage1 + static_cast<size_t>(y) * uiPitch;
+        const unsigned char* pLine2 = pImage2 + static_cast<size_t>(y) * uiPitch;
+
+        for (unsigned int bx = 0; bx < m_uiNumBlocks[0]; ++bx)
+        {
+            const unsigned int x           = bx * m_uiBlockSize[0];
+            const unsigned int uiNumPixels = std::min(m_uiBlockSize[0], m_uiWidth - x);
+
+            if (pMapRow[bx] || !m_pfnIsDifferent(pLine1 + x * 4, pLine2 + x * 4, uiNumPixels * 4))
+            {
+                continue;
+            }
+
+            unsigned int* pDiff = pBlockDiff + bx * 2;
+
+            pDiff[1] += m_pfnGetPixelDifference(pLine1 + x * 4, pLine2 + x * 4, uiNumPixels, m_uiPixelThreshold, pDiff[0]);
+
+            if (pDiff[0] >= m_uiMinChangedPixels && pDiff[1] > m_uiBlockThreshold)
+            {
+                pMapRow[bx] = 1;
+                ++uiNumChanged;
+            }
+        }
+    }
+
+    return uiNumChanged;
+}
+
+
+unsigned int RFDiffMapHost::hashBlockRow(const unsigned char* pImage, unsigned int uiPitch, unsigned int by, unsigned char* pMapRow, uint64_t* pAcc)
+{
+    memset(pAcc, 0, m_uiNumBlocks[0] * 4 * sizeof(uint64_t));
+
+    const unsigned int uiFirstLine = by * m_uiBlockSize[1];
+    const unsigned int uiLastLine  = std::min(uiFirstLine + m_uiBlockSize[1], m_uiHeight);
+
+    // Each line is read once and hashed into the accumulators of all blocks of the row.
+    for (unsigned int y = uiFirstLine; y < uiLastLine; ++y)
+    {
+        m_pfnHashLine(pImage + static_cast<size_t>(y) * uiPitch, m_uiWidth, m_uiBlockSize[0], y - uiFirstLine, pAcc);
+    }
+
+    uint64_t* pHashRow = m_BlockHashes.data() + by * m_uiNumBlocks[0];
+
+    unsigned int uiNumChanged = 0;
+
+    for (unsigned int bx = 0; bx < m_uiNumBlocks[0]; ++bx)
+    {
+        const uint64_t uiHash = finalizeHash(pAcc + bx * 4);
+
+        pMapRow[bx] = (!m_bHashesValid || uiHash != pHashRow[bx]) ? 1 : 0;
+        pHashRow[bx] = uiHash;
+
+        uiNumChanged += pMapRow[bx];
+    }
+
+    return uiNumChanged;
+}
+
+
+unsigned int RFDiffMapHost::accumulateBlockRow(unsigned int by, unsigned char* pMapRow)
+{
+    unsigned int* pFrames = m_BlockFrames.data() + by * m_uiNumBlocks[0];
+
+    unsigned int uiNumMarked = 0;
+
+    for (unsigned int bx = 0; bx < m_uiNumBlocks[0]; ++bx)
+    {
+        // Without valid frames the consumer has not received any frame yet.
+        if (pMapRow[bx] || !m_bBlockFramesValid)
+        {
+            pFrames[bx] = m_uiFrame;
+            pMapRow[bx] = 1;
+        }
+        else if (pFrames[bx] > m_uiAcknowledgedFrame)
+        {
+            pMapRow[bx] = 1;
+        }
+
+        uiNumMarked += pMapRow[bx];
+    }
+
+    return uiNumMarked;
+}
@@ -0,0 +1,266 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "RapidFire.h"
+#include "RFThreadPool.h"
+
+// Maximum number of threads used by RFDiffMapHost.
+#define RF_DIFF_HOST_MAX_THREADS    4
+
+// Minimum size of a superblock in pixels. Superblocks are a multiple of the block size.
+#define RF_DIFF_SUPERBLOCK_SIZE     64
+
+// Maximum number of RFDiffMoveRect returned per frame.
+#define RF_DIFF_MAX_MOVE_RECTS      16
+
+// RFDiffMapHost computes the diff map of two images in system memory on the CPU. The output is identical
+// to the output of the DiffMap_Buffer kernel in rfDiffMapKernel.cl: a block is marked as changed if any pixel
+// of the block differs. With thresholds the output matches the DiffMap_ThresholdBuffer kernel instead. The images are split into stripes of block rows that are processed in parallel.
+// The output starts with a RFDiffMapHeader and the superblock map, the diff map follows at getMapOffset.
+// If hashes are compared, a 64 bit hash of each block is compared with the hash of the previous call instead
+// and the previous image is not needed. The hash is the same as the one of the DiffMap_Hash kernels.
+// If moves are detected, each line of a superblock column and each column of a superblock row is hashed as well.
+// Lines or columns of the current image that match a shifted line or column of the previous call are reported as
+// RFDiffMoveRect and the blocks they cover are not marked as changed.
+// If tiles are appended, the pixels of each changed block of the current image are copied behind the map.
+// If block frames are kept, the frame in which each block changed last is stored as the version of the block. The blocks
+// that changed after the acknowledged frame are marked as well. The output matches the DiffMap_Accumulate kernel.
+class RFDiffMapHost
+{
+public:
+
+    RFDiffMapHost();
+    ~RFDiffMapHost();
+
+    // Sets the dimension of the images in pixels, the block size and the layout of the diff map. If bCompareHashes
+    // is set, blocks are compared by their hash and all blocks are reported as changed by the next call to compute.
+    // If bDetectMoves is set, the next call to compute reports no moves. If bAppendTiles is set, a RFDiffTile and the
+    // pixels of each changed block follow the map.
+    bool            init(unsigned int uiWidth, unsigned int uiHeight, unsigned int uiBlockWidth, unsigned int uiBlockHeight, RFDiffMapFormat format,
+                         bool bCompareHashes = false, bool bDetectMoves = false, bool bAppendTiles = false);
+
+    // Sets the thresholds used if the images are compared. A pixel has changed if the sum of the absolute differences of
+    // its 4 channels is larger than uiPixelThreshold. A block has changed if at least uiMinChangedPixels pixels changed and
+    // the sum of their differences is larger than uiBlockThreshold. With 0, 0 and 1 any difference marks a block.
+    void            setThresholds(unsigned int uiPixelThreshold, unsigned int uiBlockThreshold, unsigned int uiMinChangedPixels);
+
+    // If bKeepFrames is set, the frame passed to compute is stored for each changed block and compute also marks the blocks
+    // that changed after uiAcknowledgedFrame. All blocks are marked by the next call to compute. Moves are not reported
+    // correctly if blocks are marked this way.
+    void            setBlockFrames(bool bKeepFrames);
+
+    // Returns the frame in which each block changed last or NULL if no frame was computed since init.
+    const unsigned int* getBlockFrames() const { return (m_bBlockFramesValid) ? m_BlockFrames.data() : nullptr; }
+
+    // Compares two images with 4 bytes per pixel and uiPitch bytes per row. If hashes are compared, pImage1 is compared
+    // with the image of the previous call and pImage2 is not used. pDiffMap needs to store getMaxDiffMapSize() bytes.
+    // uiFrame and uiAcknowledgedFrame are only used if block frames are kept. uiFrame needs to increase with each call. If
+    // uiAcknowledgedFrame is UINT_MAX, only the frames are updated.
+    // Returns the number of bytes written to pDiffMap including the header.
+    unsigned int    compute(const unsigned char* pImage1, const unsigned char* pImage2, unsigned int uiPitch, unsigned char* pDiffMap,
+                            unsigned int uiFrame = 0, unsigned int uiAcknowledgedFrame = 0);
+
+    // Returns the maximum size in bytes of the output of compute.
+    unsigned int    getMaxDiffMapSize() const;
+
+    // Returns the header for the dimensions passed to init. The number of changed blocks is 0 and the map
+    // size is the maximum size.
+    void            getHeader(RFDiffMapHeader& Header) const;
+
+    unsigned int    getMapOffset() const { return m_uiMapOffset; }
+
+    unsigned int    getNumBlocksX() const { return m_uiNumBlocks[0]; }
+
+    unsigned int    getNumBlocksY() const { return m_uiNumBlocks[1]; }
+
+    // Sets the uiNumBlocks bytes of pBlockMap to 1 if the block changed after uiFrame according to pBlockFrames and to 0
+    // otherwise. If pBlockFrames is NULL, all blocks are marked. Returns the number of marked blocks.
+    static unsigned int getChangedBlocks(const unsigned int* pBlockFrames, unsigned int uiNumBlocks, unsigned int uiFrame, unsigned char* pBlockMap);
+
+    // Returns the size in pixels of a superblock for the block size uiBlockSize.
+    static unsigned int getSuperBlockSize(unsigned int uiBlockSize);
+
+    // Returns the offset of the diff map behind the header and a superblock map of the given dimension.
+    static unsigned int getMapOffset(unsigned int uiNumSuperBlocksX, unsigned int uiNumSuperBlocksY);
+
+    // Returns the number of bytes of one row of a RF_DIFF_MAP_BIT map.
+    static unsigned int getBitMapPitch(unsigned int uiNumBlocksX);
+
+    // Returns the maximum size in bytes of a RF_DIFF_MAP_RLE map.
+    static unsigned int getMaxRunLengthSize(unsigned int uiNumBlocksX, unsigned int uiNumBlocksY);
+
+    // Converts a RF_DIFF_MAP_BIT map into a RF_DIFF_MAP_RLE map. The padding bits of the bit map need to be 0.
+    // Returns the number of bytes written to pRunLengthMap.
+    static unsigned int encodeRunLength(const unsigned char* pBitMap, unsigned int uiNumBlocksX, unsigned int uiNumBlocksY, unsigned char* pRunLengthMap);
+
+    // Returns the maximum size in bytes of a RF_DIFF_MAP_RECT map.
+    static unsigned int getMaxRectListSize(unsigned int uiNumBlocksX, unsigned int uiNumBlocksY);
+
+    // Converts a RF_DIFF_MAP_BIT map into a list of rectangles in pixels with a single pass over the rows. Changed blocks
+    // of a row are joined into spans which either extend a rectangle of the previous row or start a new one. The
+    // rectangles do not overlap.
+    // Returns the number of bytes written to pRects.
+    static unsigned int encodeRects(const unsigned char* pBitMap, unsigned int uiNumBlocksX, unsigned int uiNumBlocksY, unsigned int uiBlockWidth,
+                                    unsigned int uiBlockHeight, unsigned int uiWidth, unsigned int uiHeight, RFDiffRect* pRects);
+
+private:
+
+    // Returns true if the uiSize bytes at p1 and p2 differ.
+    typedef bool (*RF_IS_DIFFERENT_FUNC)(const unsigned char* p1, const unsigned char* p2, unsigned int uiSize);
+
+    // Returns the sum of the differences of the uiNumPixels pixels of p1 and p2 that differ by more than uiPixelThreshold
+    // and adds their number to uiNumChanged.
+    typedef unsigned int (*RF_PIXEL_DIFFERENCE_FUNC)(const unsigned char* p1, const unsigned char* p2, unsigned int uiNumPixels, unsigned int uiPixelThreshold,
+                                                     unsigned int& uiNumChanged);
+
+    // Adds line uiLine of a block row with uiWidth pixels to the 4 accumulators per block of pAcc.
+    typedef void (*RF_HASH_LINE_FUNC)(const unsigned char* pLine, unsigned int uiWidth, unsigned int uiBlockWidth, unsigned int uiLine, uint64_t* pAcc);
+
+    // Adds line uiLine of a superblock row with uiWidth pixels to the hash of each column.
+    typedef void (*RF_HASH_COLUMNS_FUNC)(const unsigned char* pLine, unsigned int uiWidth, unsigned int uiLine, uint64_t* pColumnHashes);
+
+    // Returns the maximum size in bytes of the map behind the superblock map.
+    unsigned int    getMaxMapSize() const;
+
+    // Computes the block rows [uiFirstRow, uiLastRow) of the byte map pByteMap and the superblocks they cover. uiFirstRow
+    // needs to be the first row of a superblock. If pBitMap is not NULL, each row is packed into pBitMap once it is complete.
+    // Returns the number of changed blocks.
+    unsigned int    computeBlockRows(const unsigned char* pImage1, const unsigned char* pImage2, unsigned int uiPitch, unsigned char* pByteMap,
+                                     unsigned char* pBitMap, unsigned char* pSuperBlockMap, unsigned int uiFirstRow, unsigned int uiLastRow);
+
+    // Compares the lines of block row by and marks the changed blocks in pMapRow. Returns the number of changed blocks.
+    unsigned int    compareBlockRow(const unsigned char* pImage1, const unsigned char* pImage2, unsigned int uiPitch, unsigned int by,
+                                    unsigned char* pMapRow) const;
+
+    // Same as compareBlockRow but applies the thresholds. pBlockDiff needs to store 2 values per block.
+    unsigned int    compareBlockRowThreshold(const unsigned char* pImage1, const unsigned char* pImage2, unsigned int uiPitch, unsigned int by,
+                                             unsigned char* pMapRow, unsigned int* pBlockDiff) const;
+
+    // Hashes the blocks of block row by and marks the blocks whose hash changed in pMapRow. pAcc needs to store 4 values
+    // per block. Returns the number of changed blocks.
+    unsigned int    hashBlockRow(const unsigned char* pImage, unsigned int uiPitch, unsigned int by, unsigned char* pMapRow, uint64_t* pAcc);
+
+    // Stores the current frame for the changed blocks of pMapRow and marks the blocks that changed after the acknowledged frame.
+    // Returns the number of marked blocks.
+    unsigned int    accumulateBlockRow(unsigned int by, unsigned char* pMapRow);
+
+    // Hashes the lines of block row by for each superblock column and updates the column hashes of its superblock row.
+    // pAcc needs to store 4 values per superblock column.
+    void            hashMoveLines(const unsigned char* pImage, unsigned int uiPitch, unsigned int by, uint64_t* pAcc);
+
+    // Finds the most frequent shift s != 0 for which pCurrent[i] == pPrevious[i + s] among a sample of the changed entries.
+    // Only hashes that are unique in pPrevious are considered. Returns false if no sampled entry matches.
+    bool            findShift(const uint64_t* pPrevious, const uint64_t* pCurrent, unsigned int uiSize, int& iShift);
+
+    // Compares the line and column hashes with the ones of the previous call and stores the moves in m_MoveRects. Blocks
+    // covered by a move are removed from pByteMap and the other maps are updated. Returns the number of changed blocks.
+    unsigned int    detectMoves(unsigned char* pByteMap, unsigned char* pBitMap, unsigned char* pSuperBlockMap, unsigned int uiNumChangedBlocks);
+
+    // Copies the uiNumTiles blocks marked in pByteMap from pImage to pTiles. The list of RFDiffTile is followed by the pixels.
+    void            gatherTiles(const unsigned char* pImage, unsigned int uiPitch, const unsigned char* pByteMap, unsigned int uiNumTiles,
+                                unsigned char* pTiles);
+
+    // disable copy constructor
+    RFDiffMapHost(const RFDiffMapHost& other);
+    // Disable assignment
+    RFDiffMapHost& operator=(const RFDiffMapHost& rhs);
+
+    unsigned int                    m_uiWidth;
+    unsigned int                    m_uiHeight;
+    unsigned int                    m_uiBlockSize[2];
+    unsigned int                    m_uiNumBlocks[2];
+    // Size of a superblock in blocks.
+    unsigned int                    m_uiSuperBlockSize[2];
+    unsigned int                    m_uiNumSuperBlocks[2];
+    unsigned int                    m_uiMapOffset;
+
+    RFDiffMapFormat                 m_Format;
+
+    // Byte map the blocks are compared into if the output is a bit or run length map.
+    std::vector<unsigned char>      m_ByteMap;
+    // Bit map the run length map and the rectangle list are created from.
+    std::vector<unsigned char>      m_BitMap;
+
+    // Thresholds set by setThresholds. m_bApplyThresholds is false if any difference marks a block.
+    unsigned int                    m_uiPixelThreshold;
+    unsigned int                    m_uiBlockThreshold;
+    unsigned int                    m_uiMinChangedPixels;
+    bool                            m_bApplyThresholds;
+
+    // Hash of each block of the previous call to compute if hashes are compared.
+    std::vector<uint64_t>           m_BlockHashes;
+    bool                            m_bCompareHashes;
+    bool                            m_bHashesValid;
+
+    // Hash of each line of a superblock column and of each column of a superblock row. The hashes of the
+    // previous call are in m_PrevLineHashes and m_PrevColumnHashes.
+    std::vector<uint64_t>           m_LineHashes;
+    std::vector<uint64_t>           m_PrevLineHashes;
+    std::vector<uint64_t>           m_ColumnHashes;
+    std::vector<uint64_t>           m_PrevColumnHashes;
+    bool                            m_bDetectMoves;
+    bool                            m_bMoveHashesValid;
+
+    // Frame in which each block changed last if block frames are kept. The frames of the current call to compute are
+    // in m_uiFrame and m_uiAcknowledgedFrame.
+    std::vector<unsigned int>       m_BlockFrames;
+    bool                            m_bKeepBlockFrames;
+    bool                            m_bBlockFramesValid;
+    unsigned int                    m_uiFrame;
+    unsigned int                    m_uiAcknowledgedFrame;
+
+    // If set, the changed blocks are appended to the output of compute.
+    bool                            m_bAppendTiles;
+    // Index of the first tile of each block row.
+    std::vector<unsigned int>       m_FirstTile;
+
+    // Moves found by the last call to compute.
+    std::vector<RFDiffMoveRect>     m_MoveRects;
+    // Changed entry of a line or column hash array that is searched in the hashes of the previous call.
+    struct MoveSample
+    {
+        uint64_t        uiHash;
+        unsigned int    uiIndex;
+        unsigned int    uiNumMatches;
+        unsigned int    uiMatch;
+    };
+
+    // Scratch buffers of detectMoves.
+    std::vector<RFDiffMoveRect>     m_MoveCandidates;
+    std::vector<unsigned int>       m_ChangedEntries;
+    std::vector<MoveSample>         m_MoveSamples;
+    std::vector<int>                m_Shifts;
+
+    RF_IS_DIFFERENT_FUNC            m_pfnIsDifferent;
+    RF_PIXEL_DIFFERENCE_FUNC        m_pfnGetPixelDifference;
+    RF_HASH_LINE_FUNC               m_pfnHashLine;
+    RF_HASH_COLUMNS_FUNC            m_pfnHashColumns;
+
+    std::unique_ptr<RFThreadPool>   m_pThreadPool;
+};
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "RFContext.h"
+#include "RFLock.h"
 
 class RFEncoderSettings;
 
@@ -57,6 +58,48 @@ public:
 
     virtual RFStatus            getEncodedFrame(unsigned int& uiSize, void* &pBitStream)  { return RF_STATUS_FAIL; }
 
+    // Blocks until getEncodedFrame can return a frame without waiting or until uiTimeoutNs elapsed. Returns
+    // RF_STATUS_NO_ENCODED_FRAME on timeout. Must be called by the thread that calls getEncodedFrame.
+    virtual RFStatus            waitForEncodedFrame(uint64_t uiTimeoutNs)
+    {
+        const uint64_t uiStart = rfGetTimeNs();
+
+        for (;;)
+        {
+            // Read the count before checking for a frame. If a frame gets ready after the check the count changes
+            // and the wait returns immediately.
+            const uint64_t uiCount = m_FrameReadySignal.getCount();
+
+            if (isEncodedFrameReady())
+            {
+                return RF_STATUS_OK;
+            }
+
+            uint64_t uiRemainingNs = RF_PLATFORM_INFINITE_NS;
+
+            if (uiTimeoutNs != RF_PLATFORM_INFINITE_NS)
+            {
+                const uint64_t uiElapsedNs = rfGetTimeNs() - uiStart;
+
+                if (uiElapsedNs >= uiTimeoutNs)
+                {
+                    return RF_STATUS_NO_ENCODED_FRAME;
+                }
+
+                uiRemainingNs = uiTimeoutNs - uiElapsedNs;
+            }
+
+            m_FrameReadySignal.wait(uiCount, uiRemainingNs);
+        }
+    }
+
+    // Sets one byte per block of pBlockMap to 1 if the block changed after frame uiVersion. uiCurrentVersion receives
+    // the version of the frame last returned by getEncodedFrame. Only supported by encoders that track block versions.
+    virtual RFStatus            getChangedBlocks(unsigned int uiVersion, unsigned char* pBlockMap, unsigned int uiSize, unsigned int& uiCurrentVersion)
+    {
+        return RF_STATUS_FAIL;
+    }
+
     // Returns true if the format is supporetd as input by the encoder.
     virtual bool                isFormatSupported(RFFormat format)  const { return false; };
 
@@ -83,6 +126,10 @@ public:
 
 protected:
 
+    // Returns true if getEncodedFrame would return a frame without waiting. Encoders that support
+    // waitForEncodedFrame need to implement it and notify m_FrameReadySignal once a frame is ready.
+    virtual bool                isEncodedFrameReady()                                   { return false; }
+
     RFFormat                        m_format;
 
     unsigned int                    m_uiWidth;
@@ -94,6 +141,9 @@ protected:
 
     std::string                     m_strEncoderName;
 
+    // Notified whenever a frame may have become ready to be retrieved by getEncodedFrame.
+    RFSignal                        m_FrameReadySignal;
+
 private:
 
     RFEncoder(const RFEncoder&);
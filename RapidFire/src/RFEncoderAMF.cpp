@@ -44,6 +44,18 @@
 #define VCE_MAX_WIDTH   (1920*2)
 #define VCE_MAX_HEIGHT  (1080*2)
 
+// Time during which the output is polled without sleeping. VCE usually finishes a frame within this time and
+// a sleep would add up to a full scheduler tick of latency.
+#define AMF_POLL_YIELD_NS       1000000ULL
+// Time encode waits for the reader to retrieve an output if the VCE queue is full.
+#define AMF_SUBMIT_WAIT_NS      1000000ULL
+
+// HEVC Main 10 profile and color bit depth property of AMF runtimes that encode P010 surfaces. They are not
+// defined by the bundled AMF headers.
+#define AMF_HEVC_PROFILE_MAIN_10    2
+#define AMF_HEVC_COLOR_BIT_DEPTH    L"HevcColorBitDepth"
+#define AMF_COLOR_BIT_DEPTH_10      10
+
 using namespace std;
 using namespace amf;
 
@@ -126,14 +138,15 @@ RFEncoderAMF::RFEncoderAMF()
 
 RFEncoderAMF::~RFEncoderAMF()
 {
-    m_amfEncodedFrame = NULL;
+    m_amfEncodedFrame  = NULL;
+    m_amfPendingOutput = NULL;
     m_pPreSubmitSettings.clear();
 }
 
 
 bool RFEncoderAMF::isFormatSupported(RFFormat format) const
 {
-    return ((format == RF_NV12) || (format == RF_BGRA8));
+    return ((format == RF_NV12) || (format == RF_BGRA8) || (format == RF_P010));
 }
 
 
@@ -161,13 +174,23 @@ RFStatus RFEncoderAMF::init(const RFContextCL* pContextCL, const RFEncoderSettin
         return RF_STATUS_INVALID_FORMAT;
     }
 
-    // Only NV12 (and BGRA for DX9 only) are supported.
+    // Only NV12, P010 (and BGRA for DX9 only) are supported.
     AMF_SURFACE_FORMAT amfFormat = AMF_SURFACE_NV12;
 
     if (m_format == RF_BGRA8)
     {
         amfFormat = AMF_SURFACE_BGRA;
     }
+    else if (m_format == RF_P010)
+    {
+        // 10 bit input can only be encoded as HEVC.
+        if (pConfig->getVideoCodec() != RF_VIDEO_CODEC_HEVC)
+        {
+            return RF_STATUS_INVALID_FORMAT;
+        }
+
+        amfFormat = AMF_SURFACE_P010;
+    }
 
     m_uiWidth  = pConfig->getEncoderWidth();
     m_uiHeight = pConfig->getEncoderHeight();
@@ -242,6 +265,13 @@ RFStatus RFEncoderAMF::init(const RFContextCL* pContextCL, const RFEncoderSettin
         }
     }
 
+    if (m_format == RF_P010)
+    {
+        // Encode 10 bit input with the Main 10 profile. Errors are ignored, runtimes without 10 bit support fail in Init.
+        m_amfEncoder->SetProperty(AMF_VIDEO_ENCODER_HEVC_PROFILE, AMF_HEVC_PROFILE_MAIN_10);
+        m_amfEncoder->SetProperty(AMF_HEVC_COLOR_BIT_DEPTH, AMF_COLOR_BIT_DEPTH_10);
+    }
+
     amfErr = m_amfEncoder->Init(amfFormat, m_uiAlignedWidth, m_uiAlignedHeight);
     CHECK_AMF_ERROR(amfErr);
 
@@ -296,25 +326,25 @@ RFStatus RFEncoderAMF::encode(unsigned int uiBufferIdx, bool bUseInputImage)
 
     do
     {
+        // Read the count before submitting. If the reader retrieves an output after the submit failed
+        // the count changes and the wait returns immediately.
+        const uint64_t uiCount = m_OutputReleasedSignal.getCount();
+
         amfErr = m_amfEncoder->SubmitInput(amfSurface);
 
         // AMF_REPEAT is returned if the queue is full. We have too many pending frames and need
         // to free space by calling QueryOutput. If a separate thread reads the data we will wait
-        // and retry. It might be the case that the read thread is too slow and data is encoded faster
-        // than read.
+        // until it retrieved an output and retry. It might be the case that the read thread is too slow and data
+        // is encoded faster than read.
         // In a non multithreaded app this should not happen unless the app does not call getEncodedFrame.
         // ATTENTION: The RFSession manages a queue as well that will prevent to submit too many frames without
         // retreiving the result. The queue used by RFSession might be greater than the AMF queue and we still
         // might run into the situation that we get an AMF_REPEAT.
         if (amfErr == AMF_REPEAT)
         {
-            Sleep(1); // provide some time to the reader thread
+            // The wait times out if VCE frees the slot itself, in this case we retry as well.
+            m_OutputReleasedSignal.wait(uiCount, AMF_SUBMIT_WAIT_NS);
             ++uiFailedSubmitCount;
-
-            if (uiFailedSubmitCount > 2)
-            {
-                Sleep(1);
-            }
         }
     } while (amfErr == AMF_REPEAT && uiFailedSubmitCount < 10);
 
@@ -327,6 +357,9 @@ RFStatus RFEncoderAMF::encode(unsigned int uiBufferIdx, bool bUseInputImage)
 
     ++m_uiPendingFrames;
 
+    // Wake up a reader that waits for a frame to be submitted.
+    m_FrameReadySignal.notify();
+
     return RF_STATUS_OK;
 }
 
@@ -334,7 +367,6 @@ RFStatus RFEncoderAMF::encode(unsigned int uiBufferIdx, bool bUseInputImage)
 RFStatus RFEncoderAMF::getEncodedFrame(unsigned int& uiSize, void* &pBitStream)
 {
     bool            bBlocking = false;
-    AMFDataPtr      pData;
     AMF_RESULT      amfErr = AMF_OK;
     amf_int32       picStruct = AMF_VIDEO_ENCODER_PICTURE_STRUCTURE_NONE;
 
@@ -352,39 +384,116 @@ RFStatus RFEncoderAMF::getEncodedFrame(unsigned int& uiSize, void* &pBitStream)
         bBlocking = true;
     }
 
-    do
+    RFStatus rfStatus = queryOutput(bBlocking ? RF_PLATFORM_INFINITE_NS : 0);
+
+    if (rfStatus != RF_STATUS_OK)
     {
-        amfErr = m_amfEncoder->QueryOutput(&pData);
+        return rfStatus;
+    }
 
-        if (amfErr == AMF_OK)
-        {
-            AMFBufferPtr pBuffer(pData);
+    AMFBufferPtr pBuffer(m_amfPendingOutput);
+
+    m_amfEncodedFrame  = pBuffer;
+    m_amfPendingOutput = NULL;
 
-            m_amfEncodedFrame = pBuffer;
+    --m_uiPendingFrames;
 
-            amfErr = pData->GetProperty(AMF_VIDEO_ENCODER_PICTURE_STRUCTURE, &picStruct);
-            CHECK_AMF_ERROR(amfErr);
+    // The encoder has space for a new frame. Wake up encode if it is waiting.
+    m_OutputReleasedSignal.notify();
+
+    amfErr = m_amfEncodedFrame->GetProperty(AMF_VIDEO_ENCODER_PICTURE_STRUCTURE, &picStruct);
+    CHECK_AMF_ERROR(amfErr);
+
+    pBitStream = m_amfEncodedFrame->GetNative();
+    uiSize = static_cast<unsigned int>(m_amfEncodedFrame->GetSize());
+
+    return RF_STATUS_OK;
+}
 
-            pBitStream = m_amfEncodedFrame->GetNative();
-            uiSize = static_cast<unsigned int>(m_amfEncodedFrame->GetSize());
 
-            --m_uiPendingFrames;
+RFStatus RFEncoderAMF::waitForEncodedFrame(uint64_t uiTimeoutNs)
+{
+    const uint64_t uiStart = rfGetTimeNs();
+
+    uint64_t uiRemainingNs = uiTimeoutNs;
+
+    // Wait until a frame was submitted. encode notifies m_FrameReadySignal after each submit.
+    for (;;)
+    {
+        const uint64_t uiCount = m_FrameReadySignal.getCount();
+
+        if (m_uiPendingFrames > 0)
+        {
+            break;
         }
-        else if (bBlocking && amfErr == AMF_REPEAT)
+
+        if (uiTimeoutNs != RF_PLATFORM_INFINITE_NS)
         {
-            Sleep(1);
+            const uint64_t uiElapsedNs = rfGetTimeNs() - uiStart;
+
+            if (uiElapsedNs >= uiTimeoutNs)
+            {
+                return RF_STATUS_NO_ENCODED_FRAME;
+            }
+
+            uiRemainingNs = uiTimeoutNs - uiElapsedNs;
         }
 
-    } while (bBlocking && amfErr == AMF_REPEAT);
+        m_FrameReadySignal.wait(uiCount, uiRemainingNs);
+    }
 
-    if (amfErr == AMF_REPEAT)
+    if (uiTimeoutNs != RF_PLATFORM_INFINITE_NS)
     {
-        return RF_STATUS_NO_ENCODED_FRAME;
+        const uint64_t uiElapsedNs = rfGetTimeNs() - uiStart;
+
+        uiRemainingNs = (uiElapsedNs < uiTimeoutNs) ? (uiTimeoutNs - uiElapsedNs) : 0;
     }
 
-    CHECK_AMF_ERROR(amfErr);
+    return queryOutput(uiRemainingNs);
+}
 
-    return RF_STATUS_OK;
+
+RFStatus RFEncoderAMF::queryOutput(uint64_t uiTimeoutNs)
+{
+    if (m_amfPendingOutput)
+    {
+        return RF_STATUS_OK;
+    }
+
+    const uint64_t uiStart = rfGetTimeNs();
+
+    for (;;)
+    {
+        AMF_RESULT amfErr = m_amfEncoder->QueryOutput(&m_amfPendingOutput);
+
+        if (amfErr == AMF_OK && m_amfPendingOutput)
+        {
+            return RF_STATUS_OK;
+        }
+
+        if (amfErr != AMF_OK && amfErr != AMF_REPEAT)
+        {
+            return RF_STATUS_AMF_FAIL;
+        }
+
+        const uint64_t uiElapsedNs = rfGetTimeNs() - uiStart;
+
+        if (uiElapsedNs >= uiTimeoutNs)
+        {
+            return RF_STATUS_NO_ENCODED_FRAME;
+        }
+
+        // AMF does not signal when an output is available. Only give up the time slice while the frame is
+        // expected to finish and sleep afterwards to not burn a core if the encoder is stalled.
+        if (uiElapsedNs < AMF_POLL_YIELD_NS)
+        {
+            rfYield();
+        }
+        else
+        {
+            rfSleep(1);
+        }
+    }
 }
 
 
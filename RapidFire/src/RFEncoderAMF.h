@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include <CL/cl.h>
@@ -62,6 +63,9 @@ public:
 
     virtual RFStatus            getEncodedFrame(unsigned int& uiSize, void* &pBitStream) override;
 
+    // AMF does not notify when an output is available. After a frame was submitted, the output is polled.
+    virtual RFStatus            waitForEncodedFrame(uint64_t uiTimeoutNs) override;
+
     // Defines if getEncodeFrame should block until a frame is ready or not. If no blocking is used the call will return
     // immediatly unless the VCE queue is full and AMF needs to wait for an empty slot before submitting the next frame.
     void                        setBlockingRead(bool block);
@@ -84,14 +88,22 @@ private:
     // Updates the AMF context with the property specified by uiParameterIndex.
     RFStatus					setAMFProperty(unsigned int uiParameterIndex, RFParameterType rfType, RFProperties value);
 
+    // Polls the encoder until an output is available or uiTimeoutNs elapsed. The output is stored in m_amfPendingOutput.
+    RFStatus                    queryOutput(uint64_t uiTimeoutNs);
+
     bool                            m_bBlock;
-    unsigned int                    m_uiPendingFrames;
+    std::atomic<unsigned int>       m_uiPendingFrames;
 
     const RFContextAMF*             m_pContext;
 
     amf::AMFContextPtr              m_amfContext;
     amf::AMFComponentPtr            m_amfEncoder;
     amf::AMFBufferPtr               m_amfEncodedFrame;
+    // Output that was retrieved by queryOutput but not yet returned by getEncodedFrame.
+    amf::AMFDataPtr                 m_amfPendingOutput;
+
+    // Notified by getEncodedFrame when an output was retrieved and the encoder can accept new input.
+    RFSignal                        m_OutputReleasedSignal;
 
     const MAPPING_ENTRY*            m_pPropertyNameMap;
     unsigned int                    m_uiPropertyNameMapCount;
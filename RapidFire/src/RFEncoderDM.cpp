@@ -23,7 +23,10 @@
 #include "RFEncoderDM.h"
 
 #include <assert.h>
+#include <limits.h>
 #include <math.h>
+#include <stddef.h>
+#include <string.h>
 
 #include <fstream>
 #include <sstream>
@@ -34,6 +37,9 @@
 #include "RFError.h"
 #include "RFUtils.h"
 
+// Default time in microseconds RFEncoderDM::encode waits for the reader thread to release a target buffer.
+#define DM_BUFFER_WAIT_TIMEOUT_US   2000
+
 using namespace std;
 
 #define DIFF_KERNEL_NAME "rfDiffMapKernel.cl"
@@ -42,15 +48,38 @@ using namespace std;
 
 const char* str_cl_DiffMapkernels = MULTI_LINE_STR(     __constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_NONE | CLK_FILTER_NEAREST;
 
+                                                        // Marks the block of the work group as changed in the superblock map and in the byte or bit map and
+                                                        // increments the number of changed blocks.
+                                                        void markBlock(__global unsigned char* DiffMap, const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                                                       const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX)
+                                                        {
+                                                            unsigned int groupX = get_group_id(0);
+                                                            unsigned int groupY = get_group_id(1);
+                                                            unsigned int groupIndex = groupX + get_num_groups(0) * groupY;
+
+                                                            atomic_inc((__global unsigned int*)DiffMap);
+                                                            DiffMap[uiSuperBlockMapOffset + (groupY / uiSuperBlockY) * uiNumSuperBlocksX + groupX / uiSuperBlockX] = 1;
+                                                            if (uiBitMapPitch != 0)
+                                                            {
+                                                                atomic_or((__global unsigned int*)(DiffMap + uiMapOffset) + groupY * (uiBitMapPitch / 4) + (groupX / 32), 1u << (groupX % 32));
+                                                            }
+                                                            else
+                                                            {
+                                                                DiffMap[uiMapOffset + groupIndex] = 1;
+                                                            }
+                                                        }
+
+
                                                         __kernel void DiffMap_Image(__read_only image2d_t Image1, __read_only image2d_t Image2, __global unsigned char* DiffMap,
-                                                                                    unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY)
+                                                                                    unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                                                                    const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                                                                    const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX)
                                                         {
                                                             __local unsigned int result;
                                                             result = 0;
                                                             barrier(CLK_LOCAL_MEM_FENCE);
-                                                            short groupX = get_group_id(0);
-                                                            short groupY = get_group_id(1);
-                                                            short groupIndex = groupX + get_num_groups(0) * groupY;
+                                                            unsigned int groupX = get_group_id(0);
+                                                            unsigned int groupY = get_group_id(1);
                                                             short groupSize = get_local_size(0) * get_local_size(1);
                                                             short localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
 
@@ -81,8 +110,11 @@ const char* str_cl_DiffMapkernels = MULTI_LINE_STR(     __constant sampler_t sam
 
                                                                 if (amd_sad4(as_uint4(pixels1), as_uint4(pixels2), 0) != 0)
                                                                 {
-                                                                    result = 1;
-                                                                    DiffMap[groupIndex] = 1;
+                                                                    // Only the first work item that finds a difference updates the maps.
+                                                                    if (atomic_xchg(&result, 1) == 0)
+                                                                    {
+                                                                        markBlock(DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX);
+                                                                    }
                                                                     return;
                                                                 }
                                                             }
@@ -90,14 +122,15 @@ const char* str_cl_DiffMapkernels = MULTI_LINE_STR(     __constant sampler_t sam
 
 
                                                         __kernel void DiffMap_Buffer(__global unsigned int* Image1, __global unsigned int* Image2, __global unsigned char* DiffMap,
-                                                                                     unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY)
+                                                                                     unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                                                                     const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                                                                     const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX)
                                                         {
                                                             __local unsigned int result;
                                                             result = 0;
                                                             barrier(CLK_LOCAL_MEM_FENCE);
-                                                            short groupX = get_group_id(0);
-                                                            short groupY = get_group_id(1);
-                                                            short groupIndex = groupX + get_num_groups(0) * groupY;
+                                                            unsigned int groupX = get_group_id(0);
+                                                            unsigned int groupY = get_group_id(1);
                                                             short groupSize = get_local_size(0) * get_local_size(1);
                                                             short localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
 
@@ -126,7 +159,7 @@ const char* str_cl_DiffMapkernels = MULTI_LINE_STR(     __constant sampler_t sam
                                                                     unsigned int localIndex_ = localIndex + i * groupSize;
                                                                     unsigned int x = localIndex_ % uiLocalPxX;
                                                                     unsigned int y = localIndex_ / uiLocalPxX;
-                                                                    if (x_offset + x < DomainSizeX && y_offset + y < DomainSizeY)
+                                                                    if (localIndex_ < localBlockSize && x_offset + x < DomainSizeX && y_offset + y < DomainSizeY)
                                                                     {
                                                                         ((unsigned int*)&(pixels1))[i] = Image1[idx + x + y * DomainSizeX];
                                                                         ((unsigned int*)&(pixels2))[i] = Image2[idx + x + y * DomainSizeX];
@@ -139,31 +172,466 @@ const char* str_cl_DiffMapkernels = MULTI_LINE_STR(     __constant sampler_t sam
                                                                 }
                                                                 if (amd_sad4(pixels1, pixels2, 0) != 0)
                                                                 {
-                                                                    result = 1;
-                                                                    DiffMap[groupIndex] = 1;
+                                                                    // Only the first work item that finds a difference updates the maps.
+                                                                    if (atomic_xchg(&result, 1) == 0)
+                                                                    {
+                                                                        markBlock(DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX);
+                                                                    }
                                                                     return;
                                                                 }
                                                             }
                                                         };
+
+
+                                                        ulong4 hashStripe(uint8 pixels, ulong s)
+                                                        {
+                                                            ulong4 data = convert_ulong4(pixels.even) | (convert_ulong4(pixels.odd) << 32);
+                                                            ulong4 key  = (ulong4)(0x9E3779B185EBCA87UL, 0xC2B2AE3D27D4EB4FUL, 0x165667B19E3779F9UL, 0x85EBCA77C2B2AE63UL) +
+                                                                          (ulong4)(s) * (ulong4)(0x27D4EB2F165667C5UL, 0x94D049BB133111EBUL, 0xBF58476D1CE4E5B9UL, 0xFF51AFD7ED558CCDUL);
+                                                            ulong4 dataKey = data ^ key;
+
+                                                            return (dataKey & (ulong4)(0xFFFFFFFFUL)) * (dataKey >> 32) + data.s1032;
+                                                        }
+
+
+                                                        ulong mixHash(ulong hash)
+                                                        {
+                                                            hash ^= hash >> 33;
+                                                            hash *= 0xFF51AFD7ED558CCDUL;
+                                                            hash ^= hash >> 33;
+                                                            hash *= 0xC4CEB9FE1A85EC53UL;
+                                                            hash ^= hash >> 33;
+
+                                                            return hash;
+                                                        }
+
+
+                                                        // Sums the accumulators of all work items, compares the hash of the block with BlockHashes and updates the maps.
+                                                        void updateBlockHash(__local ulong4* Acc, ulong4 acc, __global ulong* BlockHashes, __global unsigned char* DiffMap,
+                                                                             const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                                                             const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX, const unsigned int uiResetHashes)
+                                                        {
+                                                            unsigned int groupX = get_group_id(0);
+                                                            unsigned int groupY = get_group_id(1);
+                                                            unsigned int groupIndex = groupX + get_num_groups(0) * groupY;
+                                                            unsigned int groupSize = get_local_size(0) * get_local_size(1);
+                                                            unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+                                                            Acc[localIndex] = acc;
+                                                            barrier(CLK_LOCAL_MEM_FENCE);
+
+                                                            // The group size is a power of 2.
+                                                            for (unsigned int stride = groupSize / 2; stride > 0; stride /= 2)
+                                                            {
+                                                                if (localIndex < stride)
+                                                                {
+                                                                    Acc[localIndex] += Acc[localIndex + stride];
+                                                                }
+                                                                barrier(CLK_LOCAL_MEM_FENCE);
+                                                            }
+
+                                                            if (localIndex == 0)
+                                                            {
+                                                                ulong hash = mixHash(mixHash(mixHash(mixHash(Acc[0].s0) ^ Acc[0].s1) ^ Acc[0].s2) ^ Acc[0].s3);
+
+                                                                if (uiResetHashes != 0 || hash != BlockHashes[groupIndex])
+                                                                {
+                                                                    markBlock(DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX);
+                                                                }
+
+                                                                BlockHashes[groupIndex] = hash;
+                                                            }
+                                                        }
+
+
+                                                        __kernel void DiffMap_HashImage(__read_only image2d_t Image, __global ulong* BlockHashes, __global unsigned char* DiffMap,
+                                                                                        unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                                                                        const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                                                                        const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX,
+                                                                                        const unsigned int uiResetHashes)
+                                                        {
+                                                            __local ulong4 Acc[256];
+                                                            unsigned int groupSize = get_local_size(0) * get_local_size(1);
+                                                            unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+                                                            // Offset into the image
+                                                            unsigned int x_offset = get_group_id(0) * uiLocalPxX;
+                                                            unsigned int y_offset = get_group_id(1) * uiLocalPxY;
+
+                                                            unsigned int uiStripesPerLine = uiLocalPxX / 8;
+                                                            unsigned int uiNumStripes = uiStripesPerLine * uiLocalPxY;
+
+                                                            ulong4 acc = (ulong4)(0);
+
+                                                            for (unsigned int s = localIndex; s < uiNumStripes; s += groupSize)
+                                                            {
+                                                                unsigned int x = x_offset + (s % uiStripesPerLine) * 8;
+                                                                unsigned int y = y_offset + s / uiStripesPerLine;
+
+                                                                // Stripes outside of the image are not hashed. Pixels of a stripe outside of the image are 0.
+                                                                if (x < DomainSizeX && y < DomainSizeY)
+                                                                {
+                                                                    uint8 pixels = (uint8)(0);
+
+                                                                    for (unsigned int i = 0; i < 8; ++i)
+                                                                    {
+                                                                        if (x + i < DomainSizeX)
+                                                                        {
+                                                                            uint4 c = convert_uint4_sat_rte(read_imagef(Image, sampler, (int2)(x + i, y)) * 255.0f);
+                                                                            ((unsigned int*)&(pixels))[i] = c.x | (c.y << 8) | (c.z << 16) | (c.w << 24);
+                                                                        }
+                                                                    }
+
+                                                                    acc += hashStripe(pixels, s);
+                                                                }
+                                                            }
+
+                                                            updateBlockHash(Acc, acc, BlockHashes, DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX, uiResetHashes);
+                                                        };
+
+
+                                                        __kernel void DiffMap_HashBuffer(__global unsigned int* Image, __global ulong* BlockHashes, __global unsigned char* DiffMap,
+                                                                                         unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                                                                         const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                                                                         const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX,
+                                                                                         const unsigned int uiResetHashes)
+                                                        {
+                                                            __local ulong4 Acc[256];
+                                                            unsigned int groupSize = get_local_size(0) * get_local_size(1);
+                                                            unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+                                                            // Offset into the image
+                                                            unsigned int x_offset = get_group_id(0) * uiLocalPxX;
+                                                            unsigned int y_offset = get_group_id(1) * uiLocalPxY;
+
+                                                            unsigned int uiStripesPerLine = uiLocalPxX / 8;
+                                                            unsigned int uiNumStripes = uiStripesPerLine * uiLocalPxY;
+
+                                                            ulong4 acc = (ulong4)(0);
+
+                                                            for (unsigned int s = localIndex; s < uiNumStripes; s += groupSize)
+                                                            {
+                                                                unsigned int x = x_offset + (s % uiStripesPerLine) * 8;
+                                                                unsigned int y = y_offset + s / uiStripesPerLine;
+
+                                                                // Stripes outside of the image are not hashed. Pixels of a stripe outside of the image are 0.
+                                                                if (x < DomainSizeX && y < DomainSizeY)
+                                                                {
+                                                                    uint8 pixels = (uint8)(0);
+
+                                                                    for (unsigned int i = 0; i < 8; ++i)
+                                                                    {
+                                                                        if (x + i < DomainSizeX)
+                                                                        {
+                                                                            ((unsigned int*)&(pixels))[i] = Image[x + i + y * DomainSizeX];
+                                                                        }
+                                                                    }
+
+                                                                    acc += hashStripe(pixels, s);
+                                                                }
+                                                            }
+
+                                                            updateBlockHash(Acc, acc, BlockHashes, DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX, uiResetHashes);
+                                                        };
+
+
+                                                        // Sums the number of changed pixels and their differences of all work items and marks the block if it exceeds the thresholds.
+                                                        void updateBlockDifference(__local unsigned int* Changed, unsigned int numChanged, unsigned int diff, __global unsigned char* DiffMap,
+                                                                                   const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                                                                   const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX,
+                                                                                   const unsigned int uiBlockThreshold, const unsigned int uiMinChangedPixels)
+                                                        {
+                                                            if (numChanged > 0)
+                                                            {
+                                                                atomic_add(&Changed[0], numChanged);
+                                                                atomic_add(&Changed[1], diff);
+                                                            }
+                                                            barrier(CLK_LOCAL_MEM_FENCE);
+
+                                                            if (get_local_id(0) == 0 && get_local_id(1) == 0 && Changed[0] >= uiMinChangedPixels && Changed[1] > uiBlockThreshold)
+                                                            {
+                                                                markBlock(DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX);
+                                                            }
+                                                        }
+
+
+                                                        __kernel void DiffMap_ThresholdImage(__read_only image2d_t Image1, __read_only image2d_t Image2, __global unsigned char* DiffMap,
+                                                                                             unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                                                                             const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                                                                             const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX,
+                                                                                             const unsigned int uiPixelThreshold, const unsigned int uiBlockThreshold, const unsigned int uiMinChangedPixels)
+                                                        {
+                                                            __local unsigned int Changed[2];
+                                                            unsigned int groupSize = get_local_size(0) * get_local_size(1);
+                                                            unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+                                                            if (localIndex == 0)
+                                                            {
+                                                                Changed[0] = 0;
+                                                                Changed[1] = 0;
+                                                            }
+                                                            barrier(CLK_LOCAL_MEM_FENCE);
+
+                                                            // Offset into the image
+                                                            unsigned int x_offset = get_group_id(0) * uiLocalPxX;
+                                                            unsigned int y_offset = get_group_id(1) * uiLocalPxY;
+
+                                                            unsigned int localBlockSize = uiLocalPxX * uiLocalPxY;
+
+                                                            unsigned int numChanged = 0;
+                                                            unsigned int sum = 0;
+
+                                                            for (unsigned int i = localIndex; i < localBlockSize; i += groupSize)
+                                                            {
+                                                                unsigned int x = x_offset + i % uiLocalPxX;
+                                                                unsigned int y = y_offset + i / uiLocalPxX;
+
+                                                                if (x < DomainSizeX && y < DomainSizeY)
+                                                                {
+                                                                    uint4 c1 = convert_uint4_sat_rte(read_imagef(Image1, sampler, (int2)(x, y)) * 255.0f);
+                                                                    uint4 c2 = convert_uint4_sat_rte(read_imagef(Image2, sampler, (int2)(x, y)) * 255.0f);
+                                                                    uint4 d = abs_diff(c1, c2);
+                                                                    unsigned int diff = d.x + d.y + d.z + d.w;
+
+                                                                    if (diff > uiPixelThreshold)
+                                                                    {
+                                                                        ++numChanged;
+                                                                        sum += diff;
+                                                                    }
+                                                                }
+                                                            }
+
+                                                            updateBlockDifference(Changed, numChanged, sum, DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX,
+                                                                                  uiBlockThreshold, uiMinChangedPixels);
+                                                        };
+
+
+                                                        __kernel void DiffMap_ThresholdBuffer(__global unsigned int* Image1, __global unsigned int* Image2, __global unsigned char* DiffMap,
+                                                                                              unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                                                                              const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                                                                              const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX,
+                                                                                              const unsigned int uiPixelThreshold, const unsigned int uiBlockThreshold, const unsigned int uiMinChangedPixels)
+                                                        {
+                                                            __local unsigned int Changed[2];
+                                                            unsigned int groupSize = get_local_size(0) * get_local_size(1);
+                                                            unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+                                                            if (localIndex == 0)
+                                                            {
+                                                                Changed[0] = 0;
+                                                                Changed[1] = 0;
+                                                            }
+                                                            barrier(CLK_LOCAL_MEM_FENCE);
+
+                                                            // Offset into the image
+                                                            unsigned int x_offset = get_group_id(0) * uiLocalPxX;
+                                                            unsigned int y_offset = get_group_id(1) * uiLocalPxY;
+
+                                                            unsigned int localBlockSize = uiLocalPxX * uiLocalPxY;
+
+                                                            unsigned int numChanged = 0;
+                                                            unsigned int sum = 0;
+
+                                                            for (unsigned int i = localIndex; i < localBlockSize; i += groupSize)
+                                                            {
+                                                                unsigned int x = x_offset + i % uiLocalPxX;
+                                                                unsigned int y = y_offset + i / uiLocalPxX;
+
+                                                                if (x < DomainSizeX && y < DomainSizeY)
+                                                                {
+                                                                    // amd_sad sums the absolute differences of the 4 bytes of a pixel.
+                                                                    unsigned int diff = amd_sad(Image1[x + y * DomainSizeX], Image2[x + y * DomainSizeX], 0);
+
+                                                                    if (diff > uiPixelThreshold)
+                                                                    {
+                                                                        ++numChanged;
+                                                                        sum += diff;
+                                                                    }
+                                                                }
+                                                            }
+
+                                                            updateBlockDifference(Changed, numChanged, sum, DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX,
+                                                                                  uiBlockThreshold, uiMinChangedPixels);
+                                                        };
+
+
+                                                        // Returns true if the block of the work group is marked as changed in the byte or bit map.
+                                                        bool isBlockChanged(__global unsigned char* DiffMap, const unsigned int uiBitMapPitch, const unsigned int uiMapOffset)
+                                                        {
+                                                            unsigned int groupX = get_group_id(0);
+                                                            unsigned int groupY = get_group_id(1);
+
+                                                            if (uiBitMapPitch != 0)
+                                                            {
+                                                                return (DiffMap[uiMapOffset + groupY * uiBitMapPitch + groupX / 8] & (1u << (groupX % 8))) != 0;
+                                                            }
+
+                                                            return DiffMap[uiMapOffset + groupX + get_num_groups(0) * groupY] != 0;
+                                                        }
+
+
+                                                        // Allocates the next tile, stores the position of the block in the tile list and returns the pixels of the tile.
+                                                        __global unsigned int* allocateTile(__local unsigned int* Tile, __global unsigned char* DiffMap, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                                                                            const unsigned int uiTileOffset, const unsigned int uiNumTilesOffset)
+                                                        {
+                                                            __global unsigned int* TileList = (__global unsigned int*)(DiffMap + uiTileOffset);
+
+                                                            if (get_local_id(0) == 0 && get_local_id(1) == 0)
+                                                            {
+                                                                *Tile = atomic_inc((__global unsigned int*)(DiffMap + uiNumTilesOffset));
+
+                                                                TileList[2 * *Tile]     = get_group_id(0) * uiLocalPxX;
+                                                                TileList[2 * *Tile + 1] = get_group_id(1) * uiLocalPxY;
+                                                            }
+                                                            barrier(CLK_LOCAL_MEM_FENCE);
+
+                                                            return TileList + 2 * get_num_groups(0) * get_num_groups(1) + *Tile * uiLocalPxX * uiLocalPxY;
+                                                        }
+
+
+                                                        __kernel void DiffMap_GatherTilesImage(__read_only image2d_t Image, __global unsigned char* DiffMap,
+                                                                                               unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                                                                               const unsigned int uiBitMapPitch, const unsigned int uiMapOffset, const unsigned int uiTileOffset, const unsigned int uiNumTilesOffset)
+                                                        {
+                                                            __local unsigned int Tile;
+
+                                                            // All work items of the group take the same branch.
+                                                            if (!isBlockChanged(DiffMap, uiBitMapPitch, uiMapOffset))
+                                                            {
+                                                                return;
+                                                            }
+
+                                                            __global unsigned int* TileData = allocateTile(&Tile, DiffMap, uiLocalPxX, uiLocalPxY, uiTileOffset, uiNumTilesOffset);
+
+                                                            unsigned int groupSize = get_local_size(0) * get_local_size(1);
+                                                            unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+                                                            // Offset into the image
+                                                            unsigned int x_offset = get_group_id(0) * uiLocalPxX;
+                                                            unsigned int y_offset = get_group_id(1) * uiLocalPxY;
+
+                                                            for (unsigned int i = localIndex; i < uiLocalPxX * uiLocalPxY; i += groupSize)
+                                                            {
+                                                                unsigned int x = x_offset + i % uiLocalPxX;
+                                                                unsigned int y = y_offset + i / uiLocalPxX;
+
+                                                                unsigned int pixel = 0;
+
+                                                                if (x < DomainSizeX && y < DomainSizeY)
+                                                                {
+                                                                    uint4 c = convert_uint4_sat_rte(read_imagef(Image, sampler, (int2)(x, y)) * 255.0f);
+                                                                    pixel = c.x | (c.y << 8) | (c.z << 16) | (c.w << 24);
+                                                                }
+
+                                                                TileData[i] = pixel;
+                                                            }
+                                                        };
+
+
+                                                        __kernel void DiffMap_GatherTilesBuffer(__global unsigned int* Image, __global unsigned char* DiffMap,
+                                                                                                unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                                                                                const unsigned int uiBitMapPitch, const unsigned int uiMapOffset, const unsigned int uiTileOffset, const unsigned int uiNumTilesOffset)
+                                                        {
+                                                            __local unsigned int Tile;
+
+                                                            // All work items of the group take the same branch.
+                                                            if (!isBlockChanged(DiffMap, uiBitMapPitch, uiMapOffset))
+                                                            {
+                                                                return;
+                                                            }
+
+                                                            __global unsigned int* TileData = allocateTile(&Tile, DiffMap, uiLocalPxX, uiLocalPxY, uiTileOffset, uiNumTilesOffset);
+
+                                                            unsigned int groupSize = get_local_size(0) * get_local_size(1);
+                                                            unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+                                                            // Offset into the image
+                                                            unsigned int x_offset = get_group_id(0) * uiLocalPxX;
+                                                            unsigned int y_offset = get_group_id(1) * uiLocalPxY;
+
+                                                            for (unsigned int i = localIndex; i < uiLocalPxX * uiLocalPxY; i += groupSize)
+                                                            {
+                                                                unsigned int x = x_offset + i % uiLocalPxX;
+                                                                unsigned int y = y_offset + i / uiLocalPxX;
+
+                                                                TileData[i] = (x < DomainSizeX && y < DomainSizeY) ? Image[x + y * DomainSizeX] : 0;
+                                                            }
+                                                        };
+
+
+                                                        __kernel void DiffMap_Accumulate(__global unsigned char* DiffMap, __global unsigned int* BlockFrames, const unsigned int uiFrame,
+                                                                                         const unsigned int uiAcknowledgedFrame, const unsigned int uiResetFrames,
+                                                                                         const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                                                                         const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX)
+                                                        {
+                                                            unsigned int groupIndex = get_group_id(0) + get_num_groups(0) * get_group_id(1);
+
+                                                            if (isBlockChanged(DiffMap, uiBitMapPitch, uiMapOffset))
+                                                            {
+                                                                BlockFrames[groupIndex] = uiFrame;
+                                                            }
+                                                            else if (uiResetFrames != 0)
+                                                            {
+                                                                BlockFrames[groupIndex] = uiFrame;
+
+                                                                markBlock(DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX);
+                                                            }
+                                                            else if (BlockFrames[groupIndex] > uiAcknowledgedFrame)
+                                                            {
+                                                                markBlock(DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX);
+                                                            }
+                                                        };
                                                     );
 
 
 // ATTENTION: The difference encoder needs two frames (ResultBuffers) to create a difference map. In order not to override
 // the result buffer of the previous frame, the RFEncoderDM::encode function needs to fail before the result buffer gets written.
-// Therefor the diff encoder can only store NUM_RESULT_BUFFERS - 1 frames. This way the RFEncoderDM::m_ResultQueue is full
+// Therefor the diff encoder can only store RFContextCL::getNumResultBuffers() - 1 frames. This way the RFEncoderDM::m_ResultQueue is full
 // but the RFContext::m_clResultBuffer has still one slot left which contains the previous frame.
-RFEncoderDM::RFEncoderDM()
+// If RF_DIFF_ENCODER_HASH_BLOCKS is set, only the block hashes of the previous frame are kept and all result buffers can be used.
+RFEncoderDM::RFEncoderDM(bool bAppendTiles)
     : RFEncoder()
-    , m_uiNumTargetBuffers(NUM_RESULT_BUFFERS - 1)
+    , m_uiNumTargetBuffers(DEFAULT_PIPELINE_DEPTH - 1)
     , m_bLockMappedBuffer(false)
+    , m_uiWaitTimeoutNs(DM_BUFFER_WAIT_TIMEOUT_US * 1000ULL)
     , m_uiPreviousBuffer(0)
     , m_uiCurrentTargetBuffer(0)
     , m_pClearData(nullptr)
     , m_uiDiffMapSize(0)
+    , m_DiffMapFormat(RF_DIFF_MAP_BYTE)
+    , m_uiBitMapPitch(0)
+    , m_bSuperBlockMap(false)
+    , m_uiMapOffset(0)
+    , m_bHashBlocks(false)
+    , m_bResetBlockHashes(true)
+    , m_clBlockHashes(NULL)
+    , m_bAppendTiles(bAppendTiles)
+    , m_uiMaxTileSize(0)
+    , m_bDetectMoves(false)
+    , m_uiPixelThreshold(0)
+    , m_uiBlockThreshold(0)
+    , m_uiMinChangedPixels(1)
+    , m_bApplyThresholds(false)
+    , m_bBlockVersions(false)
+    , m_bAccumulate(false)
+    , m_bResetBlockFrames(true)
+    , m_clBlockFrames(NULL)
+    , m_uiFrame(0)
+    , m_uiAcknowledgedFrame(0)
+    , m_uiReturnedFrame(0)
     , m_DiffMapImagekernel(NULL)
     , m_DiffMapBufferkernel(NULL)
+    , m_DiffMapHashImagekernel(NULL)
+    , m_DiffMapHashBufferkernel(NULL)
+    , m_DiffMapThresholdImagekernel(NULL)
+    , m_DiffMapThresholdBufferkernel(NULL)
+    , m_GatherTilesImagekernel(NULL)
+    , m_GatherTilesBufferkernel(NULL)
+    , m_DiffMapAccumulatekernel(NULL)
     , m_pContext(nullptr)
+    , m_ResultQueue(DEFAULT_PIPELINE_DEPTH - 1)
     , m_pMappedBuffer(nullptr)
+    , m_uiPendingCallbacks(0)
 {
     m_uiTotalBlockSize[0] = 16;
     m_uiTotalBlockSize[1] = 16;
@@ -177,7 +645,15 @@ RFEncoderDM::RFEncoderDM()
     m_localDim[0] = m_uiTotalBlockSize[0];
     m_localDim[1] = m_uiTotalBlockSize[1];
 
-    m_strEncoderName = "RF_ENCODER_DIFFERENCE";
+    m_uiSuperBlockSize[0] = 1;
+    m_uiSuperBlockSize[1] = 1;
+
+    m_uiNumSuperBlocks[0] = 0;
+    m_uiNumSuperBlocks[1] = 0;
+
+    memset(&m_DiffMapHeader, 0, sizeof(m_DiffMapHeader));
+
+    m_strEncoderName = (m_bAppendTiles) ? "RF_ENCODER_DIFFERENCE_TILES" : "RF_ENCODER_DIFFERENCE";
 }
 
 
@@ -193,6 +669,41 @@ RFEncoderDM::~RFEncoderDM()
         clReleaseKernel(m_DiffMapBufferkernel);
     }
 
+    if (m_DiffMapHashImagekernel != NULL)
+    {
+        clReleaseKernel(m_DiffMapHashImagekernel);
+    }
+
+    if (m_DiffMapHashBufferkernel != NULL)
+    {
+        clReleaseKernel(m_DiffMapHashBufferkernel);
+    }
+
+    if (m_DiffMapThresholdImagekernel != NULL)
+    {
+        clReleaseKernel(m_DiffMapThresholdImagekernel);
+    }
+
+    if (m_DiffMapThresholdBufferkernel != NULL)
+    {
+        clReleaseKernel(m_DiffMapThresholdBufferkernel);
+    }
+
+    if (m_GatherTilesImagekernel != NULL)
+    {
+        clReleaseKernel(m_GatherTilesImagekernel);
+    }
+
+    if (m_GatherTilesBufferkernel != NULL)
+    {
+        clReleaseKernel(m_GatherTilesBufferkernel);
+    }
+
+    if (m_DiffMapAccumulatekernel != NULL)
+    {
+        clReleaseKernel(m_DiffMapAccumulatekernel);
+    }
+
 	m_DiffMapProgram.Release();
 
     deleteBuffers();
@@ -241,61 +752,175 @@ RFStatus RFEncoderDM::init(const RFContextCL* pContextCL, const RFEncoderSetting
         m_bLockMappedBuffer = false;
     }
 
-    // For now only a block size of 64 is supported.
-    if ((m_uiTotalBlockSize[0] % 8) || (m_uiTotalBlockSize[1] % 8) || (m_uiTotalBlockSize[0] * m_uiTotalBlockSize[1] == 0))
+    unsigned int uiWaitTimeoutUs = DM_BUFFER_WAIT_TIMEOUT_US;
+
+    if (!pConfig->getParameterValue(RF_DIFF_ENCODER_WAIT_TIMEOUT, uiWaitTimeoutUs))
     {
-        return RF_STATUS_INVALID_ENCODER_PARAMETER;
+        uiWaitTimeoutUs = DM_BUFFER_WAIT_TIMEOUT_US;
     }
 
-    m_uiWidth = pConfig->getEncoderWidth();
-    m_uiHeight = pConfig->getEncoderHeight();
+    m_uiWaitTimeoutNs = uiWaitTimeoutUs * 1000ULL;
 
-    m_uiAlignedWidth = m_uiWidth;
-    m_uiAlignedHeight = m_uiHeight;
+    unsigned int uiDiffMapFormat = RF_DIFF_MAP_BYTE;
 
-    if (!createBuffers())
+    if (!pConfig->getParameterValue(RF_DIFF_ENCODER_MAP_FORMAT, uiDiffMapFormat))
     {
-        return RF_STATUS_OPENCL_FAIL;
+        uiDiffMapFormat = RF_DIFF_MAP_BYTE;
     }
 
-    // m_uiPreviousBuffer will strore the index of the previously encoded buffer. For the first frame we set it to the maximum.
-    // RFSession will use as first buffer the ResultBuffer with index 0. It is expected that the first encoded frame shows a
-    // difference on all blocks.
-    m_uiPreviousBuffer = m_pContext->getNumResultBuffers() - 1;
+    if (uiDiffMapFormat != RF_DIFF_MAP_BYTE && uiDiffMapFormat != RF_DIFF_MAP_BIT && uiDiffMapFormat != RF_DIFF_MAP_RLE && uiDiffMapFormat != RF_DIFF_MAP_RECT)
+    {
+        return RF_STATUS_INVALID_ENCODER_PARAMETER;
+    }
 
-    return GenerateCLProgramAndKernel();
-}
+    m_DiffMapFormat = static_cast<RFDiffMapFormat>(uiDiffMapFormat);
 
+    if (!pConfig->getParameterValue<bool>(RF_DIFF_ENCODER_SUPERBLOCK_MAP, m_bSuperBlockMap))
+    {
+        m_bSuperBlockMap = false;
+    }
 
-RFStatus RFEncoderDM::resize(unsigned int uiWidth, unsigned int uiHeight)
-{
-    if (!deleteBuffers())
+    if (!pConfig->getParameterValue<bool>(RF_DIFF_ENCODER_HASH_BLOCKS, m_bHashBlocks))
     {
-        return RF_STATUS_OPENCL_FAIL;
+        m_bHashBlocks = false;
     }
 
-    m_uiWidth = uiWidth;
-    m_uiHeight = uiHeight;
+    if (!pConfig->getParameterValue<bool>(RF_DIFF_ENCODER_MOVE_DETECTION, m_bDetectMoves))
+    {
+        m_bDetectMoves = false;
+    }
 
-    m_uiAlignedWidth = m_uiWidth;
-    m_uiAlignedHeight = m_uiHeight;
+    if (!pConfig->getParameterValue(RF_DIFF_ENCODER_PIXEL_THRESHOLD, m_uiPixelThreshold))
+    {
+        m_uiPixelThreshold = 0;
+    }
 
-    if (!createBuffers())
+    if (!pConfig->getParameterValue(RF_DIFF_ENCODER_BLOCK_THRESHOLD, m_uiBlockThreshold))
     {
-        return RF_STATUS_OPENCL_FAIL;
+        m_uiBlockThreshold = 0;
     }
 
-    return RF_STATUS_OK;
-}
+    if (!pConfig->getParameterValue(RF_DIFF_ENCODER_MIN_CHANGED_PIXELS, m_uiMinChangedPixels))
+    {
+        m_uiMinChangedPixels = 1;
+    }
+
+    if (m_uiMinChangedPixels == 0)
+    {
+        return RF_STATUS_INVALID_ENCODER_PARAMETER;
+    }
+
+    if (!pConfig->getParameterValue<bool>(RF_DIFF_ENCODER_ACCUMULATE, m_bAccumulate))
+    {
+        m_bAccumulate = false;
+    }
+
+    // A move is relative to the previous frame which the consumer might not have received.
+    if (m_bAccumulate && m_bDetectMoves)
+    {
+        return RF_STATUS_INVALID_ENCODER_PARAMETER;
+    }
+
+    if (!pConfig->getParameterValue<bool>(RF_DIFF_ENCODER_BLOCK_VERSIONS, m_bBlockVersions))
+    {
+        m_bBlockVersions = false;
+    }
+
+    // Accumulated blocks are found by their version.
+    m_bBlockVersions = m_bBlockVersions || m_bAccumulate;
+
+    m_uiFrame             = 0;
+    m_uiAcknowledgedFrame = 0;
+    m_uiReturnedFrame     = 0;
+
+    m_bApplyThresholds = (m_uiPixelThreshold > 0 || m_uiBlockThreshold > 0 || m_uiMinChangedPixels > 1);
+
+    // A block hash only tells if a block changed but not by how much.
+    if (m_bApplyThresholds && m_bHashBlocks)
+    {
+        return RF_STATUS_INVALID_ENCODER_PARAMETER;
+    }
+
+    // For now only a block size of 64 is supported.
+    if ((m_uiTotalBlockSize[0] % 8) || (m_uiTotalBlockSize[1] % 8) || (m_uiTotalBlockSize[0] * m_uiTotalBlockSize[1] == 0))
+    {
+        return RF_STATUS_INVALID_ENCODER_PARAMETER;
+    }
+
+    m_uiWidth = pConfig->getEncoderWidth();
+    m_uiHeight = pConfig->getEncoderHeight();
+
+    m_uiAlignedWidth = m_uiWidth;
+    m_uiAlignedHeight = m_uiHeight;
+
+    // One result buffer of the context is kept for the previous frame unless only its block hashes are needed.
+    m_uiNumTargetBuffers = m_pContext->getNumResultBuffers() - (m_bHashBlocks ? 0 : 1);
+
+    m_ResultQueue.reset(m_uiNumTargetBuffers);
+
+    // A host context has no OpenCL device and the result buffers are already located in system memory.
+    // Comparing them on the CPU avoids the transfer to the device and back.
+    if (m_pContext->getCtxType() == RFContextCL::RF_CTX_HOST && !m_pDiffMapHost)
+    {
+        m_pDiffMapHost.reset(new (std::nothrow) RFDiffMapHost);
+
+        if (!m_pDiffMapHost)
+        {
+            return RF_STATUS_MEMORY_FAIL;
+        }
+    }
+
+    // The kernels do not hash lines and columns.
+    if (m_bDetectMoves && !m_pDiffMapHost)
+    {
+        return RF_STATUS_INVALID_ENCODER_PARAMETER;
+    }
+
+    if (!createBuffers())
+    {
+        return RF_STATUS_OPENCL_FAIL;
+    }
+
+    // m_uiPreviousBuffer will strore the index of the previously encoded buffer. For the first frame we set it to the maximum.
+    // RFSession will use as first buffer the ResultBuffer with index 0. It is expected that the first encoded frame shows a
+    // difference on all blocks.
+    m_uiPreviousBuffer = m_pContext->getNumResultBuffers() - 1;
+
+    if (m_pDiffMapHost)
+    {
+        return RF_STATUS_OK;
+    }
+
+    return GenerateCLProgramAndKernel();
+}
+
+
+RFStatus RFEncoderDM::resize(unsigned int uiWidth, unsigned int uiHeight)
+{
+    if (!deleteBuffers())
+    {
+        return RF_STATUS_OPENCL_FAIL;
+    }
+
+    m_uiWidth = uiWidth;
+    m_uiHeight = uiHeight;
+
+    m_uiAlignedWidth = m_uiWidth;
+    m_uiAlignedHeight = m_uiHeight;
+
+    if (!createBuffers())
+    {
+        return RF_STATUS_OPENCL_FAIL;
+    }
+
+    return RF_STATUS_OK;
+}
 
 
 bool RFEncoderDM::createBuffers()
 {
     cl_int nStatus;
 
-    m_uiNumLocalPixels[0] = m_uiTotalBlockSize[0] / static_cast<unsigned int>(m_localDim[0]);
-    m_uiNumLocalPixels[1] = m_uiTotalBlockSize[1] / static_cast<unsigned int>(m_localDim[1]);
-
     unsigned int uiAlignedWidth = static_cast<unsigned int>(ceil(static_cast<float>(m_uiWidth) / static_cast<float>(m_uiTotalBlockSize[0]))) * m_uiTotalBlockSize[0];
     unsigned int uiAlignedHeight = static_cast<unsigned int>(ceil(static_cast<float>(m_uiHeight) / static_cast<float>(m_uiTotalBlockSize[1]))) * m_uiTotalBlockSize[1];
 
@@ -303,28 +928,132 @@ bool RFEncoderDM::createBuffers()
     m_uiOutputWidth = uiAlignedWidth / m_uiTotalBlockSize[0];
     m_uiOutputHeight = uiAlignedHeight / m_uiTotalBlockSize[1];
 
-    // Create buffers to store diff map.
-    m_uiDiffMapSize = (m_uiOutputWidth * m_uiOutputHeight);
+    if (m_pDiffMapHost)
+    {
+        if (!m_pDiffMapHost->init(m_uiWidth, m_uiHeight, m_uiTotalBlockSize[0], m_uiTotalBlockSize[1], m_DiffMapFormat, m_bHashBlocks, m_bDetectMoves,
+                                  m_bAppendTiles))
+        {
+            return false;
+        }
+
+        m_pDiffMapHost->setThresholds(m_uiPixelThreshold, m_uiBlockThreshold, m_uiMinChangedPixels);
+        m_pDiffMapHost->setBlockFrames(m_bBlockVersions);
+
+        // RFDiffMapHost writes the header, the superblock map and the diff map in the requested format. The size of a run
+        // length map or rectangle list varies.
+        m_uiDiffMapSize = m_pDiffMapHost->getMaxDiffMapSize();
+        m_uiMapOffset   = m_pDiffMapHost->getMapOffset();
+
+        // The diff map is written by the CPU, no OpenCL buffers are needed.
+        for (unsigned int i = 0; i < m_uiNumTargetBuffers; ++i)
+        {
+            DMDiffMapBuffer  TargetBuffer;
+
+            memset(&TargetBuffer, 0, sizeof(TargetBuffer));
+
+            TargetBuffer.pSysmemBuffer = new (std::nothrow) char[m_uiDiffMapSize];
+
+            if (!TargetBuffer.pSysmemBuffer)
+            {
+                return false;
+            }
+
+            memset(TargetBuffer.pSysmemBuffer, 0, m_uiDiffMapSize);
+
+            m_TargetBuffers.push_back(TargetBuffer);
+        }
+
+        return true;
+    }
+
+    // The kernels write the same layout as RFDiffMapHost: the header, the superblock map and a byte or a bit map.
+    // A run length map or a rectangle list is created from the bit map by getEncodedFrame.
+    m_uiSuperBlockSize[0] = RFDiffMapHost::getSuperBlockSize(m_uiTotalBlockSize[0]) / m_uiTotalBlockSize[0];
+    m_uiSuperBlockSize[1] = RFDiffMapHost::getSuperBlockSize(m_uiTotalBlockSize[1]) / m_uiTotalBlockSize[1];
+
+    m_uiNumSuperBlocks[0] = (m_uiOutputWidth  + m_uiSuperBlockSize[0] - 1) / m_uiSuperBlockSize[0];
+    m_uiNumSuperBlocks[1] = (m_uiOutputHeight + m_uiSuperBlockSize[1] - 1) / m_uiSuperBlockSize[1];
+
+    m_uiMapOffset = RFDiffMapHost::getMapOffset(m_uiNumSuperBlocks[0], m_uiNumSuperBlocks[1]);
+
+    unsigned int uiMapSize = 0;
+
+    if (m_DiffMapFormat == RF_DIFF_MAP_BYTE)
+    {
+        m_uiBitMapPitch = 0;
+        uiMapSize       = m_uiOutputWidth * m_uiOutputHeight;
+    }
+    else
+    {
+        if (m_DiffMapFormat == RF_DIFF_MAP_RLE && m_uiOutputWidth > 0xFFFF)
+        {
+            return false;
+        }
+
+        m_uiBitMapPitch = RFDiffMapHost::getBitMapPitch(m_uiOutputWidth);
+        uiMapSize       = m_uiBitMapPitch * m_uiOutputHeight;
+    }
+
+    m_uiDiffMapSize = m_uiMapOffset + uiMapSize;
+    m_uiMaxTileSize = 0;
+
+    if (m_bAppendTiles)
+    {
+        // The tile list and the pixels of the tiles start behind the map aligned to 32 bit.
+        m_uiDiffMapSize = ((m_uiDiffMapSize + 3) / 4) * 4;
+        m_uiMaxTileSize = m_uiOutputWidth * m_uiOutputHeight * (sizeof(RFDiffTile) + m_uiTotalBlockSize[0] * m_uiTotalBlockSize[1] * 4);
+    }
+
+    // Written to the start of the GPU buffer before each diff. The kernels only update the number of changed blocks.
+    m_DiffMapHeader.uiNumChangedBlocks    = 0;
+    m_DiffMapHeader.uiNumSuperBlocksX     = m_uiNumSuperBlocks[0];
+    m_DiffMapHeader.uiNumSuperBlocksY     = m_uiNumSuperBlocks[1];
+    m_DiffMapHeader.uiSuperBlockWidth     = m_uiSuperBlockSize[0] * m_uiTotalBlockSize[0];
+    m_DiffMapHeader.uiSuperBlockHeight    = m_uiSuperBlockSize[1] * m_uiTotalBlockSize[1];
+    m_DiffMapHeader.uiSuperBlockMapOffset = sizeof(RFDiffMapHeader);
+    m_DiffMapHeader.uiMapOffset           = m_uiMapOffset;
+    m_DiffMapHeader.uiMapSize             = uiMapSize;
+    m_DiffMapHeader.uiNumMoveRects        = 0;
+    m_DiffMapHeader.uiMoveRectOffset      = 0;
+    m_DiffMapHeader.uiNumTiles            = 0;
+    m_DiffMapHeader.uiTileOffset          = (m_bAppendTiles) ? m_uiDiffMapSize : 0;
+
+    // The converted map is followed by the tiles aligned to 32 bit.
+    if (m_DiffMapFormat == RF_DIFF_MAP_RLE)
+    {
+        m_EncodedMap.resize(m_uiMapOffset + RFDiffMapHost::getMaxRunLengthSize(m_uiOutputWidth, m_uiOutputHeight) + 3 + m_uiMaxTileSize);
+    }
+    else if (m_DiffMapFormat == RF_DIFF_MAP_RECT)
+    {
+        m_EncodedMap.resize(m_uiMapOffset + RFDiffMapHost::getMaxRectListSize(m_uiOutputWidth, m_uiOutputHeight) + 3 + m_uiMaxTileSize);
+    }
+
+    // One work group per block. Block sizes are multiples of 8 but not necessarily of 16.
+    m_localDim[0] = (m_uiTotalBlockSize[0] % 16) ? 8 : 16;
+    m_localDim[1] = (m_uiTotalBlockSize[1] % 16) ? 8 : 16;
+
+    m_uiNumLocalPixels[0] = m_uiTotalBlockSize[0] / static_cast<unsigned int>(m_localDim[0]);
+    m_uiNumLocalPixels[1] = m_uiTotalBlockSize[1] / static_cast<unsigned int>(m_localDim[1]);
 
     m_globalDim[0] = uiAlignedWidth / m_uiNumLocalPixels[0];
     m_globalDim[1] = uiAlignedHeight / m_uiNumLocalPixels[1];
 
-    m_localDim[0] = m_localDim[0];
-    m_localDim[1] = m_localDim[1];
-
     for (unsigned int i = 0; i < m_uiNumTargetBuffers; ++i)
     {
         DMDiffMapBuffer  TargetBuffer;
 
+        TargetBuffer.uiSize = m_uiDiffMapSize;
+        TargetBuffer.uiFrame = 0;
+
         // Create pinned OpenCL buffers that can be accessed by the application to retreive the diff map.
-        TargetBuffer.clPageLockedBuffer = clCreateBuffer(m_pContext->getContext(), CL_MEM_WRITE_ONLY | CL_MEM_ALLOC_HOST_PTR, m_uiDiffMapSize, nullptr, &nStatus);
+        TargetBuffer.clPageLockedBuffer = clCreateBuffer(m_pContext->getContext(), CL_MEM_WRITE_ONLY | CL_MEM_ALLOC_HOST_PTR, m_uiDiffMapSize + m_uiMaxTileSize, nullptr, &nStatus);
         if (nStatus != CL_SUCCESS)
         {
             break;
         }
 
         // Get address of pinned OpenCL buffers.
-        TargetBuffer.pSysmemBuffer = static_cast<char*>(clEnqueueMapBuffer(m_pContext->getCmdQueue(), TargetBuffer.clPageLockedBuffer, CL_TRUE, CL_MAP_READ, 0, m_uiDiffMapSize,
+        TargetBuffer.pSysmemBuffer = static_cast<char*>(clEnqueueMapBuffer(m_pContext->getCmdQueue(), TargetBuffer.clPageLockedBuffer, CL_TRUE, CL_MAP_READ, 0, m_uiDiffMapSize + m_uiMaxTileSize,
                                                         0, nullptr, nullptr, &nStatus));
         if (nStatus != CL_SUCCESS)
         {
@@ -332,7 +1061,7 @@ bool RFEncoderDM::createBuffers()
         }
 
         // Create buffer in GPU mem that will store the diff map computed by the kernel.
-        TargetBuffer.clGPUBuffer = clCreateBuffer(m_pContext->getContext(), CL_MEM_READ_WRITE, m_uiDiffMapSize, nullptr, &nStatus);
+        TargetBuffer.clGPUBuffer = clCreateBuffer(m_pContext->getContext(), CL_MEM_READ_WRITE, m_uiDiffMapSize + m_uiMaxTileSize, nullptr, &nStatus);
         if (nStatus != CL_SUCCESS)
         {
             break;
@@ -353,6 +1082,30 @@ bool RFEncoderDM::createBuffers()
         return false;
     }
 
+    if (m_bHashBlocks)
+    {
+        // One 64 bit hash per block. The content is undefined until the first frame was hashed.
+        m_clBlockHashes = clCreateBuffer(m_pContext->getContext(), CL_MEM_READ_WRITE, m_uiOutputWidth * m_uiOutputHeight * sizeof(cl_ulong), nullptr, &nStatus);
+        if (nStatus != CL_SUCCESS)
+        {
+            return false;
+        }
+
+        m_bResetBlockHashes = true;
+    }
+
+    if (m_bBlockVersions)
+    {
+        // One frame number per block. The content is undefined until the first frame was accumulated.
+        m_clBlockFrames = clCreateBuffer(m_pContext->getContext(), CL_MEM_READ_WRITE, m_uiOutputWidth * m_uiOutputHeight * sizeof(cl_uint), nullptr, &nStatus);
+        if (nStatus != CL_SUCCESS)
+        {
+            return false;
+        }
+
+        m_bResetBlockFrames = true;
+    }
+
     clFinish(m_pContext->getCmdQueue());
 
     return true;
@@ -362,12 +1115,19 @@ bool RFEncoderDM::createBuffers()
 bool RFEncoderDM::deleteBuffers()
 {
     // Release events that are still in use.
-    while (m_ResultQueue.size() > 0)
+    const DMDiffMapBuffer* pElem = nullptr;
+
+    while (m_ResultQueue.pop(pElem))
     {
-        const DMDiffMapBuffer* pElem = m_ResultQueue.pop();
+        if (pElem->clDiffFinished)
+        {
+            clReleaseEvent(pElem->clDiffFinished);
+        }
 
-        clReleaseEvent(pElem->clDiffFinished);
-        clReleaseEvent(pElem->clDMAFinished);
+        if (pElem->clDMAFinished)
+        {
+            clReleaseEvent(pElem->clDMAFinished);
+        }
     }
 
     if (!m_pContext)
@@ -385,11 +1145,22 @@ bool RFEncoderDM::deleteBuffers()
         clFinish(m_pContext->getDMAQueue());
     }
 
+    // All commands have finished but the callbacks might still be executing.
+    while (m_uiPendingCallbacks > 0)
+    {
+        rfYield();
+    }
+
     cl_int nStatus = CL_SUCCESS;
 
     for (auto& tb : m_TargetBuffers)
     {
-        if (tb.pSysmemBuffer)
+        if (m_pDiffMapHost)
+        {
+            delete [] tb.pSysmemBuffer;
+            tb.pSysmemBuffer = nullptr;
+        }
+        else if (tb.pSysmemBuffer)
         {
             nStatus |= clEnqueueUnmapMemObject(m_pContext->getCmdQueue(), tb.clPageLockedBuffer, tb.pSysmemBuffer, 0, nullptr, nullptr);
             clFinish(m_pContext->getCmdQueue());
@@ -412,19 +1183,30 @@ bool RFEncoderDM::deleteBuffers()
 
     m_TargetBuffers.clear();
 
-    clFinish(m_pContext->getCmdQueue());
+    if (m_clBlockHashes)
+    {
+        nStatus |= clReleaseMemObject(m_clBlockHashes);
+        m_clBlockHashes = NULL;
+    }
+
+    if (m_clBlockFrames)
+    {
+        nStatus |= clReleaseMemObject(m_clBlockFrames);
+        m_clBlockFrames = NULL;
+    }
+
+    if (m_pContext->getCmdQueue())
+    {
+        clFinish(m_pContext->getCmdQueue());
+    }
 
     return (nStatus == CL_SUCCESS);
 }
 
 
-RFStatus RFEncoderDM::encode(unsigned int uiBufferIdx, bool bUseInputImages)
+RFStatus RFEncoderDM::acquireTargetBuffer(DMDiffMapBuffer*& pBuffer)
 {
-    cl_mem          clCurrentImage;
-    cl_mem          clPrevImage;
-    unsigned int    uiFailCount = 0;
-
-    DMDiffMapBuffer* pCurrentBuffer = &m_TargetBuffers[m_uiCurrentTargetBuffer];
+    pBuffer = &m_TargetBuffers[m_uiCurrentTargetBuffer];
 
     // m_bLockMappedBuffer should only be set if a separate reader thread is used. In this case a call to RFEncoderDM::encode
     // is possible while the reader thread is still working on the buffer returned by RFEncoderDM::getEncodedFrame.
@@ -433,16 +1215,72 @@ RFStatus RFEncoderDM::encode(unsigned int uiBufferIdx, bool bUseInputImages)
     // This differentiation needs to be done to allow the single threading case to submit 2 frames before calling RFEncoderDM::getEncodedFrame.
     // This enables RFEncoderDM::getEncodedFrame to return without waiting for the current encode task since it can return the
     // result of the previously submitted task.
-    while ((m_bLockMappedBuffer && (pCurrentBuffer == m_pMappedBuffer)) || m_ResultQueue.size() >= m_uiNumTargetBuffers)
+    // Without a separate reader thread nobody can release a buffer while we wait.
+    // The buffers are used in the order they are read. The next buffer is the one that was released first, it can only
+    // be queued or locked if no other buffer is free.
+    const uint64_t uiTimeoutNs = m_bLockMappedBuffer ? m_uiWaitTimeoutNs : 0;
+    const uint64_t uiStart     = rfGetTimeNs();
+
+    for (;;)
     {
-        // Give other threads the chance to run.
-        Sleep(0);
-        ++uiFailCount;
+        // Read the count before checking the buffers, a buffer released after the check will change it.
+        const uint64_t uiCount = m_BufferReleasedSignal.getCount();
 
-        if (uiFailCount > 100)
+        if (!(m_bLockMappedBuffer && (pBuffer == m_pMappedBuffer)) && m_ResultQueue.size() < m_uiNumTargetBuffers)
+        {
+            return RF_STATUS_OK;
+        }
+
+        const uint64_t uiElapsedNs = rfGetTimeNs() - uiStart;
+
+        if (uiElapsedNs >= uiTimeoutNs)
         {
             return RF_STATUS_QUEUE_FULL;
         }
+
+        m_BufferReleasedSignal.wait(uiCount, uiTimeoutNs - uiElapsedNs);
+    }
+}
+
+
+RFStatus RFEncoderDM::encode(unsigned int uiBufferIdx, bool bUseInputImages)
+{
+    cl_mem          clCurrentImage;
+    cl_mem          clPrevImage;
+
+    DMDiffMapBuffer* pCurrentBuffer = nullptr;
+
+    RFStatus rfStatus = acquireTargetBuffer(pCurrentBuffer);
+
+    if (rfStatus != RF_STATUS_OK)
+    {
+        return rfStatus;
+    }
+
+    pCurrentBuffer->uiFrame = ++m_uiFrame;
+
+    if (m_pDiffMapHost)
+    {
+        rfStatus = encodeHost(uiBufferIdx, pCurrentBuffer);
+
+        if (rfStatus != RF_STATUS_OK)
+        {
+            return rfStatus;
+        }
+
+        // The diff map is complete, there is nothing to wait for.
+        pCurrentBuffer->clDiffFinished = NULL;
+        pCurrentBuffer->clDMAFinished  = NULL;
+
+        m_ResultQueue.push(pCurrentBuffer);
+
+        m_FrameReadySignal.notify();
+
+        m_uiPreviousBuffer = uiBufferIdx;
+
+        m_uiCurrentTargetBuffer = (m_uiCurrentTargetBuffer + 1) % m_uiNumTargetBuffers;
+
+        return RF_STATUS_OK;
     }
 
     cl_kernel diffMapKernel;
@@ -450,36 +1288,136 @@ RFStatus RFEncoderDM::encode(unsigned int uiBufferIdx, bool bUseInputImages)
     {
         m_pContext->getInputImage(uiBufferIdx, &clCurrentImage);
         m_pContext->getInputImage(m_uiPreviousBuffer, &clPrevImage);
-        diffMapKernel = m_DiffMapImagekernel;
+        diffMapKernel = (m_bHashBlocks) ? m_DiffMapHashImagekernel : (m_bApplyThresholds) ? m_DiffMapThresholdImagekernel : m_DiffMapImagekernel;
     }
     else
     {
         m_pContext->getResultBuffer(uiBufferIdx, &clCurrentImage);
         m_pContext->getResultBuffer(m_uiPreviousBuffer, &clPrevImage);
-        diffMapKernel = m_DiffMapBufferkernel;
+        diffMapKernel = (m_bHashBlocks) ? m_DiffMapHashBufferkernel : (m_bApplyThresholds) ? m_DiffMapThresholdBufferkernel : m_DiffMapBufferkernel;
+    }
+
+    if (m_bHashBlocks)
+    {
+        // The hash kernels read the hashes of the previous frame from m_clBlockHashes instead of the previous image.
+        cl_uint uiResetHashes = m_bResetBlockHashes ? 1 : 0;
+
+        SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 1, sizeof(cl_mem),       &m_clBlockHashes));
+        SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 13, sizeof(cl_uint),     &uiResetHashes));
+
+        m_bResetBlockHashes = false;
+    }
+    else
+    {
+        SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 1, sizeof(cl_mem),       &clPrevImage));
+
+        if (m_bApplyThresholds)
+        {
+            SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 13, sizeof(unsigned int), &m_uiPixelThreshold));
+            SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 14, sizeof(unsigned int), &m_uiBlockThreshold));
+            SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 15, sizeof(unsigned int), &m_uiMinChangedPixels));
+        }
     }
 
     SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 0, sizeof(cl_mem),       &clCurrentImage));
-    SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 1, sizeof(cl_mem),       &clPrevImage));
     SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 2, sizeof(cl_mem),       &(pCurrentBuffer->clGPUBuffer)));
     SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 3, sizeof(unsigned int), &m_uiWidth));
     SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 4, sizeof(unsigned int), &m_uiHeight));
     SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 5, sizeof(unsigned int), &m_uiTotalBlockSize[0]));
     SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 6, sizeof(unsigned int), &m_uiTotalBlockSize[1]));
-
+    SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 7, sizeof(unsigned int), &m_uiBitMapPitch));
+    SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 8, sizeof(unsigned int), &m_DiffMapHeader.uiSuperBlockMapOffset));
+    SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 9, sizeof(unsigned int), &m_uiMapOffset));
+    SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 10, sizeof(unsigned int), &m_uiSuperBlockSize[0]));
+    SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 11, sizeof(unsigned int), &m_uiSuperBlockSize[1]));
+    SAFE_CALL_CL(clSetKernelArg(diffMapKernel, 12, sizeof(unsigned int), &m_uiNumSuperBlocks[0]));
+
+    // m_DiffMapHeader does not change while the command can be pending. Only resize changes it after all commands finished.
     char cPattern = 0;
-    SAFE_CALL_CL(clEnqueueFillBuffer(m_pContext->getCmdQueue(), pCurrentBuffer->clGPUBuffer, &cPattern, sizeof(cPattern), 0, m_uiDiffMapSize, 0, nullptr, nullptr));
-    SAFE_CALL_CL(clEnqueueNDRangeKernel(m_pContext->getCmdQueue(), diffMapKernel, 2, nullptr, m_globalDim, m_localDim, 0, nullptr, &(pCurrentBuffer->clDiffFinished)));
+    SAFE_CALL_CL(clEnqueueWriteBuffer(m_pContext->getCmdQueue(), pCurrentBuffer->clGPUBuffer, CL_FALSE, 0, sizeof(m_DiffMapHeader), &m_DiffMapHeader, 0, nullptr, nullptr));
+    SAFE_CALL_CL(clEnqueueFillBuffer(m_pContext->getCmdQueue(), pCurrentBuffer->clGPUBuffer, &cPattern, sizeof(cPattern), sizeof(m_DiffMapHeader),
+                                     m_uiDiffMapSize - sizeof(m_DiffMapHeader), 0, nullptr, nullptr));
+    // The pattern is copied when the command is enqueued.
+    SAFE_CALL_CL(clEnqueueFillBuffer(m_pContext->getCmdQueue(), pCurrentBuffer->clGPUBuffer, &m_uiFrame, sizeof(m_uiFrame), offsetof(RFDiffMapHeader, uiVersion),
+                                     sizeof(m_uiFrame), 0, nullptr, nullptr));
+
+    // The accumulate and the gather kernel read the map written by the diff kernel. clDiffFinished signals the end of the last kernel.
+    cl_event* pDiffFinished = &(pCurrentBuffer->clDiffFinished);
+
+    SAFE_CALL_CL(clEnqueueNDRangeKernel(m_pContext->getCmdQueue(), diffMapKernel, 2, nullptr, m_globalDim, m_localDim, 0, nullptr,
+                                        (m_bBlockVersions || m_bAppendTiles) ? nullptr : pDiffFinished));
+
+    if (m_bBlockVersions)
+    {
+        // One work item per block, the kernel uses the same group ids as the diff kernel. Without accumulation no block
+        // changed after the acknowledged frame and only the versions are updated.
+        cl_uint uiResetFrames  = m_bResetBlockFrames ? 1 : 0;
+        cl_uint uiAckFrame     = m_bAccumulate ? m_uiAcknowledgedFrame : UINT_MAX;
+        size_t  globalDim[2]   = { m_uiOutputWidth, m_uiOutputHeight };
+        size_t  localDim[2]    = { 1, 1 };
+
+        SAFE_CALL_CL(clSetKernelArg(m_DiffMapAccumulatekernel, 0, sizeof(cl_mem),        &(pCurrentBuffer->clGPUBuffer)));
+        SAFE_CALL_CL(clSetKernelArg(m_DiffMapAccumulatekernel, 1, sizeof(cl_mem),        &m_clBlockFrames));
+        SAFE_CALL_CL(clSetKernelArg(m_DiffMapAccumulatekernel, 2, sizeof(unsigned int),  &m_uiFrame));
+        SAFE_CALL_CL(clSetKernelArg(m_DiffMapAccumulatekernel, 3, sizeof(cl_uint),       &uiAckFrame));
+        SAFE_CALL_CL(clSetKernelArg(m_DiffMapAccumulatekernel, 4, sizeof(cl_uint),       &uiResetFrames));
+        SAFE_CALL_CL(clSetKernelArg(m_DiffMapAccumulatekernel, 5, sizeof(unsigned int),  &m_uiBitMapPitch));
+        SAFE_CALL_CL(clSetKernelArg(m_DiffMapAccumulatekernel, 6, sizeof(unsigned int),  &m_DiffMapHeader.uiSuperBlockMapOffset));
+        SAFE_CALL_CL(clSetKernelArg(m_DiffMapAccumulatekernel, 7, sizeof(unsigned int),  &m_uiMapOffset));
+        SAFE_CALL_CL(clSetKernelArg(m_DiffMapAccumulatekernel, 8, sizeof(unsigned int),  &m_uiSuperBlockSize[0]));
+        SAFE_CALL_CL(clSetKernelArg(m_DiffMapAccumulatekernel, 9, sizeof(unsigned int),  &m_uiSuperBlockSize[1]));
+        SAFE_CALL_CL(clSetKernelArg(m_DiffMapAccumulatekernel, 10, sizeof(unsigned int), &m_uiNumSuperBlocks[0]));
+
+        SAFE_CALL_CL(clEnqueueNDRangeKernel(m_pContext->getCmdQueue(), m_DiffMapAccumulatekernel, 2, nullptr, globalDim, localDim, 0, nullptr,
+                                            (m_bAppendTiles) ? nullptr : pDiffFinished));
+
+        m_bResetBlockFrames = false;
+    }
+
+    if (m_bAppendTiles)
+    {
+        cl_kernel gatherKernel = (bUseInputImages) ? m_GatherTilesImagekernel : m_GatherTilesBufferkernel;
+        cl_uint   uiNumTilesOffset = offsetof(RFDiffMapHeader, uiNumTiles);
+
+        SAFE_CALL_CL(clSetKernelArg(gatherKernel, 0, sizeof(cl_mem),       &clCurrentImage));
+        SAFE_CALL_CL(clSetKernelArg(gatherKernel, 1, sizeof(cl_mem),       &(pCurrentBuffer->clGPUBuffer)));
+        SAFE_CALL_CL(clSetKernelArg(gatherKernel, 2, sizeof(unsigned int), &m_uiWidth));
+        SAFE_CALL_CL(clSetKernelArg(gatherKernel, 3, sizeof(unsigned int), &m_uiHeight));
+        SAFE_CALL_CL(clSetKernelArg(gatherKernel, 4, sizeof(unsigned int), &m_uiTotalBlockSize[0]));
+        SAFE_CALL_CL(clSetKernelArg(gatherKernel, 5, sizeof(unsigned int), &m_uiTotalBlockSize[1]));
+        SAFE_CALL_CL(clSetKernelArg(gatherKernel, 6, sizeof(unsigned int), &m_uiBitMapPitch));
+        SAFE_CALL_CL(clSetKernelArg(gatherKernel, 7, sizeof(unsigned int), &m_uiMapOffset));
+        SAFE_CALL_CL(clSetKernelArg(gatherKernel, 8, sizeof(unsigned int), &m_DiffMapHeader.uiTileOffset));
+        SAFE_CALL_CL(clSetKernelArg(gatherKernel, 9, sizeof(cl_uint),      &uiNumTilesOffset));
+
+        SAFE_CALL_CL(clEnqueueNDRangeKernel(m_pContext->getCmdQueue(), gatherKernel, 2, nullptr, m_globalDim, m_localDim, 0, nullptr, pDiffFinished));
+    }
+
+    // Only the header and the map are transferred. getEncodedFrame transfers the used tiles.
     SAFE_CALL_CL(clEnqueueCopyBuffer(m_pContext->getCmdQueue(), pCurrentBuffer->clGPUBuffer, pCurrentBuffer->clPageLockedBuffer, 0, 0, m_uiDiffMapSize, 0, nullptr, &pCurrentBuffer->clDMAFinished));
 
+    // Wake up a reader waiting in waitForEncodedFrame once the diff map is in the page locked buffer.
+    ++m_uiPendingCallbacks;
+
+    if (clSetEventCallback(pCurrentBuffer->clDMAFinished, CL_COMPLETE, onDiffMapTransferred, this) != CL_SUCCESS)
+    {
+        --m_uiPendingCallbacks;
+    }
+
     // Now we can be sure to get a Diff Map -> Store buffer in queue to be retrieved by getEncodedFrame.
     m_ResultQueue.push(pCurrentBuffer);
 
+    // The callback might have run before the buffer was in the queue.
+    m_FrameReadySignal.notify();
+
     clFlush(m_pContext->getCmdQueue());
 
     if (bUseInputImages)
     {
-        const_cast<RFContextCL*>(m_pContext)->releaseCLMemObj(m_pContext->getDMAQueue(), m_uiPreviousBuffer, 1, &(pCurrentBuffer->clDiffFinished));
+        // The hash kernels do not read the previous image, the current one can be released once it was hashed.
+        const unsigned int uiReleaseIdx = (m_bHashBlocks) ? uiBufferIdx : m_uiPreviousBuffer;
+
+        const_cast<RFContextCL*>(m_pContext)->releaseCLMemObj(m_pContext->getDMAQueue(), uiReleaseIdx, 1, &(pCurrentBuffer->clDiffFinished));
     }
 
     m_uiPreviousBuffer = uiBufferIdx;
@@ -490,33 +1428,194 @@ RFStatus RFEncoderDM::encode(unsigned int uiBufferIdx, bool bUseInputImages)
 }
 
 
+RFStatus RFEncoderDM::encodeHost(unsigned int uiBufferIdx, DMDiffMapBuffer* pTargetBuffer)
+{
+    void* pCurrentImage = nullptr;
+    void* pPrevImage    = nullptr;
+
+    m_pContext->getResultBuffer(uiBufferIdx, pCurrentImage);
+
+    // RFDiffMapHost keeps the block hashes of the previous frame itself.
+    if (!m_bHashBlocks)
+    {
+        m_pContext->getResultBuffer(m_uiPreviousBuffer, pPrevImage);
+
+        if (!pPrevImage)
+        {
+            return RF_STATUS_INVALID_INDEX;
+        }
+    }
+
+    if (!pCurrentImage || !pTargetBuffer->pSysmemBuffer)
+    {
+        return RF_STATUS_INVALID_INDEX;
+    }
+
+    // The result buffers use the aligned width of the encoder as pitch.
+    pTargetBuffer->uiSize = m_pDiffMapHost->compute(static_cast<const unsigned char*>(pCurrentImage), static_cast<const unsigned char*>(pPrevImage),
+                                                    m_uiAlignedWidth * 4, reinterpret_cast<unsigned char*>(pTargetBuffer->pSysmemBuffer),
+                                                    pTargetBuffer->uiFrame, (m_bAccumulate) ? m_uiAcknowledgedFrame : UINT_MAX);
+
+    return RF_STATUS_OK;
+}
+
+
 RFStatus RFEncoderDM::getEncodedFrame(unsigned int& uiSize, void* &pBitStream)
 {
-    if (m_ResultQueue.size() == 0)
+    const DMDiffMapBuffer* pEncodedBuffer = nullptr;
+
+    if (!m_ResultQueue.pop(pEncodedBuffer))
     {
         return RF_STATUS_NO_ENCODED_FRAME;
     }
 
-    const DMDiffMapBuffer* pEncodedBuffer = m_ResultQueue.pop();
-
     m_pMappedBuffer = pEncodedBuffer;
 
-    // Wait until transfer has completed.
-    clWaitForEvents(1, &pEncodedBuffer->clDMAFinished);
-    clReleaseEvent(pEncodedBuffer->clDMAFinished);
+    m_uiReturnedFrame = pEncodedBuffer->uiFrame;
+
+    // A slot in m_ResultQueue is free again. Wake up encode if it is waiting for a buffer.
+    m_BufferReleasedSignal.notify();
+
+    // Wait until transfer has completed. Diff maps computed on the host have no events.
+    if (pEncodedBuffer->clDMAFinished)
+    {
+        clWaitForEvents(1, &pEncodedBuffer->clDMAFinished);
+        clReleaseEvent(pEncodedBuffer->clDMAFinished);
+    }
 
     // Just release event, no sync is required sine m_clDMAFinished can only finish if m_clDiffFinished is finished.
-    clReleaseEvent(pEncodedBuffer->clDiffFinished);
+    if (pEncodedBuffer->clDiffFinished)
+    {
+        clReleaseEvent(pEncodedBuffer->clDiffFinished);
+    }
+
+    if (!pEncodedBuffer->pSysmemBuffer)
+    {
+        return RF_STATUS_NO_ENCODED_FRAME;
+    }
+
+    char*        pDiffMap      = pEncodedBuffer->pSysmemBuffer;
+    unsigned int uiDiffMapSize = pEncodedBuffer->uiSize;
+
+    if (!m_pDiffMapHost && m_bAppendTiles)
+    {
+        RFStatus rfStatus = transferTiles(pEncodedBuffer, uiDiffMapSize);
+
+        if (rfStatus != RF_STATUS_OK)
+        {
+            return rfStatus;
+        }
+    }
+
+    if (!m_pDiffMapHost && (m_DiffMapFormat == RF_DIFF_MAP_RLE || m_DiffMapFormat == RF_DIFF_MAP_RECT))
+    {
+        // The kernels wrote a bit map. The converted map stays valid until the next call of getEncodedFrame like the mapped buffer.
+        uiDiffMapSize = convertBitMap(reinterpret_cast<const unsigned char*>(pDiffMap));
+        pDiffMap      = reinterpret_cast<char*>(m_EncodedMap.data());
+    }
 
-    if (pEncodedBuffer->pSysmemBuffer)
+    // Without superblock map only the diff map behind the header is returned. The moves and tiles are only accessible through the header.
+    if (!m_bSuperBlockMap && !m_bDetectMoves && !m_bAppendTiles)
     {
-        pBitStream = pEncodedBuffer->pSysmemBuffer;
-        uiSize = m_uiDiffMapSize;
+        pDiffMap      += m_uiMapOffset;
+        uiDiffMapSize -= m_uiMapOffset;
+    }
+
+    pBitStream = pDiffMap;
+    uiSize     = uiDiffMapSize;
+
+    return RF_STATUS_OK;
+}
+
+
+unsigned int RFEncoderDM::convertBitMap(const unsigned char* pDiffMap)
+{
+    RFDiffMapHeader Header;
+
+    memcpy(&Header, pDiffMap, sizeof(Header));
+
+    // Keep the superblock map. The header is updated with the size of the converted map.
+    memcpy(m_EncodedMap.data(), pDiffMap, m_uiMapOffset);
+
+    const unsigned char* pBitMap = pDiffMap + m_uiMapOffset;
+    unsigned char*       pMap    = m_EncodedMap.data() + m_uiMapOffset;
+
+    // The bit map does not need to be scanned if nothing changed.
+    if (m_DiffMapFormat == RF_DIFF_MAP_RLE)
+    {
+        if (Header.uiNumChangedBlocks > 0)
+        {
+            Header.uiMapSize = RFDiffMapHost::encodeRunLength(pBitMap, m_uiOutputWidth, m_uiOutputHeight, pMap);
+        }
+        else
+        {
+            Header.uiMapSize = 2 * m_uiOutputHeight;
+            memset(pMap, 0, Header.uiMapSize);
+        }
+    }
+    else
+    {
+        Header.uiMapSize = 0;
+
+        if (Header.uiNumChangedBlocks > 0)
+        {
+            Header.uiMapSize = RFDiffMapHost::encodeRects(pBitMap, m_uiOutputWidth, m_uiOutputHeight, m_uiTotalBlockSize[0], m_uiTotalBlockSize[1],
+                                                          m_uiWidth, m_uiHeight, reinterpret_cast<RFDiffRect*>(pMap));
+        }
+    }
+
+    unsigned int uiSize = m_uiMapOffset + Header.uiMapSize;
 
+    if (m_bAppendTiles)
+    {
+        // transferTiles placed the tiles behind the bit map.
+        const unsigned int uiTilesSize = Header.uiNumTiles * (sizeof(RFDiffTile) + m_uiTotalBlockSize[0] * m_uiTotalBlockSize[1] * 4);
+
+        Header.uiTileOffset = ((uiSize + 3) / 4) * 4;
+
+        memset(m_EncodedMap.data() + uiSize, 0, Header.uiTileOffset - uiSize);
+        memcpy(m_EncodedMap.data() + Header.uiTileOffset, pDiffMap + m_uiDiffMapSize, uiTilesSize);
+
+        uiSize = Header.uiTileOffset + uiTilesSize;
+    }
+
+    memcpy(m_EncodedMap.data(), &Header, sizeof(Header));
+
+    return uiSize;
+}
+
+
+RFStatus RFEncoderDM::transferTiles(const DMDiffMapBuffer* pBuffer, unsigned int& uiSize)
+{
+    RFDiffMapHeader Header;
+
+    memcpy(&Header, pBuffer->pSysmemBuffer, sizeof(Header));
+
+    const unsigned int uiNumBlocks = m_uiOutputWidth * m_uiOutputHeight;
+    const unsigned int uiTileSize  = m_uiTotalBlockSize[0] * m_uiTotalBlockSize[1] * 4;
+
+    uiSize = m_uiDiffMapSize + Header.uiNumTiles * (sizeof(RFDiffTile) + uiTileSize);
+
+    if (Header.uiNumTiles == 0)
+    {
         return RF_STATUS_OK;
     }
 
-    return RF_STATUS_NO_ENCODED_FRAME;
+    // The kernels reserve space for all blocks in the tile list. The pixels are moved directly behind the used entries.
+    cl_event clTilesTransferred = NULL;
+
+    SAFE_CALL_CL(clEnqueueCopyBuffer(m_pContext->getCmdQueue(), pBuffer->clGPUBuffer, pBuffer->clPageLockedBuffer, m_uiDiffMapSize, m_uiDiffMapSize,
+                                     Header.uiNumTiles * sizeof(RFDiffTile), 0, nullptr, nullptr));
+    SAFE_CALL_CL(clEnqueueCopyBuffer(m_pContext->getCmdQueue(), pBuffer->clGPUBuffer, pBuffer->clPageLockedBuffer, m_uiDiffMapSize + uiNumBlocks * sizeof(RFDiffTile),
+                                     m_uiDiffMapSize + Header.uiNumTiles * sizeof(RFDiffTile), Header.uiNumTiles * uiTileSize, 0, nullptr, &clTilesTransferred));
+
+    cl_int nStatus = clWaitForEvents(1, &clTilesTransferred);
+
+    clReleaseEvent(clTilesTransferred);
+
+    SAFE_CALL_CL(nStatus);
+
+    return RF_STATUS_OK;
 }
 
 
@@ -525,6 +1624,30 @@ RFStatus RFEncoderDM::setParameter(const unsigned int uiParameterName, RFParamet
     if (uiParameterName == RF_DIFF_ENCODER_LOCK_BUFFER)
     {
         m_bLockMappedBuffer = (value != 0);
+
+        // The mapped buffer is no longer locked.
+        m_BufferReleasedSignal.notify();
+
+        return RF_STATUS_OK;
+    }
+    else if (uiParameterName == RF_DIFF_ENCODER_WAIT_TIMEOUT)
+    {
+        m_uiWaitTimeoutNs = static_cast<unsigned int>(value) * 1000ULL;
+
+        return RF_STATUS_OK;
+    }
+    else if (uiParameterName == RF_DIFF_ENCODER_ACKNOWLEDGE)
+    {
+        if (!m_bAccumulate)
+        {
+            return RF_STATUS_FAIL;
+        }
+
+        // The consumer received the last returned diff map. Maps of frames that are already encoded still contain the
+        // changes up to the previous acknowledgement which is safe since they are a superset.
+        m_uiAcknowledgedFrame = m_uiReturnedFrame;
+
+        return RF_STATUS_OK;
     }
 
     return RF_STATUS_FAIL;
@@ -552,16 +1675,124 @@ RFParameterState RFEncoderDM::getParameter(const unsigned int uiParameterName, R
 
         return RF_PARAMETER_STATE_BLOCKED;
     }
+    else if (uiParameterName == RF_DIFF_ENCODER_MAP_FORMAT)
+    {
+        value = m_DiffMapFormat;
+
+        return RF_PARAMETER_STATE_BLOCKED;
+    }
+    else if (uiParameterName == RF_DIFF_ENCODER_SUPERBLOCK_MAP)
+    {
+        value = m_bSuperBlockMap;
+
+        return RF_PARAMETER_STATE_BLOCKED;
+    }
+    else if (uiParameterName == RF_DIFF_ENCODER_HASH_BLOCKS)
+    {
+        value = m_bHashBlocks;
+
+        return RF_PARAMETER_STATE_BLOCKED;
+    }
+    else if (uiParameterName == RF_DIFF_ENCODER_MOVE_DETECTION)
+    {
+        value = m_bDetectMoves;
+
+        return RF_PARAMETER_STATE_BLOCKED;
+    }
+    else if (uiParameterName == RF_DIFF_ENCODER_PIXEL_THRESHOLD)
+    {
+        value = m_uiPixelThreshold;
+
+        return RF_PARAMETER_STATE_BLOCKED;
+    }
+    else if (uiParameterName == RF_DIFF_ENCODER_BLOCK_THRESHOLD)
+    {
+        value = m_uiBlockThreshold;
+
+        return RF_PARAMETER_STATE_BLOCKED;
+    }
+    else if (uiParameterName == RF_DIFF_ENCODER_MIN_CHANGED_PIXELS)
+    {
+        value = m_uiMinChangedPixels;
+
+        return RF_PARAMETER_STATE_BLOCKED;
+    }
+    else if (uiParameterName == RF_DIFF_ENCODER_ACCUMULATE)
+    {
+        value = m_bAccumulate;
+
+        return RF_PARAMETER_STATE_BLOCKED;
+    }
+    else if (uiParameterName == RF_DIFF_ENCODER_BLOCK_VERSIONS)
+    {
+        value = m_bBlockVersions;
+
+        return RF_PARAMETER_STATE_BLOCKED;
+    }
     else if (uiParameterName == RF_DIFF_ENCODER_LOCK_BUFFER)
     {
         value = m_bLockMappedBuffer;
 
         return RF_PARAMETER_STATE_READY;
     }
+    else if (uiParameterName == RF_DIFF_ENCODER_WAIT_TIMEOUT)
+    {
+        value = static_cast<RFProperties>(m_uiWaitTimeoutNs / 1000ULL);
+
+        return RF_PARAMETER_STATE_READY;
+    }
+    else if (uiParameterName == RF_DIFF_ENCODER_ACKNOWLEDGE)
+    {
+        value = m_uiAcknowledgedFrame;
+
+        return (m_bAccumulate) ? RF_PARAMETER_STATE_READY : RF_PARAMETER_STATE_INVALID;
+    }
 
     return RF_PARAMETER_STATE_INVALID;
 }
 
+
+RFStatus RFEncoderDM::getChangedBlocks(unsigned int uiVersion, unsigned char* pBlockMap, unsigned int uiSize, unsigned int& uiCurrentVersion)
+{
+    if (!m_bBlockVersions)
+    {
+        return RF_STATUS_FAIL;
+    }
+
+    const unsigned int uiNumBlocks = m_uiOutputWidth * m_uiOutputHeight;
+
+    if (uiSize < uiNumBlocks)
+    {
+        return RF_STATUS_INVALID_DIMENSION;
+    }
+
+    // Read the version before the blocks. Blocks of frames that are encoded later have a newer version and are marked
+    // again by the next call.
+    uiCurrentVersion = m_uiReturnedFrame;
+
+    // The versions are not valid until the first frame after the buffers were created was encoded.
+    const unsigned int* pBlockFrames = nullptr;
+
+    if (m_pDiffMapHost)
+    {
+        pBlockFrames = m_pDiffMapHost->getBlockFrames();
+    }
+    else if (!m_bResetBlockFrames)
+    {
+        // The read is queued behind the kernels of all frames that were encoded.
+        m_BlockFrames.resize(uiNumBlocks);
+
+        SAFE_CALL_CL(clEnqueueReadBuffer(m_pContext->getCmdQueue(), m_clBlockFrames, CL_TRUE, 0, uiNumBlocks * sizeof(cl_uint), m_BlockFrames.data(), 0, nullptr, nullptr));
+
+        pBlockFrames = m_BlockFrames.data();
+    }
+
+    RFDiffMapHost::getChangedBlocks(pBlockFrames, uiNumBlocks, uiVersion, pBlockMap);
+
+    return RF_STATUS_OK;
+}
+
+
 RFStatus RFEncoderDM::GenerateCLProgramAndKernel()
 {
     assert(m_pContext);
@@ -575,6 +1806,20 @@ RFStatus RFEncoderDM::GenerateCLProgramAndKernel()
 		SAFE_CALL_CL(nStatus);
         m_DiffMapBufferkernel = clCreateKernel(m_DiffMapProgram, "DiffMap_Buffer", &nStatus);
         SAFE_CALL_CL(nStatus);
+        m_DiffMapHashImagekernel = clCreateKernel(m_DiffMapProgram, "DiffMap_HashImage", &nStatus);
+        SAFE_CALL_CL(nStatus);
+        m_DiffMapHashBufferkernel = clCreateKernel(m_DiffMapProgram, "DiffMap_HashBuffer", &nStatus);
+        SAFE_CALL_CL(nStatus);
+        m_DiffMapThresholdImagekernel = clCreateKernel(m_DiffMapProgram, "DiffMap_ThresholdImage", &nStatus);
+        SAFE_CALL_CL(nStatus);
+        m_DiffMapThresholdBufferkernel = clCreateKernel(m_DiffMapProgram, "DiffMap_ThresholdBuffer", &nStatus);
+        SAFE_CALL_CL(nStatus);
+        m_GatherTilesImagekernel = clCreateKernel(m_DiffMapProgram, "DiffMap_GatherTilesImage", &nStatus);
+        SAFE_CALL_CL(nStatus);
+        m_GatherTilesBufferkernel = clCreateKernel(m_DiffMapProgram, "DiffMap_GatherTilesBuffer", &nStatus);
+        SAFE_CALL_CL(nStatus);
+        m_DiffMapAccumulatekernel = clCreateKernel(m_DiffMapProgram, "DiffMap_Accumulate", &nStatus);
+        SAFE_CALL_CL(nStatus);
 
         return RF_STATUS_OK;
     }
@@ -584,4 +1829,43 @@ RFStatus RFEncoderDM::GenerateCLProgramAndKernel()
 	}
 
     return RF_STATUS_OPENCL_FAIL;
-}
\ No newline at end of file
+}
+
+
+bool RFEncoderDM::isEncodedFrameReady()
+{
+    const DMDiffMapBuffer* pEncodedBuffer = nullptr;
+
+    if (!m_ResultQueue.front(pEncodedBuffer))
+    {
+        return false;
+    }
+
+    // Diff maps computed on the host are complete once they are queued.
+    if (!pEncodedBuffer->clDMAFinished)
+    {
+        return true;
+    }
+
+    cl_int nExecStatus = CL_COMPLETE;
+
+    if (clGetEventInfo(pEncodedBuffer->clDMAFinished, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int), &nExecStatus, nullptr) != CL_SUCCESS)
+    {
+        // Let getEncodedFrame handle the failure.
+        return true;
+    }
+
+    // A negative status indicates that the command terminated with an error.
+    return (nExecStatus <= CL_COMPLETE);
+}
+
+
+void CL_CALLBACK RFEncoderDM::onDiffMapTransferred(cl_event clEvent, cl_int nStatus, void* pUserData)
+{
+    RFEncoderDM* pEncoder = reinterpret_cast<RFEncoderDM*>(pUserData);
+
+    pEncoder->m_FrameReadySignal.notify();
+
+    // Needs to be last, deleteBuffers waits for this counter before the encoder gets destroyed.
+    --pEncoder->m_uiPendingCallbacks;
+}
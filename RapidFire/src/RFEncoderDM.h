@@ -22,15 +22,18 @@
 
 #pragma once
 
-#include <queue>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 #include <CL/opencl.h>
 #include <components/Component.h>
 #include <core/Buffer.h>
 #include <core/Context.h>
 
+#include "RFDiffMapHost.h"
 #include "RFEncoder.h"
-#include "RFLock.h"
+#include "RFQueue.h"
 
 class RFContextCL;
 
@@ -38,7 +41,8 @@ class RFEncoderDM : public RFEncoder
 {
 public:
 
-    RFEncoderDM();
+    // If bAppendTiles is set, the pixels of the changed blocks are returned behind the diff map (RF_DIFFERENCE_TILES).
+    explicit RFEncoderDM(bool bAppendTiles = false);
     ~RFEncoderDM();
 
     virtual RFStatus            init(const RFContextCL* pContextCL, const RFEncoderSettings* pConfig)                           override;
@@ -55,6 +59,8 @@ public:
 
     virtual RFParameterState    getParameter(unsigned int const uiParameterName, RFVideoCodec codec, RFProperties &value) const override;
 
+    virtual RFStatus            getChangedBlocks(unsigned int uiVersion, unsigned char* pBlockMap, unsigned int uiSize, unsigned int& uiCurrentVersion) override;
+
     // Returns preferred format of the encoder.
     virtual RFFormat            getPreferredFormat() const override { return RF_RGBA8; }
 
@@ -62,31 +68,115 @@ public:
 
     virtual bool                isResizeSupported()  const override { return true; }
 
+    unsigned int                getBlockWidth()      const          { return m_uiTotalBlockSize[0]; }
+
+    unsigned int                getBlockHeight()     const          { return m_uiTotalBlockSize[1]; }
+
 private:
 
+    virtual bool              isEncodedFrameReady() override;
+
+    // Called by the OpenCL runtime once the diff map was copied to the page locked buffer.
+    static void CL_CALLBACK   onDiffMapTransferred(cl_event clEvent, cl_int nStatus, void* pUserData);
+
     bool                      deleteBuffers();
     bool                      createBuffers();
     RFStatus                  GenerateCLProgramAndKernel();
 
+    // If the diff map is computed on the host, only pSysmemBuffer is used and the events are NULL.
     struct DMDiffMapBuffer
     {
         cl_mem              clGPUBuffer;
         cl_mem              clPageLockedBuffer;
         char*               pSysmemBuffer;
+        // Number of valid bytes in pSysmemBuffer.
+        unsigned int        uiSize;
+        // Number of the frame whose diff map is stored in the buffer.
+        unsigned int        uiFrame;
 
         cl_event            clDiffFinished;
         cl_event            clDMAFinished;
     };
 
+    // Converts the bit map written by the kernels into m_EncodedMap. Tiles are copied behind the converted map.
+    // Returns the size including the header.
+    unsigned int              convertBitMap(const unsigned char* pDiffMap);
+
+    // Copies the tiles gathered by the kernels behind the map of the page locked buffer and sets uiSize to the size of
+    // the output including the header.
+    RFStatus                  transferTiles(const DMDiffMapBuffer* pBuffer, unsigned int& uiSize);
+
+    // Returns the next target buffer once it is neither queued nor locked by the reader thread. Waits up to m_uiWaitTimeoutNs
+    // if m_bLockMappedBuffer is set and returns RF_STATUS_QUEUE_FULL if no buffer was released in time.
+    RFStatus                  acquireTargetBuffer(DMDiffMapBuffer*& pBuffer);
+
+    // Computes the diff map of the result buffers uiBufferIdx and m_uiPreviousBuffer on the CPU. If blocks are hashed,
+    // only the result buffer uiBufferIdx is read.
+    RFStatus                  encodeHost(unsigned int uiBufferIdx, DMDiffMapBuffer* pTargetBuffer);
+
     bool                                        m_bLockMappedBuffer;
+    // Time encode waits for a target buffer if m_bLockMappedBuffer is set.
+    uint64_t                                    m_uiWaitTimeoutNs;
 
     unsigned int                                m_uiPreviousBuffer;
     unsigned int                                m_uiDiffMapSize;
 
+    RFDiffMapFormat                             m_DiffMapFormat;
+    // Number of bytes of a row of the bit map. 0 if the kernels write a byte map.
+    unsigned int                                m_uiBitMapPitch;
+
+    // If set, the returned map starts with a RFDiffMapHeader and the superblock map. The target buffers always
+    // contain them, otherwise getEncodedFrame skips the first m_uiMapOffset bytes.
+    bool                                        m_bSuperBlockMap;
+    unsigned int                                m_uiMapOffset;
+    // Size of a superblock in blocks.
+    unsigned int                                m_uiSuperBlockSize[2];
+    unsigned int                                m_uiNumSuperBlocks[2];
+    RFDiffMapHeader                             m_DiffMapHeader;
+
+    // If set, the hash of each block is compared with the hash of the previous frame instead of the previous
+    // result buffer. The previous frame does not need to be kept and one more target buffer is available.
+    bool                                        m_bHashBlocks;
+    // Set if m_clBlockHashes does not contain the hashes of a previous frame. All blocks are marked as changed.
+    bool                                        m_bResetBlockHashes;
+    cl_mem                                      m_clBlockHashes;
+
+    // If set, the changed blocks are returned behind the map. The kernels write the tile list and the pixels of all tiles
+    // to fixed offsets behind m_uiDiffMapSize, getEncodedFrame only transfers the used part of both.
+    bool                                        m_bAppendTiles;
+    unsigned int                                m_uiMaxTileSize;
+
+    // If set, RFDiffMapHost reports scrolled and moved areas as RFDiffMoveRect. Only supported if the diff map is
+    // computed on the host.
+    bool                                        m_bDetectMoves;
+
+    // Thresholds of RF_DIFF_ENCODER_PIXEL_THRESHOLD, RF_DIFF_ENCODER_BLOCK_THRESHOLD and RF_DIFF_ENCODER_MIN_CHANGED_PIXELS.
+    // m_bApplyThresholds is false if any difference marks a block. In this case the faster compare kernels are used.
+    unsigned int                                m_uiPixelThreshold;
+    unsigned int                                m_uiBlockThreshold;
+    unsigned int                                m_uiMinChangedPixels;
+    bool                                        m_bApplyThresholds;
+
+    // If m_bBlockVersions is set, m_clBlockFrames stores the frame in which each block changed last which is the version
+    // of the block. Set m_bResetBlockFrames to mark all blocks in the next frame, e.g. after the buffer was created.
+    // If m_bAccumulate is set, blocks that changed after the frame acknowledged with RF_DIFF_ENCODER_ACKNOWLEDGE are
+    // marked in each diff map. It requires the block versions.
+    bool                                        m_bBlockVersions;
+    bool                                        m_bAccumulate;
+    bool                                        m_bResetBlockFrames;
+    cl_mem                                      m_clBlockFrames;
+    // Copy of m_clBlockFrames read by getChangedBlocks.
+    std::vector<unsigned int>                   m_BlockFrames;
+    // Number of the last encoded frame. Frames are numbered from 1, 0 is acknowledged before the first frame.
+    unsigned int                                m_uiFrame;
+    unsigned int                                m_uiAcknowledgedFrame;
+    // Number of the frame returned by the last call to getEncodedFrame. Written by the reader thread.
+    std::atomic<unsigned int>                   m_uiReturnedFrame;
+
     unsigned int                                m_uiNumLocalPixels[2];
     unsigned int                                m_uiTotalBlockSize[2];
 
-    const unsigned int                          m_uiNumTargetBuffers;
+    unsigned int                                m_uiNumTargetBuffers;
     unsigned int                                m_uiCurrentTargetBuffer;
 
     char*                                       m_pClearData;
@@ -96,17 +186,38 @@ private:
 
     cl_kernel                                   m_DiffMapImagekernel;
     cl_kernel                                   m_DiffMapBufferkernel;
+    cl_kernel                                   m_DiffMapHashImagekernel;
+    cl_kernel                                   m_DiffMapHashBufferkernel;
+    cl_kernel                                   m_DiffMapThresholdImagekernel;
+    cl_kernel                                   m_DiffMapThresholdBufferkernel;
+    cl_kernel                                   m_GatherTilesImagekernel;
+    cl_kernel                                   m_GatherTilesBufferkernel;
+    cl_kernel                                   m_DiffMapAccumulatekernel;
     RFProgramCL                                 m_DiffMapProgram;
 
     const RFContextCL*                          m_pContext;
 
+    // Computes the diff map on the CPU if the result buffers are located in system memory. NULL if the
+    // OpenCL kernels are used.
+    std::unique_ptr<RFDiffMapHost>              m_pDiffMapHost;
+
     // vector of buffers into which the diff kernel can write.
     std::vector<DMDiffMapBuffer>                m_TargetBuffers;
 
     // Queue that contains references to buffers that store a diff map which were not yet
     // read by calling getEncodedFrame
-    RFLockedQueue<const DMDiffMapBuffer*>       m_ResultQueue;
+    RFSPSCQueue<const DMDiffMapBuffer*>         m_ResultQueue;
+
+    // Pointer to the buffer that was retrieved by calling getEncodedFrame. Written by the reader thread.
+    std::atomic<const DMDiffMapBuffer*>         m_pMappedBuffer;
+
+    // Run length map or rectangle list created by getEncodedFrame from the bit map of the kernels. Not used if the
+    // diff map is computed on the host since RFDiffMapHost creates them directly.
+    std::vector<unsigned char>                  m_EncodedMap;
+
+    // Notified by getEncodedFrame when a target buffer was taken out of m_ResultQueue.
+    RFSignal                                    m_BufferReleasedSignal;
 
-    // Pointer to the buffer that was retrieved by calling getEncodedFrame
-    const DMDiffMapBuffer*                      m_pMappedBuffer;
+    // Number of registered onDiffMapTransferred callbacks that did not yet run.
+    std::atomic<unsigned int>                   m_uiPendingCallbacks;
 };
\ No newline at end of file
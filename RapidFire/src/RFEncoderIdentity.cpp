@@ -32,7 +32,7 @@
 RFEncoderIdentity::RFEncoderIdentity()
     : RFEncoder()
     , m_nBufferSize(0)
-    , m_pBuffer(nullptr)
+    , m_PendingBuffers(DEFAULT_PIPELINE_DEPTH)
     , m_pContext(nullptr)
 {
     m_strEncoderName = "RF_ENCODER_IDENTITY";
@@ -53,6 +53,8 @@ RFStatus RFEncoderIdentity::init(const RFContextCL* pContextCL, const RFEncoderS
 
     m_pContext = pContextCL;
 
+    m_PendingBuffers.reset(m_pContext->getNumResultBuffers());
+
     m_format = pConfig->getInputFormat();
 
     if (!isFormatSupported(m_format))
@@ -74,10 +76,14 @@ RFStatus RFEncoderIdentity::init(const RFContextCL* pContextCL, const RFEncoderS
     {
         m_nBufferSize = m_uiAlignedWidth * m_uiAlignedHeight * 4;
     }
-    else if (m_format == RF_NV12)
+    else if (m_format == RF_NV12 || m_format == RF_I420)
     {
         m_nBufferSize = (m_uiAlignedWidth * m_uiAlignedHeight) + (m_uiAlignedWidth * m_uiAlignedHeight) / 2;
     }
+    else if (m_format == RF_P010)
+    {
+        m_nBufferSize = (m_uiAlignedWidth * m_uiAlignedHeight) * 3;
+    }
     else
     {
         return RF_STATUS_INVALID_FORMAT;
@@ -89,6 +95,9 @@ RFStatus RFEncoderIdentity::init(const RFContextCL* pContextCL, const RFEncoderS
 
 RFStatus RFEncoderIdentity::resize(unsigned int uiWidth, unsigned int uiHeight)
 {
+    // The pending buffers were deleted with the result buffers of the context.
+    m_PendingBuffers.reset(m_pContext->getNumResultBuffers());
+
     m_uiWidth  = uiWidth;
     m_uiHeight = uiHeight;
 
@@ -103,10 +112,14 @@ RFStatus RFEncoderIdentity::resize(unsigned int uiWidth, unsigned int uiHeight)
     {
         m_nBufferSize = m_uiAlignedWidth * m_uiAlignedHeight * 4;
     }
-    else if (m_format == RF_NV12)
+    else if (m_format == RF_NV12 || m_format == RF_I420)
     {
         m_nBufferSize = (m_uiAlignedWidth * m_uiAlignedHeight) + (m_uiAlignedWidth * m_uiAlignedHeight) / 2;
     }
+    else if (m_format == RF_P010)
+    {
+        m_nBufferSize = (m_uiAlignedWidth * m_uiAlignedHeight) * 3;
+    }
     else
     {
         return RF_STATUS_INVALID_FORMAT;
@@ -118,7 +131,7 @@ RFStatus RFEncoderIdentity::resize(unsigned int uiWidth, unsigned int uiHeight)
 
 bool RFEncoderIdentity::isFormatSupported(RFFormat format) const
 {
-    if (format == RF_RGBA8 || format == RF_ARGB8 || format == RF_BGRA8 || format == RF_NV12)
+    if (format == RF_RGBA8 || format == RF_ARGB8 || format == RF_BGRA8 || format == RF_NV12 || format == RF_I420 || format == RF_P010)
     {
         return true;
     }
@@ -129,17 +142,16 @@ bool RFEncoderIdentity::isFormatSupported(RFFormat format) const
 
 RFStatus RFEncoderIdentity::getEncodedFrame(unsigned int& uiSize, void* &pBitStream)
 {
-    if (m_pBuffer)
-    {
-        uiSize = static_cast<unsigned int>(m_nBufferSize);
-        pBitStream = m_pBuffer;
-        m_pBuffer = nullptr;
-    }
-    else
+    void* pBuffer = nullptr;
+
+    if (!m_PendingBuffers.pop(pBuffer))
     {
         return RF_STATUS_NO_ENCODED_FRAME;
     }
 
+    uiSize     = static_cast<unsigned int>(m_nBufferSize);
+    pBitStream = pBuffer;
+
     return RF_STATUS_OK;
 }
 
@@ -148,13 +160,23 @@ RFStatus RFEncoderIdentity::encode(unsigned int uiBufferIdx, bool bUseInputImage
 {
     assert(m_pContext);
 
-    m_pContext->getResultBuffer(uiBufferIdx, m_pBuffer);
+    void* pBuffer = nullptr;
+
+    m_pContext->getResultBuffer(uiBufferIdx, pBuffer);
 
-    if (!m_pBuffer)
+    if (!pBuffer)
     {
         RF_Error(RF_STATUS_INVALID_OPENCL_MEMOBJ, "Input pBuffer is invalid");
         return RF_STATUS_INVALID_OPENCL_MEMOBJ;
     }
 
+    if (!m_PendingBuffers.push(pBuffer))
+    {
+        return RF_STATUS_QUEUE_FULL;
+    }
+
+    // getResultBuffer waited for the transfer to system memory, the frame can be read right away.
+    m_FrameReadySignal.notify();
+
     return RF_STATUS_OK;
 }
\ No newline at end of file
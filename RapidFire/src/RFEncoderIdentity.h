@@ -23,6 +23,7 @@
 #pragma once
 
 #include "RFEncoder.h"
+#include "RFQueue.h"
 
 class RFEncoderIdentity : public RFEncoder
 {
@@ -47,8 +48,12 @@ public:
 
 private:
 
+    virtual bool        isEncodedFrameReady()                                                 override { return (m_PendingBuffers.size() > 0); }
+
     size_t              m_nBufferSize;
-    void*               m_pBuffer;
+    // Result buffers that were encoded but not yet retrieved. Several frames can be in flight
+    // when the session queues encodes, the buffers are returned in submission order.
+    RFSPSCQueue<void*>  m_PendingBuffers;
 
     const RFContextCL*  m_pContext;
 };
\ No newline at end of file
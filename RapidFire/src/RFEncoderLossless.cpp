@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "RFEncoderLossless.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <thread>
+
+// Number of tasks per thread. Tiles that are cheap to compress are mixed with noisy tiles, smaller tasks balance the load.
+#define RF_LOSSLESS_TASKS_PER_THREAD    4
+
+
+RFEncoderLossless::RFEncoderLossless()
+    : RFEncoderDM(true)
+{
+    m_strEncoderName = "RF_ENCODER_LOSSLESS_TILES";
+
+    const unsigned int uiNumThreads = std::min(std::max(std::thread::hardware_concurrency(), 1U), static_cast<unsigned int>(RF_DIFF_HOST_MAX_THREADS));
+
+    m_pThreadPool.reset(new (std::nothrow) RFThreadPool(uiNumThreads));
+}
+
+
+RFEncoderLossless::~RFEncoderLossless()
+{}
+
+
+RFStatus RFEncoderLossless::init(const RFContextCL* pContextCL, const RFEncoderSettings* pConfig)
+{
+    if (!m_pThreadPool)
+    {
+        return RF_STATUS_MEMORY_FAIL;
+    }
+
+    RFStatus rfStatus = RFEncoderDM::init(pContextCL, pConfig);
+
+    if (rfStatus != RF_STATUS_OK)
+    {
+        return rfStatus;
+    }
+
+    if (!m_TileCodec.init(getBlockWidth(), getBlockHeight()))
+    {
+        return RF_STATUS_INVALID_ENCODER_PARAMETER;
+    }
+
+    m_Scratch.resize(m_pThreadPool->getNumThreads() * RF_LOSSLESS_TASKS_PER_THREAD * m_TileCodec.getScratchSize());
+
+    return RF_STATUS_OK;
+}
+
+
+RFStatus RFEncoderLossless::getEncodedFrame(unsigned int& uiSize, void* &pBitStream)
+{
+    unsigned int uiTilesSize = 0;
+    void*        pTiles      = nullptr;
+
+    RFStatus rfStatus = RFEncoderDM::getEncodedFrame(uiTilesSize, pTiles);
+
+    if (rfStatus != RF_STATUS_OK)
+    {
+        return rfStatus;
+    }
+
+    const unsigned char* pDiffMap = static_cast<const unsigned char*>(pTiles);
+
+    RFDiffMapHeader Header;
+
+    memcpy(&Header, pDiffMap, sizeof(Header));
+
+    const unsigned int uiNumTiles = Header.uiNumTiles;
+
+    // Nothing needs to be compressed if the frame did not change.
+    if (uiNumTiles == 0)
+    {
+        pBitStream = pTiles;
+        uiSize     = uiTilesSize;
+
+        return RF_STATUS_OK;
+    }
+
+    // The header, the maps, the moves and the tile list are returned unchanged. They are followed by the compressed
+    // size of each tile and the compressed tiles.
+    const unsigned int uiListEnd      = Header.uiTileOffset + uiNumTiles * sizeof(RFDiffTile);
+    const unsigned int uiDataOffset   = uiListEnd + uiNumTiles * sizeof(unsigned int);
+    const unsigned int uiMaxTileSize  = m_TileCodec.getMaxEncodedSize();
+    const unsigned int uiTilePixels   = getBlockWidth() * getBlockHeight();
+    const size_t       uiMaxFrameSize = uiDataOffset + static_cast<size_t>(uiNumTiles) * uiMaxTileSize;
+
+    if (m_EncodedFrame.size() < uiMaxFrameSize)
+    {
+        m_EncodedFrame.resize(uiMaxFrameSize);
+    }
+
+    unsigned char*  pFrame  = m_EncodedFrame.data();
+    const uint32_t* pPixels = reinterpret_cast<const uint32_t*>(pDiffMap + uiListEnd);
+
+    memcpy(pFrame, pDiffMap, uiListEnd);
+
+    const unsigned int uiNumTasks = std::min(uiNumTiles, m_pThreadPool->getNumThreads() * RF_LOSSLESS_TASKS_PER_THREAD);
+
+    auto compressTiles = [&](unsigned int uiTask)
+    {
+        const unsigned int uiFirstTile = static_cast<unsigned int>((static_cast<uint64_t>(uiTask) * uiNumTiles) / uiNumTasks);
+        const unsigned int uiLastTile  = static_cast<unsigned int>((static_cast<uint64_t>(uiTask + 1) * uiNumTiles) / uiNumTasks);
+
+        uint32_t* pScratch = m_Scratch.data() + uiTask * m_TileCodec.getScratchSize();
+
+        for (unsigned int i = uiFirstTile; i < uiLastTile; ++i)
+        {
+            const unsigned int uiTileSize = m_TileCodec.encodeTile(pPixels + static_cast<size_t>(i) * uiTilePixels,
+                                                                   pFrame + uiDataOffset + static_cast<size_t>(i) * uiMaxTileSize, pScratch);
+
+            memcpy(pFrame + uiListEnd + i * sizeof(unsigned int), &uiTileSize, sizeof(unsigned int));
+        }
+    };
+
+    m_pThreadPool->run(uiNumTasks, compressTiles);
+
+    // Close the gaps between the compressed tiles.
+    size_t uiPos = uiDataOffset;
+
+    for (unsigned int i = 0; i < uiNumTiles; ++i)
+    {
+        unsigned int uiTileSize;
+
+        memcpy(&uiTileSize, pFrame + uiListEnd + i * sizeof(unsigned int), sizeof(unsigned int));
+
+        if (i > 0)
+        {
+            memmove(pFrame + uiPos, pFrame + uiDataOffset + static_cast<size_t>(i) * uiMaxTileSize, uiTileSize);
+        }
+
+        uiPos += uiTileSize;
+    }
+
+    pBitStream = pFrame;
+    uiSize     = static_cast<unsigned int>(uiPos);
+
+    return RF_STATUS_OK;
+}
@@ -0,0 +1,64 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "RFEncoderDM.h"
+#include "RFThreadPool.h"
+#include "RFTileCodec.h"
+
+// The lossless tile encoder returns the same output as the RF_DIFFERENCE_TILES encoder but the pixels of each tile are
+// compressed by RFTileCodec. The changed blocks are detected and gathered by RFEncoderDM, the tiles are compressed on
+// the CPU by a thread pool when the frame is retrieved.
+class RFEncoderLossless : public RFEncoderDM
+{
+public:
+
+    RFEncoderLossless();
+    ~RFEncoderLossless();
+
+    virtual RFStatus            init(const RFContextCL* pContextCL, const RFEncoderSettings* pConfig)   override;
+
+    virtual RFStatus            getEncodedFrame(unsigned int& uiSize, void* &pBitStream)                override;
+
+private:
+
+    // disable copy constructor
+    RFEncoderLossless(const RFEncoderLossless& other);
+    // Disable assignment
+    RFEncoderLossless& operator=(const RFEncoderLossless& rhs);
+
+    RFTileCodec                     m_TileCodec;
+
+    std::unique_ptr<RFThreadPool>   m_pThreadPool;
+
+    // Scratch buffer of RFTileCodec::encodeTile for each task.
+    std::vector<uint32_t>           m_Scratch;
+
+    // Frame returned by getEncodedFrame. Tile i is compressed to a fixed offset and moved behind tile i - 1 once
+    // its size is known. The buffer only grows and stays valid until the next call of getEncodedFrame.
+    std::vector<unsigned char>      m_EncodedFrame;
+};
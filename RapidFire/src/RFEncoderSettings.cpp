@@ -1268,6 +1268,152 @@ bool RFEncoderSettings::createParameterMap()
 
     m_ParameterMap[RF_DIFF_ENCODER_LOCK_BUFFER] = Entry;
 
+    ////////////////////////////////////////////////////////////////////////////////////
+    // Format of the difference map
+    //
+    // Type : unsigend int
+    // possible values: RF_DIFF_MAP_BYTE, RF_DIFF_MAP_BIT, RF_DIFF_MAP_RLE, RF_DIFF_MAP_RECT
+    ////////////////////////////////////////////////////////////////////////////////////
+    Entry.EntryType                               = RF_PARAMETER_UINT;
+    Entry.strParameterName                        = "Diff Map Format";
+    Entry.Value.uiValue                           =  RF_DIFF_MAP_BYTE;
+    Entry.PresetValue[RF_PRESET_FAST].uiValue     =  RF_DIFF_MAP_BYTE;
+    Entry.PresetValue[RF_PRESET_BALANCED].uiValue =  RF_DIFF_MAP_BYTE;
+    Entry.PresetValue[RF_PRESET_QUALITY].uiValue  =  RF_DIFF_MAP_BYTE;
+
+    m_ParameterMap[RF_DIFF_ENCODER_MAP_FORMAT] = Entry;
+
+    Entry.EntryType                               = RF_PARAMETER_BOOL;
+    Entry.strParameterName                        = "Superblock Map";
+    Entry.Value.bValue                            =  false;
+    Entry.PresetValue[RF_PRESET_FAST].bValue      =  false;
+    Entry.PresetValue[RF_PRESET_BALANCED].bValue  =  false;
+    Entry.PresetValue[RF_PRESET_QUALITY].bValue   =  false;
+
+    m_ParameterMap[RF_DIFF_ENCODER_SUPERBLOCK_MAP] = Entry;
+
+    Entry.EntryType                               = RF_PARAMETER_BOOL;
+    Entry.strParameterName                        = "Hash Blocks";
+    Entry.Value.bValue                            =  false;
+    Entry.PresetValue[RF_PRESET_FAST].bValue      =  false;
+    Entry.PresetValue[RF_PRESET_BALANCED].bValue  =  false;
+    Entry.PresetValue[RF_PRESET_QUALITY].bValue   =  false;
+
+    m_ParameterMap[RF_DIFF_ENCODER_HASH_BLOCKS] = Entry;
+
+    Entry.EntryType                               = RF_PARAMETER_BOOL;
+    Entry.strParameterName                        = "Move Detection";
+    Entry.Value.bValue                            =  false;
+    Entry.PresetValue[RF_PRESET_FAST].bValue      =  false;
+    Entry.PresetValue[RF_PRESET_BALANCED].bValue  =  false;
+    Entry.PresetValue[RF_PRESET_QUALITY].bValue   =  false;
+
+    m_ParameterMap[RF_DIFF_ENCODER_MOVE_DETECTION] = Entry;
+
+    ////////////////////////////////////////////////////////////////////////////////////
+    // Thresholds of the difference map
+    //
+    // A pixel has changed if the sum of the absolute differences of its 4 channels is
+    // larger than the pixel threshold. A block has changed if at least min changed
+    // pixels have changed and the sum of their differences is larger than the block
+    // threshold. The defaults mark a block as changed if any pixel differs.
+    //
+    // Type : unsigned int
+    // possible values: pixel threshold 0 - 1020, block threshold >= 0, min changed pixels >= 1
+    ////////////////////////////////////////////////////////////////////////////////////
+    Entry.EntryType                               = RF_PARAMETER_UINT;
+    Entry.strParameterName                        = "Pixel Threshold";
+    Entry.Value.uiValue                           =  0;
+    Entry.PresetValue[RF_PRESET_FAST].uiValue     =  0;
+    Entry.PresetValue[RF_PRESET_BALANCED].uiValue =  0;
+    Entry.PresetValue[RF_PRESET_QUALITY].uiValue  =  0;
+
+    m_ParameterMap[RF_DIFF_ENCODER_PIXEL_THRESHOLD] = Entry;
+
+    Entry.EntryType                               = RF_PARAMETER_UINT;
+    Entry.strParameterName                        = "Block Threshold";
+    Entry.Value.uiValue                           =  0;
+    Entry.PresetValue[RF_PRESET_FAST].uiValue     =  0;
+    Entry.PresetValue[RF_PRESET_BALANCED].uiValue =  0;
+    Entry.PresetValue[RF_PRESET_QUALITY].uiValue  =  0;
+
+    m_ParameterMap[RF_DIFF_ENCODER_BLOCK_THRESHOLD] = Entry;
+
+    Entry.EntryType                               = RF_PARAMETER_UINT;
+    Entry.strParameterName                        = "Min Changed Pixels";
+    Entry.Value.uiValue                           =  1;
+    Entry.PresetValue[RF_PRESET_FAST].uiValue     =  1;
+    Entry.PresetValue[RF_PRESET_BALANCED].uiValue =  1;
+    Entry.PresetValue[RF_PRESET_QUALITY].uiValue  =  1;
+
+    m_ParameterMap[RF_DIFF_ENCODER_MIN_CHANGED_PIXELS] = Entry;
+
+    ////////////////////////////////////////////////////////////////////////////////////
+    // Accumulation of difference maps
+    //
+    // If accumulate is set, each map also marks the blocks that changed since the frame
+    // the consumer acknowledged last. Setting acknowledge acknowledges the map returned
+    // by the last call to rfGetEncodedFrame, its value is ignored. A consumer that skips
+    // frames only acknowledges the maps it applied. Can not be combined with move
+    // detection.
+    //
+    // Type : bool (accumulate), unsigned int (acknowledge)
+    ////////////////////////////////////////////////////////////////////////////////////
+    Entry.EntryType                               = RF_PARAMETER_BOOL;
+    Entry.strParameterName                        = "Accumulate";
+    Entry.Value.bValue                            =  false;
+    Entry.PresetValue[RF_PRESET_FAST].bValue      =  false;
+    Entry.PresetValue[RF_PRESET_BALANCED].bValue  =  false;
+    Entry.PresetValue[RF_PRESET_QUALITY].bValue   =  false;
+
+    m_ParameterMap[RF_DIFF_ENCODER_ACCUMULATE] = Entry;
+
+    Entry.EntryType                               = RF_PARAMETER_UINT;
+    Entry.strParameterName                        = "Acknowledge";
+    Entry.Value.uiValue                           =  0;
+    Entry.PresetValue[RF_PRESET_FAST].uiValue     =  0;
+    Entry.PresetValue[RF_PRESET_BALANCED].uiValue =  0;
+    Entry.PresetValue[RF_PRESET_QUALITY].uiValue  =  0;
+
+    m_ParameterMap[RF_DIFF_ENCODER_ACKNOWLEDGE] = Entry;
+
+    ////////////////////////////////////////////////////////////////////////////////////
+    // Block versions of the difference encoder
+    //
+    // If set, the encoder stores the version of the frame in which each block changed
+    // last. rfGetChangedBlocks returns the blocks that changed after a given version.
+    // Always set if accumulate is set.
+    //
+    // Type : bool
+    ////////////////////////////////////////////////////////////////////////////////////
+    Entry.EntryType                               = RF_PARAMETER_BOOL;
+    Entry.strParameterName                        = "Block Versions";
+    Entry.Value.bValue                            =  false;
+    Entry.PresetValue[RF_PRESET_FAST].bValue      =  false;
+    Entry.PresetValue[RF_PRESET_BALANCED].bValue  =  false;
+    Entry.PresetValue[RF_PRESET_QUALITY].bValue   =  false;
+
+    m_ParameterMap[RF_DIFF_ENCODER_BLOCK_VERSIONS] = Entry;
+
+    ////////////////////////////////////////////////////////////////////////////////////
+    // Wait timeout of the difference encoder
+    //
+    // Time in microseconds rfEncodeFrame waits for the reader thread to release a diff
+    // map buffer if RF_DIFF_ENCODER_LOCK_BUFFER is set. RF_STATUS_QUEUE_FULL is returned
+    // if no buffer was released in time. Without locked buffers rfEncodeFrame does not
+    // wait since the application reads the maps on the same thread.
+    //
+    // Type : unsigned int
+    ////////////////////////////////////////////////////////////////////////////////////
+    Entry.EntryType                               = RF_PARAMETER_UINT;
+    Entry.strParameterName                        = "Wait Timeout";
+    Entry.Value.uiValue                           =  2000;
+    Entry.PresetValue[RF_PRESET_FAST].uiValue     =  2000;
+    Entry.PresetValue[RF_PRESET_BALANCED].uiValue =  2000;
+    Entry.PresetValue[RF_PRESET_QUALITY].uiValue  =  2000;
+
+    m_ParameterMap[RF_DIFF_ENCODER_WAIT_TIMEOUT] = Entry;
+
     // Store all names in m_ParameterNames.
     map<unsigned int, MapEntry>::const_iterator itr;
 
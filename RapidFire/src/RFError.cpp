@@ -25,6 +25,11 @@
 #include <stdio.h>
 
 #include <sstream>
+#include <stdexcept>
+
+#if !defined WIN32 && !defined _WIN32
+#include <dirent.h>
+#endif
 
 #if defined(__APPLE__) || defined(__MACOSX)
 #include <OpenCL/cl.h>
@@ -40,6 +45,7 @@
 #endif
 
 #include "RapidFire.h"
+#include "RFPlatform.h"
 #include "RFTypes.h"
 
 void rfError(int code, const char* err, const char* file, const int line)
@@ -257,6 +263,7 @@ const char* getErrorStringCL(int code)
 
 void cleanLogFiles(const std::string& strPath, const std::string& strFilePrefix)
 {
+#if defined WIN32 || defined _WIN32
     HANDLE              hFind;
     WIN32_FIND_DATA     FindFileData;
 
@@ -280,6 +287,32 @@ void cleanLogFiles(const std::string& strPath, const std::string& strFilePrefix)
 
         FindClose(hFind);
     }
+#else
+    DIR* pDir = opendir(strPath.empty() ? "." : strPath.c_str());
+
+    if (pDir)
+    {
+        const std::string strSuffix(".log");
+
+        while (dirent* pEntry = readdir(pDir))
+        {
+            const std::string strFileName(pEntry->d_name);
+
+            if (strFileName.size() >= strFilePrefix.size() + strSuffix.size()                  &&
+                strFileName.compare(0, strFilePrefix.size(), strFilePrefix) == 0                &&
+                strFileName.compare(strFileName.size() - strSuffix.size(), strSuffix.size(), strSuffix) == 0)
+            {
+                std::string strFullPath(strPath);
+
+                strFullPath += strFileName;
+
+                remove(strFullPath.c_str());
+            }
+        }
+
+        closedir(pDir);
+    }
+#endif
 }
 
 
@@ -293,7 +326,7 @@ RFLogFile::RFLogFile(const std::string& strLogFileName)
 
         if (!m_LogFile.is_open())
         {
-            throw std::exception("Failed to open log file");
+            throw std::runtime_error("Failed to open log file");
         }
         else
         {
@@ -325,11 +358,11 @@ void RFLogFile::logMessage(MessageType mt, const std::string& strMsg, RFStatus e
 {
     if (m_LogFile.is_open())
     {
-        SYSTEMTIME  sysTime;
+        tm  localTime;
 
-        GetLocalTime(&sysTime);
+        rfGetLocalTime(localTime);
 
-        m_LogFile << sysTime.wYear << " " << sysTime.wMonth << " " << sysTime.wDay << " " << sysTime.wHour << ":" << sysTime.wMinute << ":" << sysTime.wSecond << " ";
+        m_LogFile << localTime.tm_year + 1900 << " " << localTime.tm_mon + 1 << " " << localTime.tm_mday << " " << localTime.tm_hour << ":" << localTime.tm_min << ":" << localTime.tm_sec << " ";
 
         switch (mt)
         {
@@ -0,0 +1,606 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "RFFileSession.h"
+
+#include <string.h>
+
+#include <sstream>
+
+#if !defined WIN32 && !defined _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "RFContextHost.h"
+#include "RFEncoderSettings.h"
+#include "RFError.h"
+
+#define Y4M_SIGNATURE           "YUV4MPEG2"
+#define Y4M_FRAME_SIGNATURE     "FRAME"
+
+
+// RFMappedFile maps a file read-only into the address space of the process.
+class RFMappedFile
+{
+public:
+
+    RFMappedFile()
+        : m_pData(nullptr)
+        , m_uiSize(0)
+#if defined WIN32 || defined _WIN32
+        , m_hFile(INVALID_HANDLE_VALUE)
+        , m_hMapping(NULL)
+#else
+        , m_nFile(-1)
+#endif
+    {}
+
+    ~RFMappedFile()
+    {
+        close();
+    }
+
+    bool open(const char* pFileName)
+    {
+        close();
+
+#if defined WIN32 || defined _WIN32
+        m_hFile = CreateFileA(pFileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+        if (m_hFile == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+
+        if (!GetFileSizeEx(m_hFile, &fileSize) || fileSize.QuadPart == 0)
+        {
+            close();
+            return false;
+        }
+
+        m_hMapping = CreateFileMapping(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (m_hMapping == NULL)
+        {
+            close();
+            return false;
+        }
+
+        m_pData = static_cast<const unsigned char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+        m_uiSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+        m_nFile = ::open(pFileName, O_RDONLY);
+
+        if (m_nFile < 0)
+        {
+            return false;
+        }
+
+        struct stat fileStat;
+
+        if (fstat(m_nFile, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            close();
+            return false;
+        }
+
+        void* pData = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, m_nFile, 0);
+
+        if (pData == MAP_FAILED)
+        {
+            close();
+            return false;
+        }
+
+        // Frames are read in order, allow the kernel to read ahead.
+        madvise(pData, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+        m_pData  = static_cast<const unsigned char*>(pData);
+        m_uiSize = static_cast<size_t>(fileStat.st_size);
+#endif
+
+        if (!m_pData)
+        {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void close()
+    {
+#if defined WIN32 || defined _WIN32
+        if (m_pData)
+        {
+            UnmapViewOfFile(m_pData);
+        }
+
+        if (m_hMapping != NULL)
+        {
+            CloseHandle(m_hMapping);
+            m_hMapping = NULL;
+        }
+
+        if (m_hFile != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_hFile);
+            m_hFile = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (m_pData)
+        {
+            munmap(const_cast<unsigned char*>(m_pData), m_uiSize);
+        }
+
+        if (m_nFile >= 0)
+        {
+            ::close(m_nFile);
+            m_nFile = -1;
+        }
+#endif
+
+        m_pData  = nullptr;
+        m_uiSize = 0;
+    }
+
+    const unsigned char*    getData() const { return m_pData;  }
+    size_t                  getSize() const { return m_uiSize; }
+
+private:
+
+    // Disable copy constructor.
+    RFMappedFile(const RFMappedFile& other);
+    // Disable assignment operator.
+    RFMappedFile& operator=(const RFMappedFile& other);
+
+    const unsigned char*    m_pData;
+    size_t                  m_uiSize;
+
+#if defined WIN32 || defined _WIN32
+    HANDLE                  m_hFile;
+    HANDLE                  m_hMapping;
+#else
+    int                     m_nFile;
+#endif
+};
+
+
+RFFileSession::RFFileSession(RFEncoderID rfEncoder)
+    : RFHostSession(rfEncoder)
+    , m_pFile(nullptr)
+    , m_FrameList()
+    , m_uiFrameWidth(0)
+    , m_uiFrameHeight(0)
+    , m_FrameFormat(RF_FORMAT_UNKNOWN)
+    , m_bPlanarChroma(false)
+    , m_uiFrameIdx(0)
+    , m_uiRTIdx(0)
+    , m_bFrameRegistered(false)
+    , m_uiFrameIntervalNs(0)
+    , m_uiNextFrameTime(0)
+    , m_FrameTimer()
+{
+    try
+    {
+        // Add all know parameters to map.
+        m_ParameterMap.addParameter(RF_FILE_SOURCE,         RFParameterAttr("RF_FILE_SOURCE",        RF_PARAMETER_PTR,  0));
+        m_ParameterMap.addParameter(RF_FILE_SOURCE_WIDTH,   RFParameterAttr("RF_FILE_SOURCE_WIDTH",  RF_PARAMETER_UINT, 0));
+        m_ParameterMap.addParameter(RF_FILE_SOURCE_HEIGHT,  RFParameterAttr("RF_FILE_SOURCE_HEIGHT", RF_PARAMETER_UINT, 0));
+        m_ParameterMap.addParameter(RF_FILE_SOURCE_FORMAT,  RFParameterAttr("RF_FILE_SOURCE_FORMAT", RF_PARAMETER_UINT, RF_RGBA8));
+        m_ParameterMap.addParameter(RF_FILE_SOURCE_FPS,     RFParameterAttr("RF_FILE_SOURCE_FPS",    RF_PARAMETER_UINT, 0));
+    }
+    catch (...)
+    {
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[CreateSession] Failed to create file source Parameters.");
+
+        throw std::runtime_error("Failed to create file source Parameters.");
+    }
+}
+
+
+RFFileSession::~RFFileSession()
+{
+}
+
+
+RFStatus RFFileSession::finalizeContext()
+{
+    RFStatus rfStatus = openFile();
+
+    if (rfStatus != RF_STATUS_OK)
+    {
+        return rfStatus;
+    }
+
+    if (m_uiFrameWidth != m_pEncoderSettings->getEncoderWidth() || m_uiFrameHeight != m_pEncoderSettings->getEncoderHeight())
+    {
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[File source] Frame dimension does not match encoder dimension", RF_STATUS_INVALID_DIMENSION);
+
+        return RF_STATUS_INVALID_DIMENSION;
+    }
+
+    // YUV frames can only be repacked to NV12 or I420. Use NV12 as default output for those files.
+    if (m_FrameFormat == RF_NV12)
+    {
+        if (m_pEncoderSettings->getInputFormat() == RF_FORMAT_UNKNOWN)
+        {
+            m_pEncoderSettings->setFormat(RF_NV12);
+        }
+        else if (m_pEncoderSettings->getInputFormat() != RF_NV12 && m_pEncoderSettings->getInputFormat() != RF_I420)
+        {
+            m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[File source] YUV files require RF_NV12 or RF_I420 as encoder format", RF_STATUS_INVALID_FORMAT);
+
+            return RF_STATUS_INVALID_FORMAT;
+        }
+    }
+
+    unsigned int uiFps = 0;
+
+    m_ParameterMap.getParameterValue(RF_FILE_SOURCE_FPS, uiFps);
+
+    m_uiFrameIntervalNs = (uiFps > 0) ? (1000000000ULL / uiFps) : 0;
+    m_uiNextFrameTime   = 0;
+    m_uiFrameIdx        = 0;
+    m_bFrameRegistered  = false;
+
+    m_FrameTimer.reset();
+
+    // Register the first frame to make the input dimension known to the context.
+    m_Properties.uiInputDim[0] = m_uiFrameWidth;
+    m_Properties.uiInputDim[1] = m_uiFrameHeight;
+
+    return registerFrame(m_uiFrameIdx);
+}
+
+
+RFStatus RFFileSession::resizeResources(unsigned int uiWidth, unsigned int uiHeight)
+{
+    // Frames are not scaled. The encoder can only be resized to the dimension of the file.
+    if (uiWidth != m_uiFrameWidth || uiHeight != m_uiFrameHeight)
+    {
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[File source] Resize to a dimension different from the file is not supported", RF_STATUS_INVALID_DIMENSION);
+
+        return RF_STATUS_INVALID_DIMENSION;
+    }
+
+    // deleteBuffers removed all inputs from the context.
+    m_bFrameRegistered = false;
+
+    return registerFrame(m_uiFrameIdx);
+}
+
+
+RFStatus RFFileSession::registerTexture(RFTexture rt, unsigned int uiWidth, unsigned int uiHeight, unsigned int& idx)
+{
+    m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[File source] Adding RenderTargets is not supported");
+
+    return RF_STATUS_FAIL;
+}
+
+
+RFStatus RFFileSession::preprocessFrame(unsigned int& idx)
+{
+    if (m_FrameList.empty())
+    {
+        return RF_STATUS_INVALID_RENDER_TARGET;
+    }
+
+    if (m_uiFrameIntervalNs > 0)
+    {
+        uint64_t uiNow = m_FrameTimer.getTimeNs();
+
+        // Sleep for most of the remaining time and yield for the last 2 ms to meet the frame time.
+        while (uiNow < m_uiNextFrameTime)
+        {
+            const uint64_t uiRemaining = m_uiNextFrameTime - uiNow;
+
+            if (uiRemaining > 2000000)
+            {
+                rfSleep(static_cast<unsigned int>(uiRemaining / 1000000) - 1);
+            }
+            else
+            {
+                rfYield();
+            }
+
+            uiNow = m_FrameTimer.getTimeNs();
+        }
+
+        // Do not try to catch up if the application is slower than the requested rate.
+        m_uiNextFrameTime += m_uiFrameIntervalNs;
+
+        if (m_uiNextFrameTime < uiNow)
+        {
+            m_uiNextFrameTime = uiNow;
+        }
+    }
+
+    RFStatus rfStatus = registerFrame(m_uiFrameIdx);
+
+    if (rfStatus != RF_STATUS_OK)
+    {
+        return rfStatus;
+    }
+
+    idx = m_uiRTIdx;
+
+    m_uiFrameIdx = (m_uiFrameIdx + 1) % m_FrameList.size();
+
+    return RF_STATUS_OK;
+}
+
+
+RFStatus RFFileSession::openFile()
+{
+    void* pFileName = nullptr;
+
+    m_ParameterMap.getParameterValue(RF_FILE_SOURCE, pFileName);
+
+    if (!pFileName)
+    {
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[File source] No file specified");
+
+        return RF_STATUS_INVALID_SESSION_PROPERTIES;
+    }
+
+    m_pFile.reset(new RFMappedFile);
+
+    if (!m_pFile->open(static_cast<const char*>(pFileName)))
+    {
+        std::stringstream oss;
+
+        oss << "[File source] Failed to map file " << static_cast<const char*>(pFileName);
+
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, oss.str());
+
+        return RF_STATUS_INVALID_SESSION_PROPERTIES;
+    }
+
+    m_FrameList.clear();
+
+    const size_t uiSignatureLength = strlen(Y4M_SIGNATURE);
+
+    RFStatus rfStatus;
+
+    if (m_pFile->getSize() > uiSignatureLength && memcmp(m_pFile->getData(), Y4M_SIGNATURE, uiSignatureLength) == 0)
+    {
+        rfStatus = parseY4MFile();
+    }
+    else
+    {
+        rfStatus = parseRawFile();
+    }
+
+    if (rfStatus != RF_STATUS_OK)
+    {
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[File source] Failed to parse file", rfStatus);
+
+        return rfStatus;
+    }
+
+    if (m_FrameList.empty())
+    {
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[File source] File does not contain a complete frame", RF_STATUS_INVALID_DIMENSION);
+
+        return RF_STATUS_INVALID_DIMENSION;
+    }
+
+    std::stringstream oss;
+
+    oss << "[File source] Mapped " << static_cast<const char*>(pFileName) << " : " << m_FrameList.size() << " frames of " << m_uiFrameWidth << " x " << m_uiFrameHeight;
+
+    m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_INFO, oss.str());
+
+    return RF_STATUS_OK;
+}
+
+
+RFStatus RFFileSession::parseRawFile()
+{
+    unsigned int uiFormat = RF_RGBA8;
+
+    m_ParameterMap.getParameterValue(RF_FILE_SOURCE_WIDTH,  m_uiFrameWidth);
+    m_ParameterMap.getParameterValue(RF_FILE_SOURCE_HEIGHT, m_uiFrameHeight);
+    m_ParameterMap.getParameterValue(RF_FILE_SOURCE_FORMAT, uiFormat);
+
+    if (m_uiFrameWidth == 0 || m_uiFrameHeight == 0)
+    {
+        return RF_STATUS_INVALID_DIMENSION;
+    }
+
+    size_t uiFrameSize = 0;
+
+    m_FrameFormat   = static_cast<RFFormat>(uiFormat);
+    m_bPlanarChroma = false;
+
+    switch (m_FrameFormat)
+    {
+        case RF_RGBA8:
+        case RF_ARGB8:
+        case RF_BGRA8:
+            uiFrameSize = static_cast<size_t>(m_uiFrameWidth) * m_uiFrameHeight * 4;
+            break;
+
+        case RF_NV12:
+            // The chroma plane of odd sized NV12 images is ambiguous.
+            if ((m_uiFrameWidth & 1) || (m_uiFrameHeight & 1))
+            {
+                return RF_STATUS_INVALID_DIMENSION;
+            }
+
+            uiFrameSize = static_cast<size_t>(m_uiFrameWidth) * m_uiFrameHeight * 3 / 2;
+            break;
+
+        default:
+            return RF_STATUS_INVALID_FORMAT;
+    }
+
+    const size_t uiNumFrames = m_pFile->getSize() / uiFrameSize;
+
+    for (size_t i = 0; i < uiNumFrames; ++i)
+    {
+        m_FrameList.push_back(m_pFile->getData() + i * uiFrameSize);
+    }
+
+    return RF_STATUS_OK;
+}
+
+
+RFStatus RFFileSession::parseY4MFile()
+{
+    const unsigned char* pData  = m_pFile->getData();
+    const size_t         uiSize = m_pFile->getSize();
+
+    const unsigned char* pHeaderEnd = static_cast<const unsigned char*>(memchr(pData, '\n', uiSize));
+
+    if (!pHeaderEnd)
+    {
+        return RF_STATUS_INVALID_FORMAT;
+    }
+
+    // Parse stream header: YUV4MPEG2 W<width> H<height> [F<rate>] [I<interlacing>] [A<aspect>] [C<colorspace>] [X<comment>]
+    std::stringstream oss(std::string(reinterpret_cast<const char*>(pData), pHeaderEnd - pData));
+    std::string       strToken;
+    std::string       strColorSpace("420jpeg");
+
+    m_uiFrameWidth  = 0;
+    m_uiFrameHeight = 0;
+
+    while (oss >> strToken)
+    {
+        switch (strToken[0])
+        {
+            case 'W':
+                m_uiFrameWidth = static_cast<unsigned int>(strtoul(strToken.c_str() + 1, nullptr, 10));
+                break;
+
+            case 'H':
+                m_uiFrameHeight = static_cast<unsigned int>(strtoul(strToken.c_str() + 1, nullptr, 10));
+                break;
+
+            case 'C':
+                strColorSpace = strToken.substr(1);
+                break;
+        }
+    }
+
+    if (m_uiFrameWidth == 0 || m_uiFrameHeight == 0)
+    {
+        return RF_STATUS_INVALID_DIMENSION;
+    }
+
+    // Only 8 bit 4:2:0 streams are supported. The siting of the chroma samples is ignored.
+    if (strColorSpace != "420jpeg" && strColorSpace != "420paldv" && strColorSpace != "420mpeg2" && strColorSpace != "420")
+    {
+        return RF_STATUS_INVALID_FORMAT;
+    }
+
+    m_FrameFormat   = RF_NV12;
+    m_bPlanarChroma = true;
+
+    const size_t uiChromaSize = static_cast<size_t>((m_uiFrameWidth + 1) / 2) * ((m_uiFrameHeight + 1) / 2);
+    const size_t uiFrameSize  = static_cast<size_t>(m_uiFrameWidth) * m_uiFrameHeight + 2 * uiChromaSize;
+    const size_t uiFrameSignatureLength = strlen(Y4M_FRAME_SIGNATURE);
+
+    size_t uiPos = (pHeaderEnd - pData) + 1;
+
+    // Each frame starts with a frame header that is terminated by a new line. A truncated last frame is ignored.
+    while (uiPos + uiFrameSignatureLength < uiSize && memcmp(pData + uiPos, Y4M_FRAME_SIGNATURE, uiFrameSignatureLength) == 0)
+    {
+        const unsigned char* pFrameHeaderEnd = static_cast<const unsigned char*>(memchr(pData + uiPos, '\n', uiSize - uiPos));
+
+        if (!pFrameHeaderEnd)
+        {
+            break;
+        }
+
+        uiPos = (pFrameHeaderEnd - pData) + 1;
+
+        if (uiSize - uiPos < uiFrameSize)
+        {
+            break;
+        }
+
+        m_FrameList.push_back(pData + uiPos);
+
+        uiPos += uiFrameSize;
+    }
+
+    return RF_STATUS_OK;
+}
+
+
+RFStatus RFFileSession::registerFrame(unsigned int uiFrame)
+{
+    if (!m_pContextCL)
+    {
+        return RF_STATUS_INVALID_CONTEXT;
+    }
+
+    RFContextHost* pContextHost = static_cast<RFContextHost*>(m_pContextCL.get());
+
+    // The frame is not copied. The registered input is moved to the next frame inside the mapped file.
+    if (m_bFrameRegistered)
+    {
+        pContextHost->removeCLInputMemObj(m_uiRTIdx);
+        m_bFrameRegistered = false;
+    }
+
+    const unsigned char* pFrame = m_FrameList[uiFrame];
+
+    RFStatus rfStatus;
+
+    if (m_FrameFormat != RF_NV12)
+    {
+        rfStatus = pContextHost->setInputBuffer(pFrame, m_uiFrameWidth * 4, m_FrameFormat, m_uiFrameWidth, m_uiFrameHeight, m_uiRTIdx);
+    }
+    else if (m_bPlanarChroma)
+    {
+        const unsigned int   uiChromaPitch = (m_uiFrameWidth + 1) / 2;
+        const unsigned char* pU = pFrame + m_uiFrameWidth * m_uiFrameHeight;
+        const unsigned char* pV = pU + uiChromaPitch * ((m_uiFrameHeight + 1) / 2);
+
+        rfStatus = pContextHost->setInputPlanes(pFrame, pU, pV, m_uiFrameWidth, uiChromaPitch, 1, m_uiFrameWidth, m_uiFrameHeight, m_uiRTIdx);
+    }
+    else
+    {
+        const unsigned char* pUV = pFrame + m_uiFrameWidth * m_uiFrameHeight;
+
+        rfStatus = pContextHost->setInputPlanes(pFrame, pUV, pUV + 1, m_uiFrameWidth, m_uiFrameWidth, 2, m_uiFrameWidth, m_uiFrameHeight, m_uiRTIdx);
+    }
+
+    if (rfStatus != RF_STATUS_OK)
+    {
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[File source] Failed to register frame", rfStatus);
+
+        return rfStatus;
+    }
+
+    m_bFrameRegistered = true;
+
+    return RF_STATUS_OK;
+}
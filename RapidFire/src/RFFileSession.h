@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "RFHostSession.h"
+#include "RFUtils.h"
+
+class RFMappedFile;
+
+// RFFileSession streams frames from a raw or a Y4M file. The file is mapped into memory and the frames
+// are passed to the host context without copying them. The frames are repeated once the end of the file
+// is reached. This allows reproducible measurements of the processing and encoding path.
+class RFFileSession : public RFHostSession
+{
+public:
+
+    explicit RFFileSession(RFEncoderID rfEncoder);
+    ~RFFileSession();
+
+private:
+
+    virtual RFStatus    finalizeContext()       override;
+
+    virtual RFStatus    resizeResources(unsigned int uiWidth, unsigned int uiHeight)    override;
+
+    virtual RFStatus    registerTexture(RFTexture rt, unsigned int uiWidth, unsigned int uiHeight, unsigned int& idx) override;
+
+    virtual RFStatus    preprocessFrame(unsigned int& idx)                              override;
+
+    // Maps the file and builds the list of frames.
+    RFStatus            openFile();
+
+    RFStatus            parseRawFile();
+    RFStatus            parseY4MFile();
+
+    // Registers the frame uiFrame as input of the host context.
+    RFStatus            registerFrame(unsigned int uiFrame);
+
+
+    std::unique_ptr<RFMappedFile>           m_pFile;
+
+    // Pointers to the first byte of each frame inside the mapped file.
+    std::vector<const unsigned char*>       m_FrameList;
+
+    unsigned int                            m_uiFrameWidth;
+    unsigned int                            m_uiFrameHeight;
+    // Format of the frames. RF_NV12 is used for all 4:2:0 files, m_bPlanarChroma distinguishes I420 from NV12.
+    RFFormat                                m_FrameFormat;
+    bool                                    m_bPlanarChroma;
+
+    unsigned int                            m_uiFrameIdx;
+    unsigned int                            m_uiRTIdx;
+    bool                                    m_bFrameRegistered;
+
+    // Time between two frames. 0 if frames are delivered as fast as possible.
+    uint64_t                                m_uiFrameIntervalNs;
+    uint64_t                                m_uiNextFrameTime;
+    Timer                                   m_FrameTimer;
+};
@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "RFHostSession.h"
+
+#include "RFContextHost.h"
+#include "RFError.h"
+
+
+RFHostSession::RFHostSession(RFEncoderID rfEncoder)
+    : RFSession(rfEncoder)
+{
+    // The result buffers of the host context are located in system memory. Only the identity encoder and
+    // the difference and lossless tile encoders, which compare them on the CPU, can consume them.
+    if (rfEncoder != RF_IDENTITY && rfEncoder != RF_DIFFERENCE && rfEncoder != RF_DIFFERENCE_TILES && rfEncoder != RF_LOSSLESS_TILES)
+    {
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[CreateSession] Failed to create host session. Encoder is not supported");
+
+        throw std::runtime_error("Failed to create host session. Encoder is not supported");
+    }
+
+    try
+    {
+        // Add all know parameters to map.
+        m_ParameterMap.addParameter(RF_HOST_MEMORY, RFParameterAttr("RF_HOST_MEMORY", RF_PARAMETER_BOOL, 0));
+    }
+    catch (...)
+    {
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[CreateSession] Failed to create host Parameters.");
+
+        throw std::runtime_error("Failed to create host Parameters.");
+    }
+}
+
+
+RFContextCL* RFHostSession::createContextInstance()
+{
+    return new RFContextHost;
+}
+
+
+RFStatus RFHostSession::createContextFromGfx()
+{
+    if (!m_pContextCL)
+    {
+        return RF_STATUS_INVALID_CONTEXT;
+    }
+
+    return m_pContextCL->createContext();
+}
+
+
+RFStatus RFHostSession::registerTexture(RFTexture rt, unsigned int uiWidth, unsigned int uiHeight, unsigned int& idx)
+{
+    const RFHostRenderTarget* pHostRT = rt.pHostRT;
+
+    if (pHostRT == nullptr || pHostRT->pBuffer == nullptr)
+    {
+        return RF_STATUS_INVALID_RENDER_TARGET;
+    }
+
+    if (!m_pContextCL)
+    {
+        return RF_STATUS_INVALID_CONTEXT;
+    }
+
+    RFContextHost* pContextHost = static_cast<RFContextHost*>(m_pContextCL.get());
+
+    return pContextHost->setInputBuffer(pHostRT->pBuffer, pHostRT->uiPitch, pHostRT->format, uiWidth, uiHeight, idx);
+}
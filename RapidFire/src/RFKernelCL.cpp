@@ -241,12 +241,15 @@ const char* str_cl_kernels =
     "    pOutI420[uiYPlaneOffset]     = Y3;\n"
     "    pOutI420[uiYPlaneOffset + 1] = Y4;\n"
     "\n"
+    "    // The U and the V plane follow the Y plane. Their pitch is half the pitch of the Y plane.\n"
+    "    uint uiChromaPitch = vDim.z / 2;\n"
+    "    __global uchar* pOutU = pOutI420 + vDim.z * vDim.y;\n"
+    "    __global uchar* pOutV = pOutU + uiChromaPitch * (vDim.y / 2);\n"
+    "\n"
     "    // Write U Plane\n"
-    "    __global uchar* pOutU = pOutI420 + vDim.z * vDim.w;"
-    "    __global uchar* pOutV = pOutU + vDim.z * vDim.w / 2;"
-    "    pOutU[uiGlobalIdX + uiGlobalIdY * vDim.z] = ( ( -38 * RGBA.x -  74 * RGBA.y + 112 * RGBA.z + 128) >> 8) + 128; \n"
+    "    pOutU[uiGlobalIdX + uiGlobalIdY * uiChromaPitch] = ( ( -38 * RGBA.x -  74 * RGBA.y + 112 * RGBA.z + 128) >> 8) + 128; \n"
     "    // Write V Plane\n"
-    "    pOutV[uiGlobalIdX + uiGlobalIdY * vDim.z] = ( ( 112 * RGBA.x -  94 * RGBA.y -  18 * RGBA.z + 128) >> 8) + 128;\n"
+    "    pOutV[uiGlobalIdX + uiGlobalIdY * uiChromaPitch] = ( ( 112 * RGBA.x -  94 * RGBA.y -  18 * RGBA.z + 128) >> 8) + 128;\n"
     "}\n"
     "\n"
     "\n"
@@ -303,5 +306,327 @@ const char* str_cl_kernels =
     "      rgbaOut[uiBufferOffset + 3] = pixel.w; \n"
     "   }\n"
     "}  \n"
-    "\n";
+    "\n"
+    "\n"
+    "////////////////////////////////////////////////////////////////////////////////////////////////////////////\n"
+    "// Scaled color space conversion\n"
+    "//\n"
+    "// vDim.x and vDim.y contain the dimension of the output image. The input image is scaled while it is read.\n"
+    "//\n"
+    "// const float4 vScale contains the scaling of the input image\n"
+    "//      vScale.x = width  of input image / width  of output image\n"
+    "//      vScale.y = height of input image / height of output image\n"
+    "//      vScale.z = width  of input image\n"
+    "//      vScale.w = height of input image\n"
+    "//\n"
+    "// Each output pixel is the average of the input area it covers (box filter). The area is sampled with bilinear taps\n"
+    "// that are at most 2 pixels apart, so each tap averages up to 2x2 input pixels and a downscaling by 2 reads each\n"
+    "// input pixel exactly once. If the image is enlarged a single bilinear tap is used.\n"
+    "////////////////////////////////////////////////////////////////////////////////////////////////////////////\n"
+    "\n"
+    "__constant sampler_t linearSampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_LINEAR;\n"
+    "\n"
+    "float4 readScaled(read_only image2d_t pIn, int2 pos, const float4 vScale, const int mirror)\n"
+    "{\n"
+    "    // Number of taps in each direction and the distance between them.\n"
+    "    int2   nTaps = max(convert_int2(ceil(vScale.xy * 0.5f)), (int2)(1, 1));\n"
+    "    float2 vStep = vScale.xy / convert_float2(nTaps);\n"
+    "\n"
+    "    // Center of the first tap in input coordinates. The pixel centers are located at .5.\n"
+    "    float2 vStart = convert_float2(pos) * vScale.xy + 0.5f * vStep;\n"
+    "\n"
+    "    float4 vSum = (float4)(0.0f);\n"
+    "\n"
+    "    for (int j = 0; j < nTaps.y; ++j)\n"
+    "    {\n"
+    "        float fY = vStart.y + j * vStep.y;\n"
+    "\n"
+    "        if (mirror == 1)\n"
+    "        {\n"
+    "            fY = vScale.w - fY;\n"
+    "        }\n"
+    "\n"
+    "        for (int i = 0; i < nTaps.x; ++i)\n"
+    "        {\n"
+    "            vSum += read_imagef(pIn, linearSampler, (float2)(vStart.x + i * vStep.x, fY));\n"
+    "        }\n"
+    "    }\n"
+    "\n"
+    "    return vSum / (float)(nTaps.x * nTaps.y);\n"
+    "}\n"
+    "\n"
+    "\n"
+    "// Same as rgbaTonv12_image2d but scales the input image. Global work size is width/2, height/2 of the output image.\n"
+    "__kernel void rgbaTonv12_scaled_image2d(read_only image2d_t pIn, __global uchar * pOut, const int4 vDim, const int mirror, const float4 vScale)\n"
+    "{\n"
+    "    uint uiGlobalIdX = get_global_id(0);    // 0 - width /2\n"
+    "    uint uiGlobalIdY = get_global_id(1);    // 0 - height/2\n"
+    "\n"
+    "    if (uiGlobalIdX >= vDim.x / 2 || uiGlobalIdY >= vDim.y / 2)\n"
+    "    {\n"
+    "        return;\n"
+    "    }\n"
+    "\n"
+    "    // Offset to the start of the chroma u-plane\n"
+    "    uint uPlaneOffset = vDim.z * vDim.y;\n"
+    "\n"
+    "    uint uiYPlaneOffset = (uiGlobalIdX + uiGlobalIdY * vDim.z) << 1;\n"
+    "\n"
+    "    uchar4 RGBA1, RGBA2, RGBA3, RGBA4;\n"
+    "\n"
+    "    int2 pos = (int2)(uiGlobalIdX * 2, uiGlobalIdY * 2);\n"
+    "\n"
+    "    RGBA1 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos, vScale, mirror));\n"
+    "    RGBA2 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos + (int2)(1, 0), vScale, mirror));\n"
+    "    RGBA3 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos + (int2)(0, 1), vScale, mirror));\n"
+    "    RGBA4 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos + (int2)(1, 1), vScale, mirror));\n"
+    "\n"
+    "    ushort4 RGBA = convert_ushort4(RGBA1) + convert_ushort4(RGBA2) + convert_ushort4(RGBA3) + convert_ushort4(RGBA4);\n"
+    "\n"
+    "    // Take average color\n"
+    "    RGBA = RGBA >> 2;\n"
+    "\n"
+    "    // Write Y Plane\n"
+    "    pOut[uiYPlaneOffset]     = ((66 * RGBA1.x + 129 * RGBA1.y + 25 * RGBA1.z + 128) >> 8) + 16;\n"
+    "    pOut[uiYPlaneOffset + 1] = ((66 * RGBA2.x + 129 * RGBA2.y + 25 * RGBA2.z + 128) >> 8) + 16;\n"
+    "\n"
+    "    uiYPlaneOffset += vDim.z;\n"
+    "\n"
+    "    pOut[uiYPlaneOffset]     = ((66 * RGBA3.x + 129 * RGBA3.y + 25 * RGBA3.z + 128) >> 8) + 16;\n"
+    "    pOut[uiYPlaneOffset + 1] = ((66 * RGBA4.x + 129 * RGBA4.y + 25 * RGBA4.z + 128) >> 8) + 16;\n"
+    "\n"
+    "    // Write U Plane\n"
+    "    pOut[uPlaneOffset + 2 * uiGlobalIdX + uiGlobalIdY * vDim.z]     = ((-38 * RGBA.x - 74 * RGBA.y + 112 * RGBA.z + 128) >> 8) + 128;\n"
+    "    // Write V Plane\n"
+    "    pOut[uPlaneOffset + 2 * uiGlobalIdX + 1 + uiGlobalIdY * vDim.z] = ((112 * RGBA.x - 94 * RGBA.y - 18  * RGBA.z + 128) >> 8) + 128;\n"
+    "}\n"
+    "\n"
+    "\n"
+    "// Same as rgbaToI420_image2d but scales the input image. Global work size is width/2, height/2 of the output image.\n"
+    "__kernel void rgbaToI420_scaled_image2d(read_only image2d_t pIn, __global uchar* pOutI420, const int4 vDim, const int mirror, const float4 vScale)\n"
+    "{\n"
+    "    uint uiGlobalIdX = get_global_id(0);    // 0 - width /2\n"
+    "    uint uiGlobalIdY = get_global_id(1);    // 0 - height/2\n"
+    "\n"
+    "    if (uiGlobalIdX >= vDim.x / 2 || uiGlobalIdY >= vDim.y / 2)\n"
+    "    {\n"
+    "        return;\n"
+    "    }\n"
+    "\n"
+    "    uint uiYPlaneOffset = (uiGlobalIdX + uiGlobalIdY * vDim.z) << 1;\n"
+    "\n"
+    "    uchar4 RGBA1, RGBA2, RGBA3, RGBA4;\n"
+    "\n"
+    "    int2 pos = (int2)(uiGlobalIdX * 2, uiGlobalIdY * 2);\n"
+    "\n"
+    "    RGBA1 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos, vScale, mirror));\n"
+    "    RGBA2 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos + (int2)(1, 0), vScale, mirror));\n"
+    "    RGBA3 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos + (int2)(0, 1), vScale, mirror));\n"
+    "    RGBA4 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos + (int2)(1, 1), vScale, mirror));\n"
+    "\n"
+    "    ushort4 RGBA = convert_ushort4(RGBA1) + convert_ushort4(RGBA2) + convert_ushort4(RGBA3) + convert_ushort4(RGBA4);\n"
+    "\n"
+    "    // Take average color\n"
+    "    RGBA = RGBA >> 2;\n"
+    "\n"
+    "    // Write Y Plane\n"
+    "    pOutI420[uiYPlaneOffset]     = ((66 * RGBA1.x + 129 * RGBA1.y + 25 * RGBA1.z + 128) >> 8) + 16;\n"
+    "    pOutI420[uiYPlaneOffset + 1] = ((66 * RGBA2.x + 129 * RGBA2.y + 25 * RGBA2.z + 128) >> 8) + 16;\n"
+    "\n"
+    "    uiYPlaneOffset += vDim.z;\n"
+    "\n"
+    "    pOutI420[uiYPlaneOffset]     = ((66 * RGBA3.x + 129 * RGBA3.y + 25 * RGBA3.z + 128) >> 8) + 16;\n"
+    "    pOutI420[uiYPlaneOffset + 1] = ((66 * RGBA4.x + 129 * RGBA4.y + 25 * RGBA4.z + 128) >> 8) + 16;\n"
+    "\n"
+    "    uint uiChromaPitch = vDim.z / 2;\n"
+    "    __global uchar* pOutU = pOutI420 + vDim.z * vDim.y;\n"
+    "    __global uchar* pOutV = pOutU + uiChromaPitch * (vDim.y / 2);\n"
+    "\n"
+    "    // Write U Plane\n"
+    "    pOutU[uiGlobalIdX + uiGlobalIdY * uiChromaPitch] = ((-38 * RGBA.x - 74 * RGBA.y + 112 * RGBA.z + 128) >> 8) + 128;\n"
+    "    // Write V Plane\n"
+    "    pOutV[uiGlobalIdX + uiGlobalIdY * uiChromaPitch] = ((112 * RGBA.x - 94 * RGBA.y - 18 * RGBA.z + 128) >> 8) + 128;\n"
+    "}\n"
+    "\n"
+    "\n"
+    "// Same as copy_rgba_image2d but scales the input image. Global work size is width, height of the output image.\n"
+    "__kernel void copy_rgba_scaled_image2d(__read_only image2d_t rgbaIn, __global uchar *rgbaOut, const int4 vDim, const int mirror, const int nTargetOrdering, const float4 vScale)\n"
+    "{\n"
+    "    uint uiGlobalId_X = get_global_id(0);\n"
+    "    uint uiGlobalId_Y = get_global_id(1);\n"
+    "\n"
+    "    if (uiGlobalId_X >= vDim.x || uiGlobalId_Y >= vDim.y)\n"
+    "    {\n"
+    "        return;\n"
+    "    }\n"
+    "\n"
+    "    uint uiBufferOffset = (uiGlobalId_X + (uiGlobalId_Y * vDim.z)) * 4;\n"
+    "\n"
+    "    uchar4 pixel = convert_uchar4_sat_rte(255.0f * readScaled(rgbaIn, (int2)(uiGlobalId_X, uiGlobalId_Y), vScale, mirror));\n"
+    "\n"
+    "    if (nTargetOrdering == 1)\n"
+    "    {\n"
+    "        // Write ARGB\n"
+    "        pixel = pixel.wxyz;\n"
+    "    }\n"
+    "    else if (nTargetOrdering == 2)\n"
+    "    {\n"
+    "        // Write BGRA\n"
+    "        pixel = pixel.zyxw;\n"
+    "    }\n"
+    "\n"
+    "    vstore4(pixel, 0, rgbaOut + uiBufferOffset);\n"
+    "}\n"
+    "\n"
+    "\n"
+    "// Converts a pixel read from the input image to 10-bit RGB. Values outside of [0, 1], e.g. of half float images,\n"
+    "// are clamped.\n"
+    "int4 toRGB10(float4 pixel)\n"
+    "{\n"
+    "    return convert_int4_sat_rte(1023.0f * clamp(pixel, 0.0f, 1.0f));\n"
+    "}\n"
+    "\n"
+    "\n"
+    "// Returns the 10-bit luma of a 10-bit RGB pixel in the upper bits of a 16-bit sample. Same BT.601 conversion as the\n"
+    "// 8-bit kernels with coefficients scaled by 1024.\n"
+    "ushort rgbToY10(int4 RGB)\n"
+    "{\n"
+    "    return (ushort)((((262 * RGB.x + 515 * RGB.y + 100 * RGB.z + 512) >> 10) + 64) << 6);\n"
+    "}\n"
+    "\n"
+    "\n"
+    "// Returns the 10-bit U and V of a 10-bit RGB pixel in the upper bits of 16-bit samples.\n"
+    "ushort2 rgbToUV10(int4 RGB)\n"
+    "{\n"
+    "    return (ushort2)((((-151 * RGB.x - 297 * RGB.y + 448 * RGB.z + 512) >> 10) + 512) << 6,\n"
+    "                     (((448 * RGB.x - 375 * RGB.y - 73  * RGB.z + 512) >> 10) + 512) << 6);\n"
+    "}\n"
+    "\n"
+    "\n"
+    "// Converts the input image into a P010 buffer. The interleaved U/V plane follows the Y plane and has the same pitch.\n"
+    "// vDim.z is the pitch in samples. Global work size is width/2, height/2 of the output image.\n"
+    "__kernel void rgbaToP010_image2d(read_only image2d_t pIn, __global ushort* pOut, const int4 vDim, const int mirror)\n"
+    "{\n"
+    "    uint uiGlobalIdX = get_global_id(0);    // 0 - width /2\n"
+    "    uint uiGlobalIdY = get_global_id(1);    // 0 - height/2\n"
+    "\n"
+    "    if (uiGlobalIdX >= vDim.x / 2 || uiGlobalIdY >= vDim.y / 2)\n"
+    "    {\n"
+    "        return;\n"
+    "    }\n"
+    "\n"
+    "    // Offset to the start of the chroma plane\n"
+    "    uint uiUVPlaneOffset = vDim.z * vDim.y;\n"
+    "\n"
+    "    uint uiYPlaneOffset = (uiGlobalIdX + uiGlobalIdY * vDim.z) << 1;\n"
+    "\n"
+    "    int4 RGB1, RGB2, RGB3, RGB4;\n"
+    "\n"
+    "    int2 pos = (int2)(uiGlobalIdX * 2, (mirror == 1) ? (vDim.y - uiGlobalIdY * 2 - 1) : uiGlobalIdY * 2);\n"
+    "\n"
+    "    RGB1 = toRGB10(read_imagef(pIn, imageSampler, pos));\n"
+    "    RGB2 = toRGB10(read_imagef(pIn, imageSampler, pos + (int2)(1, 0)));\n"
+    "\n"
+    "    pos.y = (mirror == 1) ? (vDim.y - uiGlobalIdY * 2 - 2) : (uiGlobalIdY * 2 + 1);\n"
+    "\n"
+    "    RGB3 = toRGB10(read_imagef(pIn, imageSampler, pos));\n"
+    "    RGB4 = toRGB10(read_imagef(pIn, imageSampler, pos + (int2)(1, 0)));\n"
+    "\n"
+    "    // Take average color\n"
+    "    int4 RGB = (RGB1 + RGB2 + RGB3 + RGB4) >> 2;\n"
+    "\n"
+    "    // Write Y Plane\n"
+    "    pOut[uiYPlaneOffset]     = rgbToY10(RGB1);\n"
+    "    pOut[uiYPlaneOffset + 1] = rgbToY10(RGB2);\n"
+    "\n"
+    "    uiYPlaneOffset += vDim.z;\n"
+    "\n"
+    "    pOut[uiYPlaneOffset]     = rgbToY10(RGB3);\n"
+    "    pOut[uiYPlaneOffset + 1] = rgbToY10(RGB4);\n"
+    "\n"
+    "    // Write U/V Plane\n"
+    "    vstore2(rgbToUV10(RGB), 0, pOut + uiUVPlaneOffset + 2 * uiGlobalIdX + uiGlobalIdY * vDim.z);\n"
+    "}\n"
+    "\n"
+    "\n"
+    "// Same as rgbaToP010_image2d but scales the input image. Global work size is width/2, height/2 of the output image.\n"
+    "__kernel void rgbaToP010_scaled_image2d(read_only image2d_t pIn, __global ushort* pOut, const int4 vDim, const int mirror, const float4 vScale)\n"
+    "{\n"
+    "    uint uiGlobalIdX = get_global_id(0);    // 0 - width /2\n"
+    "    uint uiGlobalIdY = get_global_id(1);    // 0 - height/2\n"
+    "\n"
+    "    if (uiGlobalIdX >= vDim.x / 2 || uiGlobalIdY >= vDim.y / 2)\n"
+    "    {\n"
+    "        return;\n"
+    "    }\n"
+    "\n"
+    "    // Offset to the start of the chroma plane\n"
+    "    uint uiUVPlaneOffset = vDim.z * vDim.y;\n"
+    "\n"
+    "    uint uiYPlaneOffset = (uiGlobalIdX + uiGlobalIdY * vDim.z) << 1;\n"
+    "\n"
+    "    int4 RGB1, RGB2, RGB3, RGB4;\n"
+    "\n"
+    "    int2 pos = (int2)(uiGlobalIdX * 2, uiGlobalIdY * 2);\n"
+    "\n"
+    "    RGB1 = toRGB10(readScaled(pIn, pos, vScale, mirror));\n"
+    "    RGB2 = toRGB10(readScaled(pIn, pos + (int2)(1, 0), vScale, mirror));\n"
+    "    RGB3 = toRGB10(readScaled(pIn, pos + (int2)(0, 1), vScale, mirror));\n"
+    "    RGB4 = toRGB10(readScaled(pIn, pos + (int2)(1, 1), vScale, mirror));\n"
+    "\n"
+    "    // Take average color\n"
+    "    int4 RGB = (RGB1 + RGB2 + RGB3 + RGB4) >> 2;\n"
+    "\n"
+    "    // Write Y Plane\n"
+    "    pOut[uiYPlaneOffset]     = rgbToY10(RGB1);\n"
+    "    pOut[uiYPlaneOffset + 1] = rgbToY10(RGB2);\n"
+    "\n"
+    "    uiYPlaneOffset += vDim.z;\n"
+    "\n"
+    "    pOut[uiYPlaneOffset]     = rgbToY10(RGB3);\n"
+    "    pOut[uiYPlaneOffset + 1] = rgbToY10(RGB4);\n"
+    "\n"
+    "    // Write U/V Plane\n"
+    "    vstore2(rgbToUV10(RGB), 0, pOut + uiUVPlaneOffset + 2 * uiGlobalIdX + uiGlobalIdY * vDim.z);\n"
+    "}\n"
+    "\n"
+    "\n"
+    "// Same as rgbaToNV12_Planes but writes the 16-bit Y and U/V image of a P010 surface.\n"
+    "__kernel void rgbaToP010_Planes(__read_only image2d_t rgbaIn, __write_only image2d_t yOut, const int4 vDim, const int mirror, __write_only image2d_t uvOut)\n"
+    "{\n"
+    "    uint uiGlobalId_X = get_global_id(0);\n"
+    "    uint uiGlobalId_Y = get_global_id(1);\n"
+    "\n"
+    "    if (uiGlobalId_X >= vDim.x / 2 || uiGlobalId_Y >= vDim.y / 2)\n"
+    "    {\n"
+    "        return;\n"
+    "    }\n"
+    "\n"
+    "    int4 RGB1, RGB2, RGB3, RGB4;\n"
+    "\n"
+    "    int2 SrcCoord = (int2)(uiGlobalId_X * 2, (mirror == 1) ? (vDim.y - 2 * uiGlobalId_Y - 1) : 2 * uiGlobalId_Y);\n"
+    "    int2 DstCoord = (int2)((uiGlobalId_X * 2), (uiGlobalId_Y * 2));\n"
+    "\n"
+    "    RGB1 = toRGB10(read_imagef(rgbaIn, imageSampler, SrcCoord));\n"
+    "    RGB2 = toRGB10(read_imagef(rgbaIn, imageSampler, SrcCoord + (int2)(1, 0)));\n"
+    "\n"
+    "    SrcCoord.y = (mirror == 1) ? (vDim.y - uiGlobalId_Y * 2 - 2) : (uiGlobalId_Y * 2 + 1);\n"
+    "\n"
+    "    RGB3 = toRGB10(read_imagef(rgbaIn, imageSampler, SrcCoord));\n"
+    "    RGB4 = toRGB10(read_imagef(rgbaIn, imageSampler, SrcCoord + (int2)(1, 0)));\n"
+    "\n"
+    "    // Take average color\n"
+    "    int4 RGB = (RGB1 + RGB2 + RGB3 + RGB4) >> 2;\n"
+    "\n"
+    "    // Write Y plane.\n"
+    "    write_imageui(yOut, DstCoord, (uint4)(rgbToY10(RGB1), 0, 0, 0));\n"
+    "    write_imageui(yOut, (int2)(DstCoord.x + 1, DstCoord.y), (uint4)(rgbToY10(RGB2), 0, 0, 0));\n"
+    "    write_imageui(yOut, (int2)(DstCoord.x, DstCoord.y + 1), (uint4)(rgbToY10(RGB3), 0, 0, 0));\n"
+    "    write_imageui(yOut, (int2)(DstCoord.x + 1, DstCoord.y + 1), (uint4)(rgbToY10(RGB4), 0, 0, 0));\n"
+    "\n"
+    "    // Store U and V of the average color interleaved in the uv image.\n"
+    "    ushort2 UV = rgbToUV10(RGB);\n"
+    "\n"
+    "    write_imageui(uvOut, (int2)(uiGlobalId_X, uiGlobalId_Y), (uint4)(UV.x, UV.y, 0, 0));\n"
+    "}\n";
     
\ No newline at end of file
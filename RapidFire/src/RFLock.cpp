@@ -25,38 +25,25 @@
 
 RFLock::RFLock()
 {
-    InitializeCriticalSection(&m_cs);
+    rfMutexInit(&m_Mutex);
 }
 
 
 RFLock::~RFLock()
 {
-    // Release just in case lock is still used.
-    LeaveCriticalSection(&m_cs);
-
-    DeleteCriticalSection(&m_cs);
+    rfMutexDestroy(&m_Mutex);
 }
 
 
 bool RFLock::lock()
 {
-    try
-    {
-        EnterCriticalSection(&m_cs);
-    }
-    catch (...)
-    {
-        // Catch possible exception EXCEPTION_POSSIBLE_DEADLOCK.
-        return false;
-    }
-
-    return true;
+    return rfMutexLock(&m_Mutex);
 }
 
 
 void RFLock::unlock()
 {
-    LeaveCriticalSection(&m_cs);
+    rfMutexUnlock(&m_Mutex);
 }
 
 
@@ -76,4 +63,77 @@ RFReadWriteAccess::~RFReadWriteAccess()
     {
         m_pLock->unlock();
     }
-}
\ No newline at end of file
+}
+
+
+RFSignal::RFSignal()
+    : m_uiCount(0)
+{
+    rfMutexInit(&m_Mutex);
+    rfCondInit(&m_CondVar);
+}
+
+
+RFSignal::~RFSignal()
+{
+    rfCondDestroy(&m_CondVar);
+    rfMutexDestroy(&m_Mutex);
+}
+
+
+void RFSignal::notify()
+{
+    rfMutexLock(&m_Mutex);
+
+    ++m_uiCount;
+
+    rfMutexUnlock(&m_Mutex);
+
+    rfCondBroadcast(&m_CondVar);
+}
+
+
+uint64_t RFSignal::getCount()
+{
+    rfMutexLock(&m_Mutex);
+
+    const uint64_t uiCount = m_uiCount;
+
+    rfMutexUnlock(&m_Mutex);
+
+    return uiCount;
+}
+
+
+bool RFSignal::wait(uint64_t uiCount, uint64_t uiTimeoutNs)
+{
+    const uint64_t uiStart = rfGetTimeNs();
+
+    rfMutexLock(&m_Mutex);
+
+    // Loop since a condition variable can wake up without being signaled.
+    while (m_uiCount == uiCount)
+    {
+        uint64_t uiRemainingNs = RF_PLATFORM_INFINITE_NS;
+
+        if (uiTimeoutNs != RF_PLATFORM_INFINITE_NS)
+        {
+            const uint64_t uiElapsedNs = rfGetTimeNs() - uiStart;
+
+            if (uiElapsedNs >= uiTimeoutNs)
+            {
+                break;
+            }
+
+            uiRemainingNs = uiTimeoutNs - uiElapsedNs;
+        }
+
+        rfCondWait(&m_CondVar, &m_Mutex, uiRemainingNs);
+    }
+
+    const bool bSignaled = (m_uiCount != uiCount);
+
+    rfMutexUnlock(&m_Mutex);
+
+    return bSignaled;
+}
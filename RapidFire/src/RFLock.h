@@ -22,9 +22,7 @@
 
 #pragma once
 
-#include <queue>
-
-#include <Windows.h>
+#include "RFPlatform.h"
 
 // RFLock implements a critical section.
 class RFLock
@@ -45,7 +43,7 @@ private:
     // Disable assignmnet operator.
     RFLock& operator= (const RFLock& rhs);
 
-    CRITICAL_SECTION m_cs;
+    RFPlatformMutex m_Mutex;
 };
 
 
@@ -73,50 +71,41 @@ private:
 };
 
 
-template <class T>
-class RFLockedQueue
+// RFSignal lets a thread wait until another thread notifies it. Each call to notify increments a counter.
+// A waiting thread reads the counter with getCount, checks its condition and, if the condition is not met,
+// calls wait with the count it read. This way a notification that happens between the check and the wait
+// is not lost.
+class RFSignal
 {
 public:
 
-    inline size_t size()
-    {
-        RFReadWriteAccess qlock(&m_Lock);
-
-        return m_queue.size();
-    }
+    RFSignal();
+    ~RFSignal();
 
-    inline void push(T elem)
-    {
-        RFReadWriteAccess qlock(&m_Lock);
+    // Increments the counter and wakes up all waiting threads.
+    void        notify();
 
-        m_queue.push(elem);
-    }
+    uint64_t    getCount();
 
-    inline T front()
-    {
-        RFReadWriteAccess qlock(&m_Lock);
-
-        return m_queue.front();
-    }
-
-    inline T pop()
-    {
-        RFReadWriteAccess qlock(&m_Lock);
-
-        T elem = m_queue.front();
-
-        m_queue.pop();
-
-        return elem;
-    }
+    // Blocks until the counter differs from uiCount or uiTimeoutNs elapsed. Returns false on timeout.
+    // Pass RF_PLATFORM_INFINITE_NS to wait without time limit.
+    bool        wait(uint64_t uiCount, uint64_t uiTimeoutNs);
 
 private:
 
-    RFLock              m_Lock;
-    std::queue<T>       m_queue;
+    // Disable copy constructor.
+    RFSignal(const RFSignal& other);
+    // Disable assignment operator.
+    RFSignal& operator= (const RFSignal& rhs);
+
+    RFPlatformMutex     m_Mutex;
+    RFPlatformCondVar   m_CondVar;
+    uint64_t            m_uiCount;
 };
 
 
+#if defined WIN32 || defined _WIN32
+
 class RFGLContextGuard
 {
 public:
@@ -182,4 +171,6 @@ private:
 
     const HDC       m_hDC;
     const HGLRC     m_hGlrc;
-};
\ No newline at end of file
+};
+
+#endif // defined WIN32 || defined _WIN32
\ No newline at end of file
@@ -22,12 +22,20 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <string>
+
 #if defined WIN32 || defined _WIN32
 
 #include <D3D11.h>
 #include <d3d9.h>
 #include <GL/glew.h>
 #include <GL/wglew.h>
+#include <intrin.h>
+#include <malloc.h>
 #include <windows.h>
 
 #define DeviceCtx       HDC
@@ -37,12 +45,25 @@
 #define D3D9Device      IDirect3DDevice9*
 #define D3D11Device     ID3D11Device*
 
+// MSVC allows the use of AVX2 and SSE4.1 intrinsics without enabling them for the whole file.
+#define RF_TARGET_AVX2
+#define RF_TARGET_SSE41
+
+typedef CRITICAL_SECTION    RFPlatformMutex;
+typedef CONDITION_VARIABLE  RFPlatformCondVar;
+typedef DWORD               RFThreadId;
+
 #else // if defined WIN32 || defined _WIN32
 
+// Compiled by the posix target of RapidFire/Makefile.
+#include <cpuid.h>
 #include <dlfcn.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #include "GL/glxew.h"
 #include <X11/keysym.h>
@@ -51,4 +72,346 @@
 #define DeviceCtx       Display*
 #define GraphicsCtx     GLXContext
 
-#endif // defined WIN32 || defined _WIN32
\ No newline at end of file
+// GCC and clang need to generate AVX2 or SSE4.1 code for functions that use the intrinsics.
+#define RF_TARGET_AVX2  __attribute__((target("avx2")))
+#define RF_TARGET_SSE41 __attribute__((target("sse4.1")))
+
+#define sprintf_s       snprintf
+
+// Windows types that are used by the interfaces shared between all platforms.
+typedef unsigned int        UINT;
+typedef uint32_t            DWORD;
+
+struct ID3D11Device;
+struct ID3D11Texture2D;
+struct IDirect3DDevice9;
+struct IDirect3DDevice9Ex;
+struct IDirect3DSurface9;
+
+// pthread mutexes on Linux are implemented with futexes and do not enter the kernel if there is no contention.
+typedef pthread_mutex_t     RFPlatformMutex;
+typedef pthread_cond_t      RFPlatformCondVar;
+typedef pid_t               RFThreadId;
+
+#endif // defined WIN32 || defined _WIN32
+
+
+//////////////////////////////////////////////////////////
+// Mutex
+//////////////////////////////////////////////////////////
+
+inline void rfMutexInit(RFPlatformMutex* pMutex)
+{
+#if defined WIN32 || defined _WIN32
+    InitializeCriticalSection(pMutex);
+#else
+    // Make the mutex recursive to match the behaviour of a CRITICAL_SECTION.
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+
+    pthread_mutex_init(pMutex, &attr);
+
+    pthread_mutexattr_destroy(&attr);
+#endif
+}
+
+
+inline void rfMutexDestroy(RFPlatformMutex* pMutex)
+{
+#if defined WIN32 || defined _WIN32
+    // Release just in case lock is still used.
+    LeaveCriticalSection(pMutex);
+
+    DeleteCriticalSection(pMutex);
+#else
+    pthread_mutex_destroy(pMutex);
+#endif
+}
+
+
+inline bool rfMutexLock(RFPlatformMutex* pMutex)
+{
+#if defined WIN32 || defined _WIN32
+    try
+    {
+        EnterCriticalSection(pMutex);
+    }
+    catch (...)
+    {
+        // Catch possible exception EXCEPTION_POSSIBLE_DEADLOCK.
+        return false;
+    }
+
+    return true;
+#else
+    return (pthread_mutex_lock(pMutex) == 0);
+#endif
+}
+
+
+inline void rfMutexUnlock(RFPlatformMutex* pMutex)
+{
+#if defined WIN32 || defined _WIN32
+    LeaveCriticalSection(pMutex);
+#else
+    pthread_mutex_unlock(pMutex);
+#endif
+}
+
+
+//////////////////////////////////////////////////////////
+// Condition variable
+//////////////////////////////////////////////////////////
+
+// Timeout value that makes rfCondWait wait without time limit.
+#define RF_PLATFORM_INFINITE_NS     UINT64_MAX
+
+
+inline void rfCondInit(RFPlatformCondVar* pCond)
+{
+#if defined WIN32 || defined _WIN32
+    InitializeConditionVariable(pCond);
+#else
+    // Use the monotonic clock for timeouts, otherwise changes of the system time would affect waiting threads.
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(pCond, &attr);
+    pthread_condattr_destroy(&attr);
+#endif
+}
+
+
+inline void rfCondDestroy(RFPlatformCondVar* pCond)
+{
+#if defined WIN32 || defined _WIN32
+    // Windows condition variables do not need to be deleted.
+    (void)pCond;
+#else
+    pthread_cond_destroy(pCond);
+#endif
+}
+
+
+inline void rfCondBroadcast(RFPlatformCondVar* pCond)
+{
+#if defined WIN32 || defined _WIN32
+    WakeAllConditionVariable(pCond);
+#else
+    pthread_cond_broadcast(pCond);
+#endif
+}
+
+
+// Releases pMutex, waits until the condition variable is signaled or uiTimeoutNs elapsed and locks pMutex again.
+// Returns false on timeout. Like any condition variable the wait may return early without being signaled.
+inline bool rfCondWait(RFPlatformCondVar* pCond, RFPlatformMutex* pMutex, uint64_t uiTimeoutNs)
+{
+#if defined WIN32 || defined _WIN32
+    DWORD dwTimeoutMs = INFINITE;
+
+    if (uiTimeoutNs < static_cast<uint64_t>(INFINITE) * 1000000ULL)
+    {
+        // Round up, otherwise timeouts below 1 ms would not wait at all.
+        dwTimeoutMs = static_cast<DWORD>((uiTimeoutNs + 999999ULL) / 1000000ULL);
+    }
+
+    return (SleepConditionVariableCS(pCond, pMutex, dwTimeoutMs) != 0);
+#else
+    if (uiTimeoutNs == RF_PLATFORM_INFINITE_NS)
+    {
+        return (pthread_cond_wait(pCond, pMutex) == 0);
+    }
+
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    const uint64_t uiNs = static_cast<uint64_t>(ts.tv_nsec) + (uiTimeoutNs % 1000000000ULL);
+
+    ts.tv_sec  += static_cast<time_t>(uiTimeoutNs / 1000000000ULL + uiNs / 1000000000ULL);
+    ts.tv_nsec  = static_cast<long>(uiNs % 1000000000ULL);
+
+    return (pthread_cond_timedwait(pCond, pMutex, &ts) == 0);
+#endif
+}
+
+
+//////////////////////////////////////////////////////////
+// Threads and time
+//////////////////////////////////////////////////////////
+
+inline RFThreadId rfGetCurrentThreadId()
+{
+#if defined WIN32 || defined _WIN32
+    return GetCurrentThreadId();
+#else
+    return static_cast<RFThreadId>(syscall(SYS_gettid));
+#endif
+}
+
+
+// Gives up the remaining time slice of the calling thread.
+inline void rfYield()
+{
+#if defined WIN32 || defined _WIN32
+    Sleep(0);
+#else
+    sched_yield();
+#endif
+}
+
+
+inline void rfSleep(unsigned int uiMilliSeconds)
+{
+#if defined WIN32 || defined _WIN32
+    Sleep(uiMilliSeconds);
+#else
+    usleep(uiMilliSeconds * 1000);
+#endif
+}
+
+
+// Returns a monotonic time stamp in nanoseconds.
+inline uint64_t rfGetTimeNs()
+{
+#if defined WIN32 || defined _WIN32
+    static LARGE_INTEGER freq = { 0 };
+
+    if (freq.QuadPart == 0)
+    {
+        QueryPerformanceFrequency(&freq);
+    }
+
+    LARGE_INTEGER time;
+    QueryPerformanceCounter(&time);
+
+    // Split the conversion to avoid an overflow of the counter multiplication.
+    const uint64_t uiSeconds   = time.QuadPart / freq.QuadPart;
+    const uint64_t uiRemainder = time.QuadPart % freq.QuadPart;
+
+    return uiSeconds * 1000000000ULL + (uiRemainder * 1000000000ULL) / freq.QuadPart;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+
+// Returns the local time split into its components.
+inline void rfGetLocalTime(tm& localTime)
+{
+    time_t now = time(nullptr);
+
+#if defined WIN32 || defined _WIN32
+    localtime_s(&localTime, &now);
+#else
+    localtime_r(&now, &localTime);
+#endif
+}
+
+
+//////////////////////////////////////////////////////////
+// Environment
+//////////////////////////////////////////////////////////
+
+// Returns the value of the environment variable or an empty string if it is not set.
+inline std::string rfGetEnv(const char* pName)
+{
+    std::string strValue;
+
+#if defined WIN32 || defined _WIN32
+    char*   pEnvVar = nullptr;
+    size_t  len = 0;
+
+    if (_dupenv_s(&pEnvVar, &len, pName) == 0 && pEnvVar)
+    {
+        strValue = pEnvVar;
+    }
+
+    free(pEnvVar);
+#else
+    const char* pEnvVar = getenv(pName);
+
+    if (pEnvVar)
+    {
+        strValue = pEnvVar;
+    }
+#endif
+
+    return strValue;
+}
+
+
+//////////////////////////////////////////////////////////
+// Memory
+//////////////////////////////////////////////////////////
+
+// Allocates uiSize bytes aligned to uiAlignment. uiAlignment needs to be a power of two. Returns nullptr on failure.
+inline void* rfAlignedMalloc(size_t uiSize, size_t uiAlignment)
+{
+#if defined WIN32 || defined _WIN32
+    return _aligned_malloc(uiSize, uiAlignment);
+#else
+    void* pMem = nullptr;
+
+    if (posix_memalign(&pMem, uiAlignment, uiSize) != 0)
+    {
+        return nullptr;
+    }
+
+    return pMem;
+#endif
+}
+
+
+inline void rfAlignedFree(void* pMem)
+{
+#if defined WIN32 || defined _WIN32
+    _aligned_free(pMem);
+#else
+    free(pMem);
+#endif
+}
+
+
+//////////////////////////////////////////////////////////
+// CPU features
+//////////////////////////////////////////////////////////
+
+// Executes cpuid for the leaf and subleaf and stores eax, ebx, ecx and edx in cpuInfo.
+inline void rfCpuid(int cpuInfo[4], int nLeaf, int nSubLeaf)
+{
+#if defined WIN32 || defined _WIN32
+    __cpuidex(cpuInfo, nLeaf, nSubLeaf);
+#else
+    unsigned int uiInfo[4] = { 0 };
+
+    __cpuid_count(nLeaf, nSubLeaf, uiInfo[0], uiInfo[1], uiInfo[2], uiInfo[3]);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        cpuInfo[i] = static_cast<int>(uiInfo[i]);
+    }
+#endif
+}
+
+
+// Returns the value of the extended control register XCR0. Only valid if the OS supports XSAVE.
+inline uint64_t rfGetXCR0()
+{
+#if defined WIN32 || defined _WIN32
+    return _xgetbv(0);
+#else
+    unsigned int uiEax = 0;
+    unsigned int uiEdx = 0;
+
+    __asm__ volatile ("xgetbv" : "=a" (uiEax), "=d" (uiEdx) : "c" (0));
+
+    return (static_cast<uint64_t>(uiEdx) << 32) | uiEax;
+#endif
+}
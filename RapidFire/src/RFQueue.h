@@ -0,0 +1,364 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <stddef.h>
+
+#include <atomic>
+#include <memory>
+
+// Indices written by different threads are separated by at least one cache line to avoid false sharing.
+#define RF_CACHE_LINE_SIZE      64
+
+
+// Returns the smallest power of two that is >= uiValue.
+inline size_t rfNextPowerOfTwo(size_t uiValue)
+{
+    size_t uiPow = 1;
+
+    while (uiPow < uiValue)
+    {
+        uiPow <<= 1;
+    }
+
+    return uiPow;
+}
+
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// push may only be called by the producer, front and pop only by the consumer. size can be called
+// by either thread. The result may already be outdated when it is used but never exceeds the capacity.
+// reset is not thread safe and must only be called while no other thread is using the queue.
+template <class T>
+class RFSPSCQueue
+{
+public:
+
+    explicit RFSPSCQueue(size_t uiCapacity)
+        : m_uiCapacity(0)
+        , m_uiMask(0)
+        , m_pBuffer()
+        , m_uiTail(0)
+        , m_uiCachedHead(0)
+        , m_uiHead(0)
+        , m_uiCachedTail(0)
+    {
+        reset(uiCapacity);
+    }
+
+
+    // Discards all elements and sets a new capacity.
+    void reset(size_t uiCapacity)
+    {
+        const size_t uiBufferSize = rfNextPowerOfTwo(uiCapacity);
+
+        m_pBuffer.reset(new T[uiBufferSize]);
+
+        m_uiCapacity = uiCapacity;
+        m_uiMask     = uiBufferSize - 1;
+
+        m_uiTail.store(0, std::memory_order_relaxed);
+        m_uiHead.store(0, std::memory_order_relaxed);
+
+        m_uiCachedHead = 0;
+        m_uiCachedTail = 0;
+    }
+
+
+    // Producer: Returns false if the queue is full.
+    bool push(const T& elem)
+    {
+        const size_t uiTail = m_uiTail.load(std::memory_order_relaxed);
+
+        if (uiTail - m_uiCachedHead >= m_uiCapacity)
+        {
+            // Only read the index of the consumer if the queue looks full.
+            m_uiCachedHead = m_uiHead.load(std::memory_order_acquire);
+
+            if (uiTail - m_uiCachedHead >= m_uiCapacity)
+            {
+                return false;
+            }
+        }
+
+        m_pBuffer[uiTail & m_uiMask] = elem;
+
+        m_uiTail.store(uiTail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+
+    // Consumer: Returns false if the queue is empty.
+    bool front(T& elem)
+    {
+        const size_t uiHead = m_uiHead.load(std::memory_order_relaxed);
+
+        if (!isAvailable(uiHead))
+        {
+            return false;
+        }
+
+        elem = m_pBuffer[uiHead & m_uiMask];
+
+        return true;
+    }
+
+
+    // Consumer: Returns false if the queue is empty.
+    bool pop(T& elem)
+    {
+        const size_t uiHead = m_uiHead.load(std::memory_order_relaxed);
+
+        if (!isAvailable(uiHead))
+        {
+            return false;
+        }
+
+        elem = m_pBuffer[uiHead & m_uiMask];
+
+        m_uiHead.store(uiHead + 1, std::memory_order_release);
+
+        return true;
+    }
+
+
+    size_t size() const
+    {
+        // Read head first. The tail can only grow, so the difference cannot become negative.
+        const size_t uiHead = m_uiHead.load(std::memory_order_acquire);
+        const size_t uiTail = m_uiTail.load(std::memory_order_acquire);
+
+        const size_t uiSize = uiTail - uiHead;
+
+        return (uiSize < m_uiCapacity) ? uiSize : m_uiCapacity;
+    }
+
+
+    size_t capacity() const { return m_uiCapacity; }
+
+private:
+
+    // Disable copy constructor.
+    RFSPSCQueue(const RFSPSCQueue& other);
+    // Disable assignment operator.
+    RFSPSCQueue& operator=(const RFSPSCQueue& rhs);
+
+    bool isAvailable(size_t uiHead)
+    {
+        if (uiHead != m_uiCachedTail)
+        {
+            return true;
+        }
+
+        // Only read the index of the producer if the queue looks empty.
+        m_uiCachedTail = m_uiTail.load(std::memory_order_acquire);
+
+        return (uiHead != m_uiCachedTail);
+    }
+
+    // Read-only after reset.
+    size_t                  m_uiCapacity;
+    size_t                  m_uiMask;
+    std::unique_ptr<T[]>    m_pBuffer;
+
+    char                    m_Pad0[RF_CACHE_LINE_SIZE];
+
+    // Written by the producer.
+    std::atomic<size_t>     m_uiTail;
+    size_t                  m_uiCachedHead;
+
+    char                    m_Pad1[RF_CACHE_LINE_SIZE];
+
+    // Written by the consumer.
+    std::atomic<size_t>     m_uiHead;
+    size_t                  m_uiCachedTail;
+
+    char                    m_Pad2[RF_CACHE_LINE_SIZE];
+};
+
+
+// Bounded lock-free queue for any number of producer and consumer threads. Each slot carries a
+// sequence number that tells producers and consumers whether the slot is free or holds an element.
+// The capacity is rounded up to the next power of two.
+// reset is not thread safe and must only be called while no other thread is using the queue.
+template <class T>
+class RFMPMCQueue
+{
+public:
+
+    explicit RFMPMCQueue(size_t uiCapacity)
+        : m_uiMask(0)
+        , m_pCells()
+        , m_uiEnqueuePos(0)
+        , m_uiDequeuePos(0)
+    {
+        reset(uiCapacity);
+    }
+
+
+    // Discards all elements and sets a new capacity.
+    void reset(size_t uiCapacity)
+    {
+        const size_t uiBufferSize = rfNextPowerOfTwo((uiCapacity < 2) ? 2 : uiCapacity);
+
+        m_pCells.reset(new Cell[uiBufferSize]);
+
+        for (size_t i = 0; i < uiBufferSize; ++i)
+        {
+            m_pCells[i].uiSequence.store(i, std::memory_order_relaxed);
+        }
+
+        m_uiMask = uiBufferSize - 1;
+
+        m_uiEnqueuePos.store(0, std::memory_order_relaxed);
+        m_uiDequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+
+    // Returns false if the queue is full.
+    bool push(const T& elem)
+    {
+        size_t uiPos = m_uiEnqueuePos.load(std::memory_order_relaxed);
+        Cell*  pCell = nullptr;
+
+        for (;;)
+        {
+            pCell = &m_pCells[uiPos & m_uiMask];
+
+            const size_t    uiSeq = pCell->uiSequence.load(std::memory_order_acquire);
+            const ptrdiff_t nDiff = static_cast<ptrdiff_t>(uiSeq) - static_cast<ptrdiff_t>(uiPos);
+
+            if (nDiff == 0)
+            {
+                // Slot is free, try to claim it.
+                if (m_uiEnqueuePos.compare_exchange_weak(uiPos, uiPos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (nDiff < 0)
+            {
+                // Slot still holds an element from the previous round.
+                return false;
+            }
+            else
+            {
+                // Another producer claimed the slot.
+                uiPos = m_uiEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        pCell->data = elem;
+        pCell->uiSequence.store(uiPos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+
+    // Returns false if the queue is empty.
+    bool pop(T& elem)
+    {
+        size_t uiPos = m_uiDequeuePos.load(std::memory_order_relaxed);
+        Cell*  pCell = nullptr;
+
+        for (;;)
+        {
+            pCell = &m_pCells[uiPos & m_uiMask];
+
+            const size_t    uiSeq = pCell->uiSequence.load(std::memory_order_acquire);
+            const ptrdiff_t nDiff = static_cast<ptrdiff_t>(uiSeq) - static_cast<ptrdiff_t>(uiPos + 1);
+
+            if (nDiff == 0)
+            {
+                // Slot holds an element, try to claim it.
+                if (m_uiDequeuePos.compare_exchange_weak(uiPos, uiPos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (nDiff < 0)
+            {
+                // Slot was not yet written.
+                return false;
+            }
+            else
+            {
+                // Another consumer claimed the slot.
+                uiPos = m_uiDequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        elem = pCell->data;
+        pCell->uiSequence.store(uiPos + m_uiMask + 1, std::memory_order_release);
+
+        return true;
+    }
+
+
+    // Approximate number of elements. Only exact if no other thread is using the queue.
+    size_t size() const
+    {
+        const size_t uiDequeuePos = m_uiDequeuePos.load(std::memory_order_acquire);
+        const size_t uiEnqueuePos = m_uiEnqueuePos.load(std::memory_order_acquire);
+
+        if (uiEnqueuePos <= uiDequeuePos)
+        {
+            return 0;
+        }
+
+        const size_t uiSize = uiEnqueuePos - uiDequeuePos;
+
+        return (uiSize <= m_uiMask) ? uiSize : m_uiMask + 1;
+    }
+
+
+    size_t capacity() const { return m_uiMask + 1; }
+
+private:
+
+    // Disable copy constructor.
+    RFMPMCQueue(const RFMPMCQueue& other);
+    // Disable assignment operator.
+    RFMPMCQueue& operator=(const RFMPMCQueue& rhs);
+
+    struct Cell
+    {
+        std::atomic<size_t>     uiSequence;
+        T                       data;
+    };
+
+    // Read-only after reset.
+    size_t                      m_uiMask;
+    std::unique_ptr<Cell[]>     m_pCells;
+
+    char                        m_Pad0[RF_CACHE_LINE_SIZE];
+
+    std::atomic<size_t>         m_uiEnqueuePos;
+
+    char                        m_Pad1[RF_CACHE_LINE_SIZE];
+
+    std::atomic<size_t>         m_uiDequeuePos;
+
+    char                        m_Pad2[RF_CACHE_LINE_SIZE];
+};
@@ -22,6 +22,8 @@
 
 #include "RFSession.h"
 
+#include <string.h>
+
 #include <sstream>
 
 #include "RFContextAMF.h"
@@ -29,8 +31,9 @@
 #include "RFEncoderAMF.h"
 #include "RFEncoderDM.h"
 #include "RFEncoderIdentity.h"
+#include "RFEncoderLossless.h"
 #include "RFEncoderSettings.h"
-#include "RFMouseGrab.h"
+#include "RFTrace.h"
 #include "RFUtils.h"
 
 // Global lock that can be used to make sure only one thread can work on a resource.
@@ -39,16 +42,35 @@
 // cannot be interrupted by another thread belonging to the same session.
 static RFLock g_GlobalSessionLock;
 
+// Time the completion thread waits for a frame before it checks if it needs to terminate.
+#define COMPLETION_WAIT_SLICE_NS        50000000ULL
+// Time to wait for each frame that is still in flight when the completion thread is stopped.
+#define COMPLETION_DRAIN_TIMEOUT_NS     100000000ULL
+
 
 RFSession::RFSession(RFEncoderID rfEncoder)
     : m_ParameterMap()
     , m_uiResultBuffer(0)
     , m_pSessionLog(nullptr)
+    , m_pTrace(nullptr)
     , m_pContextCL(nullptr)
     , m_pEncoder(nullptr)
     , m_pEncoderSettings(nullptr)
-    , m_BufferQueue()
+    , m_BufferQueue(DEFAULT_PIPELINE_DEPTH)
+    , m_ReaderLock()
+    , m_SubmitTimeNs(DEFAULT_PIPELINE_DEPTH, 0)
+    , m_uiFramesSubmitted(0)
+    , m_uiFramesEncoded(0)
+    , m_uiFramesDropped(0)
+    , m_uiQueueFullCount(0)
+    , m_uiEncodedBytes(0)
+    , m_bAsyncEncode(false)
+    , m_uiAsyncFrameId(0)
+    , m_bRunCompletionThread(false)
+    , m_bAsyncRequestsBlocked(false)
+    , m_AsyncRequests(DEFAULT_PIPELINE_DEPTH)
     , m_SessionLock()
+    , m_CompletionLock()
 {
     // Local lock: Make sure no other thread of the session interrupts the session creation.
     RFReadWriteAccess enabler(&m_SessionLock);
@@ -62,6 +84,7 @@ RFSession::RFSession(RFEncoderID rfEncoder)
         m_ParameterMap.addParameter(RF_FLIP_SOURCE, RFParameterAttr("RF_FLIP_SOURCE", RF_PARAMETER_BOOL, 0));
         m_ParameterMap.addParameter(RF_ASYNC_SOURCE_COPY, RFParameterAttr("RF_ASYNC_SOURCE_COPY", RF_PARAMETER_BOOL, 0));
         m_ParameterMap.addParameter(RF_ENCODER_BLOCKING_READ, RFParameterAttr("RF_ENCODER_BLOCKING_READ", RF_PARAMETER_BOOL, 0));
+        m_ParameterMap.addParameter(RF_PIPELINE_DEPTH, RFParameterAttr("RF_PIPELINE_DEPTH", RF_PARAMETER_UINT, DEFAULT_PIPELINE_DEPTH));
     }
     catch (const std::exception& e)
     {
@@ -86,6 +109,10 @@ RFSession::RFSession(RFEncoderID rfEncoder)
 
 RFSession::~RFSession()
 {
+    // The completion thread uses the encoder, stop it before any member gets destroyed. This is done
+    // without holding the global lock since the application callbacks might use other sessions.
+    stopCompletionThread();
+
     // Global lock. Make sure session deletion is not interupted.
     RFReadWriteAccess enabler(&g_GlobalSessionLock);
 }
@@ -99,15 +126,7 @@ RFStatus RFSession::createContext()
 
     try
     {
-        if (m_Properties.EncoderId == RF_AMF)
-        {
-            m_pContextCL = std::unique_ptr<RFContextAMF>(new RFContextAMF);
-        }
-        else
-        {
-            m_pContextCL = std::unique_ptr<RFContextCL>(new RFContextCL);
-        }
-
+        m_pContextCL = std::unique_ptr<RFContextCL>(createContextInstance());
     }
     catch (const std::exception& e)
     {
@@ -120,7 +139,27 @@ RFStatus RFSession::createContext()
         return (m_Properties.EncoderId == RF_AMF) ? RF_STATUS_AMF_FAIL : RF_STATUS_OPENCL_FAIL;
     }
 
-    RFStatus rfStatus = createContextFromGfx();
+    m_pContextCL->setTrace(m_pTrace.get());
+
+    // The pipeline depth defines the size of the render target and result buffer rings of the context.
+    unsigned int uiPipelineDepth = DEFAULT_PIPELINE_DEPTH;
+
+    m_ParameterMap.getParameterValue(RF_PIPELINE_DEPTH, uiPipelineDepth);
+
+    RFStatus rfStatus = m_pContextCL->setPipelineDepth(uiPipelineDepth);
+
+    if (rfStatus != RF_STATUS_OK)
+    {
+        std::stringstream oss;
+
+        oss << "[CreateContext]: Invalid pipeline depth " << uiPipelineDepth << ". Valid range is " << MIN_PIPELINE_DEPTH << " to " << MAX_PIPELINE_DEPTH;
+
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, oss.str());
+
+        return rfStatus;
+    }
+
+    rfStatus = createContextFromGfx();
 
     if (rfStatus != RF_STATUS_OK)
     {
@@ -131,6 +170,17 @@ RFStatus RFSession::createContext()
 }
 
 
+RFContextCL* RFSession::createContextInstance()
+{
+    if (m_Properties.EncoderId == RF_AMF)
+    {
+        return new RFContextAMF;
+    }
+
+    return new RFContextCL;
+}
+
+
 RFStatus RFSession::createEncoder(unsigned int uiWidth, unsigned int uiHeight, const RFVideoCodec codec, const RFEncodePreset preset)
 {
     RFStatus rfStatus;
@@ -254,6 +304,92 @@ RFStatus RFSession::encodeFrame(unsigned int idx)
     // Local lock: Make sure no other thread of this session is using the resources
     RFReadWriteAccess enabler(&m_SessionLock);
 
+    if (m_bAsyncEncode)
+    {
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[rfEncodeFrame] Session uses rfEncodeFrameAsync");
+        return RF_STATUS_FAIL;
+    }
+
+    return submitFrame(idx, true, nullptr);
+}
+
+
+RFStatus RFSession::encodeFrameAsync(unsigned int idx, RFEncodeCallback pCallback, void* pUserData)
+{
+    // Local lock: Make sure no other thread of this session is using the resources
+    RFReadWriteAccess enabler(&m_SessionLock);
+
+    if (!pCallback)
+    {
+        return RF_STATUS_FAIL;
+    }
+
+    if (!m_pEncoder)
+    {
+        return RF_STATUS_INVALID_ENCODER;
+    }
+
+    if (m_bAsyncRequestsBlocked)
+    {
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[rfEncodeFrameAsync] Session is being resized or deleted");
+        return RF_STATUS_FAIL;
+    }
+
+    RFAsyncRequest request;
+
+    memset(&request, 0, sizeof(request));
+
+    request.pCallback                 = pCallback;
+    request.pUserData                 = pUserData;
+    request.FrameInfo.uiSubmitTimeNs  = rfGetTimeNs();
+
+    const bool bFirstRequest = !m_bAsyncEncode;
+
+    // Frames submitted by encodeFrame have no request, the completion thread would pass them to the wrong callback.
+    if (bFirstRequest && m_BufferQueue.size() > 0)
+    {
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[rfEncodeFrameAsync] Frames of rfEncodeFrame were not retrieved");
+        return RF_STATUS_FAIL;
+    }
+
+    RFStatus rfStatus = startCompletionThread();
+
+    if (rfStatus != RF_STATUS_OK)
+    {
+        return rfStatus;
+    }
+
+    // From now on frames are only returned by the completion thread. The flag is set before the frame is submitted
+    // so that getEncodedFrame cannot take it.
+    m_bAsyncEncode = true;
+
+    // Do not accept a previous frame if there is no new frame, each request needs its own frame.
+    rfStatus = submitFrame(idx, false, &request.FrameInfo);
+
+    if (rfStatus != RF_STATUS_OK)
+    {
+        // The session stays in synchronous mode if the first request fails.
+        if (bFirstRequest)
+        {
+            m_bAsyncEncode = false;
+        }
+
+        return rfStatus;
+    }
+
+    request.FrameInfo.uiFrameId = m_uiAsyncFrameId++;
+
+    // The request queue has the same size as m_BufferQueue and submitFrame succeeded, so there is space left.
+    m_AsyncRequests.push(request);
+
+    m_AsyncRequestSignal.notify();
+
+    return RF_STATUS_OK;
+}
+
+
+RFStatus RFSession::submitFrame(unsigned int idx, bool bAcceptQueuedFrame, RFEncodedFrameInfo* pFrameInfo)
+{
     // Check if we have a valid encoder. Having a valid encoder implies thet we have a valid
     // context as well.
     if (!m_pEncoder)
@@ -270,18 +406,29 @@ RFStatus RFSession::encodeFrame(unsigned int idx)
     // existing buffer. The app needs to call getEncodedFrame to free the buffers.
     if (m_BufferQueue.size() >= m_pContextCL->getNumResultBuffers())
     {
+        ++m_uiQueueFullCount;
         return RF_STATUS_QUEUE_FULL;
     }
 
-    // Run pre processor. This function might be implemented by a derived class like e.g. DesktopSession.
-    // ATTENTION: idx might be changed by preprocessFrame to map on some internally created RTs.
-    RFStatus rfStatus = preprocessFrame(idx);
+    const uint64_t uiSubmitTimeNs = rfGetTimeNs();
+
+    RFTraceScope encodeFrameScope(m_pTrace.get(), RF_TRACE_ENCODE_FRAME, idx);
+
+    RFStatus rfStatus;
+
+    {
+        RFTraceScope preprocessScope(m_pTrace.get(), RF_TRACE_PREPROCESS, idx);
+
+        // Run pre processor. This function might be implemented by a derived class like e.g. DesktopSession.
+        // ATTENTION: idx might be changed by preprocessFrame to map on some internally created RTs.
+        rfStatus = preprocessFrame(idx);
+    }
 
     if (rfStatus != RF_STATUS_OK)
     {
         // Preprocessing failed -> we have no new data but if a frame is still in the reslut queue
         // we can return this frame without error notification to the application
-        if (m_BufferQueue.size() > 0)
+        if (bAcceptQueuedFrame && m_BufferQueue.size() > 0)
         {
             return RF_STATUS_OK;
         }
@@ -289,20 +436,57 @@ RFStatus RFSession::encodeFrame(unsigned int idx)
         return rfStatus;
     }
 
+    if (pFrameInfo)
+    {
+        pFrameInfo->uiPreprocessTimeNs = rfGetTimeNs();
+    }
+
     // Processes input texture and stores it in the result buffer. The result buffer can be used as input
     // for the encoders. During this process the CSC can be done and the image can get inverted.
     // If a sys mem buffer was requested when createBuffers was called, a transfer of the result to sys
     // mem is triggered.
-    SAFE_CALL_RF(m_pContextCL->processBuffer(m_Properties.bEncoderCSC, m_Properties.bInvertInput, idx, m_uiResultBuffer));
+    {
+        RFTraceScope processScope(m_pTrace.get(), RF_TRACE_PROCESS_BUFFER, m_uiResultBuffer);
+
+        SAFE_CALL_RF(m_pContextCL->processBuffer(m_Properties.bEncoderCSC, m_Properties.bInvertInput, idx, m_uiResultBuffer));
+    }
+
+    {
+        RFTraceScope encodeScope(m_pTrace.get(), RF_TRACE_ENCODE, m_uiResultBuffer);
+
+        // Encode frame
+        rfStatus = m_pEncoder->encode(m_uiResultBuffer, !m_Properties.bEncoderCSC);
+    }
+
+    if (rfStatus != RF_STATUS_OK)
+    {
+        // The encoder has no free output buffer.
+        if (rfStatus == RF_STATUS_QUEUE_FULL)
+        {
+            ++m_uiQueueFullCount;
+        }
+
+        rfError(rfStatus, getErrorStringRF(rfStatus), __FILE__, __LINE__);
+
+        return rfStatus;
+    }
 
-    // Encode frame
-    SAFE_CALL_RF(m_pEncoder->encode(m_uiResultBuffer, !m_Properties.bEncoderCSC));
+    if (pFrameInfo)
+    {
+        pFrameInfo->uiEncodeTimeNs = rfGetTimeNs();
+    }
 
     // Store result buffer index in queue since processBuffer filled a new resultBuffer. The ResultBuffer
     // should only be considered as valid if the enode call succeeded. Only in this case a valid pair of
     // ResultBuffer and Enoced Buffer exist that then can be queried by the application.
+    m_SubmitTimeNs[m_uiResultBuffer] = uiSubmitTimeNs;
+
     m_BufferQueue.push(m_uiResultBuffer);
 
+    m_FrameSubmittedSignal.notify();
+
+    ++m_uiFramesSubmitted;
+
     // Switch to next result buffer for new frame.
     m_uiResultBuffer = (m_uiResultBuffer + 1) % m_pContextCL->getNumResultBuffers();
 
@@ -311,6 +495,18 @@ RFStatus RFSession::encodeFrame(unsigned int idx)
 
 
 RFStatus RFSession::getEncodedFrame(unsigned int& uiSize, void* &pBitStream)
+{
+    if (m_bAsyncEncode)
+    {
+        // Frames are returned by the completion thread.
+        return RF_STATUS_FAIL;
+    }
+
+    return retrieveEncodedFrame(uiSize, pBitStream);
+}
+
+
+RFStatus RFSession::retrieveEncodedFrame(unsigned int& uiSize, void* &pBitStream)
 {
     if (!m_pEncoder)
     {
@@ -320,49 +516,126 @@ RFStatus RFSession::getEncodedFrame(unsigned int& uiSize, void* &pBitStream)
     uiSize = 0;
     pBitStream = nullptr;
 
+    // Reader lock: Only one consumer may use m_BufferQueue and resize must not recreate it meanwhile.
+    RFReadWriteAccess readerEnabler(&m_ReaderLock);
+
     RFStatus status = RF_STATUS_OK;
 
-    status = m_pEncoder->getEncodedFrame(uiSize, pBitStream);
+    unsigned int idx = 0;
+
+    // The encoder may provide the frame before submitFrame stored the index. Do not take the frame
+    // from the encoder in that case, otherwise m_BufferQueue and the encoded frames get out of sync.
+    if (!m_BufferQueue.front(idx))
+    {
+        return RF_STATUS_NO_ENCODED_FRAME;
+    }
+
+    {
+        RFTraceScope getScope(m_pTrace.get(), RF_TRACE_GET_ENCODED_FRAME, idx);
+
+        status = m_pEncoder->getEncodedFrame(uiSize, pBitStream);
+    }
 
-    if (status == RF_STATUS_OK && m_BufferQueue.size() > 0)
+    if (status == RF_STATUS_OK)
     {
         // We got a frame encoded, remove index from buffer queue.
-        m_BufferQueue.pop();
+        m_BufferQueue.pop(idx);
+
+        m_LatencyHistogram.add(rfGetTimeNs() - m_SubmitTimeNs[idx]);
+
+        ++m_uiFramesEncoded;
+        m_uiEncodedBytes += uiSize;
     }
 
     return status;
 }
 
 
-RFStatus RFSession::getSourceFrame(unsigned int& uiSize, void* &pBitStream)
+RFStatus RFSession::waitEncodedFrame(uint64_t uiTimeoutNs, unsigned int& uiSize, void* &pBitStream)
 {
     if (!m_pEncoder)
     {
         return RF_STATUS_INVALID_ENCODER;
     }
 
+    if (m_bAsyncEncode)
+    {
+        return RF_STATUS_FAIL;
+    }
+
     uiSize = 0;
     pBitStream = nullptr;
 
-    unsigned int idx = 0;
+    RFTraceScope waitScope(m_pTrace.get(), RF_TRACE_WAIT_ENCODED_FRAME, 0);
+
+    const uint64_t uiStart = rfGetTimeNs();
+
+    // The encoder signals when a frame is ready, the thread sleeps until then.
+    RFStatus status = m_pEncoder->waitForEncodedFrame(uiTimeoutNs);
 
+    if (status != RF_STATUS_OK)
     {
-        // Local lock: Ensure that m_BufferQueue is not accessed by other threads.
-        // This is required if an async reader thread is used. In this case encodeFrame
-        // might access the queue while we read the front index.
-        RFReadWriteAccess enabler(&m_SessionLock);
+        return status;
+    }
+
+    for (;;)
+    {
+        // The encoder might finish the frame before submitFrame stored its index. Read the count before checking
+        // the queue, a push after the check changes it and the wait returns immediately.
+        const uint64_t uiCount = m_FrameSubmittedSignal.getCount();
+
+        if (m_BufferQueue.size() > 0)
+        {
+            break;
+        }
 
-        if (m_BufferQueue.size() == 0)
+        uint64_t uiRemainingNs = RF_PLATFORM_INFINITE_NS;
+
+        if (uiTimeoutNs != RF_PLATFORM_INFINITE_NS)
         {
-            return RF_STATUS_NO_ENCODED_FRAME;
+            const uint64_t uiElapsedNs = rfGetTimeNs() - uiStart;
+
+            if (uiElapsedNs >= uiTimeoutNs)
+            {
+                return RF_STATUS_NO_ENCODED_FRAME;
+            }
+
+            uiRemainingNs = uiTimeoutNs - uiElapsedNs;
         }
 
-        // Get index of the oldest element in the queue. This is the index that will be used for the next call to
-        // get getEncodedFrame. If getSourceFrame is called prior to getEncoded frame the source frame is the one
-        // that was used to generate the encoded frame.
-        idx = m_BufferQueue.front();
+        m_FrameSubmittedSignal.wait(uiCount, uiRemainingNs);
     }
 
+    return getEncodedFrame(uiSize, pBitStream);
+}
+
+
+RFStatus RFSession::getSourceFrame(unsigned int& uiSize, void* &pBitStream)
+{
+    if (!m_pEncoder)
+    {
+        return RF_STATUS_INVALID_ENCODER;
+    }
+
+    uiSize = 0;
+    pBitStream = nullptr;
+
+    // Reader lock: getSourceFrame and getEncodedFrame may be called by different threads. Both are consumers
+    // of m_BufferQueue. The session lock is not needed since encodeFrame only pushes to the queue.
+    RFReadWriteAccess readerEnabler(&m_ReaderLock);
+
+    unsigned int idx = 0;
+
+    // Get index of the oldest element in the queue. This is the index that will be used for the next call to
+    // get getEncodedFrame. If getSourceFrame is called prior to getEncoded frame the source frame is the one
+    // that was used to generate the encoded frame.
+    if (!m_BufferQueue.front(idx))
+    {
+        return RF_STATUS_NO_ENCODED_FRAME;
+    }
+
+    RFTraceScope getScope(m_pTrace.get(), RF_TRACE_GET_SOURCE_FRAME, idx);
+
     void* pBuffer = nullptr;
 
     m_pContextCL->getResultBuffer(idx, pBuffer);
@@ -380,6 +653,205 @@ RFStatus RFSession::getSourceFrame(unsigned int& uiSize, void* &pBitStream)
 }
 
 
+RFStatus RFSession::startCompletionThread()
+{
+    if (m_CompletionThread.joinable())
+    {
+        return RF_STATUS_OK;
+    }
+
+    m_bRunCompletionThread = true;
+
+    try
+    {
+        m_CompletionThread = std::thread(&RFSession::completionLoop, this);
+    }
+    catch (const std::exception& e)
+    {
+        m_bRunCompletionThread = false;
+
+        std::stringstream oss;
+
+        oss << "[rfEncodeFrameAsync] Failed to start completion thread: " << e.what();
+
+        m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, oss.str());
+
+        return RF_STATUS_FAIL;
+    }
+
+    return RF_STATUS_OK;
+}
+
+
+void RFSession::stopCompletionThread()
+{
+    RFReadWriteAccess completionEnabler(&m_CompletionLock);
+
+    {
+        // Once the flag is set no new request is submitted and the completion thread is not restarted.
+        RFReadWriteAccess enabler(&m_SessionLock);
+
+        m_bAsyncRequestsBlocked = true;
+    }
+
+    if (!m_CompletionThread.joinable())
+    {
+        return;
+    }
+
+    m_bRunCompletionThread = false;
+
+    m_AsyncRequestSignal.notify();
+
+    m_CompletionThread.join();
+
+    // Return the frames that are still in flight.
+    while (m_AsyncRequests.size() > 0)
+    {
+        const bool bFrameReady = (m_pEncoder->waitForEncodedFrame(COMPLETION_DRAIN_TIMEOUT_NS) == RF_STATUS_OK);
+
+        // completeRequest fails the request itself on other errors.
+        if (!bFrameReady || completeRequest() == RF_STATUS_NO_ENCODED_FRAME)
+        {
+            // The encoder does not return the remaining frames. The application still gets the callbacks
+            // to release pUserData.
+            while (m_AsyncRequests.size() > 0)
+            {
+                failRequest(RF_STATUS_NO_ENCODED_FRAME);
+            }
+        }
+    }
+}
+
+
+void RFSession::completionLoop()
+{
+    for (;;)
+    {
+        // Read the count before checking the stop flag and the queue. A request or a stop that happens
+        // after the check will change it.
+        const uint64_t uiCount = m_AsyncRequestSignal.getCount();
+
+        if (!m_bRunCompletionThread)
+        {
+            break;
+        }
+
+        if (m_AsyncRequests.size() == 0)
+        {
+            m_AsyncRequestSignal.wait(uiCount, RF_PLATFORM_INFINITE_NS);
+            continue;
+        }
+
+        // Wait in slices to check regularly if the thread needs to terminate.
+        if (m_pEncoder->waitForEncodedFrame(COMPLETION_WAIT_SLICE_NS) == RF_STATUS_OK)
+        {
+            completeRequest();
+        }
+    }
+}
+
+
+RFStatus RFSession::completeRequest()
+{
+    RFAsyncRequest request;
+
+    if (!m_AsyncRequests.front(request))
+    {
+        return RF_STATUS_NO_ENCODED_FRAME;
+    }
+
+    RFEncodedFrameInfo& frameInfo = request.FrameInfo;
+
+    // On success retrieveEncodedFrame removes the buffer index of the request from m_BufferQueue.
+    frameInfo.rfStatus = retrieveEncodedFrame(frameInfo.uiSize, frameInfo.pBitStream);
+
+    if (frameInfo.rfStatus == RF_STATUS_NO_ENCODED_FRAME)
+    {
+        // Keep the request until its frame is ready.
+        return frameInfo.rfStatus;
+    }
+
+    if (frameInfo.rfStatus != RF_STATUS_OK)
+    {
+        failRequest(frameInfo.rfStatus);
+
+        return frameInfo.rfStatus;
+    }
+
+    RFAsyncRequest completedRequest;
+
+    m_AsyncRequests.pop(completedRequest);
+
+    frameInfo.uiCompleteTimeNs = rfGetTimeNs();
+
+    request.pCallback(reinterpret_cast<RFEncodeSession>(this), &frameInfo, request.pUserData);
+
+    return RF_STATUS_OK;
+}
+
+
+void RFSession::failRequest(RFStatus rfStatus)
+{
+    RFAsyncRequest request;
+
+    if (!m_AsyncRequests.pop(request))
+    {
+        return;
+    }
+
+    {
+        // Reader lock: getSourceFrame might read m_BufferQueue at the same time.
+        RFReadWriteAccess readerEnabler(&m_ReaderLock);
+
+        // Remove the buffer index of the request as well to keep both queues in sync.
+        unsigned int idx = 0;
+
+        if (m_BufferQueue.pop(idx))
+        {
+            ++m_uiFramesDropped;
+        }
+    }
+
+    RFEncodedFrameInfo& frameInfo = request.FrameInfo;
+
+    frameInfo.rfStatus          = rfStatus;
+    frameInfo.uiCompleteTimeNs  = rfGetTimeNs();
+
+    request.pCallback(reinterpret_cast<RFEncodeSession>(this), &frameInfo, request.pUserData);
+}
+
+
+RFStatus RFSession::getSessionStats(RFSessionStats& stats) const
+{
+    stats.uiFramesSubmitted = m_uiFramesSubmitted;
+    stats.uiFramesEncoded   = m_uiFramesEncoded;
+    stats.uiFramesDropped   = m_uiFramesDropped;
+    stats.uiQueueFullCount  = m_uiQueueFullCount;
+    stats.uiQueueDepth      = static_cast<unsigned int>(m_BufferQueue.size());
+    stats.uiEncodedBytes    = m_uiEncodedBytes;
+    stats.uiLatencyP50Ns    = m_LatencyHistogram.getPercentile(0.50);
+    stats.uiLatencyP95Ns    = m_LatencyHistogram.getPercentile(0.95);
+    stats.uiLatencyP99Ns    = m_LatencyHistogram.getPercentile(0.99);
+
+    return RF_STATUS_OK;
+}
+
+
+RFStatus RFSession::getChangedBlocks(unsigned int uiVersion, unsigned char* pBlockMap, unsigned int uiSize, unsigned int& uiCurrentVersion)
+{
+    if (!m_pEncoder)
+    {
+        return RF_STATUS_INVALID_ENCODER;
+    }
+
+    // Local lock: The block versions are updated by the encoder.
+    RFReadWriteAccess enabler(&m_SessionLock);
+
+    return m_pEncoder->getChangedBlocks(uiVersion, pBlockMap, uiSize, uiCurrentVersion);
+}
+
+
 RFStatus RFSession::releaseEvent(RFNotification const rfEvent)
 {
     // Local lock: Make sure no other thread of this session is using the resources.
@@ -391,10 +863,10 @@ RFStatus RFSession::releaseEvent(RFNotification const rfEvent)
 
 RFStatus RFSession::resize(unsigned int uiWidth, unsigned int uiHeight)
 {
-    // Local lock: Make sure no other thread of this session is using the resources.
-    RFReadWriteAccess enabler(&m_SessionLock);
-
-    m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_INFO, "Changing resolution");
+    if (!m_pEncoder)
+    {
+        return RF_STATUS_INVALID_ENCODER;
+    }
 
     if (!m_pEncoder->isResizeSupported())
     {
@@ -403,6 +875,32 @@ RFStatus RFSession::resize(unsigned int uiWidth, unsigned int uiHeight)
         return RF_STATUS_FAIL;
     }
 
+    // Make sure no other resize is stopping the completion thread or accepting new requests at the same time.
+    RFReadWriteAccess completionEnabler(&m_CompletionLock);
+
+    // Frames that are still in flight are returned before the buffers are deleted. This is done without
+    // holding m_SessionLock since the application callbacks might call functions of this session.
+    stopCompletionThread();
+
+    // Local lock: Make sure no other thread of this session is using the resources.
+    RFReadWriteAccess enabler(&m_SessionLock);
+
+    RFStatus rfStatus = resizeBuffers(uiWidth, uiHeight);
+
+    // The completion thread is restarted by the next call to encodeFrameAsync.
+    m_bAsyncRequestsBlocked = false;
+
+    return rfStatus;
+}
+
+
+RFStatus RFSession::resizeBuffers(unsigned int uiWidth, unsigned int uiHeight)
+{
+    // Reader lock: A reader thread must not access the buffers, the encoder or m_BufferQueue while they are recreated.
+    RFReadWriteAccess readerEnabler(&m_ReaderLock);
+
+    m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_INFO, "Changing resolution");
+
     // Free all OpenCL buffers.
     RFStatus rfStatus = m_pContextCL->deleteBuffers();
 
@@ -412,6 +910,10 @@ RFStatus RFSession::resize(unsigned int uiWidth, unsigned int uiHeight)
         return RF_STATUS_FAIL;
     }
 
+    // Frames that were not retrieved yet are lost with the buffers.
+    m_uiFramesDropped += m_BufferQueue.size();
+    m_BufferQueue.reset(m_pContextCL->getNumResultBuffers());
+
     // Resize the encoder.
     m_pEncoderSettings->setDimension(uiWidth, uiHeight);
 
@@ -634,6 +1136,29 @@ RFStatus RFSession::createEncoder()
             break;
         }
 
+        case RF_DIFFERENCE_TILES:
+        {
+            // The difference encoder appends the pixels of the changed blocks to the diff map.
+            pEncoder = new (std::nothrow)RFEncoderDM(true);
+            if (!pEncoder)
+            {
+                m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[rfCreateEncoder] Failed to create DIFFERENCE_TILES encoder");
+                return RF_STATUS_FAIL;
+            }
+            break;
+        }
+
+        case RF_LOSSLESS_TILES:
+        {
+            pEncoder = new (std::nothrow)RFEncoderLossless;
+            if (!pEncoder)
+            {
+                m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[rfCreateEncoder] Failed to create LOSSLESS_TILES encoder");
+                return RF_STATUS_FAIL;
+            }
+            break;
+        }
+
         default:
             m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_ERROR, "[rfCreateEncoder] No encoder defined");
             return RF_STATUS_INVALID_ENCODER;
@@ -690,10 +1215,15 @@ RFStatus RFSession::createEncoder()
         m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_INFO, oss.str());
     }
 
-    // Make sure the buffer queue is empty.
-    while (m_BufferQueue.size() > 0)
     {
-        m_BufferQueue.pop();
+        // Reader lock: m_pEncoder is already set, so a reader thread might access the queue.
+        RFReadWriteAccess readerEnabler(&m_ReaderLock);
+
+        // Make sure the buffer queue is empty and can hold one entry per result buffer.
+        m_uiFramesDropped += m_BufferQueue.size();
+        m_BufferQueue.reset(m_pContextCL->getNumResultBuffers());
+        m_SubmitTimeNs.assign(m_pContextCL->getNumResultBuffers(), 0);
+        m_AsyncRequests.reset(m_pContextCL->getNumResultBuffers());
     }
 
     m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_INFO, "[rfCreateEncoder] RFEncoder create successfully");
@@ -706,24 +1236,15 @@ RFStatus RFSession::createEncoder()
 }
 
 
-void RFSession::createSessionLog()
+// Returns the directory stored in the environment variable pName with a trailing '/' or an empty string
+// if the variable is not set.
+static std::string getDirectoryFromEnv(const char* pName)
 {
-    DWORD dwThreadId = GetCurrentThreadId();
-
-    static unsigned int uiSessionCount = 0;
+    std::string strPath = rfGetEnv(pName);
 
-    char*   pEnvVar = nullptr;
-    size_t  len = 0;
-
-    _dupenv_s(&pEnvVar, &len, "RF_LOG_PATH");
-
-    std::string strLogPath;
-
-    if (len > 0 && pEnvVar)
+    if (!strPath.empty())
     {
-        strLogPath = std::string(pEnvVar);
-
-        for (auto& c : strLogPath)
+        for (auto& c : strPath)
         {
             if (c == '\\')
             {
@@ -731,13 +1252,23 @@ void RFSession::createSessionLog()
             }
         }
 
-        if (strLogPath.rfind('/') != strLogPath.size() - 1)
+        if (strPath.rfind('/') != strPath.size() - 1)
         {
-            strLogPath += '/';
+            strPath += '/';
         }
     }
 
-    free(pEnvVar);
+    return strPath;
+}
+
+
+void RFSession::createSessionLog()
+{
+    RFThreadId threadId = rfGetCurrentThreadId();
+
+    static unsigned int uiSessionCount = 0;
+
+    std::string strLogPath = getDirectoryFromEnv("RF_LOG_PATH");
 
     if (uiSessionCount == 0)
     {
@@ -746,12 +1277,29 @@ void RFSession::createSessionLog()
     ++uiSessionCount;
 
     std::stringstream oss;
-    oss << strLogPath << "RFEncodeSession_" << uiSessionCount << "_" << dwThreadId << ".log";
+    oss << strLogPath << "RFEncodeSession_" << uiSessionCount << "_" << threadId << ".log";
 
     m_pSessionLog = std::unique_ptr<RFLogFile>(new RFLogFile(oss.str()));
 
     m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_INFO, "[rfCreateEncodeSession] Create session");
 
+    // Per frame timings are only recorded if a directory for the trace file is defined. The trace is written
+    // in the Chrome trace event format when the session is deleted.
+    std::string strTracePath = getDirectoryFromEnv("RF_TRACE_PATH");
+
+    if (!strTracePath.empty())
+    {
+        std::stringstream ossTrace;
+        ossTrace << strTracePath << "RFEncodeSession_" << uiSessionCount << "_" << threadId << ".json";
+
+        m_pTrace = std::unique_ptr<RFTrace>(new (std::nothrow) RFTrace(ossTrace.str(), uiSessionCount));
+
+        if (m_pTrace)
+        {
+            m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_INFO, "[rfCreateEncodeSession] Tracing to " + ossTrace.str());
+        }
+    }
+
     // Dump version info.
     std::string strPath;
     std::string strVersion;
@@ -920,6 +1468,7 @@ void RFSession::validateEncoderSettings()
 
 bool RFSession::getModuleInformation(std::string& strPath, std::string& strVersion)
 {
+#if defined WIN32 || defined _WIN32
     size_t const    maxlength = 512;
 
 #ifdef _WIN64
@@ -974,6 +1523,22 @@ bool RFSession::getModuleInformation(std::string& strPath, std::string& strVersi
     strVersion = oss.str();
 
     return true;
+#else
+    // Query the shared object that contains this function.
+    Dl_info dlInfo;
+
+    if (!dladdr(&g_GlobalSessionLock, &dlInfo) || !dlInfo.dli_fname)
+    {
+        return false;
+    }
+
+    strPath = std::string(dlInfo.dli_fname);
+
+    // Shared objects do not have a version resource.
+    strVersion = "unknown";
+
+    return true;
+#endif
 }
 
 
@@ -991,7 +1556,7 @@ RFStatus RFSession::parseEncoderProperties(const RFProperties* props)
 
     if (props)
     {
-        const struct Element
+        struct Element
         {
             int             name;
             RFProperties    ptr;
@@ -1079,6 +1644,14 @@ void RFSession::dumpContextProperties()
                 oss << "RF_NV12";
                 break;
 
+            case RF_I420:
+                oss << "RF_I420";
+                break;
+
+            case RF_P010:
+                oss << "RF_P010";
+                break;
+
             default:
                 oss << "RF_UNKNOWN";
                 break;
@@ -1089,6 +1662,8 @@ void RFSession::dumpContextProperties()
 
         oss << "\t\t\t Async Copy : " << m_pContextCL->getAsyncCopy() << std::endl;
 
+        oss << "\t\t\t Buffers    : " << m_pContextCL->getNumResultBuffers() << std::endl;
+
         m_pSessionLog->logMessage(RFLogFile::MessageType::RF_LOG_INFO, oss.str());
     }
 }
\ No newline at end of file
@@ -22,17 +22,22 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
-#include <queue>
+#include <thread>
+#include <vector>
 
 #include "RFContext.h"
 #include "RFEncoder.h"
 #include "RFLock.h"
 #include "RFPropertyMap.h"
+#include "RFQueue.h"
+#include "RFStats.h"
 
 class RFEncoderSettings;
 class RFMouseGrab;
 class RFLogFile;
+class RFTrace;
 
 class RFSession
 {
@@ -58,13 +63,25 @@ public:
     // Encodes the OpenCL input buffer.
     RFStatus              encodeFrame(unsigned int idx);
 
+    // Encodes the OpenCL input buffer and calls pCallback from the completion thread once the frame is encoded.
+    RFStatus              encodeFrameAsync(unsigned int idx, RFEncodeCallback pCallback, void* pUserData);
+
     // Returns the encoded frame.
     RFStatus              getEncodedFrame(unsigned int& uiSize, void* &pBitStream);
 
+    // Waits until an encoded frame is available or uiTimeoutNs elapsed and returns it.
+    RFStatus              waitEncodedFrame(uint64_t uiTimeoutNs, unsigned int& uiSize, void* &pBitStream);
+
     RFStatus              getSourceFrame(unsigned int& uiSize, void* &pBitStream);
 
     RFStatus              releaseEvent(const RFNotification rfEvent);
 
+    // Returns the frame counters and latency percentiles. Can be called by any thread.
+    RFStatus              getSessionStats(RFSessionStats& stats) const;
+
+    // Returns the blocks that changed after frame uiVersion and the version of the last returned frame.
+    RFStatus              getChangedBlocks(unsigned int uiVersion, unsigned char* pBlockMap, unsigned int uiSize, unsigned int& uiCurrentVersion);
+
     RFStatus              resize(unsigned int uiWidth, unsigned int uiHeight);
 
     RFStatus              setParameter(const int param, RFProperties value);
@@ -97,6 +114,9 @@ protected:
 
     RFParameterMap                        m_ParameterMap;
 
+    // Records per frame timings of the pipeline stages. Only created if RF_TRACE_PATH is set.
+    std::unique_ptr<RFTrace>              m_pTrace;
+
     // OpenCL Context used for CSC
     std::unique_ptr<RFContextCL>          m_pContextCL;
 
@@ -111,6 +131,10 @@ private:
     // on the GFX context. The function is called by createContext().
     virtual RFStatus            createContextFromGfx() = 0;
 
+    // This function might be implemented by a derived class to create a different context. The default
+    // implementation creates a RFContextAMF for the AMF encoder and a RFContextCL otherwise.
+    virtual RFContextCL*        createContextInstance();
+
     // This function needs to be implemented by a derived class to allow texture registration based on the used
     // Gfx context. The function is called by registerRenderTarget.
     virtual RFStatus            registerTexture(RFTexture rt, unsigned int uiWidth, unsigned int uiHeight, unsigned int& idx) = 0;
@@ -141,6 +165,41 @@ private:
 
     RFStatus                    createEncoder();
 
+    // Recreates the buffers and the encoder with the new dimension. The caller needs to hold m_SessionLock.
+    // Readers are blocked by m_ReaderLock until the buffers are recreated.
+    RFStatus                    resizeBuffers(unsigned int uiWidth, unsigned int uiHeight);
+
+    // Processes and encodes the frame. If bAcceptQueuedFrame is set and preprocessing provided no new frame, RF_STATUS_OK is
+    // returned as long as a previous frame is still queued. If pFrameInfo is set, the time stamps of the stages are stored.
+    // The caller needs to hold m_SessionLock.
+    RFStatus                    submitFrame(unsigned int idx, bool bAcceptQueuedFrame, RFEncodedFrameInfo* pFrameInfo);
+
+    // Returns the oldest encoded frame and removes its index from m_BufferQueue. Takes m_ReaderLock.
+    RFStatus                    retrieveEncodedFrame(unsigned int& uiSize, void* &pBitStream);
+
+    RFStatus                    startCompletionThread();
+
+    // Stops the completion thread and calls the callbacks of all frames that are still in flight. Afterwards
+    // encodeFrameAsync rejects new requests until m_bAsyncRequestsBlocked is cleared. The caller must not
+    // hold m_SessionLock since the callbacks may call functions of the session.
+    void                        stopCompletionThread();
+
+    void                        completionLoop();
+
+    // Retrieves the encoded frame of the oldest request and calls its callback. Returns RF_STATUS_NO_ENCODED_FRAME
+    // and keeps the request if the frame is not ready. On other errors the request is failed.
+    RFStatus                    completeRequest();
+
+    // Removes the oldest request together with its buffer index and calls its callback with rfStatus.
+    void                        failRequest(RFStatus rfStatus);
+
+    struct RFAsyncRequest
+    {
+        RFEncodeCallback        pCallback;
+        void*                   pUserData;
+        RFEncodedFrameInfo      FrameInfo;
+    };
+
     // Returns the path to the RF DLL that was loaded and the version of the DLL
     bool                        getModuleInformation(std::string& strPath, std::string& strVersion);
 
@@ -153,10 +212,48 @@ private:
     // The encoder that is used by the session
     std::unique_ptr<RFEncoder>                      m_pEncoder;
 
-    // List of submitted buffers
-    RFLockedQueue<unsigned int>                     m_BufferQueue;
+    // List of submitted buffers. Filled by encodeFrame and drained by getEncodedFrame which may run
+    // on a separate reader thread.
+    RFSPSCQueue<unsigned int>                       m_BufferQueue;
+
+    // Serializes the consumers of m_BufferQueue (getEncodedFrame, getSourceFrame and the completion thread).
+    // Held by resize and createEncoder while the buffers and the queue are recreated. encodeFrame does not use it.
+    RFLock                                          m_ReaderLock;
+
+    // Notified by submitFrame after an index was pushed to m_BufferQueue. Used by waitEncodedFrame.
+    RFSignal                                        m_FrameSubmittedSignal;
+
+    // Time each result buffer was submitted. Written by submitFrame before the index is pushed to m_BufferQueue.
+    std::vector<uint64_t>                           m_SubmitTimeNs;
+
+    // Statistics returned by getSessionStats.
+    std::atomic<uint64_t>                           m_uiFramesSubmitted;
+    std::atomic<uint64_t>                           m_uiFramesEncoded;
+    std::atomic<uint64_t>                           m_uiFramesDropped;
+    std::atomic<uint64_t>                           m_uiQueueFullCount;
+    std::atomic<uint64_t>                           m_uiEncodedBytes;
+    // Time between submitFrame and the successful retrieval of the encoded frame.
+    RFHistogram                                     m_LatencyHistogram;
+
+    // Set by the first successful call to encodeFrameAsync. Afterwards frames are only returned by the completion thread.
+    std::atomic<bool>                               m_bAsyncEncode;
+    unsigned int                                    m_uiAsyncFrameId;
+
+    std::atomic<bool>                               m_bRunCompletionThread;
+    std::thread                                     m_CompletionThread;
+
+    // Set by stopCompletionThread. encodeFrameAsync rejects requests while it is set. Protected by m_SessionLock.
+    bool                                            m_bAsyncRequestsBlocked;
+
+    // Requests of encodeFrameAsync in submission order. Filled by encodeFrameAsync and drained by the completion thread.
+    RFSPSCQueue<RFAsyncRequest>                     m_AsyncRequests;
+    RFSignal                                        m_AsyncRequestSignal;
 
     RFLock                                          m_SessionLock;
+
+    // Serializes stopCompletionThread and resize. Unlike m_SessionLock it is held while the callbacks
+    // of the drained requests are called.
+    RFLock                                          m_CompletionLock;
 };
 
 extern RFStatus createRFSession(RFSession** session, const RFProperties* properties);
\ No newline at end of file
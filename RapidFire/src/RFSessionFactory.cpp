@@ -20,14 +20,21 @@
 // THE SOFTWARE.
 //
 
+#if defined WIN32 || defined _WIN32
 #define _CRTDBG_MAP_ALLOC
 #include <crtdbg.h>
+#endif
 #include <iostream>
+#include <limits.h>
 #include <map>
 #include <stdlib.h>
 
+#if defined WIN32 || defined _WIN32
 #include "RFDOPPSession.h"
 #include "RFGfxSession.h"
+#endif
+#include "RFFileSession.h"
+#include "RFHostSession.h"
 
 
 RFStatus createRFSession(RFSession** pSession, const RFProperties* properties)
@@ -50,8 +57,8 @@ RFStatus createRFSession(RFSession** pSession, const RFProperties* properties)
     const Element* p = reinterpret_cast<const Element*>(properties);
 
 
-    HGLRC                   hGLRC  = NULL;
-    HDC                     hDC    = NULL;
+    GraphicsCtx             hGLRC  = NULL;
+    DeviceCtx               hDC    = NULL;
     IDirect3DDevice9*       pDX9   = nullptr;
     IDirect3DDevice9Ex*     pDX9Ex = nullptr;
     ID3D11Device*           pDX11  = nullptr;
@@ -60,6 +67,9 @@ RFStatus createRFSession(RFSession** pSession, const RFProperties* properties)
     unsigned int            uiDisplay = 0;
     unsigned int            uiInternalDisplayId = UINT_MAX;
 
+    bool                    bHostMemory = false;
+    const char*             pFileSource = nullptr;
+
     RFEncoderID             rfEncoder = RF_ENCODER_UNKNOWN;
 
     /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -72,6 +82,8 @@ RFStatus createRFSession(RFSession** pSession, const RFProperties* properties)
     //          c. Dx9Ex          -> RF_D3D9EX_DEVICE needs to be set
     //          d. Dx11           -> RF_D3D11_DEVICE needs to be set
     //          e. Desktop        -> RF_DESKTOP or RF_DESKTOP_DSP_ID need to be set
+    //          f. System memory  -> RF_HOST_MEMORY needs to be set
+    //          g. File           -> RF_FILE_SOURCE needs to be set
     //
     // All remaining properties are optional and are passed to the session. Depending on the session
     // type different parameters are supported
@@ -87,11 +99,11 @@ RFStatus createRFSession(RFSession** pSession, const RFProperties* properties)
                 break;
 
             case RF_GL_GRAPHICS_CTX:
-                hGLRC = reinterpret_cast<HGLRC>(p->ptr);
+                hGLRC = reinterpret_cast<GraphicsCtx>(p->ptr);
                 break;
 
             case RF_GL_DEVICE_CTX:
-                hDC = reinterpret_cast<HDC>(p->ptr);
+                hDC = reinterpret_cast<DeviceCtx>(p->ptr);
                 break;
 
             case RF_D3D9_DEVICE:
@@ -118,6 +130,14 @@ RFStatus createRFSession(RFSession** pSession, const RFProperties* properties)
                 uiInternalDisplayId = static_cast<unsigned int>(p->ptr);
                 break;
 
+            case RF_HOST_MEMORY:
+                bHostMemory = (p->ptr != 0);
+                break;
+
+            case RF_FILE_SOURCE:
+                pFileSource = reinterpret_cast<const char*>(p->ptr);
+                break;
+
             default:
                 parameters[p->name] = p->ptr;
         }
@@ -134,7 +154,24 @@ RFStatus createRFSession(RFSession** pSession, const RFProperties* properties)
     try
     {
         // Make sure we have a valid session description
-        if (hDC && hGLRC && pDX9 == nullptr && pDX9Ex == nullptr && pDX11 == nullptr && uiDesktop == 0 && uiDisplay == 0 && uiInternalDisplayId == UINT_MAX)
+        if (pFileSource)
+        {
+            // File session, no other source may be specified
+            if (!bHostMemory && hDC == NULL && hGLRC == NULL && pDX9 == nullptr && pDX9Ex == nullptr && pDX11 == nullptr && uiDesktop == 0 && uiDisplay == 0 && uiInternalDisplayId == UINT_MAX)
+            {
+                *pSession = new RFFileSession(rfEncoder);
+            }
+        }
+        else if (bHostMemory)
+        {
+            // Host memory session, no graphics context or desktop may be specified
+            if (hDC == NULL && hGLRC == NULL && pDX9 == nullptr && pDX9Ex == nullptr && pDX11 == nullptr && uiDesktop == 0 && uiDisplay == 0 && uiInternalDisplayId == UINT_MAX)
+            {
+                *pSession = new RFHostSession(rfEncoder);
+            }
+        }
+#if defined WIN32 || defined _WIN32
+        else if (hDC && hGLRC && pDX9 == nullptr && pDX9Ex == nullptr && pDX11 == nullptr && uiDesktop == 0 && uiDisplay == 0 && uiInternalDisplayId == UINT_MAX)
         {
             // GL Session
             *pSession = new RFGLSession(hDC, hGLRC, rfEncoder);
@@ -169,6 +206,7 @@ RFStatus createRFSession(RFSession** pSession, const RFProperties* properties)
             // Desktop session based on internal Display ID
             *pSession = new RFDOPPSession(rfEncoder, hDC, hGLRC);
         }
+#endif
     }
     catch (...)
     {
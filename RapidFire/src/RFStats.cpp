@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "RFStats.h"
+
+#include <cmath>
+
+
+RFHistogram::RFHistogram()
+    : m_uiCount(0)
+    , m_uiMax(0)
+{
+    for (unsigned int i = 0; i < RF_HISTOGRAM_BUCKETS; ++i)
+    {
+        m_uiBuckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+
+void RFHistogram::add(uint64_t uiValue)
+{
+    m_uiBuckets[getBucket(uiValue)].fetch_add(1, std::memory_order_relaxed);
+    m_uiCount.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t uiMax = m_uiMax.load(std::memory_order_relaxed);
+
+    while (uiValue > uiMax && !m_uiMax.compare_exchange_weak(uiMax, uiValue, std::memory_order_relaxed))
+    {
+    }
+}
+
+
+uint64_t RFHistogram::getPercentile(double fPercentile) const
+{
+    // Sum up the buckets instead of using m_uiCount, other threads might add values while the buckets are read.
+    uint64_t uiCount = 0;
+
+    for (unsigned int i = 0; i < RF_HISTOGRAM_BUCKETS; ++i)
+    {
+        uiCount += m_uiBuckets[i].load(std::memory_order_relaxed);
+    }
+
+    if (uiCount == 0)
+    {
+        return 0;
+    }
+
+    fPercentile = (fPercentile < 0.0) ? 0.0 : ((fPercentile > 1.0) ? 1.0 : fPercentile);
+
+    // Rank of the value that is returned, starting with 1.
+    uint64_t uiRank = static_cast<uint64_t>(std::ceil(fPercentile * static_cast<double>(uiCount)));
+
+    if (uiRank == 0)
+    {
+        uiRank = 1;
+    }
+
+    const uint64_t uiMax = m_uiMax.load(std::memory_order_relaxed);
+
+    uint64_t uiSum = 0;
+
+    for (unsigned int i = 0; i < RF_HISTOGRAM_BUCKETS; ++i)
+    {
+        uiSum += m_uiBuckets[i].load(std::memory_order_relaxed);
+
+        if (uiSum >= uiRank)
+        {
+            // The largest value is known exactly, do not report a bound above it.
+            const uint64_t uiBound = getBucketUpperBound(i);
+
+            return (uiBound < uiMax) ? uiBound : uiMax;
+        }
+    }
+
+    return uiMax;
+}
+
+
+unsigned int RFHistogram::getBucket(uint64_t uiValue)
+{
+    if (uiValue < RF_HISTOGRAM_SUB_BUCKETS)
+    {
+        return static_cast<unsigned int>(uiValue);
+    }
+
+    // Find the index of the highest set bit.
+    unsigned int uiExp = 0;
+
+    for (unsigned int uiShift = 32; uiShift > 0; uiShift >>= 1)
+    {
+        if (uiValue >> (uiExp + uiShift))
+        {
+            uiExp += uiShift;
+        }
+    }
+
+    // The bits below the highest set bit select the linear sub bucket.
+    const unsigned int uiSubBucket = static_cast<unsigned int>(uiValue >> (uiExp - RF_HISTOGRAM_SUB_BUCKET_BITS)) & (RF_HISTOGRAM_SUB_BUCKETS - 1);
+
+    return (uiExp - RF_HISTOGRAM_SUB_BUCKET_BITS + 1) * RF_HISTOGRAM_SUB_BUCKETS + uiSubBucket;
+}
+
+
+uint64_t RFHistogram::getBucketUpperBound(unsigned int uiBucket)
+{
+    if (uiBucket < RF_HISTOGRAM_SUB_BUCKETS)
+    {
+        return uiBucket;
+    }
+
+    const unsigned int uiShift     = uiBucket / RF_HISTOGRAM_SUB_BUCKETS - 1;
+    const uint64_t     uiSubBucket = uiBucket % RF_HISTOGRAM_SUB_BUCKETS;
+
+    // The last bucket ends at the largest uint64_t value.
+    if (uiShift == 64 - RF_HISTOGRAM_SUB_BUCKET_BITS && uiSubBucket == RF_HISTOGRAM_SUB_BUCKETS - 1)
+    {
+        return UINT64_MAX;
+    }
+
+    return ((RF_HISTOGRAM_SUB_BUCKETS + uiSubBucket + 1) << uiShift) - 1;
+}
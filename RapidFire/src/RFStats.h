@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Number of linear sub buckets per power of two. The relative error of a percentile is below 1 / RF_HISTOGRAM_SUB_BUCKETS.
+#define RF_HISTOGRAM_SUB_BUCKET_BITS    3
+#define RF_HISTOGRAM_SUB_BUCKETS        (1 << RF_HISTOGRAM_SUB_BUCKET_BITS)
+// Values below RF_HISTOGRAM_SUB_BUCKETS have their own bucket, each further power of two up to 2^63 gets RF_HISTOGRAM_SUB_BUCKETS.
+#define RF_HISTOGRAM_BUCKETS            ((64 - RF_HISTOGRAM_SUB_BUCKET_BITS + 1) * RF_HISTOGRAM_SUB_BUCKETS)
+
+
+// RFHistogram counts values in log-linear buckets of fixed size. Any thread may add values
+// or read percentiles without locking.
+class RFHistogram
+{
+public:
+
+    RFHistogram();
+
+    void        add(uint64_t uiValue);
+
+    // Returns the upper bound of the bucket that contains the fPercentile [0, 1] of all values or 0 if no value was added.
+    uint64_t    getPercentile(double fPercentile) const;
+
+    uint64_t    getCount() const { return m_uiCount.load(std::memory_order_relaxed); }
+
+private:
+
+    static unsigned int     getBucket(uint64_t uiValue);
+    static uint64_t         getBucketUpperBound(unsigned int uiBucket);
+
+    // disable copy constructor
+    RFHistogram(const RFHistogram& other);
+    // Disable assignment
+    RFHistogram& operator=(const RFHistogram& rhs);
+
+    std::atomic<uint64_t>   m_uiBuckets[RF_HISTOGRAM_BUCKETS];
+    std::atomic<uint64_t>   m_uiCount;
+    std::atomic<uint64_t>   m_uiMax;
+};
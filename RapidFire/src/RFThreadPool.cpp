@@ -0,0 +1,188 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "RFThreadPool.h"
+
+
+RFThreadPool::RFThreadPool(unsigned int uiNumThreads)
+    : m_bRun(true)
+    , m_uiJobId(0)
+    , m_pTask(nullptr)
+    , m_uiNumTasks(0)
+    , m_uiActiveWorkers(0)
+    , m_uiNextTask(0)
+    , m_uiPendingTasks(0)
+{
+    rfMutexInit(&m_Mutex);
+    rfCondInit(&m_JobCondVar);
+    rfCondInit(&m_DoneCondVar);
+
+    for (unsigned int i = 1; i < uiNumThreads; ++i)
+    {
+        try
+        {
+            m_Workers.push_back(std::thread(&RFThreadPool::workerLoop, this));
+        }
+        catch (...)
+        {
+            // Continue with the threads that were created.
+            break;
+        }
+    }
+}
+
+
+RFThreadPool::~RFThreadPool()
+{
+    rfMutexLock(&m_Mutex);
+
+    m_bRun = false;
+
+    rfCondBroadcast(&m_JobCondVar);
+
+    rfMutexUnlock(&m_Mutex);
+
+    for (auto& worker : m_Workers)
+    {
+        worker.join();
+    }
+
+    rfCondDestroy(&m_DoneCondVar);
+    rfCondDestroy(&m_JobCondVar);
+    rfMutexDestroy(&m_Mutex);
+}
+
+
+void RFThreadPool::run(unsigned int uiNumTasks, const std::function<void(unsigned int)>& task)
+{
+    if (uiNumTasks == 0)
+    {
+        return;
+    }
+
+    if (m_Workers.empty() || uiNumTasks == 1)
+    {
+        for (unsigned int i = 0; i < uiNumTasks; ++i)
+        {
+            task(i);
+        }
+
+        return;
+    }
+
+    rfMutexLock(&m_Mutex);
+
+    // A worker that was late for the previous job might still be looking for a task of it.
+    while (m_uiActiveWorkers > 0)
+    {
+        rfCondWait(&m_DoneCondVar, &m_Mutex, RF_PLATFORM_INFINITE_NS);
+    }
+
+    m_pTask      = &task;
+    m_uiNumTasks = uiNumTasks;
+
+    m_uiNextTask     = 0;
+    m_uiPendingTasks = uiNumTasks;
+
+    ++m_uiJobId;
+
+    rfCondBroadcast(&m_JobCondVar);
+
+    rfMutexUnlock(&m_Mutex);
+
+    executeTasks(&task, uiNumTasks);
+
+    rfMutexLock(&m_Mutex);
+
+    while (m_uiPendingTasks > 0)
+    {
+        rfCondWait(&m_DoneCondVar, &m_Mutex, RF_PLATFORM_INFINITE_NS);
+    }
+
+    m_pTask = nullptr;
+
+    rfMutexUnlock(&m_Mutex);
+}
+
+
+void RFThreadPool::workerLoop()
+{
+    uint64_t uiLastJobId = 0;
+
+    rfMutexLock(&m_Mutex);
+
+    for (;;)
+    {
+        while (m_bRun && m_uiJobId == uiLastJobId)
+        {
+            rfCondWait(&m_JobCondVar, &m_Mutex, RF_PLATFORM_INFINITE_NS);
+        }
+
+        if (!m_bRun)
+        {
+            break;
+        }
+
+        uiLastJobId = m_uiJobId;
+
+        const std::function<void(unsigned int)>* pTask = m_pTask;
+        const unsigned int uiNumTasks = m_uiNumTasks;
+
+        ++m_uiActiveWorkers;
+
+        rfMutexUnlock(&m_Mutex);
+
+        executeTasks(pTask, uiNumTasks);
+
+        rfMutexLock(&m_Mutex);
+
+        --m_uiActiveWorkers;
+
+        rfCondBroadcast(&m_DoneCondVar);
+    }
+
+    rfMutexUnlock(&m_Mutex);
+}
+
+
+void RFThreadPool::executeTasks(const std::function<void(unsigned int)>* pTask, unsigned int uiNumTasks)
+{
+    for (;;)
+    {
+        const unsigned int uiTask = m_uiNextTask.fetch_add(1);
+
+        if (uiTask >= uiNumTasks)
+        {
+            break;
+        }
+
+        (*pTask)(uiTask);
+
+        if (m_uiPendingTasks.fetch_sub(1) == 1)
+        {
+            // Take the lock, otherwise the notification could get lost between the check and the wait in run.
+            rfMutexLock(&m_Mutex);
+            rfCondBroadcast(&m_DoneCondVar);
+            rfMutexUnlock(&m_Mutex);
+        }
+    }
+}
@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "RFPlatform.h"
+
+// RFThreadPool executes the tasks of a job on a fixed set of worker threads. The thread calling run
+// executes tasks as well and returns once all tasks of the job have finished. Only one thread may
+// call run at a time.
+class RFThreadPool
+{
+public:
+
+    // Creates uiNumThreads - 1 worker threads. If threads cannot be created the caller executes all tasks.
+    explicit RFThreadPool(unsigned int uiNumThreads);
+    ~RFThreadPool();
+
+    // Calls task(i) for each i in [0, uiNumTasks) and blocks until all calls returned.
+    void            run(unsigned int uiNumTasks, const std::function<void(unsigned int)>& task);
+
+    // Returns the number of threads that execute tasks including the calling thread.
+    unsigned int    getNumThreads() const { return static_cast<unsigned int>(m_Workers.size()) + 1; }
+
+private:
+
+    void            workerLoop();
+
+    // Executes tasks of the current job until no task is left.
+    void            executeTasks(const std::function<void(unsigned int)>* pTask, unsigned int uiNumTasks);
+
+    // disable copy constructor
+    RFThreadPool(const RFThreadPool& other);
+    // Disable assignment
+    RFThreadPool& operator=(const RFThreadPool& rhs);
+
+    std::vector<std::thread>                    m_Workers;
+
+    // Protects the job description and the number of active workers.
+    RFPlatformMutex                             m_Mutex;
+    // Signaled when a new job is available or the pool is destroyed.
+    RFPlatformCondVar                           m_JobCondVar;
+    // Signaled when the last task of a job finished or a worker left a job.
+    RFPlatformCondVar                           m_DoneCondVar;
+
+    bool                                        m_bRun;
+    uint64_t                                    m_uiJobId;
+    const std::function<void(unsigned int)>*    m_pTask;
+    unsigned int                                m_uiNumTasks;
+    // Number of workers that took the current job and did not yet return from it.
+    unsigned int                                m_uiActiveWorkers;
+
+    std::atomic<unsigned int>                   m_uiNextTask;
+    std::atomic<unsigned int>                   m_uiPendingTasks;
+};
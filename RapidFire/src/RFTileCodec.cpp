@@ -0,0 +1,627 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "RFTileCodec.h"
+
+#include <string.h>
+
+#include <immintrin.h>
+
+#include "RFPlatform.h"
+#include "RFUtils.h"
+
+// The first byte of a tile selects how the pixels are stored.
+#define RF_TILE_MODE_STORED         0
+#define RF_TILE_MODE_CODED          1
+
+// Row filters. The residual of a pixel is the byte wise difference of the pixel and its prediction.
+#define RF_TILE_FILTER_LEFT         0
+#define RF_TILE_FILTER_UP           1
+#define RF_TILE_FILTER_GRADIENT     2
+#define RF_TILE_NUM_FILTERS         3
+
+// Opcodes of the coded residuals.
+#define RF_TILE_OP_RUN              0x00
+#define RF_TILE_OP_LONG_RUN         0x3F
+#define RF_TILE_OP_DIFF             0x40
+#define RF_TILE_OP_LUMA             0x80
+#define RF_TILE_OP_INDEX            0xC0
+#define RF_TILE_OP_RGB              0xFE
+#define RF_TILE_OP_RGBA             0xFF
+
+// Longest run that is stored in the opcode.
+#define RF_TILE_MAX_SHORT_RUN       63
+
+// The cache of recent pixels has 1 << RF_TILE_CACHE_BITS entries.
+#define RF_TILE_CACHE_BITS          5
+#define RF_TILE_CACHE_SIZE          (1 << RF_TILE_CACHE_BITS)
+
+// A pixel takes at most RF_TILE_OP_RGBA and 4 residual bytes.
+#define RF_TILE_MAX_BYTES_PER_PIXEL 5
+
+
+// Adds the 4 bytes of a and b without carry between the bytes.
+static inline uint32_t addBytes(uint32_t a, uint32_t b)
+{
+    return ((a & 0x7F7F7F7F) + (b & 0x7F7F7F7F)) ^ ((a ^ b) & 0x80808080);
+}
+
+
+// Subtracts the 4 bytes of b from a without borrow between the bytes.
+static inline uint32_t subBytes(uint32_t a, uint32_t b)
+{
+    return ((a | 0x80808080) - (b & 0x7F7F7F7F)) ^ ((a ^ ~b) & 0x80808080);
+}
+
+
+static inline uint32_t predictPixel(unsigned int uiFilter, uint32_t uiLeft, uint32_t uiUp, uint32_t uiUpLeft)
+{
+    if (uiFilter == RF_TILE_FILTER_LEFT)
+    {
+        return uiLeft;
+    }
+
+    if (uiFilter == RF_TILE_FILTER_UP)
+    {
+        return uiUp;
+    }
+
+    return subBytes(addBytes(uiLeft, uiUp), uiUpLeft);
+}
+
+
+static inline unsigned int getCacheIndex(uint32_t uiPixel)
+{
+    return (uiPixel * 0x9E3779B1) >> (32 - RF_TILE_CACHE_BITS);
+}
+
+
+// Returns the sum of the absolute values of the 4 signed bytes of uiResidual.
+static inline unsigned int getAbsSum(uint32_t uiResidual)
+{
+    unsigned int uiSum = 0;
+
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        const unsigned int uiByte = (uiResidual >> (8 * i)) & 0xFF;
+
+        uiSum += (uiByte < 128) ? uiByte : 256 - uiByte;
+    }
+
+    return uiSum;
+}
+
+
+// Computes the residuals of the pixels [uiStart, uiEnd) of a row for all filters and adds their cost to pCost. The
+// left neighbour of the first pixel and its upper left neighbour are the first pixel of the row above.
+static void predictPixels(const uint32_t* pRow, const uint32_t* pAbove, unsigned int uiStart, unsigned int uiEnd, unsigned int uiWidth,
+                          uint32_t* pResiduals, uint64_t* pCost)
+{
+    for (unsigned int x = uiStart; x < uiEnd; ++x)
+    {
+        const uint32_t uiLeft   = (x > 0) ? pRow[x - 1]   : pAbove[0];
+        const uint32_t uiUpLeft = (x > 0) ? pAbove[x - 1] : pAbove[0];
+
+        for (unsigned int f = 0; f < RF_TILE_NUM_FILTERS; ++f)
+        {
+            const uint32_t uiResidual = subBytes(pRow[x], predictPixel(f, uiLeft, pAbove[x], uiUpLeft));
+
+            pResiduals[f * uiWidth + x] = uiResidual;
+            pCost[f] += getAbsSum(uiResidual);
+        }
+    }
+}
+
+
+static void predictRowScalar(const uint32_t* pRow, const uint32_t* pAbove, unsigned int uiWidth, uint32_t* pResiduals, uint64_t* pCost)
+{
+    pCost[0] = 0;
+    pCost[1] = 0;
+    pCost[2] = 0;
+
+    predictPixels(pRow, pAbove, 0, uiWidth, uiWidth, pResiduals, pCost);
+}
+
+
+static unsigned int findNonZeroScalar(const uint32_t* pValues, unsigned int uiStart, unsigned int uiEnd)
+{
+    unsigned int i = uiStart;
+
+    while (i < uiEnd && pValues[i] == 0)
+    {
+        ++i;
+    }
+
+    return i;
+}
+
+
+RF_TARGET_AVX2 static void predictRowAVX2(const uint32_t* pRow, const uint32_t* pAbove, unsigned int uiWidth, uint32_t* pResiduals, uint64_t* pCost)
+{
+    // Moves each pixel one position up. The first position is replaced by the last pixel of the previous vector.
+    const __m256i ShiftLeft = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6);
+    const __m256i Zero      = _mm256_setzero_si256();
+
+    __m256i CostLeft     = _mm256_setzero_si256();
+    __m256i CostUp       = _mm256_setzero_si256();
+    __m256i CostGradient = _mm256_setzero_si256();
+
+    uint32_t uiLeft   = pAbove[0];
+    uint32_t uiUpLeft = pAbove[0];
+
+    unsigned int x = 0;
+
+    for (; x + 8 <= uiWidth; x += 8)
+    {
+        const __m256i Pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pRow + x));
+        const __m256i Up     = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pAbove + x));
+        const __m256i Left   = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(Pixels, ShiftLeft), _mm256_set1_epi32(static_cast<int>(uiLeft)), 1);
+        const __m256i UpLeft = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(Up, ShiftLeft), _mm256_set1_epi32(static_cast<int>(uiUpLeft)), 1);
+
+        const __m256i ResLeft     = _mm256_sub_epi8(Pixels, Left);
+        const __m256i ResUp       = _mm256_sub_epi8(Pixels, Up);
+        const __m256i ResGradient = _mm256_sub_epi8(Pixels, _mm256_sub_epi8(_mm256_add_epi8(Left, Up), UpLeft));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pResiduals + x), ResLeft);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pResiduals + uiWidth + x), ResUp);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pResiduals + 2 * uiWidth + x), ResGradient);
+
+        CostLeft     = _mm256_add_epi64(CostLeft,     _mm256_sad_epu8(_mm256_abs_epi8(ResLeft), Zero));
+        CostUp       = _mm256_add_epi64(CostUp,       _mm256_sad_epu8(_mm256_abs_epi8(ResUp), Zero));
+        CostGradient = _mm256_add_epi64(CostGradient, _mm256_sad_epu8(_mm256_abs_epi8(ResGradient), Zero));
+
+        uiLeft   = pRow[x + 7];
+        uiUpLeft = pAbove[x + 7];
+    }
+
+    uint64_t Sums[3][4];
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(Sums[0]), CostLeft);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(Sums[1]), CostUp);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(Sums[2]), CostGradient);
+
+    for (unsigned int f = 0; f < RF_TILE_NUM_FILTERS; ++f)
+    {
+        pCost[f] = Sums[f][0] + Sums[f][1] + Sums[f][2] + Sums[f][3];
+    }
+
+    predictPixels(pRow, pAbove, x, uiWidth, uiWidth, pResiduals, pCost);
+}
+
+
+RF_TARGET_AVX2 static unsigned int findNonZeroAVX2(const uint32_t* pValues, unsigned int uiStart, unsigned int uiEnd)
+{
+    const __m256i Zero = _mm256_setzero_si256();
+
+    unsigned int i = uiStart;
+
+    for (; i + 8 <= uiEnd; i += 8)
+    {
+        const __m256i Values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pValues + i));
+
+        int iZeroMask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(Values, Zero)));
+
+        if (iZeroMask != 0xFF)
+        {
+            while (iZeroMask & 1)
+            {
+                iZeroMask >>= 1;
+                ++i;
+            }
+
+            return i;
+        }
+    }
+
+    return findNonZeroScalar(pValues, i, uiEnd);
+}
+
+
+static unsigned char* writeRun(unsigned char* p, unsigned int uiRun)
+{
+    if (uiRun <= RF_TILE_MAX_SHORT_RUN)
+    {
+        *p++ = static_cast<unsigned char>(RF_TILE_OP_RUN + uiRun - 1);
+
+        return p;
+    }
+
+    *p++ = RF_TILE_OP_LONG_RUN;
+
+    // The length beyond the longest short run follows with 7 bits per byte, the lowest bits first.
+    unsigned int uiValue = uiRun - RF_TILE_MAX_SHORT_RUN - 1;
+
+    while (uiValue >= 0x80)
+    {
+        *p++ = static_cast<unsigned char>((uiValue & 0x7F) | 0x80);
+        uiValue >>= 7;
+    }
+
+    *p++ = static_cast<unsigned char>(uiValue);
+
+    return p;
+}
+
+
+RFTileCodec::RFTileCodec()
+    : m_uiTileWidth(0)
+    , m_uiTileHeight(0)
+    , m_pfnPredictRow(predictRowScalar)
+    , m_pfnFindNonZero(findNonZeroScalar)
+{
+    if (utilIsAVX2Supported())
+    {
+        m_pfnPredictRow  = predictRowAVX2;
+        m_pfnFindNonZero = findNonZeroAVX2;
+    }
+}
+
+
+bool RFTileCodec::init(unsigned int uiTileWidth, unsigned int uiTileHeight)
+{
+    if (uiTileWidth == 0 || uiTileHeight == 0)
+    {
+        return false;
+    }
+
+    m_uiTileWidth  = uiTileWidth;
+    m_uiTileHeight = uiTileHeight;
+
+    return true;
+}
+
+
+unsigned int RFTileCodec::getMaxEncodedSize() const
+{
+    // Mode, row filters and the residuals.
+    return 1 + (m_uiTileHeight + 3) / 4 + m_uiTileWidth * m_uiTileHeight * RF_TILE_MAX_BYTES_PER_PIXEL;
+}
+
+
+unsigned int RFTileCodec::getScratchSize() const
+{
+    // Residuals of the tile, the residuals of a row for each filter and a row of zeros above the first row.
+    return m_uiTileWidth * m_uiTileHeight + (RF_TILE_NUM_FILTERS + 1) * m_uiTileWidth;
+}
+
+
+unsigned int RFTileCodec::encodeTile(const uint32_t* pPixels, unsigned char* pOut, uint32_t* pScratch) const
+{
+    const unsigned int uiNumPixels   = m_uiTileWidth * m_uiTileHeight;
+    const unsigned int uiFilterBytes = (m_uiTileHeight + 3) / 4;
+
+    uint32_t* pResiduals    = pScratch;
+    uint32_t* pRowResiduals = pScratch + uiNumPixels;
+    uint32_t* pZeroRow      = pRowResiduals + RF_TILE_NUM_FILTERS * m_uiTileWidth;
+
+    memset(pZeroRow, 0, m_uiTileWidth * sizeof(uint32_t));
+
+    // The filter of row y is stored in bits 2 * (y % 4) of byte y / 4.
+    unsigned char* pFilters = pOut + 1;
+
+    memset(pFilters, 0, uiFilterBytes);
+
+    for (unsigned int y = 0; y < m_uiTileHeight; ++y)
+    {
+        const uint32_t* pRow   = pPixels + y * m_uiTileWidth;
+        const uint32_t* pAbove = (y > 0) ? pRow - m_uiTileWidth : pZeroRow;
+
+        uint64_t Cost[RF_TILE_NUM_FILTERS];
+
+        m_pfnPredictRow(pRow, pAbove, m_uiTileWidth, pRowResiduals, Cost);
+
+        // Use the filter with the smallest sum of absolute residuals.
+        unsigned int uiFilter = 0;
+
+        for (unsigned int f = 1; f < RF_TILE_NUM_FILTERS; ++f)
+        {
+            if (Cost[f] < Cost[uiFilter])
+            {
+                uiFilter = f;
+            }
+        }
+
+        pFilters[y / 4] |= static_cast<unsigned char>(uiFilter << (2 * (y % 4)));
+
+        memcpy(pResiduals + y * m_uiTileWidth, pRowResiduals + uiFilter * m_uiTileWidth, m_uiTileWidth * sizeof(uint32_t));
+    }
+
+    const unsigned int uiStoredSize = 1 + uiNumPixels * 4;
+    const unsigned int uiCodedSize  = 1 + uiFilterBytes + encodeResiduals(pPixels, pResiduals, uiStoredSize - 1 - uiFilterBytes, pOut + 1 + uiFilterBytes);
+
+    // Store noise like tiles that do not compress.
+    if (uiCodedSize >= uiStoredSize)
+    {
+        pOut[0] = RF_TILE_MODE_STORED;
+
+        memcpy(pOut + 1, pPixels, uiNumPixels * 4);
+
+        return uiStoredSize;
+    }
+
+    pOut[0] = RF_TILE_MODE_CODED;
+
+    return uiCodedSize;
+}
+
+
+unsigned int RFTileCodec::encodeResiduals(const uint32_t* pPixels, const uint32_t* pResiduals, unsigned int uiLimit, unsigned char* pOut) const
+{
+    const unsigned int uiNumPixels = m_uiTileWidth * m_uiTileHeight;
+
+    uint32_t Cache[RF_TILE_CACHE_SIZE];
+
+    memset(Cache, 0, sizeof(Cache));
+
+    unsigned char* p = pOut;
+    unsigned int   i = 0;
+
+    while (i < uiNumPixels)
+    {
+        if (static_cast<unsigned int>(p - pOut) >= uiLimit)
+        {
+            return uiLimit;
+        }
+
+        const uint32_t uiResidual = pResiduals[i];
+
+        // Runs continue across rows. Their pixels are not added to the cache.
+        if (uiResidual == 0)
+        {
+            const unsigned int uiEnd = m_pfnFindNonZero(pResiduals, i + 1, uiNumPixels);
+
+            p = writeRun(p, uiEnd - i);
+            i = uiEnd;
+
+            continue;
+        }
+
+        const uint32_t     uiPixel = pPixels[i];
+        const unsigned int uiIndex = getCacheIndex(uiPixel);
+
+        ++i;
+
+        if (Cache[uiIndex] == uiPixel)
+        {
+            *p++ = static_cast<unsigned char>(RF_TILE_OP_INDEX + uiIndex);
+
+            continue;
+        }
+
+        Cache[uiIndex] = uiPixel;
+
+        const int r0 = static_cast<signed char>(uiResidual & 0xFF);
+        const int r1 = static_cast<signed char>((uiResidual >> 8) & 0xFF);
+        const int r2 = static_cast<signed char>((uiResidual >> 16) & 0xFF);
+
+        if ((uiResidual >> 24) != 0)
+        {
+            *p++ = RF_TILE_OP_RGBA;
+
+            memcpy(p, &uiResidual, 4);
+            p += 4;
+
+            continue;
+        }
+
+        if (r0 >= -2 && r0 <= 1 && r1 >= -2 && r1 <= 1 && r2 >= -2 && r2 <= 1)
+        {
+            *p++ = static_cast<unsigned char>(RF_TILE_OP_DIFF | ((r0 + 2) << 4) | ((r1 + 2) << 2) | (r2 + 2));
+
+            continue;
+        }
+
+        const int d0 = r0 - r1;
+        const int d2 = r2 - r1;
+
+        if (r1 >= -32 && r1 <= 31 && d0 >= -8 && d0 <= 7 && d2 >= -8 && d2 <= 7)
+        {
+            *p++ = static_cast<unsigned char>(RF_TILE_OP_LUMA | (r1 + 32));
+            *p++ = static_cast<unsigned char>(((d0 + 8) << 4) | (d2 + 8));
+
+            continue;
+        }
+
+        *p++ = RF_TILE_OP_RGB;
+
+        memcpy(p, &uiResidual, 3);
+        p += 3;
+    }
+
+    return static_cast<unsigned int>(p - pOut);
+}
+
+
+bool RFTileCodec::decodeTile(const unsigned char* pData, unsigned int uiSize, unsigned int uiTileWidth, unsigned int uiTileHeight, uint32_t* pPixels)
+{
+    if (!pData || !pPixels || uiSize == 0 || uiTileWidth == 0 || uiTileHeight == 0)
+    {
+        return false;
+    }
+
+    const unsigned int uiNumPixels   = uiTileWidth * uiTileHeight;
+    const unsigned int uiFilterBytes = (uiTileHeight + 3) / 4;
+
+    if (pData[0] == RF_TILE_MODE_STORED)
+    {
+        if (uiSize != 1 + uiNumPixels * 4)
+        {
+            return false;
+        }
+
+        memcpy(pPixels, pData + 1, uiNumPixels * 4);
+
+        return true;
+    }
+
+    if (pData[0] != RF_TILE_MODE_CODED || uiSize < 1 + uiFilterBytes)
+    {
+        return false;
+    }
+
+    const unsigned char* pFilters = pData + 1;
+    const unsigned char* p        = pFilters + uiFilterBytes;
+    const unsigned char* pEnd     = pData + uiSize;
+
+    uint32_t Cache[RF_TILE_CACHE_SIZE];
+
+    memset(Cache, 0, sizeof(Cache));
+
+    unsigned int uiRun = 0;
+
+    for (unsigned int y = 0; y < uiTileHeight; ++y)
+    {
+        const unsigned int uiFilter = (pFilters[y / 4] >> (2 * (y % 4))) & 3;
+
+        if (uiFilter >= RF_TILE_NUM_FILTERS)
+        {
+            return false;
+        }
+
+        uint32_t*       pRow   = pPixels + y * uiTileWidth;
+        const uint32_t* pAbove = (y > 0) ? pRow - uiTileWidth : nullptr;
+
+        const uint32_t uiFirstUp = pAbove ? pAbove[0] : 0;
+
+        for (unsigned int x = 0; x < uiTileWidth; ++x)
+        {
+            const uint32_t uiUp     = pAbove ? pAbove[x] : 0;
+            const uint32_t uiLeft   = (x > 0) ? pRow[x - 1] : uiFirstUp;
+            const uint32_t uiUpLeft = (x > 0 && pAbove) ? pAbove[x - 1] : uiFirstUp;
+
+            const uint32_t uiPrediction = predictPixel(uiFilter, uiLeft, uiUp, uiUpLeft);
+
+            if (uiRun > 0)
+            {
+                pRow[x] = uiPrediction;
+                --uiRun;
+
+                continue;
+            }
+
+            if (p >= pEnd)
+            {
+                return false;
+            }
+
+            const unsigned int uiOp = *p++;
+
+            if (uiOp < RF_TILE_OP_DIFF)
+            {
+                if (uiOp == RF_TILE_OP_LONG_RUN)
+                {
+                    unsigned int uiValue = 0;
+                    unsigned int uiShift = 0;
+                    unsigned int uiByte  = 0x80;
+
+                    while (uiByte & 0x80)
+                    {
+                        if (p >= pEnd || uiShift > 28)
+                        {
+                            return false;
+                        }
+
+                        uiByte   = *p++;
+                        uiValue |= (uiByte & 0x7F) << uiShift;
+                        uiShift += 7;
+                    }
+
+                    if (uiValue >= uiNumPixels)
+                    {
+                        return false;
+                    }
+
+                    uiRun = uiValue + RF_TILE_MAX_SHORT_RUN + 1;
+                }
+                else
+                {
+                    uiRun = uiOp - RF_TILE_OP_RUN + 1;
+                }
+
+                pRow[x] = uiPrediction;
+                --uiRun;
+
+                continue;
+            }
+
+            uint32_t uiPixel = 0;
+
+            if (uiOp < RF_TILE_OP_LUMA)
+            {
+                const uint32_t r0 = static_cast<uint32_t>(((uiOp >> 4) & 3) - 2) & 0xFF;
+                const uint32_t r1 = static_cast<uint32_t>(((uiOp >> 2) & 3) - 2) & 0xFF;
+                const uint32_t r2 = static_cast<uint32_t>((uiOp & 3) - 2) & 0xFF;
+
+                uiPixel = addBytes(uiPrediction, r0 | (r1 << 8) | (r2 << 16));
+            }
+            else if (uiOp < RF_TILE_OP_INDEX)
+            {
+                if (p >= pEnd)
+                {
+                    return false;
+                }
+
+                const int r1 = static_cast<int>(uiOp & 0x3F) - 32;
+                const int d0 = static_cast<int>(*p >> 4) - 8;
+                const int d2 = static_cast<int>(*p & 0xF) - 8;
+
+                ++p;
+
+                const uint32_t uiResidual = (static_cast<uint32_t>(r1 + d0) & 0xFF) | ((static_cast<uint32_t>(r1) & 0xFF) << 8) |
+                                            ((static_cast<uint32_t>(r1 + d2) & 0xFF) << 16);
+
+                uiPixel = addBytes(uiPrediction, uiResidual);
+            }
+            else if (uiOp < RF_TILE_OP_INDEX + RF_TILE_CACHE_SIZE)
+            {
+                uiPixel = Cache[uiOp - RF_TILE_OP_INDEX];
+            }
+            else if (uiOp == RF_TILE_OP_RGB || uiOp == RF_TILE_OP_RGBA)
+            {
+                const unsigned int uiNumBytes = (uiOp == RF_TILE_OP_RGB) ? 3 : 4;
+
+                if (static_cast<size_t>(pEnd - p) < uiNumBytes)
+                {
+                    return false;
+                }
+
+                uint32_t uiResidual = 0;
+
+                memcpy(&uiResidual, p, uiNumBytes);
+                p += uiNumBytes;
+
+                uiPixel = addBytes(uiPrediction, uiResidual);
+            }
+            else
+            {
+                return false;
+            }
+
+            Cache[getCacheIndex(uiPixel)] = uiPixel;
+
+            pRow[x] = uiPixel;
+        }
+    }
+
+    return (uiRun == 0 && p == pEnd);
+}
@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <stdint.h>
+
+// RFTileCodec compresses the tiles of the RF_LOSSLESS_TILES encoder without loss. Each row of a tile is predicted from
+// the pixels to the left and above, the residuals are coded as runs of zeros, references into a cache of recent pixels,
+// short deltas or literals. The bitstream is described in RapidFire.h.
+class RFTileCodec
+{
+public:
+
+    RFTileCodec();
+
+    // Sets the size of the tiles in pixels. Returns false if a dimension is 0.
+    bool                    init(unsigned int uiTileWidth, unsigned int uiTileHeight);
+
+    // Returns the maximum number of bytes that encodeTile writes.
+    unsigned int            getMaxEncodedSize() const;
+
+    // Returns the number of uint32_t of the scratch buffer that encodeTile requires.
+    unsigned int            getScratchSize() const;
+
+    // Compresses the tile pPixels which is stored row by row with 4 bytes per pixel into pOut and returns the number of
+    // bytes written. pScratch needs to hold getScratchSize() elements.
+    unsigned int            encodeTile(const uint32_t* pPixels, unsigned char* pOut, uint32_t* pScratch) const;
+
+    // Decompresses the uiSize bytes at pData into pPixels. Returns false if pData is not a valid tile of the given size.
+    static bool             decodeTile(const unsigned char* pData, unsigned int uiSize, unsigned int uiTileWidth, unsigned int uiTileHeight, uint32_t* pPixels);
+
+private:
+
+    // Computes the residuals of the row pRow for each row filter. pAbove is the previous row or a row of zeros. The residuals
+    // of filter f are stored at pResiduals + f * uiWidth and the sum of their absolute values is stored in pCost[f].
+    typedef void (*RF_PREDICT_ROW_FUNC)(const uint32_t* pRow, const uint32_t* pAbove, unsigned int uiWidth, uint32_t* pResiduals, uint64_t* pCost);
+
+    // Returns the index of the first non zero value of pValues in [uiStart, uiEnd) or uiEnd if all values are 0.
+    typedef unsigned int (*RF_FIND_NON_ZERO_FUNC)(const uint32_t* pValues, unsigned int uiStart, unsigned int uiEnd);
+
+    // Codes the residuals of all pixels. Returns the number of bytes written to pOut or uiLimit once uiLimit bytes
+    // were written.
+    unsigned int            encodeResiduals(const uint32_t* pPixels, const uint32_t* pResiduals, unsigned int uiLimit, unsigned char* pOut) const;
+
+    unsigned int            m_uiTileWidth;
+    unsigned int            m_uiTileHeight;
+
+    RF_PREDICT_ROW_FUNC     m_pfnPredictRow;
+    RF_FIND_NON_ZERO_FUNC   m_pfnFindNonZero;
+};
@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "RFTrace.h"
+
+#include <fstream>
+#include <iomanip>
+
+
+static const char* const g_StageName[RF_TRACE_STAGE_NUMBER] = { "encodeFrame",
+                                                                 "preprocessFrame",
+                                                                 "processBuffer",
+                                                                 "acquire",
+                                                                 "csc",
+                                                                 "dma",
+                                                                 "dmaWait",
+                                                                 "encode",
+                                                                 "waitEncodedFrame",
+                                                                 "getEncodedFrame",
+                                                                 "getSourceFrame" };
+
+
+RFTrace::RFTrace(const std::string& strFileName, unsigned int uiSessionId)
+    : m_strFileName(strFileName)
+    , m_uiSessionId(uiSessionId)
+    , m_uiStartTimeNs(rfGetTimeNs())
+    , m_pEvents(new RFTraceEvent[RF_TRACE_RING_SIZE])
+    , m_uiNextEvent(0)
+{
+    for (unsigned int i = 0; i < RF_TRACE_RING_SIZE; ++i)
+    {
+        m_pEvents[i].uiSequence.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+RFTrace::~RFTrace()
+{
+    write();
+}
+
+
+void RFTrace::addEvent(RFTraceStage stage, uint64_t uiStartNs, uint64_t uiEndNs, unsigned int uiIndex)
+{
+    const uint64_t uiEvent = m_uiNextEvent.fetch_add(1, std::memory_order_relaxed);
+
+    RFTraceEvent& e = m_pEvents[uiEvent % RF_TRACE_RING_SIZE];
+
+    // Mark the slot as incomplete while it is written. write skips slots whose sequence does not match.
+    e.uiSequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    e.uiStartNs = uiStartNs;
+    e.uiEndNs   = uiEndNs;
+    e.threadId  = rfGetCurrentThreadId();
+    e.uiIndex   = uiIndex;
+    e.stage     = stage;
+
+    e.uiSequence.store(uiEvent + 1, std::memory_order_release);
+}
+
+
+bool RFTrace::write() const
+{
+    std::ofstream traceFile(m_strFileName, std::ios_base::out | std::ios_base::trunc);
+
+    if (!traceFile.is_open())
+    {
+        return false;
+    }
+
+    const uint64_t uiNumEvents = m_uiNextEvent.load(std::memory_order_acquire);
+    const uint64_t uiFirst     = (uiNumEvents > RF_TRACE_RING_SIZE) ? (uiNumEvents - RF_TRACE_RING_SIZE) : 0;
+
+    traceFile << std::fixed << std::setprecision(3);
+
+    traceFile << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << std::endl;
+    traceFile << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << m_uiSessionId << ",\"args\":{\"name\":\"RFEncodeSession " << m_uiSessionId << "\"}}";
+
+    for (uint64_t i = uiFirst; i < uiNumEvents; ++i)
+    {
+        const RFTraceEvent& e = m_pEvents[i % RF_TRACE_RING_SIZE];
+
+        if (e.uiSequence.load(std::memory_order_acquire) != i + 1)
+        {
+            continue;
+        }
+
+        const uint64_t      uiStartNs = e.uiStartNs;
+        const uint64_t      uiEndNs   = e.uiEndNs;
+        const RFThreadId    threadId  = e.threadId;
+        const unsigned int  uiIndex   = e.uiIndex;
+        const RFTraceStage  stage     = e.stage;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // The event was overwritten while it was read.
+        if (e.uiSequence.load(std::memory_order_relaxed) != i + 1 || stage < 0 || stage >= RF_TRACE_STAGE_NUMBER)
+        {
+            continue;
+        }
+
+        // Chrome trace events use microseconds.
+        const double dStartUs    = static_cast<double>(uiStartNs - m_uiStartTimeNs) / 1000.0;
+        const double dDurationUs = static_cast<double>(uiEndNs - uiStartNs) / 1000.0;
+
+        traceFile << "," << std::endl;
+        traceFile << "{\"name\":\"" << g_StageName[stage] << "\",\"cat\":\"RapidFire\",\"ph\":\"X\",\"pid\":" << m_uiSessionId << ",\"tid\":" << threadId
+                  << ",\"ts\":" << dStartUs << ",\"dur\":" << dDurationUs << ",\"args\":{\"index\":" << uiIndex << "}}";
+    }
+
+    traceFile << std::endl << "]}" << std::endl;
+
+    return traceFile.good();
+}
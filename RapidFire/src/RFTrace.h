@@ -0,0 +1,126 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "RFPlatform.h"
+
+// Number of events kept by RFTrace. Older events are overwritten once the ring is full.
+#define RF_TRACE_RING_SIZE      65536
+
+// Stages of the encoding pipeline that are recorded.
+enum RFTraceStage
+{
+    RF_TRACE_ENCODE_FRAME       = 0,
+    RF_TRACE_PREPROCESS         = 1,
+    RF_TRACE_PROCESS_BUFFER     = 2,
+    RF_TRACE_ACQUIRE            = 3,
+    RF_TRACE_CSC                = 4,
+    RF_TRACE_DMA                = 5,
+    RF_TRACE_DMA_WAIT           = 6,
+    RF_TRACE_ENCODE             = 7,
+    RF_TRACE_WAIT_ENCODED_FRAME = 8,
+    RF_TRACE_GET_ENCODED_FRAME  = 9,
+    RF_TRACE_GET_SOURCE_FRAME   = 10,
+    RF_TRACE_STAGE_NUMBER       = 11
+};
+
+
+// RFTrace records the duration of pipeline stages in a lock-free ring. Any thread may add events.
+// The events are written as Chrome trace events (chrome://tracing) when the trace is destroyed.
+class RFTrace
+{
+public:
+
+    RFTrace(const std::string& strFileName, unsigned int uiSessionId);
+    ~RFTrace();
+
+    // Records a stage that started at uiStartNs and ended at uiEndNs. uiIndex is the render target or
+    // result buffer index the stage was working on.
+    void        addEvent(RFTraceStage stage, uint64_t uiStartNs, uint64_t uiEndNs, unsigned int uiIndex);
+
+    // Writes all events of the ring to the trace file.
+    bool        write() const;
+
+private:
+
+    struct RFTraceEvent
+    {
+        // Number of the event + 1. Is 0 while the event is written.
+        std::atomic<uint64_t>   uiSequence;
+        uint64_t                uiStartNs;
+        uint64_t                uiEndNs;
+        RFThreadId              threadId;
+        unsigned int            uiIndex;
+        RFTraceStage            stage;
+    };
+
+    // disable copy constructor
+    RFTrace(const RFTrace& other);
+    // Disable assignment
+    RFTrace& operator=(const RFTrace& rhs);
+
+    const std::string                   m_strFileName;
+    const unsigned int                  m_uiSessionId;
+    // Time stamps are written relative to the creation of the trace.
+    const uint64_t                      m_uiStartTimeNs;
+
+    std::unique_ptr<RFTraceEvent[]>     m_pEvents;
+    std::atomic<uint64_t>               m_uiNextEvent;
+};
+
+
+// Records the lifetime of the object as event of the given stage. Nothing is recorded if pTrace is NULL.
+class RFTraceScope
+{
+public:
+
+    RFTraceScope(RFTrace* pTrace, RFTraceStage stage, unsigned int uiIndex)
+        : m_pTrace(pTrace)
+        , m_stage(stage)
+        , m_uiIndex(uiIndex)
+        , m_uiStartNs(pTrace ? rfGetTimeNs() : 0)
+    {}
+
+    ~RFTraceScope()
+    {
+        if (m_pTrace)
+        {
+            m_pTrace->addEvent(m_stage, m_uiStartNs, rfGetTimeNs(), m_uiIndex);
+        }
+    }
+
+private:
+
+    RFTraceScope(const RFTraceScope& other);
+    RFTraceScope& operator=(const RFTraceScope& rhs);
+
+    RFTrace* const      m_pTrace;
+    const RFTraceStage  m_stage;
+    const unsigned int  m_uiIndex;
+    const uint64_t      m_uiStartNs;
+};
@@ -24,14 +24,20 @@
 
 #include "RapidFire.h"
 
-/* Support of multiple render targets
-   1 : allow only single buffering
-   2 : allow double buffering
-   3 : allow triple buffering
+/* Maximum number of render targets that can be registered. It does not depend on the pipeline depth
+   since the desktop session registers DOPP_NUM_RT render targets.
  */
 #define MAX_NUM_RENDER_TARGETS                        3
 
-#define NUM_RESULT_BUFFERS                            3
+/* Depth of the encoding pipeline. Defines how many result buffers are used. The depth can be set with
+   the session property RF_PIPELINE_DEPTH.
+   2 : double buffering
+   3 : triple buffering
+   n : allows n - 1 frames to be queued while the application reads the current one
+ */
+#define DEFAULT_PIPELINE_DEPTH                        3
+#define MIN_PIPELINE_DEPTH                            2
+#define MAX_PIPELINE_DEPTH                            16
 
 enum RFParameterType { RF_PARAMETER_UNKNOWN = -1, RF_PARAMETER_BOOL = 0, RF_PARAMETER_INT = 1, RF_PARAMETER_UINT = 2, RF_PARAMETER_PTR = 3 };
 
@@ -46,6 +52,7 @@ union RFTexture
     ID3D11Texture2D*    pDX11TexPtr;
     IDirect3DSurface9*  pDX9TexPtr;
     RFRenderTarget      rfRT;
+    RFHostRenderTarget* pHostRT;
 };
 
 enum RFCaptureSource
@@ -55,5 +62,6 @@ enum RFCaptureSource
     RF_SOURCE_RENDER_TARGET_D3D9    =  1,
     RF_SOURCE_RENDER_TARGET_D3D11   =  2,
     RF_SOURCE_DESKTOP               =  3,
-    RF_SOURCE_WINDOW                =  4
+    RF_SOURCE_WINDOW                =  4,
+    RF_SOURCE_FILE                  =  5
 };
\ No newline at end of file
@@ -24,41 +24,27 @@
 
 #include <limits.h>
 
-#if defined WIN32 || defined _WIN32
-#include <windows.h>
-#endif
-
-float Timer::s_clockTime = 0.0;
+#include "RFPlatform.h"
 
 Timer::Timer()
 {
-    if (s_clockTime == 0.0)
-    {
-        LARGE_INTEGER freq;
-        QueryPerformanceFrequency(&freq);
-
-        s_clockTime = 1.0f / freq.QuadPart;
-    }
-
     reset();
 }
 
 void Timer::reset()
 {
-    LARGE_INTEGER time;
-    QueryPerformanceCounter(&time);
-    m_startTime = time.QuadPart;
+    m_startTime = rfGetTimeNs();
 }
 
 float Timer::getTime()
 {
-    LARGE_INTEGER time;
-    QueryPerformanceCounter(&time);
-
-    return s_clockTime * (time.QuadPart - m_startTime);
+    return static_cast<float>(getTimeNs()) * 1.0e-9f;
 }
 
-#if defined WIN32 || defined _WIN32
+uint64_t Timer::getTimeNs()
+{
+    return rfGetTimeNs() - m_startTime;
+}
 
 #ifdef _DEBUG
 
@@ -97,7 +83,7 @@ std::string utilGetExecutablePath()
     size_t last = str.find_last_of('\\');
 #else // ifdef _WIN32
     char buffer[PATH_MAX + 1];
-    size_t len;
+    ssize_t len;
     if ((len = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1)) == -1)
     {
         throw std::string("readlink() failed!");
@@ -139,6 +125,47 @@ bool utilIsPropertyValid(size_t Property)
 }
 
 
+bool utilIsAVX2Supported()
+{
+    int cpuInfo[4] = { 0 };
+
+    rfCpuid(cpuInfo, 0, 0);
+
+    if (cpuInfo[0] < 7)
+    {
+        return false;
+    }
+
+    rfCpuid(cpuInfo, 1, 0);
+
+    // Check for AVX and OSXSAVE.
+    if ((cpuInfo[2] & (1 << 28)) == 0 || (cpuInfo[2] & (1 << 27)) == 0)
+    {
+        return false;
+    }
+
+    // The OS needs to save the XMM and YMM registers on context switches.
+    if ((rfGetXCR0() & 0x6) != 0x6)
+    {
+        return false;
+    }
+
+    rfCpuid(cpuInfo, 7, 0);
+
+    return ((cpuInfo[1] & (1 << 5)) != 0);
+}
+
+
+bool utilIsSSE41Supported()
+{
+    int cpuInfo[4] = { 0 };
+
+    rfCpuid(cpuInfo, 1, 0);
+
+    return ((cpuInfo[2] & (1 << 19)) != 0);
+}
+
+
 #ifdef _DEBUG
 
 void dumpCLBuffer(cl_mem clBuffer, RFContextCL* pContext, unsigned int uiWidth, unsigned int uiHeight, RFFormat rfFormat, const char* pFileName)
@@ -149,6 +176,7 @@ void dumpCLBuffer(cl_mem clBuffer, RFContextCL* pContext, unsigned int uiWidth,
     switch (rfFormat)
     {
     case RF_NV12:
+    case RF_I420:
         uiBufferSize = (uiWidth * uiHeight) + (uiWidth * uiHeight) / 2;
         break;
 
@@ -204,6 +232,10 @@ void dumpCLBuffer(cl_mem clBuffer, RFContextCL* pContext, unsigned int uiWidth,
             {
                 writeNV12Image(reinterpret_cast<unsigned char*>(pTmp), uiWidth, uiHeight, pFileName);
             }
+            else if (rfFormat == RF_I420)
+            {
+                writeYUVImage(reinterpret_cast<unsigned char*>(pTmp), uiWidth, uiHeight, pFileName);
+            }
 
             clEnqueueUnmapMemObject(pContext->getCmdQueue(), clImageBuffer, pTmp, 0, nullptr, nullptr);
         }
@@ -215,6 +247,4 @@ void dumpCLBuffer(cl_mem clBuffer, RFContextCL* pContext, unsigned int uiWidth,
     }
 }
 
-#endif // _DEBUG
-
-#endif // if defined WIN32 || defined _WIN32
\ No newline at end of file
+#endif // _DEBUG
\ No newline at end of file
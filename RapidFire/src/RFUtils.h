@@ -32,11 +32,15 @@ public:
     Timer();
 
     void reset();
+
+    // Returns the time in seconds since the last reset.
     float getTime();
 
+    // Returns the time in nanoseconds since the last reset.
+    uint64_t getTimeNs();
+
 protected:
 
-    static float s_clockTime;
     uint64_t m_startTime;
 };
 
@@ -52,6 +56,12 @@ bool utilIsBitrateValid(size_t bitrate);
 
 bool utilIsPropertyValid(size_t Property);
 
+// Returns true if the CPU and the OS support AVX2 instructions.
+bool utilIsAVX2Supported();
+
+// Returns true if the CPU supports SSE4.1 instructions.
+bool utilIsSSE41Supported();
+
 #ifdef _DEBUG
 #include <CL/cl.h>
 
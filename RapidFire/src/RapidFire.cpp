@@ -22,6 +22,7 @@
 
 #include "RFError.h"
 #include "RFSession.h"
+#include "RFTileCodec.h"
 
 
 RFStatus RAPIDFIRE_API rfCreateEncodeSession(RFEncodeSession* session, const RFProperties* properties)
@@ -206,6 +207,19 @@ RFStatus RAPIDFIRE_API rfEncodeFrame(RFEncodeSession s, const unsigned int idx)
 }
 
 
+RFStatus RAPIDFIRE_API rfEncodeFrameAsync(RFEncodeSession session, const unsigned int idx, RFEncodeCallback pCallback, void* pUserData)
+{
+    RFSession* pEncodeSession = reinterpret_cast<RFSession*>(session);
+
+    if (!pEncodeSession)
+    {
+        return RF_STATUS_INVALID_SESSION;
+    }
+
+    return pEncodeSession->encodeFrameAsync(idx, pCallback, pUserData);
+}
+
+
 RFStatus RAPIDFIRE_API rfGetEncodedFrame(RFEncodeSession session, unsigned int* uiSize, void** pBitStream)
 {
     RFSession* pEncodeSession = reinterpret_cast<RFSession*>(session);
@@ -219,6 +233,19 @@ RFStatus RAPIDFIRE_API rfGetEncodedFrame(RFEncodeSession session, unsigned int*
 }
 
 
+RFStatus RAPIDFIRE_API rfWaitEncodedFrame(RFEncodeSession session, unsigned long long uiTimeoutNs, unsigned int* uiSize, void** pBitStream)
+{
+    RFSession* pEncodeSession = reinterpret_cast<RFSession*>(session);
+
+    if (!pEncodeSession)
+    {
+        return RF_STATUS_INVALID_SESSION;
+    }
+
+    return pEncodeSession->waitEncodedFrame(uiTimeoutNs, *uiSize, *pBitStream);
+}
+
+
 RFStatus RAPIDFIRE_API rfGetSourceFrame(RFEncodeSession session, unsigned int* uiSize, void** pBitStream)
 {
     RFSession* pEncodeSession = reinterpret_cast<RFSession*>(session);
@@ -255,4 +282,60 @@ RFStatus RAPIDFIRE_API rfReleaseEvent(RFEncodeSession s, const RFNotification rf
     }
 
     return pEncodeSession->releaseEvent(rfNotification);
-}
\ No newline at end of file
+}
+
+RFStatus RAPIDFIRE_API rfGetSessionStats(RFEncodeSession s, RFSessionStats* pStats)
+{
+    RFSession* pEncodeSession = reinterpret_cast<RFSession*>(s);
+
+    if (!pEncodeSession)
+    {
+        return RF_STATUS_INVALID_SESSION;
+    }
+
+    if (!pStats)
+    {
+        return RF_STATUS_FAIL;
+    }
+
+    return pEncodeSession->getSessionStats(*pStats);
+}
+
+
+RFStatus RAPIDFIRE_API rfDecodeLosslessTile(const void* pTile, unsigned int uiSize, unsigned int uiTileWidth, unsigned int uiTileHeight, void* pPixels)
+{
+    if (!pTile || !pPixels)
+    {
+        return RF_STATUS_FAIL;
+    }
+
+    if (uiTileWidth == 0 || uiTileHeight == 0)
+    {
+        return RF_STATUS_INVALID_DIMENSION;
+    }
+
+    if (!RFTileCodec::decodeTile(static_cast<const unsigned char*>(pTile), uiSize, uiTileWidth, uiTileHeight, static_cast<uint32_t*>(pPixels)))
+    {
+        return RF_STATUS_FAIL;
+    }
+
+    return RF_STATUS_OK;
+}
+
+
+RFStatus RAPIDFIRE_API rfGetChangedBlocks(RFEncodeSession s, unsigned int uiVersion, void* pBlockMap, unsigned int uiSize, unsigned int* pVersion)
+{
+    RFSession* pEncodeSession = reinterpret_cast<RFSession*>(s);
+
+    if (!pEncodeSession)
+    {
+        return RF_STATUS_INVALID_SESSION;
+    }
+
+    if (!pBlockMap || !pVersion)
+    {
+        return RF_STATUS_FAIL;
+    }
+
+    return pEncodeSession->getChangedBlocks(uiVersion, static_cast<unsigned char*>(pBlockMap), uiSize, *pVersion);
+}
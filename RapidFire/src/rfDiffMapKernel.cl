@@ -36,19 +36,49 @@
 // DomainSizeY: Image height
 // uiLocalPxX: Number of pixels each work item compares in x direction
 // uiLocalPxY: Number of pixels each work item compares in y direction
+// uiBitMapPitch: If 0 DiffMap stores one byte per block. Otherwise DiffMap stores one bit per block
+//                and each row of blocks has uiBitMapPitch bytes.
+// uiSuperBlockMapOffset: Offset of the superblock map in DiffMap. DiffMap starts with the number of changed blocks.
+// uiMapOffset: Offset of the byte or bit map in DiffMap.
+// uiSuperBlockX: Number of blocks of a superblock in x direction
+// uiSuperBlockY: Number of blocks of a superblock in y direction
+// uiNumSuperBlocksX: Number of superblocks in x direction
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
 __constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_NONE | CLK_FILTER_NEAREST;
 
+// Marks the block of the work group as changed in the superblock map and in the byte or bit map and
+// increments the number of changed blocks.
+void markBlock(__global unsigned char* DiffMap, const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+               const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX)
+{
+    unsigned int groupX = get_group_id(0);
+    unsigned int groupY = get_group_id(1);
+    unsigned int groupIndex = groupX + get_num_groups(0) * groupY;
+
+    atomic_inc((__global unsigned int*)DiffMap);
+    DiffMap[uiSuperBlockMapOffset + (groupY / uiSuperBlockY) * uiNumSuperBlocksX + groupX / uiSuperBlockX] = 1;
+    if (uiBitMapPitch != 0)
+    {
+        atomic_or((__global unsigned int*)(DiffMap + uiMapOffset) + groupY * (uiBitMapPitch / 4) + (groupX / 32), 1u << (groupX % 32));
+    }
+    else
+    {
+        DiffMap[uiMapOffset + groupIndex] = 1;
+    }
+}
+
+
 __kernel void DiffMap_Image(__read_only image2d_t Image1, __read_only image2d_t Image2, __global unsigned char* DiffMap,
-                            unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY)
+                            unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                            const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                            const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX)
 {
     __local unsigned int result;
     result = 0;
     barrier(CLK_LOCAL_MEM_FENCE);
-    short groupX = get_group_id(0);
-    short groupY = get_group_id(1);
-    short groupIndex = groupX + get_num_groups(0) * groupY;
+    unsigned int groupX = get_group_id(0);
+    unsigned int groupY = get_group_id(1);
     short groupSize = get_local_size(0) * get_local_size(1);
     short localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
 
@@ -79,8 +109,11 @@ __kernel void DiffMap_Image(__read_only image2d_t Image1, __read_only image2d_t
 
         if (amd_sad4(as_uint4(pixels1), as_uint4(pixels2), 0) != 0)
         {
-            result = 1;
-            DiffMap[groupIndex] = 1;
+            // Only the first work item that finds a difference updates the maps.
+            if (atomic_xchg(&result, 1) == 0)
+            {
+                markBlock(DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX);
+            }
             return;
         }
     }
@@ -88,14 +121,15 @@ __kernel void DiffMap_Image(__read_only image2d_t Image1, __read_only image2d_t
 
 
 __kernel void DiffMap_Buffer(__global unsigned int* Image1, __global unsigned int* Image2, __global unsigned char* DiffMap,
-                             unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY)
+                             unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                             const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                             const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX)
 {
     __local unsigned int result;
     result = 0;
     barrier(CLK_LOCAL_MEM_FENCE);
-    short groupX = get_group_id(0);
-    short groupY = get_group_id(1);
-    short groupIndex = groupX + get_num_groups(0) * groupY;
+    unsigned int groupX = get_group_id(0);
+    unsigned int groupY = get_group_id(1);
     short groupSize = get_local_size(0) * get_local_size(1);
     short localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
 
@@ -124,7 +158,7 @@ __kernel void DiffMap_Buffer(__global unsigned int* Image1, __global unsigned in
             unsigned int localIndex_ = localIndex + i * groupSize;
             unsigned int x = localIndex_ % uiLocalPxX;
             unsigned int y = localIndex_ / uiLocalPxX;
-            if (x_offset + x < DomainSizeX && y_offset + y < DomainSizeY)
+            if (localIndex_ < localBlockSize && x_offset + x < DomainSizeX && y_offset + y < DomainSizeY)
             {
                 ((unsigned int*)&(pixels1))[i] = Image1[idx + x + y * DomainSizeX];
                 ((unsigned int*)&(pixels2))[i] = Image2[idx + x + y * DomainSizeX];
@@ -137,9 +171,473 @@ __kernel void DiffMap_Buffer(__global unsigned int* Image1, __global unsigned in
         }
         if (amd_sad4(pixels1, pixels2, 0) != 0)
         {
-            result = 1;
-            DiffMap[groupIndex] = 1;
+            // Only the first work item that finds a difference updates the maps.
+            if (atomic_xchg(&result, 1) == 0)
+            {
+                markBlock(DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX);
+            }
             return;
         }
     }
-};
\ No newline at end of file
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Kernels to create a diff map from block hashes. Each work group hashes one block and compares
+// the hash with the hash of the previous frame in BlockHashes. Only the current image is read.
+// A block is hashed in stripes of 8 pixels which are processed as 4 64 bit lanes. The hash is
+// identical to the one computed by RFDiffMapHost.
+//
+// Global Work Size : (DomainSizeX / uiLocalPxX) x (DomainSizeY / uiLocalPxY) work groups
+// Local Work Size  : 8 or 16 x 8 or 16
+//
+// Image: Image that is hashed.
+// BlockHashes: One hash per block. Contains the hashes of the previous frame and is updated.
+// uiResetHashes: If not 0, BlockHashes is not valid and all blocks are marked as changed.
+// All other arguments are the same as for DiffMap_Buffer.
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+ulong4 hashStripe(uint8 pixels, ulong s)
+{
+    ulong4 data = convert_ulong4(pixels.even) | (convert_ulong4(pixels.odd) << 32);
+    ulong4 key  = (ulong4)(0x9E3779B185EBCA87UL, 0xC2B2AE3D27D4EB4FUL, 0x165667B19E3779F9UL, 0x85EBCA77C2B2AE63UL) +
+                  (ulong4)(s) * (ulong4)(0x27D4EB2F165667C5UL, 0x94D049BB133111EBUL, 0xBF58476D1CE4E5B9UL, 0xFF51AFD7ED558CCDUL);
+    ulong4 dataKey = data ^ key;
+
+    return (dataKey & (ulong4)(0xFFFFFFFFUL)) * (dataKey >> 32) + data.s1032;
+}
+
+
+ulong mixHash(ulong hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDUL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53UL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+
+// Sums the accumulators of all work items, compares the hash of the block with BlockHashes and updates the maps.
+void updateBlockHash(__local ulong4* Acc, ulong4 acc, __global ulong* BlockHashes, __global unsigned char* DiffMap,
+                     const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                     const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX, const unsigned int uiResetHashes)
+{
+    unsigned int groupX = get_group_id(0);
+    unsigned int groupY = get_group_id(1);
+    unsigned int groupIndex = groupX + get_num_groups(0) * groupY;
+    unsigned int groupSize = get_local_size(0) * get_local_size(1);
+    unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+    Acc[localIndex] = acc;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // The group size is a power of 2.
+    for (unsigned int stride = groupSize / 2; stride > 0; stride /= 2)
+    {
+        if (localIndex < stride)
+        {
+            Acc[localIndex] += Acc[localIndex + stride];
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (localIndex == 0)
+    {
+        ulong hash = mixHash(mixHash(mixHash(mixHash(Acc[0].s0) ^ Acc[0].s1) ^ Acc[0].s2) ^ Acc[0].s3);
+
+        if (uiResetHashes != 0 || hash != BlockHashes[groupIndex])
+        {
+            markBlock(DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX);
+        }
+
+        BlockHashes[groupIndex] = hash;
+    }
+}
+
+
+__kernel void DiffMap_HashImage(__read_only image2d_t Image, __global ulong* BlockHashes, __global unsigned char* DiffMap,
+                                unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX,
+                                const unsigned int uiResetHashes)
+{
+    __local ulong4 Acc[256];
+    unsigned int groupSize = get_local_size(0) * get_local_size(1);
+    unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+    // Offset into the image
+    unsigned int x_offset = get_group_id(0) * uiLocalPxX;
+    unsigned int y_offset = get_group_id(1) * uiLocalPxY;
+
+    unsigned int uiStripesPerLine = uiLocalPxX / 8;
+    unsigned int uiNumStripes = uiStripesPerLine * uiLocalPxY;
+
+    ulong4 acc = (ulong4)(0);
+
+    for (unsigned int s = localIndex; s < uiNumStripes; s += groupSize)
+    {
+        unsigned int x = x_offset + (s % uiStripesPerLine) * 8;
+        unsigned int y = y_offset + s / uiStripesPerLine;
+
+        // Stripes outside of the image are not hashed. Pixels of a stripe outside of the image are 0.
+        if (x < DomainSizeX && y < DomainSizeY)
+        {
+            uint8 pixels = (uint8)(0);
+
+            for (unsigned int i = 0; i < 8; ++i)
+            {
+                if (x + i < DomainSizeX)
+                {
+                    uint4 c = convert_uint4_sat_rte(read_imagef(Image, sampler, (int2)(x + i, y)) * 255.0f);
+                    ((unsigned int*)&(pixels))[i] = c.x | (c.y << 8) | (c.z << 16) | (c.w << 24);
+                }
+            }
+
+            acc += hashStripe(pixels, s);
+        }
+    }
+
+    updateBlockHash(Acc, acc, BlockHashes, DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX, uiResetHashes);
+};
+
+
+__kernel void DiffMap_HashBuffer(__global unsigned int* Image, __global ulong* BlockHashes, __global unsigned char* DiffMap,
+                                 unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                 const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                 const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX,
+                                 const unsigned int uiResetHashes)
+{
+    __local ulong4 Acc[256];
+    unsigned int groupSize = get_local_size(0) * get_local_size(1);
+    unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+    // Offset into the image
+    unsigned int x_offset = get_group_id(0) * uiLocalPxX;
+    unsigned int y_offset = get_group_id(1) * uiLocalPxY;
+
+    unsigned int uiStripesPerLine = uiLocalPxX / 8;
+    unsigned int uiNumStripes = uiStripesPerLine * uiLocalPxY;
+
+    ulong4 acc = (ulong4)(0);
+
+    for (unsigned int s = localIndex; s < uiNumStripes; s += groupSize)
+    {
+        unsigned int x = x_offset + (s % uiStripesPerLine) * 8;
+        unsigned int y = y_offset + s / uiStripesPerLine;
+
+        // Stripes outside of the image are not hashed. Pixels of a stripe outside of the image are 0.
+        if (x < DomainSizeX && y < DomainSizeY)
+        {
+            uint8 pixels = (uint8)(0);
+
+            for (unsigned int i = 0; i < 8; ++i)
+            {
+                if (x + i < DomainSizeX)
+                {
+                    ((unsigned int*)&(pixels))[i] = Image[x + i + y * DomainSizeX];
+                }
+            }
+
+            acc += hashStripe(pixels, s);
+        }
+    }
+
+    updateBlockHash(Acc, acc, BlockHashes, DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX, uiResetHashes);
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Kernels to create a diff map with thresholds. A pixel has changed if the sum of the absolute
+// differences of its 4 channels is larger than uiPixelThreshold. A block has changed if at least
+// uiMinChangedPixels pixels changed and the sum of their differences is larger than uiBlockThreshold.
+// The result is identical to the one computed by RFDiffMapHost with the same thresholds.
+//
+// Global Work Size : (DomainSizeX / uiLocalPxX) x (DomainSizeY / uiLocalPxY) work groups
+// Local Work Size  : 8 or 16 x 8 or 16
+//
+// uiPixelThreshold: Difference of a pixel up to which the pixel is not counted as changed.
+// uiBlockThreshold: Sum of the differences of the changed pixels up to which the block is not marked.
+// uiMinChangedPixels: Minimum number of changed pixels of a changed block. Needs to be at least 1.
+// All other arguments are the same as for DiffMap_Buffer.
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Sums the number of changed pixels and their differences of all work items and marks the block if it exceeds the thresholds.
+void updateBlockDifference(__local unsigned int* Changed, unsigned int numChanged, unsigned int diff, __global unsigned char* DiffMap,
+                           const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                           const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX,
+                           const unsigned int uiBlockThreshold, const unsigned int uiMinChangedPixels)
+{
+    if (numChanged > 0)
+    {
+        atomic_add(&Changed[0], numChanged);
+        atomic_add(&Changed[1], diff);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (get_local_id(0) == 0 && get_local_id(1) == 0 && Changed[0] >= uiMinChangedPixels && Changed[1] > uiBlockThreshold)
+    {
+        markBlock(DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX);
+    }
+}
+
+
+__kernel void DiffMap_ThresholdImage(__read_only image2d_t Image1, __read_only image2d_t Image2, __global unsigned char* DiffMap,
+                                     unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                     const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                     const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX,
+                                     const unsigned int uiPixelThreshold, const unsigned int uiBlockThreshold, const unsigned int uiMinChangedPixels)
+{
+    __local unsigned int Changed[2];
+    unsigned int groupSize = get_local_size(0) * get_local_size(1);
+    unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+    if (localIndex == 0)
+    {
+        Changed[0] = 0;
+        Changed[1] = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // Offset into the image
+    unsigned int x_offset = get_group_id(0) * uiLocalPxX;
+    unsigned int y_offset = get_group_id(1) * uiLocalPxY;
+
+    unsigned int localBlockSize = uiLocalPxX * uiLocalPxY;
+
+    unsigned int numChanged = 0;
+    unsigned int sum = 0;
+
+    for (unsigned int i = localIndex; i < localBlockSize; i += groupSize)
+    {
+        unsigned int x = x_offset + i % uiLocalPxX;
+        unsigned int y = y_offset + i / uiLocalPxX;
+
+        if (x < DomainSizeX && y < DomainSizeY)
+        {
+            uint4 c1 = convert_uint4_sat_rte(read_imagef(Image1, sampler, (int2)(x, y)) * 255.0f);
+            uint4 c2 = convert_uint4_sat_rte(read_imagef(Image2, sampler, (int2)(x, y)) * 255.0f);
+            uint4 d = abs_diff(c1, c2);
+            unsigned int diff = d.x + d.y + d.z + d.w;
+
+            if (diff > uiPixelThreshold)
+            {
+                ++numChanged;
+                sum += diff;
+            }
+        }
+    }
+
+    updateBlockDifference(Changed, numChanged, sum, DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX,
+                          uiBlockThreshold, uiMinChangedPixels);
+};
+
+
+__kernel void DiffMap_ThresholdBuffer(__global unsigned int* Image1, __global unsigned int* Image2, __global unsigned char* DiffMap,
+                                      unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                      const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                      const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX,
+                                      const unsigned int uiPixelThreshold, const unsigned int uiBlockThreshold, const unsigned int uiMinChangedPixels)
+{
+    __local unsigned int Changed[2];
+    unsigned int groupSize = get_local_size(0) * get_local_size(1);
+    unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+    if (localIndex == 0)
+    {
+        Changed[0] = 0;
+        Changed[1] = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // Offset into the image
+    unsigned int x_offset = get_group_id(0) * uiLocalPxX;
+    unsigned int y_offset = get_group_id(1) * uiLocalPxY;
+
+    unsigned int localBlockSize = uiLocalPxX * uiLocalPxY;
+
+    unsigned int numChanged = 0;
+    unsigned int sum = 0;
+
+    for (unsigned int i = localIndex; i < localBlockSize; i += groupSize)
+    {
+        unsigned int x = x_offset + i % uiLocalPxX;
+        unsigned int y = y_offset + i / uiLocalPxX;
+
+        if (x < DomainSizeX && y < DomainSizeY)
+        {
+            // amd_sad sums the absolute differences of the 4 bytes of a pixel.
+            unsigned int diff = amd_sad(Image1[x + y * DomainSizeX], Image2[x + y * DomainSizeX], 0);
+
+            if (diff > uiPixelThreshold)
+            {
+                ++numChanged;
+                sum += diff;
+            }
+        }
+    }
+
+    updateBlockDifference(Changed, numChanged, sum, DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX,
+                          uiBlockThreshold, uiMinChangedPixels);
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Kernels to gather the pixels of the changed blocks. They run after a diff map kernel and read the
+// byte or bit map that it wrote. Each work group copies one changed block into the next free tile.
+// The tile list with one RFDiffTile per block starts at uiTileOffset and the pixels of the tiles
+// follow the list. The order of the tiles is not defined.
+//
+// Global Work Size : (DomainSizeX / uiLocalPxX) x (DomainSizeY / uiLocalPxY) work groups
+// Local Work Size  : 8 or 16 x 8 or 16
+//
+// Image: Image of which the changed blocks are copied.
+// uiTileOffset: Offset of the tile list in DiffMap. The list has space for all blocks.
+// uiNumTilesOffset: Offset of the number of tiles in DiffMap. Needs to be 0 when the kernel starts.
+// All other arguments are the same as for DiffMap_Buffer.
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Returns true if the block of the work group is marked as changed in the byte or bit map.
+bool isBlockChanged(__global unsigned char* DiffMap, const unsigned int uiBitMapPitch, const unsigned int uiMapOffset)
+{
+    unsigned int groupX = get_group_id(0);
+    unsigned int groupY = get_group_id(1);
+
+    if (uiBitMapPitch != 0)
+    {
+        return (DiffMap[uiMapOffset + groupY * uiBitMapPitch + groupX / 8] & (1u << (groupX % 8))) != 0;
+    }
+
+    return DiffMap[uiMapOffset + groupX + get_num_groups(0) * groupY] != 0;
+}
+
+
+// Allocates the next tile, stores the position of the block in the tile list and returns the pixels of the tile.
+__global unsigned int* allocateTile(__local unsigned int* Tile, __global unsigned char* DiffMap, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                    const unsigned int uiTileOffset, const unsigned int uiNumTilesOffset)
+{
+    __global unsigned int* TileList = (__global unsigned int*)(DiffMap + uiTileOffset);
+
+    if (get_local_id(0) == 0 && get_local_id(1) == 0)
+    {
+        *Tile = atomic_inc((__global unsigned int*)(DiffMap + uiNumTilesOffset));
+
+        TileList[2 * *Tile]     = get_group_id(0) * uiLocalPxX;
+        TileList[2 * *Tile + 1] = get_group_id(1) * uiLocalPxY;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    return TileList + 2 * get_num_groups(0) * get_num_groups(1) + *Tile * uiLocalPxX * uiLocalPxY;
+}
+
+
+__kernel void DiffMap_GatherTilesImage(__read_only image2d_t Image, __global unsigned char* DiffMap,
+                                       unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                       const unsigned int uiBitMapPitch, const unsigned int uiMapOffset, const unsigned int uiTileOffset, const unsigned int uiNumTilesOffset)
+{
+    __local unsigned int Tile;
+
+    // All work items of the group take the same branch.
+    if (!isBlockChanged(DiffMap, uiBitMapPitch, uiMapOffset))
+    {
+        return;
+    }
+
+    __global unsigned int* TileData = allocateTile(&Tile, DiffMap, uiLocalPxX, uiLocalPxY, uiTileOffset, uiNumTilesOffset);
+
+    unsigned int groupSize = get_local_size(0) * get_local_size(1);
+    unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+    // Offset into the image
+    unsigned int x_offset = get_group_id(0) * uiLocalPxX;
+    unsigned int y_offset = get_group_id(1) * uiLocalPxY;
+
+    for (unsigned int i = localIndex; i < uiLocalPxX * uiLocalPxY; i += groupSize)
+    {
+        unsigned int x = x_offset + i % uiLocalPxX;
+        unsigned int y = y_offset + i / uiLocalPxX;
+
+        unsigned int pixel = 0;
+
+        if (x < DomainSizeX && y < DomainSizeY)
+        {
+            uint4 c = convert_uint4_sat_rte(read_imagef(Image, sampler, (int2)(x, y)) * 255.0f);
+            pixel = c.x | (c.y << 8) | (c.z << 16) | (c.w << 24);
+        }
+
+        TileData[i] = pixel;
+    }
+};
+
+
+__kernel void DiffMap_GatherTilesBuffer(__global unsigned int* Image, __global unsigned char* DiffMap,
+                                        unsigned int DomainSizeX, unsigned int DomainSizeY, const unsigned int uiLocalPxX, const unsigned int uiLocalPxY,
+                                        const unsigned int uiBitMapPitch, const unsigned int uiMapOffset, const unsigned int uiTileOffset, const unsigned int uiNumTilesOffset)
+{
+    __local unsigned int Tile;
+
+    // All work items of the group take the same branch.
+    if (!isBlockChanged(DiffMap, uiBitMapPitch, uiMapOffset))
+    {
+        return;
+    }
+
+    __global unsigned int* TileData = allocateTile(&Tile, DiffMap, uiLocalPxX, uiLocalPxY, uiTileOffset, uiNumTilesOffset);
+
+    unsigned int groupSize = get_local_size(0) * get_local_size(1);
+    unsigned int localIndex = get_local_id(0) + get_local_size(0) * get_local_id(1);
+
+    // Offset into the image
+    unsigned int x_offset = get_group_id(0) * uiLocalPxX;
+    unsigned int y_offset = get_group_id(1) * uiLocalPxY;
+
+    for (unsigned int i = localIndex; i < uiLocalPxX * uiLocalPxY; i += groupSize)
+    {
+        unsigned int x = x_offset + i % uiLocalPxX;
+        unsigned int y = y_offset + i / uiLocalPxX;
+
+        TileData[i] = (x < DomainSizeX && y < DomainSizeY) ? Image[x + y * DomainSizeX] : 0;
+    }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Kernel to accumulate the diff maps of several frames. It runs after a diff map kernel and reads
+// the byte or bit map that it wrote. BlockFrames stores the frame in which each block changed last.
+// Blocks that changed after the acknowledged frame are marked again, this way the map contains all
+// changes the consumer did not yet receive.
+//
+// Global Work Size : number of blocks in x direction x number of blocks in y direction
+// Local Work Size  : 1 x 1
+//
+// BlockFrames: One frame number per block.
+// uiFrame: Number of the current frame.
+// uiAcknowledgedFrame: Number of the last frame acknowledged by the consumer.
+// uiResetFrames: If 1, BlockFrames is not valid yet and all blocks are marked as changed.
+// All other arguments are the same as for DiffMap_Buffer.
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+__kernel void DiffMap_Accumulate(__global unsigned char* DiffMap, __global unsigned int* BlockFrames, const unsigned int uiFrame,
+                                 const unsigned int uiAcknowledgedFrame, const unsigned int uiResetFrames,
+                                 const unsigned int uiBitMapPitch, const unsigned int uiSuperBlockMapOffset, const unsigned int uiMapOffset,
+                                 const unsigned int uiSuperBlockX, const unsigned int uiSuperBlockY, const unsigned int uiNumSuperBlocksX)
+{
+    unsigned int groupIndex = get_group_id(0) + get_num_groups(0) * get_group_id(1);
+
+    if (isBlockChanged(DiffMap, uiBitMapPitch, uiMapOffset))
+    {
+        BlockFrames[groupIndex] = uiFrame;
+    }
+    else if (uiResetFrames != 0)
+    {
+        BlockFrames[groupIndex] = uiFrame;
+
+        markBlock(DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX);
+    }
+    else if (BlockFrames[groupIndex] > uiAcknowledgedFrame)
+    {
+        markBlock(DiffMap, uiBitMapPitch, uiSuperBlockMapOffset, uiMapOffset, uiSuperBlockX, uiSuperBlockY, uiNumSuperBlocksX);
+    }
+};
@@ -253,12 +253,15 @@ __kernel void rgbaToI420_image2d(read_only image2d_t pIn, __global uchar* pOutI4
     pOutI420[uiYPlaneOffset] = Y3;
     pOutI420[uiYPlaneOffset + 1] = Y4;
 
+    // The U and the V plane follow the Y plane. Their pitch is half the pitch of the Y plane.
+    uint uiChromaPitch = vDim.z / 2;
+    __global uchar* pOutU = pOutI420 + vDim.z * vDim.y;
+    __global uchar* pOutV = pOutU + uiChromaPitch * (vDim.y / 2);
+
     // Write U Plane
-    __global uchar* pOutU = pOutI420 + vDim.z * vDim.w;
-    __global uchar* pOutV = pOutU + vDim.z * vDim.w / 2;
-    pOutU[uiGlobalIdX + uiGlobalIdY * vDim.z] = ((-38 * RGBA.x - 74 * RGBA.y + 112 * RGBA.z + 128) >> 8) + 128;
+    pOutU[uiGlobalIdX + uiGlobalIdY * uiChromaPitch] = ((-38 * RGBA.x - 74 * RGBA.y + 112 * RGBA.z + 128) >> 8) + 128;
     // Write V Plane
-    pOutV[uiGlobalIdX + uiGlobalIdY * vDim.z] = ((112 * RGBA.x - 94 * RGBA.y - 18 * RGBA.z + 128) >> 8) + 128;
+    pOutV[uiGlobalIdX + uiGlobalIdY * uiChromaPitch] = ((112 * RGBA.x - 94 * RGBA.y - 18 * RGBA.z + 128) >> 8) + 128;
 }
 
 
@@ -311,4 +314,325 @@ __kernel void copy_rgba_image2d(__read_only image2d_t rgbaIn, __global uchar *rg
         rgbaOut[uiBufferOffset + 2] = pixel.z;
         rgbaOut[uiBufferOffset + 3] = pixel.w;
     }
-}
\ No newline at end of file
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scaled color space conversion
+//
+// vDim.x and vDim.y contain the dimension of the output image. The input image is scaled while it is read.
+//
+// const float4 vScale contains the scaling of the input image
+//      vScale.x = width  of input image / width  of output image
+//      vScale.y = height of input image / height of output image
+//      vScale.z = width  of input image
+//      vScale.w = height of input image
+//
+// Each output pixel is the average of the input area it covers (box filter). The area is sampled with bilinear taps
+// that are at most 2 pixels apart, so each tap averages up to 2x2 input pixels and a downscaling by 2 reads each
+// input pixel exactly once. If the image is enlarged a single bilinear tap is used.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+__constant sampler_t linearSampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_LINEAR;
+
+float4 readScaled(read_only image2d_t pIn, int2 pos, const float4 vScale, const int mirror)
+{
+    // Number of taps in each direction and the distance between them.
+    int2   nTaps = max(convert_int2(ceil(vScale.xy * 0.5f)), (int2)(1, 1));
+    float2 vStep = vScale.xy / convert_float2(nTaps);
+
+    // Center of the first tap in input coordinates. The pixel centers are located at .5.
+    float2 vStart = convert_float2(pos) * vScale.xy + 0.5f * vStep;
+
+    float4 vSum = (float4)(0.0f);
+
+    for (int j = 0; j < nTaps.y; ++j)
+    {
+        float fY = vStart.y + j * vStep.y;
+
+        if (mirror == 1)
+        {
+            fY = vScale.w - fY;
+        }
+
+        for (int i = 0; i < nTaps.x; ++i)
+        {
+            vSum += read_imagef(pIn, linearSampler, (float2)(vStart.x + i * vStep.x, fY));
+        }
+    }
+
+    return vSum / (float)(nTaps.x * nTaps.y);
+}
+
+
+// Same as rgbaTonv12_image2d but scales the input image. Global work size is width/2, height/2 of the output image.
+__kernel void rgbaTonv12_scaled_image2d(read_only image2d_t pIn, __global uchar * pOut, const int4 vDim, const int mirror, const float4 vScale)
+{
+    uint uiGlobalIdX = get_global_id(0);    // 0 - width /2
+    uint uiGlobalIdY = get_global_id(1);    // 0 - height/2
+
+    if (uiGlobalIdX >= vDim.x / 2 || uiGlobalIdY >= vDim.y / 2)
+    {
+        return;
+    }
+
+    // Offset to the start of the chroma u-plane
+    uint uPlaneOffset = vDim.z * vDim.y;
+
+    uint uiYPlaneOffset = (uiGlobalIdX + uiGlobalIdY * vDim.z) << 1;
+
+    uchar4 RGBA1, RGBA2, RGBA3, RGBA4;
+
+    int2 pos = (int2)(uiGlobalIdX * 2, uiGlobalIdY * 2);
+
+    RGBA1 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos, vScale, mirror));
+    RGBA2 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos + (int2)(1, 0), vScale, mirror));
+    RGBA3 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos + (int2)(0, 1), vScale, mirror));
+    RGBA4 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos + (int2)(1, 1), vScale, mirror));
+
+    ushort4 RGBA = convert_ushort4(RGBA1) + convert_ushort4(RGBA2) + convert_ushort4(RGBA3) + convert_ushort4(RGBA4);
+
+    // Take average color
+    RGBA = RGBA >> 2;
+
+    // Write Y Plane
+    pOut[uiYPlaneOffset]     = ((66 * RGBA1.x + 129 * RGBA1.y + 25 * RGBA1.z + 128) >> 8) + 16;
+    pOut[uiYPlaneOffset + 1] = ((66 * RGBA2.x + 129 * RGBA2.y + 25 * RGBA2.z + 128) >> 8) + 16;
+
+    uiYPlaneOffset += vDim.z;
+
+    pOut[uiYPlaneOffset]     = ((66 * RGBA3.x + 129 * RGBA3.y + 25 * RGBA3.z + 128) >> 8) + 16;
+    pOut[uiYPlaneOffset + 1] = ((66 * RGBA4.x + 129 * RGBA4.y + 25 * RGBA4.z + 128) >> 8) + 16;
+
+    // Write U Plane
+    pOut[uPlaneOffset + 2 * uiGlobalIdX + uiGlobalIdY * vDim.z]     = ((-38 * RGBA.x - 74 * RGBA.y + 112 * RGBA.z + 128) >> 8) + 128;
+    // Write V Plane
+    pOut[uPlaneOffset + 2 * uiGlobalIdX + 1 + uiGlobalIdY * vDim.z] = ((112 * RGBA.x - 94 * RGBA.y - 18  * RGBA.z + 128) >> 8) + 128;
+}
+
+
+// Same as rgbaToI420_image2d but scales the input image. Global work size is width/2, height/2 of the output image.
+__kernel void rgbaToI420_scaled_image2d(read_only image2d_t pIn, __global uchar* pOutI420, const int4 vDim, const int mirror, const float4 vScale)
+{
+    uint uiGlobalIdX = get_global_id(0);    // 0 - width /2
+    uint uiGlobalIdY = get_global_id(1);    // 0 - height/2
+
+    if (uiGlobalIdX >= vDim.x / 2 || uiGlobalIdY >= vDim.y / 2)
+    {
+        return;
+    }
+
+    uint uiYPlaneOffset = (uiGlobalIdX + uiGlobalIdY * vDim.z) << 1;
+
+    uchar4 RGBA1, RGBA2, RGBA3, RGBA4;
+
+    int2 pos = (int2)(uiGlobalIdX * 2, uiGlobalIdY * 2);
+
+    RGBA1 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos, vScale, mirror));
+    RGBA2 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos + (int2)(1, 0), vScale, mirror));
+    RGBA3 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos + (int2)(0, 1), vScale, mirror));
+    RGBA4 = convert_uchar4_sat_rte(255 * readScaled(pIn, pos + (int2)(1, 1), vScale, mirror));
+
+    ushort4 RGBA = convert_ushort4(RGBA1) + convert_ushort4(RGBA2) + convert_ushort4(RGBA3) + convert_ushort4(RGBA4);
+
+    // Take average color
+    RGBA = RGBA >> 2;
+
+    // Write Y Plane
+    pOutI420[uiYPlaneOffset]     = ((66 * RGBA1.x + 129 * RGBA1.y + 25 * RGBA1.z + 128) >> 8) + 16;
+    pOutI420[uiYPlaneOffset + 1] = ((66 * RGBA2.x + 129 * RGBA2.y + 25 * RGBA2.z + 128) >> 8) + 16;
+
+    uiYPlaneOffset += vDim.z;
+
+    pOutI420[uiYPlaneOffset]     = ((66 * RGBA3.x + 129 * RGBA3.y + 25 * RGBA3.z + 128) >> 8) + 16;
+    pOutI420[uiYPlaneOffset + 1] = ((66 * RGBA4.x + 129 * RGBA4.y + 25 * RGBA4.z + 128) >> 8) + 16;
+
+    uint uiChromaPitch = vDim.z / 2;
+    __global uchar* pOutU = pOutI420 + vDim.z * vDim.y;
+    __global uchar* pOutV = pOutU + uiChromaPitch * (vDim.y / 2);
+
+    // Write U Plane
+    pOutU[uiGlobalIdX + uiGlobalIdY * uiChromaPitch] = ((-38 * RGBA.x - 74 * RGBA.y + 112 * RGBA.z + 128) >> 8) + 128;
+    // Write V Plane
+    pOutV[uiGlobalIdX + uiGlobalIdY * uiChromaPitch] = ((112 * RGBA.x - 94 * RGBA.y - 18 * RGBA.z + 128) >> 8) + 128;
+}
+
+// Same as copy_rgba_image2d but scales the input image. Global work size is width, height of the output image.
+__kernel void copy_rgba_scaled_image2d(__read_only image2d_t rgbaIn, __global uchar *rgbaOut, const int4 vDim, const int mirror, const int nTargetOrdering, const float4 vScale)
+{
+    uint uiGlobalId_X = get_global_id(0);
+    uint uiGlobalId_Y = get_global_id(1);
+
+    if (uiGlobalId_X >= vDim.x || uiGlobalId_Y >= vDim.y)
+    {
+        return;
+    }
+
+    uint uiBufferOffset = (uiGlobalId_X + (uiGlobalId_Y * vDim.z)) * 4;
+
+    uchar4 pixel = convert_uchar4_sat_rte(255.0f * readScaled(rgbaIn, (int2)(uiGlobalId_X, uiGlobalId_Y), vScale, mirror));
+
+    if (nTargetOrdering == 1)
+    {
+        // Write ARGB
+        pixel = pixel.wxyz;
+    }
+    else if (nTargetOrdering == 2)
+    {
+        // Write BGRA
+        pixel = pixel.zyxw;
+    }
+
+    vstore4(pixel, 0, rgbaOut + uiBufferOffset);
+}
+
+
+// Converts a pixel read from the input image to 10-bit RGB. Values outside of [0, 1], e.g. of half float images,
+// are clamped.
+int4 toRGB10(float4 pixel)
+{
+    return convert_int4_sat_rte(1023.0f * clamp(pixel, 0.0f, 1.0f));
+}
+
+
+// Returns the 10-bit luma of a 10-bit RGB pixel in the upper bits of a 16-bit sample. Same BT.601 conversion as the
+// 8-bit kernels with coefficients scaled by 1024.
+ushort rgbToY10(int4 RGB)
+{
+    return (ushort)((((262 * RGB.x + 515 * RGB.y + 100 * RGB.z + 512) >> 10) + 64) << 6);
+}
+
+
+// Returns the 10-bit U and V of a 10-bit RGB pixel in the upper bits of 16-bit samples.
+ushort2 rgbToUV10(int4 RGB)
+{
+    return (ushort2)((((-151 * RGB.x - 297 * RGB.y + 448 * RGB.z + 512) >> 10) + 512) << 6,
+                     (((448 * RGB.x - 375 * RGB.y - 73  * RGB.z + 512) >> 10) + 512) << 6);
+}
+
+
+// Converts the input image into a P010 buffer. The interleaved U/V plane follows the Y plane and has the same pitch.
+// vDim.z is the pitch in samples. Global work size is width/2, height/2 of the output image.
+__kernel void rgbaToP010_image2d(read_only image2d_t pIn, __global ushort* pOut, const int4 vDim, const int mirror)
+{
+    uint uiGlobalIdX = get_global_id(0);    // 0 - width /2
+    uint uiGlobalIdY = get_global_id(1);    // 0 - height/2
+
+    if (uiGlobalIdX >= vDim.x / 2 || uiGlobalIdY >= vDim.y / 2)
+    {
+        return;
+    }
+
+    // Offset to the start of the chroma plane
+    uint uiUVPlaneOffset = vDim.z * vDim.y;
+
+    uint uiYPlaneOffset = (uiGlobalIdX + uiGlobalIdY * vDim.z) << 1;
+
+    int4 RGB1, RGB2, RGB3, RGB4;
+
+    int2 pos = (int2)(uiGlobalIdX * 2, (mirror == 1) ? (vDim.y - uiGlobalIdY * 2 - 1) : uiGlobalIdY * 2);
+
+    RGB1 = toRGB10(read_imagef(pIn, imageSampler, pos));
+    RGB2 = toRGB10(read_imagef(pIn, imageSampler, pos + (int2)(1, 0)));
+
+    pos.y = (mirror == 1) ? (vDim.y - uiGlobalIdY * 2 - 2) : (uiGlobalIdY * 2 + 1);
+
+    RGB3 = toRGB10(read_imagef(pIn, imageSampler, pos));
+    RGB4 = toRGB10(read_imagef(pIn, imageSampler, pos + (int2)(1, 0)));
+
+    // Take average color
+    int4 RGB = (RGB1 + RGB2 + RGB3 + RGB4) >> 2;
+
+    // Write Y Plane
+    pOut[uiYPlaneOffset]     = rgbToY10(RGB1);
+    pOut[uiYPlaneOffset + 1] = rgbToY10(RGB2);
+
+    uiYPlaneOffset += vDim.z;
+
+    pOut[uiYPlaneOffset]     = rgbToY10(RGB3);
+    pOut[uiYPlaneOffset + 1] = rgbToY10(RGB4);
+
+    // Write U/V Plane
+    vstore2(rgbToUV10(RGB), 0, pOut + uiUVPlaneOffset + 2 * uiGlobalIdX + uiGlobalIdY * vDim.z);
+}
+
+
+// Same as rgbaToP010_image2d but scales the input image. Global work size is width/2, height/2 of the output image.
+__kernel void rgbaToP010_scaled_image2d(read_only image2d_t pIn, __global ushort* pOut, const int4 vDim, const int mirror, const float4 vScale)
+{
+    uint uiGlobalIdX = get_global_id(0);    // 0 - width /2
+    uint uiGlobalIdY = get_global_id(1);    // 0 - height/2
+
+    if (uiGlobalIdX >= vDim.x / 2 || uiGlobalIdY >= vDim.y / 2)
+    {
+        return;
+    }
+
+    // Offset to the start of the chroma plane
+    uint uiUVPlaneOffset = vDim.z * vDim.y;
+
+    uint uiYPlaneOffset = (uiGlobalIdX + uiGlobalIdY * vDim.z) << 1;
+
+    int4 RGB1, RGB2, RGB3, RGB4;
+
+    int2 pos = (int2)(uiGlobalIdX * 2, uiGlobalIdY * 2);
+
+    RGB1 = toRGB10(readScaled(pIn, pos, vScale, mirror));
+    RGB2 = toRGB10(readScaled(pIn, pos + (int2)(1, 0), vScale, mirror));
+    RGB3 = toRGB10(readScaled(pIn, pos + (int2)(0, 1), vScale, mirror));
+    RGB4 = toRGB10(readScaled(pIn, pos + (int2)(1, 1), vScale, mirror));
+
+    // Take average color
+    int4 RGB = (RGB1 + RGB2 + RGB3 + RGB4) >> 2;
+
+    // Write Y Plane
+    pOut[uiYPlaneOffset]     = rgbToY10(RGB1);
+    pOut[uiYPlaneOffset + 1] = rgbToY10(RGB2);
+
+    uiYPlaneOffset += vDim.z;
+
+    pOut[uiYPlaneOffset]     = rgbToY10(RGB3);
+    pOut[uiYPlaneOffset + 1] = rgbToY10(RGB4);
+
+    // Write U/V Plane
+    vstore2(rgbToUV10(RGB), 0, pOut + uiUVPlaneOffset + 2 * uiGlobalIdX + uiGlobalIdY * vDim.z);
+}
+
+
+// Same as rgbaToNV12_Planes but writes the 16-bit Y and U/V image of a P010 surface.
+__kernel void rgbaToP010_Planes(__read_only image2d_t rgbaIn, __write_only image2d_t yOut, const int4 vDim, const int mirror, __write_only image2d_t uvOut)
+{
+    uint uiGlobalId_X = get_global_id(0);
+    uint uiGlobalId_Y = get_global_id(1);
+
+    if (uiGlobalId_X >= vDim.x / 2 || uiGlobalId_Y >= vDim.y / 2)
+    {
+        return;
+    }
+
+    int4 RGB1, RGB2, RGB3, RGB4;
+
+    int2 SrcCoord = (int2)(uiGlobalId_X * 2, (mirror == 1) ? (vDim.y - 2 * uiGlobalId_Y - 1) : 2 * uiGlobalId_Y);
+    int2 DstCoord = (int2)((uiGlobalId_X * 2), (uiGlobalId_Y * 2));
+
+    RGB1 = toRGB10(read_imagef(rgbaIn, imageSampler, SrcCoord));
+    RGB2 = toRGB10(read_imagef(rgbaIn, imageSampler, SrcCoord + (int2)(1, 0)));
+
+    SrcCoord.y = (mirror == 1) ? (vDim.y - uiGlobalId_Y * 2 - 2) : (uiGlobalId_Y * 2 + 1);
+
+    RGB3 = toRGB10(read_imagef(rgbaIn, imageSampler, SrcCoord));
+    RGB4 = toRGB10(read_imagef(rgbaIn, imageSampler, SrcCoord + (int2)(1, 0)));
+
+    // Take average color
+    int4 RGB = (RGB1 + RGB2 + RGB3 + RGB4) >> 2;
+
+    // Write Y plane.
+    write_imageui(yOut, DstCoord, (uint4)(rgbToY10(RGB1), 0, 0, 0));
+    write_imageui(yOut, (int2)(DstCoord.x + 1, DstCoord.y), (uint4)(rgbToY10(RGB2), 0, 0, 0));
+    write_imageui(yOut, (int2)(DstCoord.x, DstCoord.y + 1), (uint4)(rgbToY10(RGB3), 0, 0, 0));
+    write_imageui(yOut, (int2)(DstCoord.x + 1, DstCoord.y + 1), (uint4)(rgbToY10(RGB4), 0, 0, 0));
+
+    // Store U and V of the average color interleaved in the uv image.
+    ushort2 UV = rgbToUV10(RGB);
+
+    write_imageui(uvOut, (int2)(uiGlobalId_X, uiGlobalId_Y), (uint4)(UV.x, UV.y, 0, 0));
+}
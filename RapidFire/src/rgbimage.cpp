@@ -399,20 +399,20 @@ extern void writeYUVImage(unsigned char* pPixel, unsigned int w, unsigned int h,
             yPtr += w;
         }
 
-        // Write u plane
+        // Write u plane. The pitch of the chroma planes is half the pitch of the Y plane.
         for (unsigned int i = 0; i < (h / 2); ++i)
         {
             of.write(yPtr, w / 2);
 
-            yPtr += w;
+            yPtr += w / 2;
         }
 
-        // Write u plane
+        // Write v plane
         for (unsigned int i = 0; i < (h / 2); ++i)
         {
             of.write(yPtr, w / 2);
 
-            yPtr += w;
+            yPtr += w / 2;
         }
     }
 }
\ No newline at end of file